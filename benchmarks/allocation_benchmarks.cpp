@@ -0,0 +1,178 @@
+#include <benchmark/benchmark.h>
+#include "orderbook/order_book.h"
+#include "legacy_order_book.h"
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Allocation-count benchmarks
+//
+// The global operator new is replaced below so every trip into the heap made
+// by the benchmark thread is counted. Each case reports `allocs_per_op`: for
+// the pooled book in steady state this should stay at zero, so any non-zero
+// value is an allocation regression on the hot path.
+
+namespace {
+thread_local size_t g_allocation_count = 0;
+}
+
+// GCC flags the malloc/free pairing once these get inlined into new/delete
+// call sites; the pairing is intentional for a replacement allocator.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+    ++g_allocation_count;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+using namespace clunk;
+
+namespace {
+
+constexpr int kRestingOrders = 10000;
+constexpr int kPriceLevels = 1000;
+
+std::chrono::nanoseconds allocTimestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    );
+}
+
+// Engine adapters: the key each book indexes orders by, parsed once up front
+OrderId allocId(const OrderBook&, const std::string& id) {
+    return OrderId::fromString(id);
+}
+
+std::string allocId(const legacy::OrderBook&, const std::string& id) {
+    return id;
+}
+
+// IDs padded to `length` characters (12 fits in SSO, 36 is a Coinbase UUID)
+template <typename Book>
+auto makeIds(const Book& book, int count, size_t length) {
+    std::vector<decltype(allocId(book, std::string()))> ids;
+    ids.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        std::string id = std::to_string(i);
+        id.insert(0, length > id.size() ? length - id.size() : 0, '0');
+        ids.push_back(allocId(book, id));
+    }
+    return ids;
+}
+
+// Prices on a 1.0 grid so orders share a bounded set of levels
+std::vector<double> makePrices(int count) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<> level_dist(0, kPriceLevels - 1);
+    std::vector<double> prices;
+    prices.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        prices.push_back(9500.0 + level_dist(rng));
+    }
+    return prices;
+}
+
+// Engine adapters: a size in each book's units (lots vs. raw doubles)
+Quantity allocSize(const OrderBook& book, double size) {
+    return book.getScale().toQuantity(size);
+}
+
+double allocSize(const legacy::OrderBook&, double size) {
+    return size;
+}
+
+bool addAllocOrder(OrderBook& book, const OrderId& id, double price, double size) {
+    const ProductScale& scale = book.getScale();
+    return book.addOrder(Order(id, OrderSide::BUY, scale.toPrice(price), scale.toQuantity(size),
+                               allocTimestamp()));
+}
+
+bool addAllocOrder(legacy::OrderBook& book, const std::string& id, double price, double size) {
+    return book.addOrder(std::make_shared<legacy::Order>(
+        id, legacy::OrderSide::BUY, price, size, allocTimestamp()));
+}
+
+void presize(OrderBook& book) {
+    book.reserve(kRestingOrders + kRestingOrders / 4, kPriceLevels);
+}
+
+void presize(legacy::OrderBook&) {
+}
+
+} // namespace
+
+// Steady-state cancel/replace/modify churn against a populated book
+template <typename Book>
+static void BM_SteadyStateAllocations(benchmark::State& state) {
+    Book book("BTC-USD");
+    presize(book);
+
+    auto ids = makeIds(book, kRestingOrders, static_cast<size_t>(state.range(0)));
+    auto prices = makePrices(kRestingOrders * 2);
+
+    for (int i = 0; i < kRestingOrders; ++i) {
+        addAllocOrder(book, ids[i], prices[i], 1.0);
+    }
+
+    auto new_size = allocSize(book, 3.0);
+    size_t index = 0;
+    size_t allocations_before = g_allocation_count;
+
+    for (auto _ : state) {
+        const auto& id = ids[index % kRestingOrders];
+        book.removeOrder(id);
+        addAllocOrder(book, id, prices[index % prices.size()], 2.0);
+        book.modifyOrder(ids[(index + kRestingOrders / 2) % kRestingOrders], new_size);
+        ++index;
+    }
+
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        static_cast<double>(g_allocation_count - allocations_before),
+        benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_TEMPLATE(BM_SteadyStateAllocations, OrderBook)->Arg(12)->Arg(36);
+BENCHMARK_TEMPLATE(BM_SteadyStateAllocations, legacy::OrderBook)->Arg(12)->Arg(36);
+
+// Repeated clear-and-rebuild, as done when a book is re-snapshotted
+template <typename Book>
+static void BM_RebuildAllocations(benchmark::State& state) {
+    Book book("BTC-USD");
+    presize(book);
+
+    auto ids = makeIds(book, static_cast<int>(state.range(0)), 12);
+    auto prices = makePrices(static_cast<int>(state.range(0)));
+
+    size_t allocations_before = g_allocation_count;
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            addAllocOrder(book, ids[i], prices[i], 1.0);
+        }
+        for (const auto& id : ids) {
+            book.removeOrder(id);
+        }
+    }
+
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        static_cast<double>(g_allocation_count - allocations_before),
+        benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_TEMPLATE(BM_RebuildAllocations, OrderBook)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_RebuildAllocations, legacy::OrderBook)->Arg(1000);
@@ -0,0 +1,184 @@
+#include <benchmark/benchmark.h>
+#include "feed_handlers/coinbase_decoder.h"
+#include "orderbook/fixed_point.h"
+#include "orderbook/order_id.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using namespace clunk;
+using json = nlohmann::json;
+
+namespace {
+
+// Messages in the shape Coinbase sends them (taken from a recorded session)
+std::vector<std::string> recordedMessages() {
+    return {
+        R"({"type":"l2update","product_id":"BTC-USD","changes":[["buy","64998.41","0.01538461"]],"time":"2024-05-02T14:03:11.583337Z"})",
+        R"({"type":"l2update","product_id":"BTC-USD","changes":[["sell","65003.17","0.00000000"]],"time":"2024-05-02T14:03:11.583512Z"})",
+        R"({"type":"ticker","sequence":79050182046,"product_id":"BTC-USD","price":"65001.02","open_24h":"63410.5","volume_24h":"14512.01874012","low_24h":"63012.44","high_24h":"65540","volume_30d":"402101.40882385","best_bid":"65001.01","best_bid_size":"0.12408208","best_ask":"65001.02","best_ask_size":"0.03124234","side":"buy","time":"2024-05-02T14:03:11.590031Z","trade_id":630780071,"last_size":"0.00019076"})",
+        R"({"type":"open","side":"buy","product_id":"BTC-USD","time":"2024-05-02T14:03:11.601000Z","sequence":79050182047,"price":"64990.15","order_id":"d50ec984-77a8-460a-b958-66f114b0de9b","remaining_size":"0.25"})",
+        R"({"type":"done","side":"sell","product_id":"BTC-USD","time":"2024-05-02T14:03:11.603126Z","sequence":79050182048,"order_id":"ac928c66-ca53-498f-9c13-a110027a60e8","reason":"canceled","price":"65010.02","remaining_size":"0.5"})",
+        R"({"type":"match","trade_id":630780072,"maker_order_id":"ac928c66-ca53-498f-9c13-a110027a60e8","taker_order_id":"132fb6ae-456b-4654-b4e0-d681ac05cea1","side":"sell","size":"0.00512","price":"65001.01","product_id":"BTC-USD","sequence":79050182049,"time":"2024-05-02T14:03:11.604585Z"})",
+    };
+}
+
+// Snapshot with `depth` levels per side
+std::string snapshotMessage(size_t depth) {
+    std::string text = R"({"type":"snapshot","product_id":"BTC-USD","bids":[)";
+    for (size_t i = 0; i < depth; ++i) {
+        text += (i ? "," : "");
+        text += "[\"" + formatFixed(6500000 - static_cast<Price>(i), 2) + "\",\"0.0" + std::to_string(i % 97 + 1) + "\"]";
+    }
+    text += R"(],"asks":[)";
+    for (size_t i = 0; i < depth; ++i) {
+        text += (i ? "," : "");
+        text += "[\"" + formatFixed(6500001 + static_cast<Price>(i), 2) + "\",\"1." + std::to_string(i % 89) + "\"]";
+    }
+    return text + "]}";
+}
+
+// The previous handler path: parse a DOM, look up and copy fields, parse
+// decimals from the DOM strings
+int64_t decodeWithDom(const std::string& text) {
+    json j = json::parse(text);
+    std::string type = j["type"];
+    std::string symbol = j["product_id"];
+    int64_t checksum = static_cast<int64_t>(symbol.size());
+    int64_t value = 0;
+
+    auto scaled = [&](const json& field, int decimals) {
+        parseFixed(field.get_ref<const std::string&>(), decimals, value);
+        checksum += value;
+    };
+
+    if (type == "l2update") {
+        for (const auto& change : j["changes"]) {
+            std::string side = change[0];
+            checksum += side == "buy" ? 0 : 1;
+            scaled(change[1], 2);
+            scaled(change[2], 8);
+        }
+    } else if (type == "ticker") {
+        scaled(j["best_bid"], 2);
+        scaled(j["best_bid_size"], 8);
+        scaled(j["best_ask"], 2);
+        scaled(j["best_ask_size"], 8);
+    } else if (type == "open") {
+        checksum += static_cast<int64_t>(OrderId::fromString(j["order_id"].get<std::string>()).lo);
+        std::string side = j["side"];
+        checksum += side == "buy" ? 0 : 1;
+        scaled(j["price"], 2);
+    } else if (type == "done") {
+        checksum += static_cast<int64_t>(OrderId::fromString(j["order_id"].get<std::string>()).lo);
+    } else if (type == "match") {
+        checksum += static_cast<int64_t>(OrderId::fromString(j["maker_order_id"].get<std::string>()).lo);
+        scaled(j["size"], 8);
+    } else if (type == "snapshot") {
+        for (const char* side : {"bids", "asks"}) {
+            for (const auto& level : j[side]) {
+                scaled(level[0], 2);
+                scaled(level[1], 8);
+            }
+        }
+    }
+    return checksum;
+}
+
+// The streaming decoder path, extracting the same fields
+int64_t decodeStreaming(std::string_view text) {
+    CoinbaseMessage m;
+    decodeCoinbaseMessage(text, m);
+    int64_t checksum = static_cast<int64_t>(m.product_id.size());
+    int64_t value = 0;
+
+    auto scaled = [&](std::string_view field, int decimals) {
+        parseFixed(field, decimals, value);
+        checksum += value;
+    };
+
+    switch (m.type) {
+        case CoinbaseMessageType::L2UPDATE:
+            forEachRow(m.changes, [&](const JsonRow& change) {
+                checksum += static_cast<int64_t>(coinbaseSide(change[0]));
+                scaled(change[1], 2);
+                scaled(change[2], 8);
+            });
+            break;
+        case CoinbaseMessageType::TICKER:
+            scaled(m.best_bid, 2);
+            scaled(m.best_bid_size, 8);
+            scaled(m.best_ask, 2);
+            scaled(m.best_ask_size, 8);
+            break;
+        case CoinbaseMessageType::OPEN:
+            checksum += static_cast<int64_t>(OrderId::fromString(m.order_id).lo);
+            checksum += static_cast<int64_t>(m.order_side);
+            scaled(m.price, 2);
+            break;
+        case CoinbaseMessageType::DONE:
+            checksum += static_cast<int64_t>(OrderId::fromString(m.order_id).lo);
+            break;
+        case CoinbaseMessageType::MATCH:
+            checksum += static_cast<int64_t>(OrderId::fromString(m.maker_order_id).lo);
+            scaled(m.size, 8);
+            break;
+        case CoinbaseMessageType::SNAPSHOT:
+            for (std::string_view levels : {m.bids, m.asks}) {
+                forEachRow(levels, [&](const JsonRow& level) {
+                    scaled(level[0], 2);
+                    scaled(level[1], 8);
+                });
+            }
+            break;
+        default:
+            break;
+    }
+    return checksum;
+}
+
+} // namespace
+
+// Benchmark decoding the recorded update mix through a DOM (previous path)
+static void BM_DecodeUpdatesDom(benchmark::State& state) {
+    std::vector<std::string> messages = recordedMessages();
+    for (auto _ : state) {
+        for (const std::string& message : messages) {
+            benchmark::DoNotOptimize(decodeWithDom(message));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(messages.size()));
+}
+BENCHMARK(BM_DecodeUpdatesDom);
+
+// Benchmark decoding the recorded update mix with the streaming decoder
+static void BM_DecodeUpdatesStreaming(benchmark::State& state) {
+    std::vector<std::string> messages = recordedMessages();
+    for (auto _ : state) {
+        for (const std::string& message : messages) {
+            benchmark::DoNotOptimize(decodeStreaming(message));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(messages.size()));
+}
+BENCHMARK(BM_DecodeUpdatesStreaming);
+
+// Benchmark decoding a deep snapshot through a DOM (previous path)
+static void BM_DecodeSnapshotDom(benchmark::State& state) {
+    std::string message = snapshotMessage(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(decodeWithDom(message));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(message.size()));
+}
+BENCHMARK(BM_DecodeSnapshotDom)->Arg(1000)->Arg(10000);
+
+// Benchmark decoding a deep snapshot with the streaming decoder
+static void BM_DecodeSnapshotStreaming(benchmark::State& state) {
+    std::string message = snapshotMessage(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(decodeStreaming(message));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(message.size()));
+}
+BENCHMARK(BM_DecodeSnapshotStreaming)->Arg(1000)->Arg(10000);
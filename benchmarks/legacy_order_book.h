@@ -0,0 +1,229 @@
+#pragma once
+
+// Frozen copy of the original shared_ptr/string-keyed order book, kept only so
+// the benchmarks can compare the current engine against it side by side.
+// Do not use this outside of benchmarks.
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace clunk {
+namespace legacy {
+
+enum class OrderSide : uint8_t {
+    BUY = 0,
+    SELL = 1
+};
+
+class Order {
+public:
+    Order(const std::string& id, OrderSide side, double price, double size,
+          std::chrono::nanoseconds timestamp)
+        : id_(id), side_(side), price_(price), size_(size), timestamp_(timestamp) {
+    }
+
+    const std::string& getId() const { return id_; }
+    OrderSide getSide() const { return side_; }
+    double getPrice() const { return price_; }
+    double getSize() const { return size_; }
+    void setSize(double size) { size_ = size; }
+
+private:
+    std::string id_;
+    OrderSide side_;
+    double price_;
+    double size_;
+    std::chrono::nanoseconds timestamp_;
+};
+
+class PriceLevel {
+public:
+    explicit PriceLevel(double price) : price_(price), total_size_(0.0) {}
+
+    double getTotalSize() const { return total_size_; }
+    bool isEmpty() const { return orders_.empty(); }
+
+    bool addOrder(const std::shared_ptr<Order>& order) {
+        if (std::abs(order->getPrice() - price_) > std::numeric_limits<double>::epsilon()) {
+            return false;
+        }
+        if (orders_.find(order->getId()) != orders_.end()) {
+            return false;
+        }
+        orders_[order->getId()] = order;
+        total_size_ += order->getSize();
+        return true;
+    }
+
+    bool removeOrder(const std::string& order_id) {
+        auto it = orders_.find(order_id);
+        if (it == orders_.end()) {
+            return false;
+        }
+        total_size_ -= it->second->getSize();
+        orders_.erase(it);
+        return true;
+    }
+
+    bool updateOrder(const std::string& order_id, double new_size) {
+        auto it = orders_.find(order_id);
+        if (it == orders_.end()) {
+            return false;
+        }
+        double old_size = it->second->getSize();
+        it->second->setSize(new_size);
+        total_size_ = total_size_ - old_size + new_size;
+        return true;
+    }
+
+private:
+    double price_;
+    double total_size_;
+    std::unordered_map<std::string, std::shared_ptr<Order>> orders_;
+};
+
+class OrderBook {
+public:
+    explicit OrderBook(const std::string& symbol) : symbol_(symbol) {}
+
+    bool addOrder(const std::shared_ptr<Order>& order) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (orders_.find(order->getId()) != orders_.end()) {
+            return false;
+        }
+        double price = order->getPrice();
+        if (order->getSide() == OrderSide::BUY) {
+            auto it = bid_levels_.find(price);
+            if (it == bid_levels_.end()) {
+                auto level = std::make_unique<PriceLevel>(price);
+                level->addOrder(order);
+                bid_levels_[price] = std::move(level);
+            } else {
+                it->second->addOrder(order);
+            }
+        } else {
+            auto it = ask_levels_.find(price);
+            if (it == ask_levels_.end()) {
+                auto level = std::make_unique<PriceLevel>(price);
+                level->addOrder(order);
+                ask_levels_[price] = std::move(level);
+            } else {
+                it->second->addOrder(order);
+            }
+        }
+        orders_[order->getId()] = order;
+        notifyUpdate();
+        return true;
+    }
+
+    bool removeOrder(const std::string& order_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto order_it = orders_.find(order_id);
+        if (order_it == orders_.end()) {
+            return false;
+        }
+        std::shared_ptr<Order> order = order_it->second;
+        double price = order->getPrice();
+        if (order->getSide() == OrderSide::BUY) {
+            auto level_it = bid_levels_.find(price);
+            if (level_it != bid_levels_.end()) {
+                level_it->second->removeOrder(order_id);
+                if (level_it->second->isEmpty()) {
+                    bid_levels_.erase(level_it);
+                }
+            }
+        } else {
+            auto level_it = ask_levels_.find(price);
+            if (level_it != ask_levels_.end()) {
+                level_it->second->removeOrder(order_id);
+                if (level_it->second->isEmpty()) {
+                    ask_levels_.erase(level_it);
+                }
+            }
+        }
+        orders_.erase(order_it);
+        notifyUpdate();
+        return true;
+    }
+
+    bool modifyOrder(const std::string& order_id, double new_size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto order_it = orders_.find(order_id);
+        if (order_it == orders_.end()) {
+            return false;
+        }
+        std::shared_ptr<Order> order = order_it->second;
+        double price = order->getPrice();
+        bool success = false;
+        if (order->getSide() == OrderSide::BUY) {
+            auto level_it = bid_levels_.find(price);
+            if (level_it != bid_levels_.end()) {
+                success = level_it->second->updateOrder(order_id, new_size);
+            }
+        } else {
+            auto level_it = ask_levels_.find(price);
+            if (level_it != ask_levels_.end()) {
+                success = level_it->second->updateOrder(order_id, new_size);
+            }
+        }
+        if (success) {
+            notifyUpdate();
+        }
+        return success;
+    }
+
+    double getBestBid() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bid_levels_.empty() ? 0.0 : bid_levels_.begin()->first;
+    }
+
+    double getBestAsk() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ask_levels_.empty() ? std::numeric_limits<double>::max() : ask_levels_.begin()->first;
+    }
+
+    std::vector<std::pair<double, double>> getBidLevels(size_t depth) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::pair<double, double>> result;
+        for (const auto& [price, level] : bid_levels_) {
+            if (result.size() >= depth) break;
+            result.emplace_back(price, level->getTotalSize());
+        }
+        return result;
+    }
+
+    std::vector<std::pair<double, double>> getAskLevels(size_t depth) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::pair<double, double>> result;
+        for (const auto& [price, level] : ask_levels_) {
+            if (result.size() >= depth) break;
+            result.emplace_back(price, level->getTotalSize());
+        }
+        return result;
+    }
+
+private:
+    std::string symbol_;
+    std::map<double, std::unique_ptr<PriceLevel>, std::greater<>> bid_levels_;
+    std::map<double, std::unique_ptr<PriceLevel>> ask_levels_;
+    std::unordered_map<std::string, std::shared_ptr<Order>> orders_;
+    mutable std::mutex mutex_;
+    std::function<void()> update_callback_;
+
+    void notifyUpdate() {
+        if (update_callback_) {
+            update_callback_();
+        }
+    }
+};
+
+} // namespace legacy
+} // namespace clunk
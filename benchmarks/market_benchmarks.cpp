@@ -0,0 +1,407 @@
+#include <benchmark/benchmark.h>
+#include "market_data.h"
+#include "feed_handlers/capture_log.h"
+#include "feed_handlers/coinbase_decoder.h"
+#include "feed_handlers/coinbase_handler.h"
+#include "orderbook/level_book.h"
+#include "orderbook/order_book.h"
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace clunk;
+using namespace clunk::bench;
+
+// Benchmarks on market-shaped data (see MarketGenerator), each reporting
+// per-operation percentiles next to Google Benchmark's mean
+
+namespace {
+
+// Events per generated stream; the book is rebuilt (untimed) on wrap
+constexpr size_t kStreamLength = 1 << 18;
+
+// A book seeded with `seed` (rebuilt whenever the stream wraps)
+template <typename Book>
+std::unique_ptr<Book> seededBook(const std::vector<BookEvent>& seed) {
+    auto book = std::make_unique<Book>("BTC-USD");
+    for (const BookEvent& event : seed) {
+        applyEvent(*book, event);
+    }
+    return book;
+}
+
+} // namespace
+
+// Benchmark order-level flow: adds, cancels and partial fills in the mix of
+// a live full channel, on a book of state.range(0) resting orders
+template <typename Book>
+static void BM_MarketL3Flow(benchmark::State& state) {
+    MarketGenerator generator;
+    std::vector<BookEvent> seed = generator.seed(static_cast<size_t>(state.range(0)));
+    std::vector<BookEvent> events = generator.flow(kStreamLength);
+    std::unique_ptr<Book> book = seededBook<Book>(seed);
+    auto timer = std::make_unique<OpTimer>();
+
+    size_t index = 0;
+    for (auto _ : state) {
+        if (index == events.size()) {
+            state.PauseTiming();
+            book = seededBook<Book>(seed);
+            index = 0;
+            state.ResumeTiming();
+        }
+        uint64_t started = timer->start();
+        benchmark::DoNotOptimize(applyEvent(*book, events[index++]));
+        timer->stop(started);
+    }
+    timer->report(state);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_MarketL3Flow, OrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_MarketL3Flow, LadderOrderBook)->Arg(1000)->Arg(10000);
+
+// Benchmark level2 changes crowded at the touch, as on a live feed, on a
+// book seeded with a state.range(0)-level snapshot
+template <typename Book>
+static void BM_MarketL2Changes(benchmark::State& state) {
+    MarketGenerator generator;
+    std::vector<LevelUpdate> levels = generator.snapshot(static_cast<size_t>(state.range(0)));
+    std::vector<LevelUpdate> changes = generator.levelChanges(kStreamLength);
+    Book book("BTC-USD");
+    book.loadSnapshot(levels.data(), levels.size());
+    auto timer = std::make_unique<OpTimer>();
+
+    size_t index = 0;
+    for (auto _ : state) {
+        uint64_t started = timer->start();
+        book.applyUpdates(&changes[index], 1);
+        timer->stop(started);
+        index = (index + 1) % changes.size();
+    }
+    timer->report(state);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["touch%"] = book.getTouchStats().hitRate() * 100.0;
+}
+BENCHMARK_TEMPLATE(BM_MarketL2Changes, OrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_MarketL2Changes, LadderOrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_MarketL2Changes, LevelBook)->Arg(1000)->Arg(10000);
+
+// Benchmark resizing the best bid and ask only (the ticker-driven and
+// touch-crowded case the best-level slot serves without a tree walk)
+template <typename Book>
+static void BM_TouchChanges(benchmark::State& state) {
+    MarketGenerator generator;
+    std::vector<LevelUpdate> levels = generator.snapshot(static_cast<size_t>(state.range(0)));
+    Book book("BTC-USD");
+    book.loadSnapshot(levels.data(), levels.size());
+    TopOfBook top = book.getTopOfBook();
+
+    Quantity size = 1;
+    for (auto _ : state) {
+        LevelUpdate change{size % 2 ? OrderSide::BUY : OrderSide::SELL, size % 2 ? top.bid_price : top.ask_price,
+                           1 + size % 7, OrderId()};
+        book.applyUpdates(&change, 1);
+        ++size;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["touch%"] = book.getTouchStats().hitRate() * 100.0;
+}
+BENCHMARK_TEMPLATE(BM_TouchChanges, OrderBook)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_TouchChanges, LadderOrderBook)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_TouchChanges, LevelBook)->Arg(10000);
+
+// Benchmark the same level2 changes with state.range(0) delta subscribers
+// attached. The timer covers only the writer's applyUpdates(); subscribers
+// are drained every 256 changes, inside the loop but outside the timer.
+template <typename Book>
+static void BM_MarketL2Subscribers(benchmark::State& state) {
+    MarketGenerator generator;
+    std::vector<LevelUpdate> levels = generator.snapshot(1000);
+    std::vector<LevelUpdate> changes = generator.levelChanges(kStreamLength);
+    Book book("BTC-USD");
+    book.loadSnapshot(levels.data(), levels.size());
+    std::vector<std::shared_ptr<BookSubscription>> subscriptions;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        subscriptions.push_back(book.subscribe());
+    }
+    auto timer = std::make_unique<OpTimer>();
+
+    size_t index = 0;
+    size_t deltas = 0;
+    for (auto _ : state) {
+        uint64_t started = timer->start();
+        book.applyUpdates(&changes[index], 1);
+        timer->stop(started);
+        index = (index + 1) % changes.size();
+
+        if ((index & 255) == 0) {
+            for (const auto& subscription : subscriptions) {
+                deltas += subscription->poll([](const LevelDelta&) {});
+            }
+        }
+    }
+    benchmark::DoNotOptimize(deltas);
+    timer->report(state);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_MarketL2Subscribers, LadderOrderBook)->Arg(0)->Arg(1)->Arg(3);
+BENCHMARK_TEMPLATE(BM_MarketL2Subscribers, LevelBook)->Arg(0)->Arg(1)->Arg(3);
+
+// Benchmark bulk-loading a snapshot whose levels thin out away from the touch
+template <typename Book>
+static void BM_MarketSnapshotLoad(benchmark::State& state) {
+    MarketGenerator generator;
+    std::vector<LevelUpdate> levels = generator.snapshot(static_cast<size_t>(state.range(0)));
+    Book book("BTC-USD");
+    auto timer = std::make_unique<OpTimer>();
+
+    for (auto _ : state) {
+        uint64_t started = timer->start();
+        book.loadSnapshot(levels.data(), levels.size());
+        timer->stop(started);
+    }
+    timer->report(state);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(levels.size()));
+}
+BENCHMARK_TEMPLATE(BM_MarketSnapshotLoad, OrderBook)->Arg(1000)->Arg(50000);
+BENCHMARK_TEMPLATE(BM_MarketSnapshotLoad, LadderOrderBook)->Arg(1000)->Arg(50000);
+BENCHMARK_TEMPLATE(BM_MarketSnapshotLoad, LevelBook)->Arg(1000)->Arg(50000);
+
+namespace {
+
+// State shared by the writer and reader threads of BM_TopOfBookReaders
+template <typename Book>
+struct ReaderContention {
+    std::unique_ptr<Book> book;
+    std::vector<LevelUpdate> changes;
+    std::mutex mutex;
+    std::unique_ptr<OpTimer> readers;
+    std::atomic<int> readers_done{0};
+
+    static ReaderContention& get() {
+        static ReaderContention contention;
+        return contention;
+    }
+};
+
+} // namespace
+
+// Benchmark one writer applying level2 changes while the other threads poll
+// the top of book, as strategy and display threads do. Thread 0 writes;
+// writer_* counters time its updates and reader_* counters the polls.
+template <typename Book>
+static void BM_TopOfBookReaders(benchmark::State& state) {
+    ReaderContention<Book>& contention = ReaderContention<Book>::get();
+    const bool writer = state.thread_index() == 0;
+    if (writer) {
+        MarketGenerator generator;
+        std::vector<LevelUpdate> levels = generator.snapshot(1000);
+        contention.changes = generator.levelChanges(kStreamLength);
+        contention.book = std::make_unique<Book>("BTC-USD");
+        contention.book->loadSnapshot(levels.data(), levels.size());
+        contention.readers = std::make_unique<OpTimer>();
+        contention.readers_done = 0;
+    }
+
+    auto timer = std::make_unique<OpTimer>();
+    size_t index = 0;
+    for (auto _ : state) {
+        uint64_t started = timer->start();
+        if (writer) {
+            contention.book->applyUpdates(&contention.changes[index], 1);
+            index = (index + 1) % contention.changes.size();
+        } else {
+            benchmark::DoNotOptimize(contention.book->getTopOfBook());
+        }
+        timer->stop(started);
+    }
+
+    if (!writer) {
+        std::lock_guard<std::mutex> lock(contention.mutex);
+        contention.readers->merge(*timer);
+        ++contention.readers_done;
+        return;
+    }
+
+    // Report once every reader has handed in its samples
+    while (contention.readers_done.load() < state.threads() - 1) {
+        std::this_thread::yield();
+    }
+    timer->report(state, "writer_");
+    if (state.threads() > 1) {
+        contention.readers->report(state, "reader_");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_TopOfBookReaders, LevelBook)->Threads(1)->Threads(2)->Threads(4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TopOfBookReaders, LadderOrderBook)->Threads(1)->Threads(2)->Threads(4)->UseRealTime();
+
+// Benchmark one writer applying level2 changes while the other threads read
+// 10 levels of depth, either under the book lock (state.range(0) == 0) or
+// from the depth the writer publishes (1). Counters as BM_TopOfBookReaders.
+template <typename Book>
+static void BM_DepthReaders(benchmark::State& state) {
+    ReaderContention<Book>& contention = ReaderContention<Book>::get();
+    const bool writer = state.thread_index() == 0;
+    const bool published = state.range(0) != 0;
+    if (writer) {
+        MarketGenerator generator;
+        std::vector<LevelUpdate> levels = generator.snapshot(1000);
+        contention.changes = generator.levelChanges(kStreamLength);
+        contention.book = std::make_unique<Book>("BTC-USD");
+        contention.book->loadSnapshot(levels.data(), levels.size());
+        if (published) {
+            contention.book->enableDepthPublishing(10);
+        }
+        contention.readers = std::make_unique<OpTimer>();
+        contention.readers_done = 0;
+    }
+
+    auto timer = std::make_unique<OpTimer>();
+    DepthSnapshot snapshot;
+    size_t index = 0;
+    for (auto _ : state) {
+        uint64_t started = timer->start();
+        if (writer) {
+            contention.book->applyUpdates(&contention.changes[index], 1);
+            index = (index + 1) % contention.changes.size();
+        } else if (published) {
+            PublishedDepth depth = contention.book->getPublishedDepth();
+            benchmark::DoNotOptimize(depth->bids.sizes.data());
+        } else {
+            contention.book->getDepthSnapshot(10, snapshot);
+            benchmark::DoNotOptimize(snapshot.bids.sizes.data());
+        }
+        timer->stop(started);
+    }
+
+    if (!writer) {
+        std::lock_guard<std::mutex> lock(contention.mutex);
+        contention.readers->merge(*timer);
+        ++contention.readers_done;
+        return;
+    }
+
+    while (contention.readers_done.load() < state.threads() - 1) {
+        std::this_thread::yield();
+    }
+    timer->report(state, "writer_");
+    if (state.threads() > 1) {
+        contention.readers->report(state, "reader_");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_DepthReaders, LevelBook)->Arg(0)->Arg(1)->Threads(1)->Threads(3)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_DepthReaders, LadderOrderBook)->Arg(0)->Arg(1)->Threads(1)->Threads(3)->UseRealTime();
+
+// Benchmark the whole handler path for one message: decode, sequence
+// check, book update and publish, on level2 traffic in Coinbase's format
+static void BM_HandleMessage(benchmark::State& state) {
+    MarketGenerator generator;
+    std::vector<LevelUpdate> levels = generator.snapshot(1000);
+    std::vector<std::string> messages;
+    for (const LevelUpdate& change : generator.levelChanges(1 << 14)) {
+        messages.push_back(generator.l2updateMessage("BTC-USD", change));
+    }
+
+    CoinbaseHandler handler;
+    handler.subscribe("BTC-USD");
+    handler.injectMessage(generator.snapshotMessage("BTC-USD", levels));
+    auto timer = std::make_unique<OpTimer>();
+
+    size_t index = 0;
+    for (auto _ : state) {
+        uint64_t started = timer->start();
+        handler.injectMessage(messages[index]);
+        timer->stop(started);
+        index = (index + 1) % messages.size();
+    }
+    timer->report(state);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HandleMessage);
+
+// Benchmark the handler path for a whole snapshot message
+static void BM_HandleSnapshotMessage(benchmark::State& state) {
+    MarketGenerator generator;
+    std::string snapshot = generator.snapshotMessage(
+        "BTC-USD", generator.snapshot(static_cast<size_t>(state.range(0))));
+
+    CoinbaseHandler handler;
+    handler.subscribe("BTC-USD");
+    auto timer = std::make_unique<OpTimer>();
+
+    for (auto _ : state) {
+        uint64_t started = timer->start();
+        handler.injectMessage(snapshot);
+        timer->stop(started);
+    }
+    timer->report(state);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(snapshot.size()));
+}
+BENCHMARK(BM_HandleSnapshotMessage)->Arg(1000)->Arg(50000);
+
+namespace {
+
+// Replay a recorded session (set CLUNK_BENCH_CAPTURE to a --capture file)
+// message by message through the handler; the capture is replayed from
+// the top, with fresh books, each time it runs out
+void BM_HandleCapturedMessages(benchmark::State& state, const std::string& path) {
+    CaptureReader reader(path);
+    std::set<std::string> products;
+    std::vector<std::string_view> messages;
+    CaptureRecord record;
+    while (reader.next(record)) {
+        messages.push_back(record.payload);
+        std::string_view product = peekProductId(record.payload);
+        if (!product.empty()) {
+            products.emplace(product);
+        }
+    }
+    if (messages.empty()) {
+        state.SkipWithError("Capture has no messages");
+        return;
+    }
+
+    auto makeHandler = [&products]() {
+        auto handler = std::make_unique<CoinbaseHandler>();
+        for (const std::string& product : products) {
+            handler->subscribe(product);
+        }
+        return handler;
+    };
+
+    std::unique_ptr<CoinbaseHandler> handler = makeHandler();
+    auto timer = std::make_unique<OpTimer>();
+    size_t index = 0;
+    for (auto _ : state) {
+        if (index == messages.size()) {
+            state.PauseTiming();
+            handler = makeHandler();
+            index = 0;
+            state.ResumeTiming();
+        }
+        uint64_t started = timer->start();
+        handler->injectMessage(messages[index++]);
+        timer->stop(started);
+    }
+    timer->report(state);
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Registered only when a capture is given
+const bool kCaptureRegistered = []() {
+    const char* path = std::getenv("CLUNK_BENCH_CAPTURE");
+    if (path == nullptr || *path == '\0') {
+        return false;
+    }
+    benchmark::RegisterBenchmark("BM_HandleCapturedMessages", BM_HandleCapturedMessages, std::string(path));
+    return true;
+}();
+
+} // namespace
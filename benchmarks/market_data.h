@@ -0,0 +1,239 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include "orderbook/book_view.h"
+#include "orderbook/fixed_point.h"
+#include "orderbook/order.h"
+#include "orderbook/order_id.h"
+#include "utils/latency_histogram.h"
+#include "utils/time_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace clunk {
+namespace bench {
+
+// Share of each event type in generated L3 flow
+//
+// The defaults follow the shape of a liquid product's full channel, where
+// nearly every order is cancelled rather than filled: adds and cancels
+// dominate in equal measure (so the resting book neither grows nor drains)
+// and a small share of events are fills or size changes.
+struct FlowMix {
+    double add = 0.45;
+    double cancel = 0.45;
+    double modify = 0.10;
+};
+
+// What an L3 event does to the book
+enum class BookEventKind : uint8_t {
+    ADD,
+    MODIFY,
+    CANCEL
+};
+
+// One pre-built L3 event (IDs are built up front so timed loops measure
+// the book, not ID formatting)
+struct BookEvent {
+    BookEventKind kind = BookEventKind::ADD;
+    OrderSide side = OrderSide::BUY;
+    Price price = 0;
+    Quantity size = 0;
+    OrderId id;
+};
+
+// Synthetic market data shaped like a liquid Coinbase product
+//
+// Prices sit a geometric number of ticks behind the touch, so activity
+// crowds the best few levels with a long thin tail, as it does on a real
+// book. Sizes are log-normal in lots: many small orders, a few large ones.
+// Everything is drawn from a fixed seed, so runs are comparable.
+class MarketGenerator {
+public:
+    // `touch_ticks`: best bid in ticks (the best ask is one tick above);
+    // `mean_distance`: mean ticks behind the touch
+    explicit MarketGenerator(const ProductScale& scale = ProductScale(2, 8), Price touch_ticks = 6500000,
+                             double mean_distance = 8.0, uint64_t seed = 42)
+        : scale_(scale), touch_(touch_ticks), distance_(1.0 / (1.0 + mean_distance)), rng_(seed) {}
+
+    const ProductScale& getScale() const { return scale_; }
+
+    // Price for a new order or level change on `side`
+    Price nextPrice(OrderSide side) {
+        Price distance = std::min<Price>(distance_(rng_), kMaxDistance);
+        return side == OrderSide::BUY ? touch_ - distance : touch_ + 1 + distance;
+    }
+
+    // Size for a new order or level, at least one lot
+    Quantity nextSize() {
+        double units = std::exp(size_(rng_));
+        return std::max<Quantity>(1, scale_.toQuantity(units));
+    }
+
+    // Either side, evenly
+    OrderSide nextSide() { return coin_(rng_) ? OrderSide::BUY : OrderSide::SELL; }
+
+    // Orders to seed a book with before replaying flow()
+    std::vector<BookEvent> seed(size_t resting) {
+        live_.clear();
+        std::vector<BookEvent> events;
+        events.reserve(resting);
+        for (size_t i = 0; i < resting; ++i) {
+            events.push_back(makeAdd());
+        }
+        return events;
+    }
+
+    // `count` events continuing from the book seed() (and earlier calls)
+    // built, drawn per the mix; cancels and modifies pick a random live
+    // order, a modify shrinks it as a partial fill would
+    std::vector<BookEvent> flow(size_t count, const FlowMix& mix = FlowMix()) {
+        std::uniform_real_distribution<double> pick(0.0, mix.add + mix.cancel + mix.modify);
+        std::vector<BookEvent> events;
+        events.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            double draw = pick(rng_);
+            if (live_.empty() || draw < mix.add) {
+                events.push_back(makeAdd());
+                continue;
+            }
+
+            size_t index = std::uniform_int_distribution<size_t>(0, live_.size() - 1)(rng_);
+            BookEvent event = live_[index];
+            if (draw < mix.add + mix.cancel || event.size <= 1) {
+                event.kind = BookEventKind::CANCEL;
+                live_[index] = live_.back();
+                live_.pop_back();
+            } else {
+                event.kind = BookEventKind::MODIFY;
+                event.size = std::uniform_int_distribution<Quantity>(1, event.size - 1)(rng_);
+                live_[index].size = event.size;
+            }
+            events.push_back(event);
+        }
+        return events;
+    }
+
+    // `count` level2 changes: one in four removes its level
+    std::vector<LevelUpdate> levelChanges(size_t count) {
+        std::vector<LevelUpdate> changes;
+        changes.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            OrderSide side = nextSide();
+            Quantity size = quarter_(rng_) == 0 ? 0 : nextSize();
+            changes.push_back({side, nextPrice(side), size, OrderId()});
+        }
+        return changes;
+    }
+
+    // A snapshot of `depth` levels per side, best first, with the gaps
+    // between populated levels widening away from the touch
+    std::vector<LevelUpdate> snapshot(size_t depth) {
+        std::vector<LevelUpdate> levels;
+        levels.reserve(2 * depth);
+        for (OrderSide side : {OrderSide::BUY, OrderSide::SELL}) {
+            Price price = side == OrderSide::BUY ? touch_ : touch_ + 1;
+            for (size_t i = 0; i < depth; ++i) {
+                levels.push_back({side, price, nextSize(), OrderId()});
+                Price gap = 1 + static_cast<Price>(i / 64) + gap_(rng_);
+                price += side == OrderSide::BUY ? -gap : gap;
+            }
+        }
+        return levels;
+    }
+
+    // Coinbase level2 messages for the same data
+    std::string snapshotMessage(const std::string& symbol, const std::vector<LevelUpdate>& levels) const {
+        std::string bids;
+        std::string asks;
+        for (const LevelUpdate& level : levels) {
+            std::string& out = level.side == OrderSide::BUY ? bids : asks;
+            out += out.empty() ? "[\"" : ",[\"";
+            out += scale_.formatPrice(level.price) + "\",\"" + scale_.formatSize(level.size) + "\"]";
+        }
+        return R"({"type":"snapshot","product_id":")" + symbol + R"(","bids":[)" + bids +
+               R"(],"asks":[)" + asks + "]}";
+    }
+
+    std::string l2updateMessage(const std::string& symbol, const LevelUpdate& change) const {
+        return R"({"type":"l2update","product_id":")" + symbol + R"(","changes":[[")" +
+               (change.side == OrderSide::BUY ? "buy" : "sell") + "\",\"" + scale_.formatPrice(change.price) +
+               "\",\"" + scale_.formatSize(change.size) + R"("]],"time":"2024-05-02T14:03:11.583337Z"})";
+    }
+
+private:
+    static constexpr Price kMaxDistance = 5000;
+
+    ProductScale scale_;
+    Price touch_;
+    std::geometric_distribution<Price> distance_;
+    std::normal_distribution<double> size_{std::log(0.05), 1.5};   // Median 0.05 units
+    std::bernoulli_distribution coin_{0.5};
+    std::uniform_int_distribution<int> quarter_{0, 3};
+    std::geometric_distribution<Price> gap_{0.6};
+    std::mt19937_64 rng_;
+
+    std::vector<BookEvent> live_;
+    uint64_t next_id_ = 1;
+
+    BookEvent makeAdd() {
+        BookEvent event;
+        event.kind = BookEventKind::ADD;
+        event.side = nextSide();
+        event.price = nextPrice(event.side);
+        event.size = nextSize();
+        event.id = OrderId(0x5eed, next_id_++);
+        live_.push_back(event);
+        return event;
+    }
+};
+
+// Apply an L3 event to any book with the order-level interface
+template <typename Book>
+bool applyEvent(Book& book, const BookEvent& event) {
+    switch (event.kind) {
+        case BookEventKind::ADD:
+            return book.addOrder(Order(event.id, event.side, event.price, event.size, std::chrono::nanoseconds(0)));
+        case BookEventKind::MODIFY:
+            return book.modifyOrder(event.id, event.size);
+        case BookEventKind::CANCEL:
+            return book.removeOrder(event.id);
+    }
+    return false;
+}
+
+// Times single operations with the cycle counter
+//
+// Google Benchmark reports the mean; a tail is what matters for a feed, so
+// time each operation and report p50/p99/p99.9/max (in ns) as counters.
+// Each sample adds one cycle-counter read (a few ns) to the measured mean.
+class OpTimer {
+public:
+    uint64_t start() const { return readCycles(); }
+    void stop(uint64_t started) { histogram_.record(readCycles() - started); }
+
+    const LatencyHistogram& histogram() const { return histogram_; }
+
+    // Add another timer's samples (e.g. another thread's, once it is done)
+    void merge(const OpTimer& other) { histogram_.merge(other.histogram_); }
+
+    // Add the percentiles to the benchmark's counters, under `prefix`
+    void report(benchmark::State& state, const std::string& prefix = "") const {
+        const CycleClock& clock = CycleClock::instance();
+        HistogramSummary summary = histogram_.summarize();
+        state.counters[prefix + "p50_ns"] = clock.toNanos(summary.p50);
+        state.counters[prefix + "p99_ns"] = clock.toNanos(summary.p99);
+        state.counters[prefix + "p999_ns"] = clock.toNanos(summary.p999);
+        state.counters[prefix + "max_ns"] = clock.toNanos(summary.max);
+    }
+
+private:
+    LatencyHistogram histogram_;
+};
+
+} // namespace bench
+} // namespace clunk
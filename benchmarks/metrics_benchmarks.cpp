@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+#include "analytics/book_metrics.h"
+#include <random>
+
+using namespace clunk;
+
+namespace {
+
+// Deep two-sided snapshot around 65,000.00 with random sizes
+DepthSnapshot makeSnapshot(size_t depth) {
+    std::mt19937_64 rng(3);
+    std::uniform_int_distribution<Quantity> size_dist(1000, 500000000);
+
+    DepthSnapshot snapshot;
+    for (size_t i = 0; i < depth; ++i) {
+        snapshot.bids.push(6500000 - static_cast<Price>(i), size_dist(rng));
+        snapshot.asks.push(6500001 + static_cast<Price>(i), size_dist(rng));
+    }
+    return snapshot;
+}
+
+void runMetrics(benchmark::State& state, const MetricsKernels& kernels) {
+    DepthSnapshot snapshot = makeSnapshot(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        BookMetrics metrics = computeBookMetrics(snapshot, 5, 500, kernels);
+        benchmark::DoNotOptimize(metrics);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+    state.SetLabel(kernels.name);
+}
+
+} // namespace
+
+// Benchmark the full metrics pass with the scalar reference kernels
+static void BM_BookMetricsScalar(benchmark::State& state) {
+    runMetrics(state, scalarMetricsKernels());
+}
+BENCHMARK(BM_BookMetricsScalar)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+// Benchmark the full metrics pass with the dispatched (SIMD) kernels
+static void BM_BookMetricsDispatched(benchmark::State& state) {
+    runMetrics(state, metricsKernels());
+}
+BENCHMARK(BM_BookMetricsDispatched)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
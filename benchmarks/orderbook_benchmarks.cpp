@@ -1,5 +1,9 @@
 #include <benchmark/benchmark.h>
 #include "orderbook/order_book.h"
+#include "orderbook/level_book.h"
+#include "backtest/simulated_execution.h"
+#include "legacy_order_book.h"
+#include "market_data.h"
 #include <random>
 #include <string>
 #include <chrono>
@@ -8,129 +12,384 @@
 
 using namespace clunk;
 
-// Helper function to create an order
-std::shared_ptr<Order> createBenchOrder(const std::string& id, OrderSide side, double price, double size) {
-    return std::make_shared<Order>(
-        id, side, price, size,
-        std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::system_clock::now().time_since_epoch()
-        )
+// Every benchmark below is instantiated for both the current pooled engine
+// (OrderBook) and the original shared_ptr engine (legacy::OrderBook), so the
+// two show up side by side in the output. Level-heavy cases also run on the
+// array-indexed ladder book (LadderOrderBook).
+
+namespace {
+
+std::chrono::nanoseconds benchTimestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
     );
 }
 
-// Benchmark adding a single order
+// Engine adapters: the key each book indexes orders by
+// (IDs are converted up front so lookups measure the index, not parsing)
+template <template <OrderSide> class Levels>
+OrderId benchId(const BasicOrderBook<Levels>&, const std::string& id) {
+    return OrderId::fromString(id);
+}
+
+std::string benchId(const legacy::OrderBook&, const std::string& id) {
+    return id;
+}
+
+// Engine adapters: a size in each book's units (lots vs. raw doubles)
+template <template <OrderSide> class Levels>
+Quantity benchSize(const BasicOrderBook<Levels>& book, double size) {
+    return book.getScale().toQuantity(size);
+}
+
+double benchSize(const legacy::OrderBook&, double size) {
+    return size;
+}
+
+// Engine adapters: add a buy or sell order to either book
+template <template <OrderSide> class Levels>
+bool addBenchOrder(BasicOrderBook<Levels>& book, const OrderId& id, bool is_buy, double price, double size) {
+    const ProductScale& scale = book.getScale();
+    return book.addOrder(Order(id, is_buy ? OrderSide::BUY : OrderSide::SELL,
+                               scale.toPrice(price), scale.toQuantity(size), benchTimestamp()));
+}
+
+bool addBenchOrder(legacy::OrderBook& book, const std::string& id, bool is_buy, double price, double size) {
+    return book.addOrder(std::make_shared<legacy::Order>(
+        id, is_buy ? legacy::OrderSide::BUY : legacy::OrderSide::SELL,
+        price, size, benchTimestamp()));
+}
+
+// Fill a book with random bids below and asks above 10,000, within 2,000
+// cent ticks of the touch (where a liquid product's activity sits)
+template <typename Book>
+void populateBook(Book& book, int bids, int asks) {
+    std::mt19937 rng(42);  // Fixed seed for reproducibility
+    std::uniform_int_distribution<> tick_dist(0, 1999);
+    std::uniform_real_distribution<> size_dist(0.1, 10.0);
+
+    for (int i = 0; i < bids; ++i) {
+        std::string id = "bid-" + std::to_string(i);
+        double price = 10000.0 - tick_dist(rng) * 0.01;
+        double size = size_dist(rng);
+        addBenchOrder(book, benchId(book, id), true, price, size);
+    }
+
+    for (int i = 0; i < asks; ++i) {
+        std::string id = "ask-" + std::to_string(i);
+        double price = 10000.01 + tick_dist(rng) * 0.01;
+        double size = size_dist(rng);
+        addBenchOrder(book, benchId(book, id), false, price, size);
+    }
+}
+
+// An order to add, with its ID already in the book's key type
+template <typename Id>
+struct BenchOrder {
+    Id id;
+    bool is_buy;
+    double price;
+    double size;
+};
+
+// `count` orders at market-shaped prices and sizes (see MarketGenerator),
+// so benchmarks spread over realistic levels rather than one price
+template <typename Book>
+auto marketOrders(const Book& book, size_t count) {
+    bench::MarketGenerator generator;
+    const ProductScale& scale = generator.getScale();
+    std::vector<BenchOrder<decltype(benchId(book, std::string()))>> orders;
+    orders.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        OrderSide side = generator.nextSide();
+        orders.push_back({benchId(book, "order-" + std::to_string(i)), side == OrderSide::BUY,
+                          scale.toDouble(generator.nextPrice(side)), scale.sizeToDouble(generator.nextSize())});
+    }
+    return orders;
+}
+
+} // namespace
+
+// Benchmark adding a single order (the book is rebuilt, untimed, every
+// 64k orders so it stays a realistic size)
+template <typename Book>
 static void BM_AddOrder(benchmark::State& state) {
-    OrderBook book("BTC-USD");
-    int order_id = 0;
+    auto book = std::make_unique<Book>("BTC-USD");
+    auto orders = marketOrders(*book, 1 << 16);
 
+    size_t index = 0;
     for (auto _ : state) {
-        std::string id = "order-" + std::to_string(order_id++);
-        auto order = createBenchOrder(id, OrderSide::BUY, 100.0, 1.0);
-        book.addOrder(order);
+        if (index == orders.size()) {
+            state.PauseTiming();
+            book = std::make_unique<Book>("BTC-USD");
+            index = 0;
+            state.ResumeTiming();
+        }
+        const auto& order = orders[index++];
+        addBenchOrder(*book, order.id, order.is_buy, order.price, order.size);
     }
 }
-BENCHMARK(BM_AddOrder);
+BENCHMARK_TEMPLATE(BM_AddOrder, OrderBook);
+BENCHMARK_TEMPLATE(BM_AddOrder, legacy::OrderBook);
 
 // Benchmark removing a single order
+template <typename Book>
 static void BM_RemoveOrder(benchmark::State& state) {
-    OrderBook book("BTC-USD");
-    std::vector<std::string> order_ids;
+    Book book("BTC-USD");
+    auto orders = marketOrders(book, static_cast<size_t>(state.range(0)));
 
     // Add some orders first
-    for (int i = 0; i < state.range(0); ++i) {
-        std::string id = "order-" + std::to_string(i);
-        auto order = createBenchOrder(id, OrderSide::BUY, 100.0, 1.0);
-        book.addOrder(order);
-        order_ids.push_back(id);
+    for (const auto& order : orders) {
+        addBenchOrder(book, order.id, order.is_buy, order.price, order.size);
     }
 
-    int index = 0;
+    size_t index = 0;
     for (auto _ : state) {
-        book.removeOrder(order_ids[index % order_ids.size()]);
+        book.removeOrder(orders[index % orders.size()].id);
         ++index;
     }
 }
-BENCHMARK(BM_RemoveOrder)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_RemoveOrder, OrderBook)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_RemoveOrder, legacy::OrderBook)->Arg(1000);
+
+// Benchmark adding and then cancelling an order (steady-state churn)
+template <typename Book>
+static void BM_AddCancelOrder(benchmark::State& state) {
+    Book book("BTC-USD");
+    populateBook(book, static_cast<int>(state.range(0)), static_cast<int>(state.range(0)));
+    auto churn_id = benchId(book, "churn-order");
+
+    for (auto _ : state) {
+        addBenchOrder(book, churn_id, true, 10000.0, 1.0);
+        book.removeOrder(churn_id);
+    }
+}
+BENCHMARK_TEMPLATE(BM_AddCancelOrder, OrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_AddCancelOrder, LadderOrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_AddCancelOrder, legacy::OrderBook)->Arg(1000)->Arg(10000);
+
+// Benchmark the same churn with incremental metrics maintained on every event
+template <typename Book>
+static void BM_AddCancelOrderWithMetrics(benchmark::State& state) {
+    Book book("BTC-USD");
+    populateBook(book, static_cast<int>(state.range(0)), static_cast<int>(state.range(0)));
+    book.enableMetrics();
+    auto churn_id = benchId(book, "churn-order");
+
+    for (auto _ : state) {
+        addBenchOrder(book, churn_id, true, 10000.0, 1.0);
+        book.removeOrder(churn_id);
+    }
+    benchmark::DoNotOptimize(book.getMetrics());
+}
+BENCHMARK_TEMPLATE(BM_AddCancelOrderWithMetrics, OrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_AddCancelOrderWithMetrics, LadderOrderBook)->Arg(1000)->Arg(10000);
+
+// Benchmark an IOC buy sweeping `range` ask levels, each holding two makers
+// that are re-added afterwards so every iteration matches the same book
+template <typename Book>
+static void BM_SubmitOrder(benchmark::State& state) {
+    Book book("BTC-USD");
+    populateBook(book, 1000, 0);
+    const int levels = static_cast<int>(state.range(0));
+    const Price best = book.getScale().toPrice(10000.01);
+
+    std::vector<Order> makers;
+    for (int i = 0; i < levels * 2; ++i) {
+        makers.emplace_back(OrderId::fromString("maker-" + std::to_string(i)), OrderSide::SELL, best + i / 2, 1,
+                            std::chrono::nanoseconds(0));
+    }
+    for (const Order& maker : makers) {
+        book.addOrder(maker);
+    }
+
+    // Far deeper asks the sweep never reaches
+    book.addOrder(Order(OrderId::fromString("backstop"), OrderSide::SELL, best + 100000, 1,
+                        std::chrono::nanoseconds(0)));
+
+    Order taker(OrderId::fromString("taker"), OrderSide::BUY, best + levels - 1, levels * 2,
+                std::chrono::nanoseconds(0));
+    std::vector<Fill> fills;
+    fills.reserve(makers.size());
+    for (auto _ : state) {
+        MatchResult result = book.submitOrder(taker, TimeInForce::IOC, fills);
+        benchmark::DoNotOptimize(result);
+        for (const Order& maker : makers) {
+            book.addOrder(maker);
+        }
+    }
+    state.counters["fills/s"] = benchmark::Counter(static_cast<double>(state.iterations() * makers.size()),
+                                                   benchmark::Counter::kIsRate);
+}
+BENCHMARK_TEMPLATE(BM_SubmitOrder, OrderBook)->Arg(1)->Arg(10);
+BENCHMARK_TEMPLATE(BM_SubmitOrder, LadderOrderBook)->Arg(1)->Arg(10);
+
+// Benchmark simulated execution over a churning aggregated book: each
+// iteration is one level delta and one trade, matched against `range`
+// resting simulated orders
+static void BM_SimulatedExecution(benchmark::State& state) {
+    auto book = std::make_shared<LevelBook>("BTC-USD", ProductScale(2, 8));
+    for (Price price = 0; price < 100; ++price) {
+        book->setLevel(OrderSide::BUY, 1000000 - price, 1000);
+        book->setLevel(OrderSide::SELL, 1000001 + price, 1000);
+    }
+
+    SimulatedExecution simulation(book);
+    auto refill = [&]() {
+        while (simulation.getRestingCount() < static_cast<size_t>(state.range(0))) {
+            simulation.place(OrderSide::BUY, 1000000 - static_cast<Price>(simulation.getRestingCount() % 20), 10);
+        }
+    };
+    refill();
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<Price> offset(0, 19);
+    std::uniform_int_distribution<Quantity> size(500, 1500);
+    for (auto _ : state) {
+        Price price = 1000000 - offset(rng);
+        book->setLevel(OrderSide::BUY, price, size(rng));
+        simulation.onTrade(Trade{OrderSide::BUY, price, 50});
+        if (simulation.getRestingCount() < static_cast<size_t>(state.range(0))) {
+            refill();
+        }
+    }
+    state.counters["events/s"] = benchmark::Counter(static_cast<double>(state.iterations() * 2),
+                                                    benchmark::Counter::kIsRate);
+    state.counters["fills"] = static_cast<double>(simulation.getStats().fills);
+}
+BENCHMARK(BM_SimulatedExecution)->Arg(1)->Arg(16);
+
+// Snapshot levels best-first on each side, one synthetic level per tick
+std::vector<LevelUpdate> snapshotLevels(int depth) {
+    std::vector<LevelUpdate> levels;
+    for (int i = 0; i < depth; ++i) {
+        levels.push_back({OrderSide::BUY, 1000000 - i, 1 + i % 100, OrderId()});
+    }
+    for (int i = 0; i < depth; ++i) {
+        levels.push_back({OrderSide::SELL, 1000001 + i, 1 + i % 100, OrderId()});
+    }
+    return levels;
+}
+
+// Benchmark loading a snapshot one addOrder() (lock + publication + level
+// delta) per level
+template <typename Book>
+static void BM_SnapshotPerLevel(benchmark::State& state) {
+    std::vector<LevelUpdate> levels = snapshotLevels(static_cast<int>(state.range(0)));
+    Book book("BTC-USD");
+    auto subscription = book.subscribe();
+
+    size_t deltas = 0;
+    for (auto _ : state) {
+        book.clear();
+        book.reserve(levels.size(), levels.size());
+        for (const LevelUpdate& level : levels) {
+            book.addOrder(Order(OrderId::level(level.side, level.price), level.side,
+                                level.price, level.size, std::chrono::nanoseconds(0)));
+        }
+        deltas += subscription->poll([](const LevelDelta&) {});
+    }
+    benchmark::DoNotOptimize(deltas);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(levels.size()));
+}
+BENCHMARK_TEMPLATE(BM_SnapshotPerLevel, OrderBook)->Arg(1000)->Arg(50000);
+BENCHMARK_TEMPLATE(BM_SnapshotPerLevel, LadderOrderBook)->Arg(1000)->Arg(50000);
+
+// Benchmark loading the same snapshot in one batch
+template <typename Book>
+static void BM_SnapshotBatch(benchmark::State& state) {
+    std::vector<LevelUpdate> levels = snapshotLevels(static_cast<int>(state.range(0)));
+    Book book("BTC-USD");
+    auto subscription = book.subscribe();
+
+    for (auto _ : state) {
+        book.loadSnapshot(levels.data(), levels.size());
+        benchmark::DoNotOptimize(subscription->needsResync());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(levels.size()));
+}
+BENCHMARK_TEMPLATE(BM_SnapshotBatch, OrderBook)->Arg(1000)->Arg(50000);
+BENCHMARK_TEMPLATE(BM_SnapshotBatch, LadderOrderBook)->Arg(1000)->Arg(50000);
+BENCHMARK_TEMPLATE(BM_SnapshotBatch, LevelBook)->Arg(1000)->Arg(50000);
+
+// Benchmark applying l2update-style change sets (sizes replaced, ~1 in 5
+// levels removed) to a book seeded with a snapshot
+template <typename Book>
+static void BM_L2Changes(benchmark::State& state) {
+    const int depth = static_cast<int>(state.range(0));
+    std::vector<LevelUpdate> levels = snapshotLevels(depth);
+    Book book("BTC-USD");
+    book.loadSnapshot(levels.data(), levels.size());
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> offset_dist(0, depth / 10);
+    std::uniform_int_distribution<Quantity> size_dist(0, 100);
+    std::vector<LevelUpdate> changes;
+    for (int i = 0; i < 4096; ++i) {
+        OrderSide side = i % 2 == 0 ? OrderSide::BUY : OrderSide::SELL;
+        int offset = offset_dist(rng);
+        Price price = side == OrderSide::BUY ? 1000000 - offset : 1000001 + offset;
+        Quantity size = size_dist(rng);
+        changes.push_back({side, price, size < 20 ? 0 : size, OrderId()});
+    }
+
+    constexpr size_t kBatch = 4;
+    size_t index = 0;
+    for (auto _ : state) {
+        book.applyUpdates(changes.data() + index, kBatch);
+        index = (index + kBatch) % changes.size();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kBatch));
+}
+BENCHMARK_TEMPLATE(BM_L2Changes, OrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_L2Changes, LadderOrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_L2Changes, LevelBook)->Arg(1000)->Arg(10000);
 
 // Benchmark modifying a single order
+template <typename Book>
 static void BM_ModifyOrder(benchmark::State& state) {
-    OrderBook book("BTC-USD");
-    std::vector<std::string> order_ids;
+    Book book("BTC-USD");
+    auto orders = marketOrders(book, static_cast<size_t>(state.range(0)));
 
     // Add some orders first
-    for (int i = 0; i < state.range(0); ++i) {
-        std::string id = "order-" + std::to_string(i);
-        auto order = createBenchOrder(id, OrderSide::BUY, 100.0, 1.0);
-        book.addOrder(order);
-        order_ids.push_back(id);
+    for (const auto& order : orders) {
+        addBenchOrder(book, order.id, order.is_buy, order.price, order.size);
     }
 
-    int index = 0;
+    auto new_size = benchSize(book, 2.0);
+    size_t index = 0;
     for (auto _ : state) {
-        book.modifyOrder(order_ids[index % order_ids.size()], 2.0);
+        book.modifyOrder(orders[index % orders.size()].id, new_size);
         ++index;
     }
 }
-BENCHMARK(BM_ModifyOrder)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_ModifyOrder, OrderBook)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_ModifyOrder, LadderOrderBook)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_ModifyOrder, legacy::OrderBook)->Arg(1000);
 
 // Benchmark getting the best bid/ask
+template <typename Book>
 static void BM_GetBestBidAsk(benchmark::State& state) {
-    OrderBook book("BTC-USD");
+    Book book("BTC-USD");
 
     // Set up a realistic order book
-    std::mt19937 rng(42);  // Fixed seed for reproducibility
-    std::uniform_real_distribution<> price_dist(9000.0, 11000.0);
-    std::uniform_real_distribution<> size_dist(0.1, 10.0);
-
-    // Add some bid orders
-    for (int i = 0; i < state.range(0) / 2; ++i) {
-        std::string id = "bid-" + std::to_string(i);
-        double price = price_dist(rng);
-        double size = size_dist(rng);
-        auto order = createBenchOrder(id, OrderSide::BUY, price, size);
-        book.addOrder(order);
-    }
-
-    // Add some ask orders
-    for (int i = 0; i < state.range(0) / 2; ++i) {
-        std::string id = "ask-" + std::to_string(i);
-        double price = price_dist(rng);
-        double size = size_dist(rng);
-        auto order = createBenchOrder(id, OrderSide::SELL, price, size);
-        book.addOrder(order);
-    }
+    populateBook(book, static_cast<int>(state.range(0) / 2), static_cast<int>(state.range(0) / 2));
 
     for (auto _ : state) {
         benchmark::DoNotOptimize(book.getBestBid());
         benchmark::DoNotOptimize(book.getBestAsk());
     }
 }
-BENCHMARK(BM_GetBestBidAsk)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_GetBestBidAsk, OrderBook)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_GetBestBidAsk, LadderOrderBook)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK_TEMPLATE(BM_GetBestBidAsk, legacy::OrderBook)->Arg(1000)->Arg(10000)->Arg(100000);
 
 // Benchmark getting the spread
 static void BM_GetSpread(benchmark::State& state) {
     OrderBook book("BTC-USD");
 
     // Set up a realistic order book (same as above)
-    std::mt19937 rng(42);
-    std::uniform_real_distribution<> price_dist(9000.0, 11000.0);
-    std::uniform_real_distribution<> size_dist(0.1, 10.0);
-
-    for (int i = 0; i < state.range(0) / 2; ++i) {
-        std::string id = "bid-" + std::to_string(i);
-        double price = price_dist(rng);
-        double size = size_dist(rng);
-        auto order = createBenchOrder(id, OrderSide::BUY, price, size);
-        book.addOrder(order);
-    }
-
-    for (int i = 0; i < state.range(0) / 2; ++i) {
-        std::string id = "ask-" + std::to_string(i);
-        double price = price_dist(rng);
-        double size = size_dist(rng);
-        auto order = createBenchOrder(id, OrderSide::SELL, price, size);
-        book.addOrder(order);
-    }
+    populateBook(book, static_cast<int>(state.range(0) / 2), static_cast<int>(state.range(0) / 2));
 
     for (auto _ : state) {
         benchmark::DoNotOptimize(book.getSpread());
@@ -143,25 +402,7 @@ static void BM_GetMidpointPrice(benchmark::State& state) {
     OrderBook book("BTC-USD");
 
     // Set up a realistic order book (same as above)
-    std::mt19937 rng(42);
-    std::uniform_real_distribution<> price_dist(9000.0, 11000.0);
-    std::uniform_real_distribution<> size_dist(0.1, 10.0);
-
-    for (int i = 0; i < state.range(0) / 2; ++i) {
-        std::string id = "bid-" + std::to_string(i);
-        double price = price_dist(rng);
-        double size = size_dist(rng);
-        auto order = createBenchOrder(id, OrderSide::BUY, price, size);
-        book.addOrder(order);
-    }
-
-    for (int i = 0; i < state.range(0) / 2; ++i) {
-        std::string id = "ask-" + std::to_string(i);
-        double price = price_dist(rng);
-        double size = size_dist(rng);
-        auto order = createBenchOrder(id, OrderSide::SELL, price, size);
-        book.addOrder(order);
-    }
+    populateBook(book, static_cast<int>(state.range(0) / 2), static_cast<int>(state.range(0) / 2));
 
     for (auto _ : state) {
         benchmark::DoNotOptimize(book.getMidpointPrice());
@@ -170,70 +411,55 @@ static void BM_GetMidpointPrice(benchmark::State& state) {
 BENCHMARK(BM_GetMidpointPrice)->Arg(1000)->Arg(10000);
 
 // Benchmark getting top N levels
+template <typename Book>
 static void BM_GetLevels(benchmark::State& state) {
-    OrderBook book("BTC-USD");
+    Book book("BTC-USD");
 
     // Set up a realistic order book (same as above)
-    std::mt19937 rng(42);
-    std::uniform_real_distribution<> price_dist(9000.0, 11000.0);
-    std::uniform_real_distribution<> size_dist(0.1, 10.0);
-
-    for (int i = 0; i < state.range(0); ++i) {
-        std::string id = "bid-" + std::to_string(i);
-        double price = price_dist(rng);
-        double size = size_dist(rng);
-        auto order = createBenchOrder(id, OrderSide::BUY, price, size);
-        book.addOrder(order);
-    }
-
-    for (int i = 0; i < state.range(0); ++i) {
-        std::string id = "ask-" + std::to_string(i);
-        double price = price_dist(rng);
-        double size = size_dist(rng);
-        auto order = createBenchOrder(id, OrderSide::SELL, price, size);
-        book.addOrder(order);
-    }
+    populateBook(book, static_cast<int>(state.range(0)), static_cast<int>(state.range(0)));
 
     for (auto _ : state) {
         benchmark::DoNotOptimize(book.getBidLevels(10));
         benchmark::DoNotOptimize(book.getAskLevels(10));
     }
 }
-BENCHMARK(BM_GetLevels)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_GetLevels, OrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_GetLevels, LadderOrderBook)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_GetLevels, legacy::OrderBook)->Arg(1000)->Arg(10000);
 
 // Benchmark L3 update processing
 static void BM_ProcessL3Update(benchmark::State& state) {
     OrderBook book("BTC-USD");
 
     // Generate a sequence of L3 updates
-    std::vector<std::tuple<std::string, std::string, OrderSide, double, double>> updates;
+    std::vector<std::tuple<std::string, OrderId, OrderSide, Price, Quantity>> updates;
 
     // Add some orders
     for (int i = 0; i < 1000; ++i) {
-        std::string id = "order-" + std::to_string(i);
+        OrderId id = OrderId::fromString("order-" + std::to_string(i));
         OrderSide side = (i % 2 == 0) ? OrderSide::BUY : OrderSide::SELL;
-        double price = 10000.0 + (i % 100);
-        double size = 1.0 + (i % 10);
+        Price price = book.getScale().toPrice(10000.0 + (i % 100));
+        Quantity size = book.getScale().toQuantity(1.0 + (i % 10));
 
         updates.emplace_back("open", id, side, price, size);
     }
 
     // Modify some orders
     for (int i = 0; i < 500; ++i) {
-        std::string id = "order-" + std::to_string(i);
+        OrderId id = OrderId::fromString("order-" + std::to_string(i));
         OrderSide side = (i % 2 == 0) ? OrderSide::BUY : OrderSide::SELL;
-        double price = 10000.0 + (i % 100);
-        double size = 0.5 + (i % 5);
+        Price price = book.getScale().toPrice(10000.0 + (i % 100));
+        Quantity size = book.getScale().toQuantity(0.5 + (i % 5));
 
         updates.emplace_back("change", id, side, price, size);
     }
 
     // Remove some orders
     for (int i = 500; i < 1000; ++i) {
-        std::string id = "order-" + std::to_string(i);
+        OrderId id = OrderId::fromString("order-" + std::to_string(i));
         OrderSide side = (i % 2 == 0) ? OrderSide::BUY : OrderSide::SELL;
 
-        updates.emplace_back("done", id, side, 0.0, 0.0);
+        updates.emplace_back("done", id, side, 0, 0);
     }
 
     int index = 0;
@@ -245,4 +471,4 @@ static void BM_ProcessL3Update(benchmark::State& state) {
 }
 BENCHMARK(BM_ProcessL3Update);
 
-BENCHMARK_MAIN();
\ No newline at end of file
+BENCHMARK_MAIN();
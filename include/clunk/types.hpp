@@ -0,0 +1,5 @@
+#pragma once
+
+// Core order book vocabulary (orders and sides) shared by the public headers.
+// The engine itself lives in src/orderbook; these headers re-export it.
+#include "orderbook/order.h"
@@ -0,0 +1,331 @@
+#include "book_metrics.h"
+#include <algorithm>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define CLUNK_METRICS_NEON 1
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CLUNK_METRICS_AVX2 1
+#endif
+
+namespace clunk {
+
+namespace {
+
+// Scalar kernels (reference and fallback)
+
+int64_t scalarSumSizes(const Quantity* sizes, size_t n) {
+    int64_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += sizes[i];
+    }
+    return total;
+}
+
+double scalarSumNotional(const Price* prices, const Quantity* sizes, size_t n) {
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        total += static_cast<double>(prices[i]) * static_cast<double>(sizes[i]);
+    }
+    return total;
+}
+
+int64_t scalarSumSizesAtOrAbove(const Price* prices, const Quantity* sizes, size_t n, Price threshold) {
+    int64_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += prices[i] >= threshold ? sizes[i] : 0;
+    }
+    return total;
+}
+
+int64_t scalarSumSizesAtOrBelow(const Price* prices, const Quantity* sizes, size_t n, Price threshold) {
+    int64_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += prices[i] <= threshold ? sizes[i] : 0;
+    }
+    return total;
+}
+
+size_t scalarWalkToVolume(const Quantity* sizes, size_t n, Quantity target) {
+    Quantity cumulative = 0;
+    for (size_t i = 0; i < n; ++i) {
+        cumulative += sizes[i];
+        if (cumulative >= target) {
+            return i;
+        }
+    }
+    return n;
+}
+
+const MetricsKernels kScalarKernels = {
+    "scalar",
+    scalarSumSizes,
+    scalarSumNotional,
+    scalarSumSizesAtOrAbove,
+    scalarSumSizesAtOrBelow,
+    scalarWalkToVolume,
+};
+
+#if defined(CLUNK_METRICS_AVX2)
+
+// AVX2 kernels, compiled for AVX2 + FMA regardless of the build's -march
+// and only selected when the CPU reports both
+#define CLUNK_AVX2 __attribute__((target("avx2,fma")))
+
+// Exact int64 -> double for 0 <= x < 2^63 (AVX2 has no 64-bit integer
+// conversion): split into 32-bit halves biased by 2^84 and 2^52, then
+// remove the bias
+CLUNK_AVX2 inline __m256d toDouble(__m256i x) {
+    __m256i high = _mm256_srli_epi64(x, 32);
+    high = _mm256_or_si256(high, _mm256_castpd_si256(_mm256_set1_pd(19342813113834066795298816.0)));
+    __m256i low = _mm256_blend_epi16(x, _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)), 0xcc);
+    __m256d biased = _mm256_sub_pd(_mm256_castsi256_pd(high), _mm256_set1_pd(19342813118337666422669312.0));
+    return _mm256_add_pd(biased, _mm256_castsi256_pd(low));
+}
+
+CLUNK_AVX2 inline int64_t horizontalSum(__m256i v) {
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1);
+}
+
+CLUNK_AVX2 inline __m256i load(const int64_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+CLUNK_AVX2 int64_t avx2SumSizes(const Quantity* sizes, size_t n) {
+    __m256i a = _mm256_setzero_si256();
+    __m256i b = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a = _mm256_add_epi64(a, load(sizes + i));
+        b = _mm256_add_epi64(b, load(sizes + i + 4));
+    }
+    int64_t total = horizontalSum(_mm256_add_epi64(a, b));
+    return total + scalarSumSizes(sizes + i, n - i);
+}
+
+CLUNK_AVX2 double avx2SumNotional(const Price* prices, const Quantity* sizes, size_t n) {
+    __m256d a = _mm256_setzero_pd();
+    __m256d b = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a = _mm256_fmadd_pd(toDouble(load(prices + i)), toDouble(load(sizes + i)), a);
+        b = _mm256_fmadd_pd(toDouble(load(prices + i + 4)), toDouble(load(sizes + i + 4)), b);
+    }
+    __m256d sum = _mm256_add_pd(a, b);
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+    double total = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    return total + scalarSumNotional(prices + i, sizes + i, n - i);
+}
+
+CLUNK_AVX2 int64_t avx2SumSizesAtOrAbove(const Price* prices, const Quantity* sizes, size_t n, Price threshold) {
+    // prices[i] >= threshold  <=>  prices[i] > threshold - 1
+    const __m256i bound = _mm256_set1_epi64x(threshold - 1);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i inside = _mm256_cmpgt_epi64(load(prices + i), bound);
+        total = _mm256_add_epi64(total, _mm256_and_si256(inside, load(sizes + i)));
+    }
+    return horizontalSum(total) + scalarSumSizesAtOrAbove(prices + i, sizes + i, n - i, threshold);
+}
+
+CLUNK_AVX2 int64_t avx2SumSizesAtOrBelow(const Price* prices, const Quantity* sizes, size_t n, Price threshold) {
+    // prices[i] <= threshold  <=>  threshold + 1 > prices[i]
+    const __m256i bound = _mm256_set1_epi64x(threshold + 1);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i inside = _mm256_cmpgt_epi64(bound, load(prices + i));
+        total = _mm256_add_epi64(total, _mm256_and_si256(inside, load(sizes + i)));
+    }
+    return horizontalSum(total) + scalarSumSizesAtOrBelow(prices + i, sizes + i, n - i, threshold);
+}
+
+CLUNK_AVX2 size_t avx2WalkToVolume(const Quantity* sizes, size_t n, Quantity target) {
+    // Skip whole 8-level blocks while they cannot reach the target, then
+    // finish inside the block that does
+    Quantity cumulative = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        Quantity block = horizontalSum(_mm256_add_epi64(load(sizes + i), load(sizes + i + 4)));
+        if (cumulative + block >= target) {
+            break;
+        }
+        cumulative += block;
+    }
+
+    size_t rest = scalarWalkToVolume(sizes + i, n - i, target - cumulative);
+    return i + rest;
+}
+
+const MetricsKernels kAvx2Kernels = {
+    "avx2",
+    avx2SumSizes,
+    avx2SumNotional,
+    avx2SumSizesAtOrAbove,
+    avx2SumSizesAtOrBelow,
+    avx2WalkToVolume,
+};
+
+#undef CLUNK_AVX2
+
+#elif defined(CLUNK_METRICS_NEON)
+
+// NEON kernels (always available on AArch64)
+
+int64_t neonSumSizes(const Quantity* sizes, size_t n) {
+    int64x2_t a = vdupq_n_s64(0);
+    int64x2_t b = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        a = vaddq_s64(a, vld1q_s64(sizes + i));
+        b = vaddq_s64(b, vld1q_s64(sizes + i + 2));
+    }
+    return vaddvq_s64(vaddq_s64(a, b)) + scalarSumSizes(sizes + i, n - i);
+}
+
+double neonSumNotional(const Price* prices, const Quantity* sizes, size_t n) {
+    float64x2_t a = vdupq_n_f64(0.0);
+    float64x2_t b = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        a = vfmaq_f64(a, vcvtq_f64_s64(vld1q_s64(prices + i)), vcvtq_f64_s64(vld1q_s64(sizes + i)));
+        b = vfmaq_f64(b, vcvtq_f64_s64(vld1q_s64(prices + i + 2)), vcvtq_f64_s64(vld1q_s64(sizes + i + 2)));
+    }
+    return vaddvq_f64(vaddq_f64(a, b)) + scalarSumNotional(prices + i, sizes + i, n - i);
+}
+
+int64_t neonSumSizesAtOrAbove(const Price* prices, const Quantity* sizes, size_t n, Price threshold) {
+    const int64x2_t bound = vdupq_n_s64(threshold);
+    int64x2_t total = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        uint64x2_t inside = vcgeq_s64(vld1q_s64(prices + i), bound);
+        total = vaddq_s64(total, vandq_s64(vreinterpretq_s64_u64(inside), vld1q_s64(sizes + i)));
+    }
+    return vaddvq_s64(total) + scalarSumSizesAtOrAbove(prices + i, sizes + i, n - i, threshold);
+}
+
+int64_t neonSumSizesAtOrBelow(const Price* prices, const Quantity* sizes, size_t n, Price threshold) {
+    const int64x2_t bound = vdupq_n_s64(threshold);
+    int64x2_t total = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        uint64x2_t inside = vcleq_s64(vld1q_s64(prices + i), bound);
+        total = vaddq_s64(total, vandq_s64(vreinterpretq_s64_u64(inside), vld1q_s64(sizes + i)));
+    }
+    return vaddvq_s64(total) + scalarSumSizesAtOrBelow(prices + i, sizes + i, n - i, threshold);
+}
+
+size_t neonWalkToVolume(const Quantity* sizes, size_t n, Quantity target) {
+    Quantity cumulative = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        Quantity block = vaddvq_s64(vaddq_s64(vld1q_s64(sizes + i), vld1q_s64(sizes + i + 2)));
+        if (cumulative + block >= target) {
+            break;
+        }
+        cumulative += block;
+    }
+    return i + scalarWalkToVolume(sizes + i, n - i, target - cumulative);
+}
+
+const MetricsKernels kNeonKernels = {
+    "neon",
+    neonSumSizes,
+    neonSumNotional,
+    neonSumSizesAtOrAbove,
+    neonSumSizesAtOrBelow,
+    neonWalkToVolume,
+};
+
+#endif
+
+} // namespace
+
+const MetricsKernels& scalarMetricsKernels() {
+    return kScalarKernels;
+}
+
+const MetricsKernels* simdMetricsKernels() {
+#if defined(CLUNK_METRICS_AVX2)
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported ? &kAvx2Kernels : nullptr;
+#elif defined(CLUNK_METRICS_NEON)
+    return &kNeonKernels;
+#else
+    return nullptr;
+#endif
+}
+
+const MetricsKernels& metricsKernels() {
+    static const MetricsKernels& selected =
+        simdMetricsKernels() ? *simdMetricsKernels() : scalarMetricsKernels();
+    return selected;
+}
+
+BookMetrics computeBookMetrics(const DepthSnapshot& snapshot, int band_permille, int impact_permille,
+                               const MetricsKernels& kernels) {
+    BookMetrics metrics;
+
+    const DepthSide& bids = snapshot.bids;
+    const DepthSide& asks = snapshot.asks;
+
+    // Volumes and volume-weighted prices
+    metrics.bid_volume = kernels.sumSizes(bids.sizes.data(), bids.size());
+    metrics.ask_volume = kernels.sumSizes(asks.sizes.data(), asks.size());
+
+    if (metrics.bid_volume > 0) {
+        metrics.vwap_bid = kernels.sumNotional(bids.prices.data(), bids.sizes.data(), bids.size()) /
+                           static_cast<double>(metrics.bid_volume);
+    }
+    if (metrics.ask_volume > 0) {
+        metrics.vwap_ask = kernels.sumNotional(asks.prices.data(), asks.sizes.data(), asks.size()) /
+                           static_cast<double>(metrics.ask_volume);
+    }
+
+    // Imbalance and pressure
+    if (metrics.ask_volume > 0) {
+        metrics.imbalance = static_cast<double>(metrics.bid_volume) /
+                            static_cast<double>(metrics.ask_volume);
+    }
+    metrics.pressure = (metrics.imbalance - 1.0) / (metrics.imbalance + 1.0);
+
+    if (bids.empty() || asks.empty()) {
+        return metrics;
+    }
+
+    Price best_bid = bids.prices[0];
+    Price best_ask = asks.prices[0];
+    metrics.spread_bps = static_cast<double>(best_ask - best_bid) * 20000.0 /
+                         static_cast<double>(best_ask + best_bid);
+
+    // Depth within the band: price * 1000 >= best * (1000 - band) for bids
+    // and price * 1000 <= best * (1000 + band) for asks, as exact tick
+    // thresholds
+    Price bid_floor = (best_bid * (1000 - band_permille) + 999) / 1000;
+    Price ask_ceiling = best_ask * (1000 + band_permille) / 1000;
+    metrics.bid_band_depth = kernels.sumSizesAtOrAbove(bids.prices.data(), bids.sizes.data(),
+                                                       bids.size(), bid_floor);
+    metrics.ask_band_depth = kernels.sumSizesAtOrBelow(asks.prices.data(), asks.sizes.data(),
+                                                       asks.size(), ask_ceiling);
+
+    // Impact of a market order sized as a fraction of visible volume: the
+    // last level it reaches on each side (the deepest level if it exhausts
+    // the side)
+    metrics.impact_size = (metrics.bid_volume + metrics.ask_volume) * impact_permille / 1000;
+
+    size_t buy_level = kernels.walkToVolume(asks.sizes.data(), asks.size(), metrics.impact_size);
+    size_t sell_level = kernels.walkToVolume(bids.sizes.data(), bids.size(), metrics.impact_size);
+    metrics.buy_impact_price = asks.prices[std::min(buy_level, asks.size() - 1)];
+    metrics.sell_impact_price = bids.prices[std::min(sell_level, bids.size() - 1)];
+
+    metrics.buy_impact_pct = static_cast<double>(metrics.buy_impact_price - best_ask) * 100.0 /
+                             static_cast<double>(best_ask);
+
+    return metrics;
+}
+
+} // namespace clunk
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "orderbook/depth_snapshot.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace clunk {
+
+// Vector kernels over one side of a DepthSnapshot
+//
+// Each implementation (AVX2, NEON, scalar) fills one table; metricsKernels()
+// picks the best one the running CPU supports, once. Sums of sizes and
+// band depths are exact integer sums; price * size sums are accumulated in
+// double, since tick * lot products overflow int64 on deep books.
+struct MetricsKernels {
+    const char* name;
+
+    // Total of sizes[0, n)
+    int64_t (*sumSizes)(const Quantity* sizes, size_t n);
+
+    // Sum of prices[i] * sizes[i] (for VWAP)
+    double (*sumNotional)(const Price* prices, const Quantity* sizes, size_t n);
+
+    // Sum of sizes where prices[i] >= threshold (bids inside a band)
+    int64_t (*sumSizesAtOrAbove)(const Price* prices, const Quantity* sizes, size_t n, Price threshold);
+
+    // Sum of sizes where prices[i] <= threshold (asks inside a band)
+    int64_t (*sumSizesAtOrBelow)(const Price* prices, const Quantity* sizes, size_t n, Price threshold);
+
+    // First level at which the running total of sizes reaches `target`,
+    // or n if the side holds less than that
+    size_t (*walkToVolume)(const Quantity* sizes, size_t n, Quantity target);
+};
+
+// Portable reference implementation
+const MetricsKernels& scalarMetricsKernels();
+
+// Vector implementation for this CPU, or nullptr if none is available
+const MetricsKernels* simdMetricsKernels();
+
+// Best implementation for this CPU (SIMD if available, else scalar)
+const MetricsKernels& metricsKernels();
+
+// Liquidity metrics for a depth snapshot, in ticks and lots
+struct BookMetrics {
+    Quantity bid_volume = 0;        // Total size on each side
+    Quantity ask_volume = 0;
+    double vwap_bid = 0.0;          // Volume-weighted price (ticks)
+    double vwap_ask = 0.0;
+    Quantity bid_band_depth = 0;    // Size within the band of the touch
+    Quantity ask_band_depth = 0;
+    double imbalance = 1.0;         // bid_volume / ask_volume (1 if no asks)
+    double pressure = 0.0;          // (imbalance - 1) / (imbalance + 1), in [-1, 1]
+    Quantity impact_size = 0;       // Market order size the impact was estimated for
+    Price buy_impact_price = 0;     // Last ask level a buy of impact_size reaches
+    Price sell_impact_price = 0;    // Last bid level a sell of impact_size reaches
+    double spread_bps = 0.0;        // (ask - bid) / mid in basis points
+    double buy_impact_pct = 0.0;    // (buy_impact_price - best ask) / best ask, percent
+};
+
+// Compute liquidity metrics for `snapshot`
+//
+// `band_permille` sets the band around the touch counted as depth (5 is
+// 0.5%, compared exactly on ticks); `impact_permille` sets the market order
+// size used for impact as a fraction of total visible volume (10 is 1%).
+// Both sides must be non-empty for the spread and impact fields to be set.
+BookMetrics computeBookMetrics(const DepthSnapshot& snapshot,
+                               int band_permille = 5, int impact_permille = 10,
+                               const MetricsKernels& kernels = metricsKernels());
+
+} // namespace clunk
@@ -0,0 +1,292 @@
+#pragma once
+
+#include "orderbook/fixed_point.h"
+#include "orderbook/price_level.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+namespace clunk {
+
+// Running notional (price * size in ticks * lots). Kept exact where the
+// compiler has a 128-bit integer, since the sums are updated incrementally
+// for the life of the book and a floating accumulator would drift.
+#if defined(__SIZEOF_INT128__)
+using NotionalSum = __int128;
+#else
+using NotionalSum = double;
+#endif
+
+// Which windows OrderBookMetrics maintains
+struct MetricsConfig {
+    size_t top_levels = 10;     // Best N levels per side
+    int64_t band_bps = 50;      // Levels within this many bps of the touch
+};
+
+// Volume and notional of one side: whole side, best N levels, and levels
+// within the band of the touch
+struct SideMetrics {
+    Quantity volume = 0;
+    double notional = 0.0;
+    size_t levels = 0;
+
+    Quantity top_volume = 0;
+    double top_notional = 0.0;
+    size_t top_levels = 0;      // min(N, levels)
+
+    Quantity band_volume = 0;
+    double band_notional = 0.0;
+    Price band_edge = 0;        // Worst price inside the band
+
+    // Volume-weighted prices in ticks (0 when the window is empty)
+    double vwap() const { return volume > 0 ? notional / static_cast<double>(volume) : 0.0; }
+    double topVwap() const { return top_volume > 0 ? top_notional / static_cast<double>(top_volume) : 0.0; }
+    double bandVwap() const { return band_volume > 0 ? band_notional / static_cast<double>(band_volume) : 0.0; }
+};
+
+// Both sides, published by the book after every mutation
+struct OrderBookMetrics {
+    SideMetrics bids;
+    SideMetrics asks;
+    uint64_t sequence = 0;      // Book mutation count (matches TopOfBook::sequence)
+
+    // Bid / ask volume ratio over the top N levels (1 if no asks)
+    double topImbalance() const {
+        return asks.top_volume > 0
+            ? static_cast<double>(bids.top_volume) / static_cast<double>(asks.top_volume) : 1.0;
+    }
+
+    // Bid / ask volume ratio within the band (1 if no asks)
+    double bandImbalance() const {
+        return asks.band_volume > 0
+            ? static_cast<double>(bids.band_volume) / static_cast<double>(asks.band_volume) : 1.0;
+    }
+};
+
+// Incrementally maintained metrics for one side of a book
+//
+// The book reports every level size change (with whether it created or
+// dropped the level) after applying it to its level container, and the
+// tracker adjusts its running sums:
+//   - whole-side volume and notional: O(1) per event;
+//   - best N levels: O(1) unless a level enters or leaves the top N, which
+//     costs one neighbour lookup in the container;
+//   - band around the touch: O(1) unless the touch moves, which walks only
+//     the levels that cross the band edge.
+// `SideLevels` is MapLevels or PriceLadder for this side; it is only
+// queried, never modified.
+template <typename SideLevels>
+class SideMetricsTracker {
+public:
+    explicit SideMetricsTracker(const MetricsConfig& config = MetricsConfig()) : config_(config) {}
+
+    // Start over from an empty side
+    void reset(const MetricsConfig& config) {
+        *this = SideMetricsTracker(config);
+    }
+
+    // Recompute everything from the levels currently in `levels`
+    void rebuild(const SideLevels& levels, const MetricsConfig& config) {
+        reset(config);
+
+        levels.forEach(levels.size(), [this](const PriceLevel& level) {
+            volume_ += level.getTotalSize();
+            notional_ += notionalOf(level);
+            ++level_count_;
+
+            if (top_count_ < config_.top_levels) {
+                ++top_count_;
+                top_volume_ += level.getTotalSize();
+                top_notional_ += notionalOf(level);
+                top_boundary_ = level.getPrice();
+            }
+        });
+
+        if (const PriceLevel* best = levels.best()) {
+            has_best_ = true;
+            best_ = best->getPrice();
+            band_edge_ = edgeFor(best_);
+            for (const PriceLevel* level = best; level && !better(band_edge_, level->getPrice());
+                 level = levels.nextWorse(level->getPrice())) {
+                band_volume_ += level->getTotalSize();
+                band_notional_ += notionalOf(*level);
+            }
+        }
+    }
+
+    // Apply a size change of `delta` at `price`. `created`: the change added
+    // the level; `dropped`: it removed it. `levels` already reflects it.
+    void onChange(const SideLevels& levels, Price price, Quantity delta, bool created, bool dropped) {
+        NotionalSum notional = static_cast<NotionalSum>(price) * delta;
+
+        volume_ += delta;
+        notional_ += notional;
+        level_count_ += created ? 1 : 0;
+        level_count_ -= dropped ? 1 : 0;
+
+        updateTop(levels, price, delta, notional, created, dropped);
+        updateBand(levels, price, delta, notional);
+    }
+
+    // Current values
+    SideMetrics get() const {
+        SideMetrics metrics;
+        metrics.volume = volume_;
+        metrics.notional = static_cast<double>(notional_);
+        metrics.levels = level_count_;
+        metrics.top_volume = top_volume_;
+        metrics.top_notional = static_cast<double>(top_notional_);
+        metrics.top_levels = top_count_;
+        metrics.band_volume = band_volume_;
+        metrics.band_notional = static_cast<double>(band_notional_);
+        metrics.band_edge = has_best_ ? band_edge_ : 0;
+        return metrics;
+    }
+
+private:
+    using Compare = typename SideLevels::Compare;
+
+    MetricsConfig config_;
+
+    Quantity volume_ = 0;
+    NotionalSum notional_ = 0;
+    size_t level_count_ = 0;
+
+    // Best N levels: every level at or better than top_boundary_
+    Quantity top_volume_ = 0;
+    NotionalSum top_notional_ = 0;
+    size_t top_count_ = 0;
+    Price top_boundary_ = 0;
+
+    // Band: every level at or better than band_edge_
+    Quantity band_volume_ = 0;
+    NotionalSum band_notional_ = 0;
+    Price best_ = 0;
+    Price band_edge_ = 0;
+    bool has_best_ = false;
+
+    static bool better(Price a, Price b) { return Compare()(a, b); }
+
+    static NotionalSum notionalOf(const PriceLevel& level) {
+        return static_cast<NotionalSum>(level.getPrice()) * level.getTotalSize();
+    }
+
+    // Worst price within config_.band_bps of `best`, rounded inwards
+    Price edgeFor(Price best) const {
+        if constexpr (std::is_same_v<Compare, std::greater<Price>>) {
+            // Bids: price * 10000 >= best * (10000 - bps)
+            return (best * (10000 - config_.band_bps) + 9999) / 10000;
+        }
+        // Asks: price * 10000 <= best * (10000 + bps)
+        return best * (10000 + config_.band_bps) / 10000;
+    }
+
+    void updateTop(const SideLevels& levels, Price price, Quantity delta, NotionalSum notional,
+                   bool created, bool dropped) {
+        if (config_.top_levels == 0) {
+            return;
+        }
+
+        bool inside = top_count_ != 0 && !better(top_boundary_, price);
+
+        if (created) {
+            if (top_count_ < config_.top_levels) {
+                // Fewer than N levels: every level counts
+                if (top_count_ == 0 || better(top_boundary_, price)) {
+                    top_boundary_ = price;
+                }
+                ++top_count_;
+                top_volume_ += delta;
+                top_notional_ += notional;
+            } else if (better(price, top_boundary_)) {
+                // New level pushes the current Nth level out
+                top_volume_ += delta;
+                top_notional_ += notional;
+
+                const PriceLevel* evicted = levels.find(top_boundary_);
+                top_volume_ -= evicted->getTotalSize();
+                top_notional_ -= notionalOf(*evicted);
+                top_boundary_ = levels.nextBetter(top_boundary_)->getPrice();
+            }
+            return;
+        }
+
+        if (!inside) {
+            return;
+        }
+
+        top_volume_ += delta;
+        top_notional_ += notional;
+
+        if (dropped) {
+            // Pull in the first level beyond the window, if any
+            --top_count_;
+            Price search_from = price == top_boundary_ ? price : top_boundary_;
+            if (const PriceLevel* next = levels.nextWorse(search_from)) {
+                ++top_count_;
+                top_volume_ += next->getTotalSize();
+                top_notional_ += notionalOf(*next);
+                top_boundary_ = next->getPrice();
+            } else if (price == top_boundary_ && top_count_ != 0) {
+                top_boundary_ = levels.nextBetter(price)->getPrice();
+            }
+        }
+    }
+
+    void updateBand(const SideLevels& levels, Price price, Quantity delta, NotionalSum notional) {
+        // Apply the change under the current band
+        if (has_best_ && !better(band_edge_, price)) {
+            band_volume_ += delta;
+            band_notional_ += notional;
+        }
+
+        const PriceLevel* best = levels.best();
+        if (best == nullptr) {
+            has_best_ = false;
+            band_volume_ = 0;
+            band_notional_ = 0;
+            return;
+        }
+
+        if (has_best_ && best->getPrice() == best_) {
+            return;
+        }
+
+        // The touch moved: shift the edge, adding or removing only the
+        // levels that cross it
+        Price new_edge = edgeFor(best->getPrice());
+
+        if (!has_best_) {
+            band_volume_ = 0;
+            band_notional_ = 0;
+            for (const PriceLevel* level = best; level && !better(new_edge, level->getPrice());
+                 level = levels.nextWorse(level->getPrice())) {
+                band_volume_ += level->getTotalSize();
+                band_notional_ += notionalOf(*level);
+            }
+        } else if (better(new_edge, band_edge_)) {
+            // Edge moved towards the touch: levels in (new_edge, old_edge] leave
+            for (const PriceLevel* level = levels.nextWorse(new_edge);
+                 level && !better(band_edge_, level->getPrice());
+                 level = levels.nextWorse(level->getPrice())) {
+                band_volume_ -= level->getTotalSize();
+                band_notional_ -= notionalOf(*level);
+            }
+        } else if (better(band_edge_, new_edge)) {
+            // Edge moved away from the touch: levels in (old_edge, new_edge] join
+            for (const PriceLevel* level = levels.nextWorse(band_edge_);
+                 level && !better(new_edge, level->getPrice());
+                 level = levels.nextWorse(level->getPrice())) {
+                band_volume_ += level->getTotalSize();
+                band_notional_ += notionalOf(*level);
+            }
+        }
+
+        has_best_ = true;
+        best_ = best->getPrice();
+        band_edge_ = new_edge;
+    }
+};
+
+} // namespace clunk
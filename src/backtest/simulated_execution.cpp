@@ -0,0 +1,224 @@
+#include "simulated_execution.h"
+#include <algorithm>
+
+namespace clunk {
+
+SimulatedExecution::SimulatedExecution(std::shared_ptr<BookView> book, size_t sweep_depth)
+    : book_(std::move(book)), subscription_(book_->subscribe()), sweep_depth_(std::max<size_t>(sweep_depth, 1)) {
+    depth_.bids.reserve(sweep_depth_);
+    depth_.asks.reserve(sweep_depth_);
+}
+
+SimulatedExecution::~SimulatedExecution() {
+    book_->unsubscribe(subscription_);
+}
+
+uint64_t SimulatedExecution::place(OrderSide side, Price price, Quantity size, TimeInForce tif) {
+    sync();
+
+    SimulatedOrder order;
+    order.id = orders_.size() + 1;
+    order.side = side;
+    order.price = price;
+    order.size = size;
+    order.tif = tif;
+    orders_.push_back(order);
+    ++stats_.orders;
+
+    SimulatedOrder& placed = orders_.back();
+    if (size <= 0) {
+        placed.status = SimulatedStatus::REJECTED;
+        ++stats_.rejected;
+        return placed.id;
+    }
+
+    sweep(placed);
+    if (placed.status != SimulatedStatus::RESTING) {
+        return placed.id;
+    }
+
+    if (tif != TimeInForce::GTC) {
+        placed.status = SimulatedStatus::CANCELLED;
+        ++stats_.cancelled;
+        return placed.id;
+    }
+
+    // Join the back of the level; take the sequence first so any change
+    // after the size is read still arrives as a newer delta
+    placed.synced = book_->getTopOfBook().sequence;
+    placed.queue_ahead = book_->getLevelSize(side, price);
+    resting_.push_back(placed.id);
+    return placed.id;
+}
+
+bool SimulatedExecution::cancel(uint64_t id) {
+    if (id == 0 || id > orders_.size() || orders_[id - 1].status != SimulatedStatus::RESTING) {
+        return false;
+    }
+    orders_[id - 1].status = SimulatedStatus::CANCELLED;
+    ++stats_.cancelled;
+    compact();
+    return true;
+}
+
+const SimulatedOrder* SimulatedExecution::getOrder(uint64_t id) const {
+    if (id == 0 || id > orders_.size()) {
+        return nullptr;
+    }
+    return &orders_[id - 1];
+}
+
+void SimulatedExecution::onTrade(const Trade& trade) {
+    sync();
+    ++stats_.trades;
+
+    // What the trade has left for orders at its price, in queue order
+    Quantity left = trade.size;
+    for (uint64_t id : resting_) {
+        SimulatedOrder& order = orders_[id - 1];
+        if (order.side != trade.maker_side || order.status != SimulatedStatus::RESTING) {
+            continue;
+        }
+
+        // A trade through our price would have reached us first
+        bool through = order.side == OrderSide::BUY ? trade.price < order.price : trade.price > order.price;
+        if (through) {
+            fill(order, order.price, order.remaining(), true);
+        } else if (trade.price == order.price && left > 0) {
+            Quantity consumed = std::min(order.queue_ahead, left);
+            order.queue_ahead -= consumed;
+            Quantity reached = std::min(left - consumed, order.remaining());
+            if (reached > 0) {
+                fill(order, order.price, reached, true);
+                left -= reached;
+            }
+        }
+    }
+    compact();
+
+    if (trade_callback_) {
+        trade_callback_(trade);
+    }
+}
+
+void SimulatedExecution::sync() {
+    if (subscription_->needsResync()) {
+        ++stats_.resyncs;
+        uint64_t sequence = book_->getTopOfBook().sequence;
+        for (uint64_t id : resting_) {
+            SimulatedOrder& order = orders_[id - 1];
+            order.queue_ahead = std::min(order.queue_ahead, book_->getLevelSize(order.side, order.price));
+            order.synced = sequence;
+        }
+        taken_.clear();
+    }
+
+    if (resting_.empty() && taken_.empty()) {
+        // Nothing to move up the queue; just keep the ring drained
+        subscription_->poll([](const LevelDelta&) {});
+        return;
+    }
+
+    subscription_->poll([this](const LevelDelta& delta) {
+        for (uint64_t id : resting_) {
+            SimulatedOrder& order = orders_[id - 1];
+            if (order.side == delta.side && order.price == delta.price && delta.sequence > order.synced) {
+                order.queue_ahead = std::min(order.queue_ahead, delta.size);
+            }
+        }
+
+        // The venue's own view of a level we swept supersedes what we took
+        taken_.erase(std::remove_if(taken_.begin(), taken_.end(),
+                                    [&delta](const TakenLevel& level) {
+                                        return level.side == delta.side && level.price == delta.price &&
+                                               delta.sequence > level.sequence;
+                                    }),
+                     taken_.end());
+    });
+}
+
+void SimulatedExecution::sweep(SimulatedOrder& order) {
+    // Passive orders skip the snapshot: the top of book is a lock-free read
+    TopOfBook top = book_->getTopOfBook();
+    bool buy = order.side == OrderSide::BUY;
+    if (buy ? top.ask_size == 0 || top.ask_price > order.price : top.bid_size == 0 || top.bid_price < order.price) {
+        if (order.tif == TimeInForce::FOK) {
+            order.status = SimulatedStatus::REJECTED;
+            ++stats_.rejected;
+        }
+        return;
+    }
+
+    book_->getDepthSnapshot(sweep_depth_, depth_);
+    OrderSide opposite = buy ? OrderSide::SELL : OrderSide::BUY;
+    const DepthSide& levels = buy ? depth_.asks : depth_.bids;
+    auto crosses = [&order, buy](Price price) { return buy ? price <= order.price : price >= order.price; };
+    auto available = [&](size_t i) {
+        return std::max<Quantity>(levels.sizes[i] - takenAt(opposite, levels.prices[i]), 0);
+    };
+
+    if (order.tif == TimeInForce::FOK) {
+        Quantity total = 0;
+        for (size_t i = 0; i < levels.size() && crosses(levels.prices[i]); ++i) {
+            total += available(i);
+        }
+        if (total < order.size) {
+            order.status = SimulatedStatus::REJECTED;
+            ++stats_.rejected;
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < levels.size() && order.remaining() > 0 && crosses(levels.prices[i]); ++i) {
+        Quantity size = std::min(available(i), order.remaining());
+        if (size > 0) {
+            take(opposite, levels.prices[i], size, depth_.sequence);
+            fill(order, levels.prices[i], size, false);
+        }
+    }
+}
+
+Quantity SimulatedExecution::takenAt(OrderSide side, Price price) const {
+    for (const TakenLevel& level : taken_) {
+        if (level.side == side && level.price == price) {
+            return level.size;
+        }
+    }
+    return 0;
+}
+
+void SimulatedExecution::take(OrderSide side, Price price, Quantity size, uint64_t sequence) {
+    for (TakenLevel& level : taken_) {
+        if (level.side == side && level.price == price) {
+            level.size += size;
+            level.sequence = std::max(level.sequence, sequence);
+            return;
+        }
+    }
+    taken_.push_back(TakenLevel{side, price, size, sequence});
+}
+
+void SimulatedExecution::fill(SimulatedOrder& order, Price price, Quantity size, bool passive) {
+    order.filled += size;
+    if (order.remaining() == 0) {
+        order.status = SimulatedStatus::FILLED;
+    }
+
+    ++stats_.fills;
+    stats_.filled += size;
+    if (passive) {
+        ++stats_.passive_fills;
+    }
+
+    if (fill_callback_) {
+        fill_callback_(SimulatedFill{order.id, order.side, price, size, order.remaining(), passive});
+    }
+}
+
+void SimulatedExecution::compact() {
+    resting_.erase(std::remove_if(resting_.begin(), resting_.end(),
+                                  [this](uint64_t id) { return orders_[id - 1].status != SimulatedStatus::RESTING; }),
+                   resting_.end());
+}
+
+} // namespace clunk
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "feed_handlers/feed_handler.h"
+#include "orderbook/book_subscription.h"
+#include "orderbook/book_view.h"
+#include "orderbook/depth_snapshot.h"
+#include "orderbook/matching.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace clunk {
+
+// Lifecycle of a simulated order
+enum class SimulatedStatus : uint8_t {
+    RESTING,
+    FILLED,
+    CANCELLED,      // By cancel(), or the unfilled part of an IOC
+    REJECTED        // No size, or an FOK the book could not fill
+};
+
+// An order placed against a replayed book
+struct SimulatedOrder {
+    uint64_t id = 0;
+    OrderSide side = OrderSide::BUY;
+    Price price = 0;
+    Quantity size = 0;
+    Quantity filled = 0;
+    Quantity queue_ahead = 0;       // Resting volume that trades before this order
+    TimeInForce tif = TimeInForce::GTC;
+    SimulatedStatus status = SimulatedStatus::RESTING;
+    uint64_t synced = 0;            // Book sequence queue_ahead was last taken at
+
+    Quantity remaining() const { return size - filled; }
+};
+
+// One simulated execution
+struct SimulatedFill {
+    uint64_t order_id = 0;
+    OrderSide side = OrderSide::BUY;
+    Price price = 0;
+    Quantity size = 0;
+    Quantity remaining = 0;
+    bool passive = false;           // Filled resting (by a trade) rather than on entry
+};
+
+// Totals over a simulation
+struct SimulationStats {
+    uint64_t orders = 0;
+    uint64_t fills = 0;
+    uint64_t passive_fills = 0;
+    uint64_t rejected = 0;
+    uint64_t cancelled = 0;
+    uint64_t trades = 0;            // Venue trades seen
+    uint64_t resyncs = 0;           // Queue positions re-read after a book resync
+    Quantity filled = 0;
+};
+
+// Callback for each simulated fill
+using SimulatedFillCallback = std::function<void(const SimulatedFill& fill)>;
+
+// Fills simulated orders against a book being replayed (or fed live)
+//
+// The book is never touched: orders only exist here. Marketable orders take
+// the liquidity of a depth snapshot of the opposite side at once. Resting
+// orders join the back of their level's queue and fill from the venue's
+// trades: a trade at their price first consumes the volume queued ahead of
+// them, a trade through their price fills them outright. A trade's size is
+// shared by the orders at its price in placement order, so it never fills
+// more than it printed. Level deltas from
+// a subscription move them up the queue when the level shrinks below their
+// position (cancels are assumed to come from behind them until then, the
+// conservative reading of an aggregated feed). In LEVELS mode a trade's
+// level update usually lands before its ticker, so the same volume can
+// advance an order twice; ORDERS mode captures give exact match order.
+// Liquidity a sweep took stays taken until the venue next changes that
+// level, so back-to-back marketable orders cannot fill the same volume.
+//
+// Not thread-safe: drive it from the thread that feeds the book (e.g. the
+// trade callback of ReplayFeedHandler::simulate()), so trades and deltas
+// are seen in the order the book applied them.
+class SimulatedExecution {
+public:
+    static constexpr size_t kDefaultSweepDepth = 50;
+
+    // Subscribe to `book`'s deltas; marketable orders sweep at most
+    // `sweep_depth` opposite levels
+    explicit SimulatedExecution(std::shared_ptr<BookView> book, size_t sweep_depth = kDefaultSweepDepth);
+
+    // Destructor
+    ~SimulatedExecution();
+
+    SimulatedExecution(const SimulatedExecution&) = delete;
+    SimulatedExecution& operator=(const SimulatedExecution&) = delete;
+
+    // Place an order, filling what crosses the book now; returns its ID
+    uint64_t place(OrderSide side, Price price, Quantity size, TimeInForce tif = TimeInForce::GTC);
+
+    // Cancel a resting order
+    bool cancel(uint64_t id);
+
+    // An order placed here (nullptr for an unknown ID)
+    const SimulatedOrder* getOrder(uint64_t id) const;
+
+    // Match a venue trade against the resting orders, then run the trade
+    // callback
+    void onTrade(const Trade& trade);
+
+    // Apply the book's pending deltas to queue positions (onTrade() and
+    // place() do this first)
+    void sync();
+
+    // Set the fill callback (it must not place or cancel orders; use the
+    // trade callback for that)
+    void setFillCallback(SimulatedFillCallback callback) { fill_callback_ = std::move(callback); }
+
+    // Set a callback run after each trade has been matched, where a
+    // strategy can place and cancel orders
+    void setTradeCallback(std::function<void(const Trade& trade)> callback) { trade_callback_ = std::move(callback); }
+
+    // Orders still resting
+    size_t getRestingCount() const { return resting_.size(); }
+
+    // Simulation totals
+    const SimulationStats& getStats() const { return stats_; }
+
+    // The book orders are simulated against
+    const BookView& getBook() const { return *book_; }
+
+private:
+    std::shared_ptr<BookView> book_;
+    std::shared_ptr<BookSubscription> subscription_;
+    size_t sweep_depth_;
+
+    // Every order by ID - 1, and the IDs still resting
+    std::vector<SimulatedOrder> orders_;
+    std::vector<uint64_t> resting_;
+
+    SimulationStats stats_;
+    SimulatedFillCallback fill_callback_;
+    std::function<void(const Trade& trade)> trade_callback_;
+
+    // Volume our sweeps took from a level the venue has not changed since
+    struct TakenLevel {
+        OrderSide side;
+        Price price;
+        Quantity size;
+        uint64_t sequence;          // Book sequence the level was swept at
+    };
+    std::vector<TakenLevel> taken_;
+
+    // Reused for sweeps
+    DepthSnapshot depth_;
+
+    // Fill `order` against the opposite side's snapshot
+    void sweep(SimulatedOrder& order);
+
+    // Volume of a level our sweeps have already taken
+    Quantity takenAt(OrderSide side, Price price) const;
+
+    // Record that a sweep took `size` at a level seen at `sequence`
+    void take(OrderSide side, Price price, Quantity size, uint64_t sequence);
+
+    // Record and report a fill
+    void fill(SimulatedOrder& order, Price price, Quantity size, bool passive);
+
+    // Drop no-longer-resting orders from resting_
+    void compact();
+};
+
+} // namespace clunk
@@ -0,0 +1,177 @@
+#include "book_checkpoint.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace clunk {
+
+namespace {
+
+constexpr uint8_t kOrdersFlag = 1;
+
+template <typename T>
+void put(char* out, const T& value) {
+    std::memcpy(out, &value, sizeof(T));
+}
+
+template <typename T>
+T get(const char* in) {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+std::string checkpointPath(const std::string& directory, const std::string& symbol) {
+    std::string path = directory;
+    if (!path.empty() && path.back() != '/') {
+        path += '/';
+    }
+    return path + symbol + ".clunkbook";
+}
+
+bool saveCheckpoint(const std::string& path, const BookCheckpoint& checkpoint) {
+    if (checkpoint.symbol.size() >= kCheckpointSymbolSize) {
+        return false;
+    }
+
+    char header[kCheckpointHeaderSize] = {};
+    std::memcpy(header, kCheckpointMagic, sizeof(kCheckpointMagic));
+    put(header + 8, kCheckpointVersion);
+    header[12] = checkpoint.orders ? kOrdersFlag : 0;
+    header[13] = static_cast<char>(checkpoint.scale.price_decimals);
+    header[14] = static_cast<char>(checkpoint.scale.size_decimals);
+    put(header + 16, checkpoint.sequence);
+    put(header + 24, checkpoint.saved_ns);
+    put(header + 32, static_cast<uint64_t>(checkpoint.entries.size()));
+    std::memcpy(header + 40, checkpoint.symbol.data(), checkpoint.symbol.size());
+
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    // Entries go out a block at a time
+    char block[kCheckpointEntrySize * 256];
+    for (size_t i = 0; ok && i < checkpoint.entries.size();) {
+        size_t count = std::min<size_t>(checkpoint.entries.size() - i, 256);
+        std::memset(block, 0, count * kCheckpointEntrySize);
+        for (size_t j = 0; j < count; ++j) {
+            const LevelUpdate& entry = checkpoint.entries[i + j];
+            char* out = block + j * kCheckpointEntrySize;
+            put(out, entry.price);
+            put(out + 8, entry.size);
+            put(out + 16, entry.order_id.hi);
+            put(out + 24, entry.order_id.lo);
+            out[32] = static_cast<char>(entry.side);
+        }
+        ok = std::fwrite(block, kCheckpointEntrySize, count, file) == count;
+        i += count;
+    }
+
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool loadCheckpoint(const std::string& path, BookCheckpoint& out) {
+#if defined(_WIN32)
+    (void)path;
+    (void)out;
+    return false;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kCheckpointHeaderSize) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    const char* data = static_cast<const char*>(mapping);
+
+    uint64_t count = get<uint64_t>(data + 32);
+    bool valid = std::memcmp(data, kCheckpointMagic, sizeof(kCheckpointMagic)) == 0 &&
+                 get<uint32_t>(data + 8) == kCheckpointVersion &&
+                 count == (size - kCheckpointHeaderSize) / kCheckpointEntrySize &&
+                 size == kCheckpointHeaderSize + count * kCheckpointEntrySize;
+    if (valid) {
+        ::madvise(mapping, size, MADV_SEQUENTIAL);
+
+        out.orders = (data[12] & kOrdersFlag) != 0;
+        out.scale = ProductScale(static_cast<uint8_t>(data[13]), static_cast<uint8_t>(data[14]));
+        out.sequence = get<uint64_t>(data + 16);
+        out.saved_ns = get<uint64_t>(data + 24);
+        out.symbol.assign(data + 40, strnlen(data + 40, kCheckpointSymbolSize));
+
+        out.entries.resize(count);
+        const char* in = data + kCheckpointHeaderSize;
+        for (LevelUpdate& entry : out.entries) {
+            entry.price = get<Price>(in);
+            entry.size = get<Quantity>(in + 8);
+            entry.order_id = OrderId(get<uint64_t>(in + 16), get<uint64_t>(in + 24));
+            entry.side = static_cast<OrderSide>(in[32]);
+            in += kCheckpointEntrySize;
+        }
+    }
+
+    ::munmap(mapping, size);
+    return valid;
+#endif
+}
+
+CheckpointWriter::CheckpointWriter(std::string directory)
+    : directory_(std::move(directory)), writer_([this](std::vector<BookCheckpoint>& checkpoints) {
+          write(checkpoints);
+      }) {}
+
+void CheckpointWriter::submit(BookCheckpoint checkpoint) {
+    writer_.submit([&checkpoint](std::vector<BookCheckpoint>& pending) {
+        auto it = std::find_if(pending.begin(), pending.end(), [&checkpoint](const BookCheckpoint& waiting) {
+            return waiting.symbol == checkpoint.symbol;
+        });
+        if (it != pending.end()) {
+            *it = std::move(checkpoint);
+        } else {
+            pending.push_back(std::move(checkpoint));
+        }
+    });
+}
+
+void CheckpointWriter::write(const std::vector<BookCheckpoint>& checkpoints) {
+    for (const BookCheckpoint& checkpoint : checkpoints) {
+        if (saveCheckpoint(checkpointPath(directory_, checkpoint.symbol), checkpoint)) {
+            written_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "Could not write checkpoint for " << checkpoint.symbol << " to " << directory_
+                      << std::endl;
+        }
+    }
+}
+
+} // namespace clunk
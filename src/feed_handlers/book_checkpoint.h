@@ -0,0 +1,86 @@
+#pragma once
+
+#include "orderbook/book_view.h"
+#include "orderbook/fixed_point.h"
+#include "utils/background_writer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace clunk {
+
+// Book checkpoint file format
+//
+// A 64-byte header (magic, version, flags, the book's scale, the feed
+// sequence the book reflects, the save time, the entry count and the
+// symbol) followed by fixed-width 40-byte entries: price, size, order ID
+// and side, little-endian as the host writes them. Fixed widths keep the
+// file mmap-able: loading is one pass over the mapping, with no parsing.
+constexpr char kCheckpointMagic[8] = {'C', 'L', 'U', 'N', 'K', 'B', 'K', 0};
+constexpr uint32_t kCheckpointVersion = 1;
+constexpr size_t kCheckpointHeaderSize = 64;
+constexpr size_t kCheckpointEntrySize = 40;
+constexpr size_t kCheckpointSymbolSize = 24;
+
+// One book as saved to or loaded from a checkpoint
+struct BookCheckpoint {
+    std::string symbol;
+    ProductScale scale;
+    uint64_t sequence = 0;              // Last feed sequence the book reflects (0: unsequenced)
+    uint64_t saved_ns = 0;              // Wall clock when captured
+    bool orders = false;                // Order-level entries (else one per level)
+    std::vector<LevelUpdate> entries;   // As BookView::exportBook() gives them
+};
+
+// File a symbol's checkpoint lives in under `directory`
+std::string checkpointPath(const std::string& directory, const std::string& symbol);
+
+// Write `checkpoint` to `path` through a temporary file renamed over it, so
+// a crash mid-write leaves the previous checkpoint intact; false on failure
+bool saveCheckpoint(const std::string& path, const BookCheckpoint& checkpoint);
+
+// Map and read the checkpoint at `path`; false if there is none or it is
+// not a whole checkpoint of this version
+bool loadCheckpoint(const std::string& path, BookCheckpoint& out);
+
+// Writes checkpoints on a background thread, so the feed thread that
+// captured a book only hands it over
+//
+// A checkpoint for a symbol that still has one waiting replaces it: only
+// the newest state is worth the disk write.
+class CheckpointWriter {
+public:
+    // Start the writer thread, saving into `directory` (which must exist)
+    explicit CheckpointWriter(std::string directory);
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Queue a checkpoint for writing
+    void submit(BookCheckpoint checkpoint);
+
+    // Block until everything submitted so far is on disk
+    void flush() { writer_.flush(); }
+
+    // Directory checkpoints are written to
+    const std::string& getDirectory() const { return directory_; }
+
+    // Checkpoints written, and writes that failed
+    uint64_t getWrittenCount() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t getFailedCount() const { return failed_.load(std::memory_order_relaxed); }
+
+private:
+    std::string directory_;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> failed_{0};
+
+    BackgroundWriter<std::vector<BookCheckpoint>> writer_;
+
+    // Save a batch of checkpoints (on the writer thread)
+    void write(const std::vector<BookCheckpoint>& checkpoints);
+};
+
+} // namespace clunk
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "network/pipeline_latency.h"
+#include "network/sharded_pipeline.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace clunk {
+
+// The books of a feed handler's products, grouped by the thread that
+// applies them, and whether each has been built yet
+//
+// There is one shard until enableSharding() gives each ShardedPipeline
+// worker its own; a product's books are then created in the shard it is
+// routed to, on that worker's NUMA node when placement is on.
+//
+// `Shard` is the handler's per-thread state: it has a `books` map from
+// symbol to the product's books, a `mutex` guarding it, and a `latency`.
+// The product's books hold a `sync` pointer whose `ready` flag is set
+// through markReady().
+template <typename Shard>
+class BookShards {
+public:
+    using Books = typename decltype(Shard::books)::mapped_type;
+
+    // Called on a shard's thread for each message routed to it
+    using Handler = std::function<void(Shard& shard, std::string_view message, const MessageTiming& timing)>;
+
+    // Constructor (one shard, no workers)
+    BookShards() { shards_.push_back(std::make_unique<Shard>()); }
+
+    BookShards(const BookShards&) = delete;
+    BookShards& operator=(const BookShards&) = delete;
+
+    // Apply messages on `shard_count` worker threads, calling `handler` on
+    // each, with the options ShardedPipeline takes. Replaces the shards, so
+    // call before any product is added.
+    void enableSharding(size_t shard_count, size_t capacity, Handler handler,
+                        const std::vector<int>& worker_cpus, bool local_memory) {
+        sharding_ = std::make_unique<ShardedPipeline>(
+            shard_count, capacity,
+            [this, handler = std::move(handler)](size_t shard, std::string_view payload,
+                                                 const MessageTiming& timing) {
+                handler(*shards_[shard], payload, timing);
+            },
+            worker_cpus, local_memory);
+
+        shards_.clear();
+        for (size_t i = 0; i < sharding_->size(); ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    // The workers' pipeline (null when not sharded)
+    ShardedPipeline* getPipeline() const { return sharding_.get(); }
+
+    // Start the workers, and let them finish what is queued and stop
+    void start() {
+        if (sharding_) {
+            sharding_->start();
+        }
+    }
+    void stop() {
+        if (sharding_) {
+            sharding_->stop();
+        }
+    }
+
+    // Per-shard queue counters and product counts (empty when not sharded)
+    std::vector<ShardStats> getStats() const {
+        return sharding_ ? sharding_->getStats() : std::vector<ShardStats>{};
+    }
+
+    // Add every shard's latency samples to `merged`
+    void mergeLatency(StageLatency& merged) const {
+        for (const auto& shard : shards_) {
+            merged.merge(shard->latency);
+        }
+    }
+
+    // Number of shards, and shard i
+    size_t size() const { return shards_.size(); }
+    Shard& operator[](size_t index) const { return *shards_[index]; }
+
+    // Shard owning a symbol's books
+    Shard& shardFor(std::string_view symbol) const {
+        return *shards_[sharding_ ? sharding_->shardFor(symbol) : 0];
+    }
+
+    // Route a symbol to a shard and, unless it has books there already,
+    // call `create(books, node)` under the shard's lock to build them on
+    // NUMA node `node` (-1: anywhere); returns whether it did
+    template <typename Create>
+    bool add(const std::string& symbol, Create&& create) {
+        size_t index = sharding_ ? sharding_->assign(symbol) : 0;
+        Shard& shard = *shards_[index];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto [it, inserted] = shard.books.try_emplace(symbol);
+        if (inserted) {
+            create(it->second, sharding_ ? sharding_->nodeFor(index) : -1);
+        }
+        return inserted;
+    }
+
+    // Drop a symbol's books and its route
+    void remove(const std::string& symbol) {
+        {
+            Shard& shard = shardFor(symbol);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.books.erase(symbol);
+        }
+        if (sharding_) {
+            sharding_->unassign(symbol);
+        }
+    }
+
+    // Copy out the symbol's books; returns false if it has none
+    static bool find(Shard& shard, const std::string& symbol, Books& out) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.books.find(symbol);
+        if (it == shard.books.end()) {
+            return false;
+        }
+        out = it->second;
+        return true;
+    }
+    bool find(const std::string& symbol, Books& out) const { return find(shardFor(symbol), symbol, out); }
+
+    // Whether a symbol's books have been flagged ready
+    bool isReady(const std::string& symbol) const {
+        Books books;
+        return find(symbol, books) && books.sync->ready.load(std::memory_order_acquire);
+    }
+
+    // Block until every symbol is ready or `timeout` passes; returns
+    // whether they all are
+    bool waitReady(const std::vector<std::string>& symbols, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(ready_mutex_);
+        return ready_cv_.wait_for(lock, timeout, [this, &symbols]() {
+            return std::all_of(symbols.begin(), symbols.end(),
+                               [this](const std::string& symbol) { return isReady(symbol); });
+        });
+    }
+
+    // Flag a product's books as ready and wake waitReady() (the flag is set
+    // under the lock waitReady() checks it under, so no wakeup is missed)
+    void markReady(std::atomic<bool>& ready) {
+        if (ready.load(std::memory_order_relaxed)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            ready.store(true, std::memory_order_release);
+        }
+        ready_cv_.notify_all();
+    }
+
+private:
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // Routes messages to the shard workers (null when not sharded)
+    std::unique_ptr<ShardedPipeline> sharding_;
+
+    // Notified as books become ready
+    std::mutex ready_mutex_;
+    std::condition_variable ready_cv_;
+};
+
+} // namespace clunk
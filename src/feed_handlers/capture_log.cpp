@@ -0,0 +1,146 @@
+#include "capture_log.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace clunk {
+
+namespace {
+
+// stdio buffer for the writer
+constexpr size_t kWriteBuffer = 1 << 20;
+
+std::runtime_error captureError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+CaptureWriter::CaptureWriter(const std::string& path) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ == nullptr) {
+        throw captureError("Cannot create capture file", path);
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, kWriteBuffer);
+
+    char header[kCaptureHeaderSize] = {};
+    std::memcpy(header, kCaptureMagic, sizeof(kCaptureMagic));
+    std::memcpy(header + 8, &kCaptureVersion, sizeof(kCaptureVersion));
+    std::fwrite(header, 1, sizeof(header), file_);
+    bytes_ = sizeof(header);
+}
+
+CaptureWriter::~CaptureWriter() {
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+void CaptureWriter::append(uint64_t receive_ns, uint16_t source, std::string_view payload) {
+    char header[kCaptureRecordHeaderSize] = {};
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    std::memcpy(header, &receive_ns, sizeof(receive_ns));
+    std::memcpy(header + 8, &length, sizeof(length));
+    std::memcpy(header + 12, &source, sizeof(source));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::fwrite(header, 1, sizeof(header), file_);
+    std::fwrite(payload.data(), 1, payload.size(), file_);
+    ++records_;
+    bytes_ += sizeof(header) + payload.size();
+}
+
+void CaptureWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::fflush(file_);
+}
+
+uint64_t CaptureWriter::getRecordCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+uint64_t CaptureWriter::getByteCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+CaptureReader::CaptureReader(const std::string& path) {
+#if defined(_WIN32)
+    throw std::runtime_error("Capture replay is not supported on this platform: " + path);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw captureError("Cannot open capture file", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw captureError("Cannot stat capture file", path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (size_ < kCaptureHeaderSize) {
+        ::close(fd);
+        throw std::runtime_error("Not a capture file: " + path);
+    }
+
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw captureError("Cannot map capture file", path);
+    }
+    data_ = static_cast<const char*>(mapping);
+
+    // Replay reads the file front to back
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+
+    uint32_t version = 0;
+    std::memcpy(&version, data_ + 8, sizeof(version));
+    if (std::memcmp(data_, kCaptureMagic, sizeof(kCaptureMagic)) != 0 || version != kCaptureVersion) {
+        ::munmap(mapping, size_);
+        data_ = nullptr;
+        throw std::runtime_error("Not a capture file (or unsupported version): " + path);
+    }
+#endif
+}
+
+CaptureReader::~CaptureReader() {
+#if !defined(_WIN32)
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+bool CaptureReader::next(CaptureRecord& out) {
+    if (size_ - offset_ < kCaptureRecordHeaderSize) {
+        truncated_ = offset_ != size_;
+        return false;
+    }
+
+    const char* header = data_ + offset_;
+    uint32_t length = 0;
+    std::memcpy(&out.receive_ns, header, sizeof(out.receive_ns));
+    std::memcpy(&length, header + 8, sizeof(length));
+    std::memcpy(&out.source, header + 12, sizeof(out.source));
+
+    if (size_ - offset_ - kCaptureRecordHeaderSize < length) {
+        truncated_ = true;
+        return false;
+    }
+
+    out.payload = std::string_view(header + kCaptureRecordHeaderSize, length);
+    offset_ += kCaptureRecordHeaderSize + length;
+    return true;
+}
+
+} // namespace clunk
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace clunk {
+
+// Capture file layout (native byte order; all supported targets are
+// little-endian):
+//   header: 8-byte magic "CLNKCAP1", then uint32 version and uint32 reserved
+//   records, back to back: uint64 receive time (ns since the Unix epoch),
+//   uint32 payload length, uint16 source (connection index), uint16
+//   reserved, then the payload bytes
+constexpr char kCaptureMagic[8] = {'C', 'L', 'N', 'K', 'C', 'A', 'P', '1'};
+constexpr uint32_t kCaptureVersion = 1;
+constexpr size_t kCaptureHeaderSize = 16;
+constexpr size_t kCaptureRecordHeaderSize = 16;
+
+// One captured payload (the view points into the reader's mapping)
+struct CaptureRecord {
+    uint64_t receive_ns = 0;
+    uint16_t source = 0;
+    std::string_view payload;
+};
+
+// Appends payloads to a capture file
+//
+// Records go through a large stdio buffer, so an append is a memcpy in the
+// common case. Appends may come from several I/O threads and are
+// serialized by a mutex.
+class CaptureWriter {
+public:
+    // Create (or truncate) `path`; throws std::runtime_error on failure
+    explicit CaptureWriter(const std::string& path);
+
+    // Destructor (flushes and closes)
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // Append one payload received at `receive_ns` on `source`
+    void append(uint64_t receive_ns, uint16_t source, std::string_view payload);
+
+    // Push buffered records to the file
+    void flush();
+
+    // Records and bytes (headers included) written so far
+    uint64_t getRecordCount() const;
+    uint64_t getByteCount() const;
+
+private:
+    std::FILE* file_ = nullptr;
+    mutable std::mutex mutex_;
+    uint64_t records_ = 0;
+    uint64_t bytes_ = 0;
+};
+
+// Reads a capture file through a read-only memory mapping
+//
+// Records are returned as views into the mapping, so iterating copies
+// nothing. A record cut short at the end of the file (e.g. the capturing
+// process was killed) ends the iteration and sets truncated().
+class CaptureReader {
+public:
+    // Map `path`; throws std::runtime_error if it cannot be read or is not
+    // a capture file
+    explicit CaptureReader(const std::string& path);
+
+    // Destructor (unmaps)
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    // Read the next record; false at the end of the file
+    bool next(CaptureRecord& out);
+
+    // Start again from the first record
+    void rewind() { offset_ = kCaptureHeaderSize; }
+
+    // Whether the file ended partway through a record
+    bool truncated() const { return truncated_; }
+
+    // File size in bytes
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t offset_ = kCaptureHeaderSize;
+    bool truncated_ = false;
+};
+
+} // namespace clunk
@@ -0,0 +1,155 @@
+#include "coinbase_decoder.h"
+
+namespace clunk {
+
+namespace {
+
+// How a known key's value is captured
+enum class FieldKind : uint8_t {
+    STRING,     // String value
+    SCALAR,     // Decimal as a string or bare number
+    RAW         // Raw text of an array
+};
+
+struct FieldSpec {
+    std::string_view key;
+    std::string_view CoinbaseMessage::*field;
+    FieldKind kind;
+};
+
+// Keys the handler reads; everything else is skipped
+constexpr FieldSpec kFields[] = {
+    {"type", &CoinbaseMessage::type_name, FieldKind::STRING},
+    {"product_id", &CoinbaseMessage::product_id, FieldKind::STRING},
+    {"changes", &CoinbaseMessage::changes, FieldKind::RAW},
+    {"sequence", &CoinbaseMessage::sequence, FieldKind::SCALAR},
+    {"price", &CoinbaseMessage::price, FieldKind::SCALAR},
+    {"size", &CoinbaseMessage::size, FieldKind::SCALAR},
+    {"side", &CoinbaseMessage::side, FieldKind::STRING},
+    {"order_id", &CoinbaseMessage::order_id, FieldKind::STRING},
+    {"maker_order_id", &CoinbaseMessage::maker_order_id, FieldKind::STRING},
+    {"new_size", &CoinbaseMessage::new_size, FieldKind::SCALAR},
+    {"remaining_size", &CoinbaseMessage::remaining_size, FieldKind::SCALAR},
+    {"last_size", &CoinbaseMessage::last_size, FieldKind::SCALAR},
+    {"best_bid", &CoinbaseMessage::best_bid, FieldKind::SCALAR},
+    {"best_bid_size", &CoinbaseMessage::best_bid_size, FieldKind::SCALAR},
+    {"best_ask", &CoinbaseMessage::best_ask, FieldKind::SCALAR},
+    {"best_ask_size", &CoinbaseMessage::best_ask_size, FieldKind::SCALAR},
+    {"bids", &CoinbaseMessage::bids, FieldKind::RAW},
+    {"asks", &CoinbaseMessage::asks, FieldKind::RAW},
+    {"message", &CoinbaseMessage::message, FieldKind::STRING},
+};
+
+const FieldSpec* findField(std::string_view key) {
+    for (const FieldSpec& spec : kFields) {
+        if (spec.key == key) {
+            return &spec;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+CoinbaseMessageType coinbaseMessageType(std::string_view name) {
+    struct TypeName {
+        std::string_view name;
+        CoinbaseMessageType type;
+    };
+
+    // Ordered roughly by frequency on a busy feed
+    static constexpr TypeName kTypes[] = {
+        {"l2update", CoinbaseMessageType::L2UPDATE},
+        {"ticker", CoinbaseMessageType::TICKER},
+        {"open", CoinbaseMessageType::OPEN},
+        {"done", CoinbaseMessageType::DONE},
+        {"received", CoinbaseMessageType::RECEIVED},
+        {"match", CoinbaseMessageType::MATCH},
+        {"change", CoinbaseMessageType::CHANGE},
+        {"l3update", CoinbaseMessageType::L3UPDATE},
+        {"heartbeat", CoinbaseMessageType::HEARTBEAT},
+        {"snapshot", CoinbaseMessageType::SNAPSHOT},
+        {"subscriptions", CoinbaseMessageType::SUBSCRIPTIONS},
+        {"error", CoinbaseMessageType::ERROR},
+    };
+
+    for (const TypeName& entry : kTypes) {
+        if (entry.name == name) {
+            return entry.type;
+        }
+    }
+    return CoinbaseMessageType::UNKNOWN;
+}
+
+bool decodeCoinbaseMessage(std::string_view text, CoinbaseMessage& out) {
+    out = CoinbaseMessage();
+    out.text = text;
+
+    JsonScanner scanner(text);
+    if (!scanner.beginObject()) {
+        return false;
+    }
+
+    std::string_view key;
+    while (scanner.nextKey(key)) {
+        const FieldSpec* spec = findField(key);
+        if (spec == nullptr) {
+            if (!scanner.skipValue()) {
+                return false;
+            }
+            continue;
+        }
+
+        std::string_view& field = out.*(spec->field);
+        bool ok = false;
+        switch (spec->kind) {
+            case FieldKind::STRING:
+                // Tolerate null (e.g. "price": null on market orders) as absent
+                ok = scanner.peek() == JsonType::STRING ? scanner.readString(field) : scanner.skipValue();
+                break;
+            case FieldKind::SCALAR:
+                ok = scanner.peek() == JsonType::LITERAL ? scanner.skipValue() : scanner.readScalar(field);
+                break;
+            case FieldKind::RAW:
+                ok = scanner.readRaw(field);
+                break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+
+    if (scanner.failed() || !scanner.atEnd()) {
+        return false;
+    }
+
+    out.type = coinbaseMessageType(out.type_name);
+    out.order_side = coinbaseSide(out.side);
+    return true;
+}
+
+std::string_view peekProductId(std::string_view text) {
+    return peekString(text, "\"product_id\"");
+}
+
+bool coinbaseRestSnapshot(std::string_view product_id, std::string_view body, std::string& out) {
+    size_t open = body.find_first_not_of(" \t\r\n");
+    if (open == std::string_view::npos || body[open] != '{') {
+        return false;
+    }
+    size_t first = body.find_first_not_of(" \t\r\n", open + 1);
+    if (first == std::string_view::npos) {
+        return false;
+    }
+
+    // The book's own fields follow the two the feed's snapshots lead with
+    out.clear();
+    out.reserve(body.size() + product_id.size() + 40);
+    out += R"({"type":"snapshot","product_id":")";
+    out += product_id;
+    out += body[first] == '}' ? "\"" : "\",";
+    out += body.substr(open + 1);
+    return true;
+}
+
+} // namespace clunk
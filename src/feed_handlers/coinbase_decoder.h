@@ -0,0 +1,101 @@
+#pragma once
+
+#include "orderbook/order.h"
+#include "utils/json_utils.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace clunk {
+
+// Coinbase feed message types the handler acts on
+enum class CoinbaseMessageType : uint8_t {
+    UNKNOWN,
+    SNAPSHOT,
+    L2UPDATE,
+    TICKER,
+    L3UPDATE,
+    RECEIVED,
+    OPEN,
+    DONE,
+    MATCH,
+    CHANGE,
+    ERROR,
+    SUBSCRIPTIONS,
+    HEARTBEAT
+};
+
+// Map a "type" value to its enum (UNKNOWN for anything else)
+CoinbaseMessageType coinbaseMessageType(std::string_view name);
+
+// Map a "buy"/"sell" side to OrderSide by its first byte (anything not
+// starting with 'b' is a sell)
+inline OrderSide coinbaseSide(std::string_view side) {
+    return !side.empty() && side[0] == 'b' ? OrderSide::BUY : OrderSide::SELL;
+}
+
+// The fields of one Coinbase message the handler reads, as views into the
+// message text
+//
+// Decimal fields keep their text so they can be parsed straight into ticks
+// and lots once the product's scale is known. Absent fields are
+// default-constructed views (see has()); "bids", "asks" and "changes" hold
+// the raw text of their arrays, to walk with forEachRow(). Views are only
+// valid while the message text is.
+struct CoinbaseMessage {
+    CoinbaseMessageType type = CoinbaseMessageType::UNKNOWN;
+    std::string_view text;          // The whole message
+    std::string_view type_name;
+    std::string_view product_id;
+    std::string_view sequence;      // Per-product sequence number, if sent
+
+    // L3 fields
+    std::string_view order_id;
+    std::string_view maker_order_id;
+    std::string_view side;
+    OrderSide order_side = OrderSide::SELL;     // "side" resolved at decode
+    std::string_view price;
+    std::string_view size;
+    std::string_view new_size;
+    std::string_view remaining_size;    // What an "open" order rests with
+
+    // Ticker fields ("price" and "side" above are its last trade's)
+    std::string_view last_size;
+    std::string_view best_bid;
+    std::string_view best_bid_size;
+    std::string_view best_ask;
+    std::string_view best_ask_size;
+
+    // Error text
+    std::string_view message;
+
+    // Raw arrays: snapshot levels and l2update changes
+    std::string_view bids;
+    std::string_view asks;
+    std::string_view changes;
+
+    // Whether a field was present in the message (it may still be empty)
+    static bool has(std::string_view field) { return field.data() != nullptr; }
+};
+
+// Decode one Coinbase message in a single pass without building a document
+//
+// Keys are matched as they are scanned, wherever "type" appears, and
+// values the handler does not use are skipped unparsed. The side is
+// resolved to order_side here, once per message. Returns false if
+// the text is not a well-formed JSON object.
+bool decodeCoinbaseMessage(std::string_view text, CoinbaseMessage& out);
+
+// Product ID of a message without decoding it (empty if absent), so the
+// I/O thread can route it to the product's shard. This is a text search
+// for the first "product_id" key, so it is only a routing hint: the shard
+// decodes the message properly.
+std::string_view peekProductId(std::string_view text);
+
+// Turn the body of a REST level-3 book (/products/<id>/book?level=3, with
+// "bids", "asks" and "sequence") into a "snapshot" message for
+// `product_id`, so it is applied like a snapshot from the feed. Returns
+// false if `body` is not a JSON object.
+bool coinbaseRestSnapshot(std::string_view product_id, std::string_view body, std::string& out);
+
+} // namespace clunk
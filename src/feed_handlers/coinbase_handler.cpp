@@ -1,22 +1,104 @@
 #include "coinbase_handler.h"
+#include "network/https_client.h"
+#include "utils/node_allocator.h"
+#include "utils/time_utils.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <charconv>
 #include <iostream>
 #include <chrono>
+#include <stdexcept>
 
 namespace clunk {
 
 using json = nlohmann::json;
 
-CoinbaseHandler::CoinbaseHandler() : verbose_logging_(false) {
+namespace {
+
+// Parse a decimal feed field into ticks/lots at the given scale, throwing on
+// malformed input like std::stod did
+int64_t parseScaled(std::string_view text, int decimals) {
+    int64_t result = 0;
+    if (!parseDecimal(text, decimals, result)) {
+        throw std::invalid_argument("Malformed decimal: " + std::string(text));
+    }
+    return result;
+}
+
+// Parse a "sequence" field, throwing on malformed input
+uint64_t parseSequence(std::string_view text) {
+    uint64_t sequence = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), sequence);
+    if (ec != std::errc() || end != text.data() + text.size()) {
+        throw std::invalid_argument("Malformed sequence: " + std::string(text));
+    }
+    return sequence;
+}
+
+} // namespace
+
+CoinbaseHandler::CoinbaseHandler(BookMode mode) : book_mode_(mode), verbose_logging_(false) {
     // Create the websocket client
-    ws_client_ = std::make_shared<WebSocketClient>(kHost, kPort);
+    connections_.push_back(makeConnection(0));
+
+    // The full channel sends no snapshots of its own
+    if (book_mode_ == BookMode::ORDERS) {
+        snapshot_fetches_ = std::make_unique<BackgroundWriter<std::vector<std::string>>>(
+            [this](std::vector<std::string>& symbols) { fetchSnapshots(symbols); });
+    }
+}
+
+std::vector<std::string> CoinbaseHandler::channels() const {
+    return {bookChannel(), "ticker", "heartbeat"};
+}
+
+std::shared_ptr<WebSocketClient> CoinbaseHandler::makeConnection(size_t index) {
+    auto client = std::make_shared<WebSocketClient>(kHost, kPort);
 
     // Set up the message callback
-    ws_client_->setMessageCallback([this](const std::string& message) {
-        handleMessage(message);
+    client->setMessageCallback([this, index](std::string_view message, const MessageTiming& timing) {
+        dispatchMessage(index, message, timing);
     });
-    
+
+    // Re-subscribe whenever the session is (re)established
+    client->setConnectCallback([this, index](bool reconnected) {
+        onConnected(index, reconnected);
+    });
+
     // Set the path for WebSocket handshake
-    ws_client_->setPath(kPath);
+    client->setPath(kPath);
+    client->setVerboseLogging(verbose_logging_);
+    client->setIoCpu(index < io_cpus_.size() ? io_cpus_[index] : -1);
+    client->setBusyPoll(busy_poll_);
+    return client;
+}
+
+void CoinbaseHandler::onConnected(size_t connection, bool reconnected) {
+    std::vector<std::string> symbols;
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        symbols = routes_.symbolsOn(connection);
+    }
+    if (symbols.empty()) {
+        return;
+    }
+
+    // One message restores every product on this connection
+    json subscription = {
+        {"type", "subscribe"},
+        {"product_ids", symbols},
+        {"channels", channels()}
+    };
+    if (verbose_logging_) {
+        std::cout << "Restoring subscriptions: " << subscription.dump() << std::endl;
+    }
+    connections_[connection]->send(subscription.dump());
+
+    if (reconnected && resync_callback_) {
+        for (const std::string& symbol : symbols) {
+            resync_callback_(symbol, ResyncReason::RECONNECT);
+        }
+    }
 }
 
 CoinbaseHandler::~CoinbaseHandler() {
@@ -24,459 +106,1001 @@ CoinbaseHandler::~CoinbaseHandler() {
 }
 
 void CoinbaseHandler::connect() {
-    ws_client_->connect();
+    startWorkers();
+    for (const auto& connection : connections_) {
+        connection->connect();
+    }
+}
+
+void CoinbaseHandler::startWorkers() {
+    shards_.start();
 }
 
 void CoinbaseHandler::disconnect() {
-    if (ws_client_) {
-        ws_client_->disconnect();
+    for (const auto& connection : connections_) {
+        connection->disconnect();
+    }
+
+    // Let the shards finish what the I/O thread already queued
+    shards_.stop();
+
+    if (capture_) {
+        capture_->flush();
     }
 }
 
 bool CoinbaseHandler::isConnected() const {
-    return ws_client_ && ws_client_->isConnected();
+    return getConnectedCount() > 0;
+}
+
+size_t CoinbaseHandler::getConnectedCount() const {
+    size_t count = 0;
+    for (const auto& connection : connections_) {
+        count += connection->isConnected() ? 1 : 0;
+    }
+    return count;
+}
+
+void CoinbaseHandler::enableConnectionPool(size_t connections, size_t redundancy) {
+    if (isConnected()) {
+        std::cerr << "Cannot change the connection pool while connected" << std::endl;
+        return;
+    }
+
+    connections = std::max<size_t>(connections, 1);
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        routes_.reset(connections, redundancy);
+        redundant_ = routes_.getRedundancy() > 1;
+        copies_.publish(std::make_shared<const CopyTable>());
+    }
+
+    connections_.clear();
+    for (size_t i = 0; i < connections; ++i) {
+        connections_.push_back(makeConnection(i));
+    }
+}
+
+void CoinbaseHandler::setReconnectPolicy(const ReconnectPolicy& policy) {
+    for (const auto& connection : connections_) {
+        connection->setReconnectPolicy(policy);
+    }
+}
+
+uint64_t CoinbaseHandler::getReconnectCount() const {
+    uint64_t count = 0;
+    for (const auto& connection : connections_) {
+        count += connection->getReconnectCount();
+    }
+    return count;
+}
+
+void CoinbaseHandler::setIoThreads(const std::vector<int>& io_cpus, bool busy_poll) {
+    io_cpus_ = io_cpus;
+    busy_poll_ = busy_poll;
+    for (size_t i = 0; i < connections_.size(); ++i) {
+        connections_[i]->setIoCpu(i < io_cpus_.size() ? io_cpus_[i] : -1);
+        connections_[i]->setBusyPoll(busy_poll_);
+    }
 }
 
 void CoinbaseHandler::setVerboseLogging(bool enabled) {
     verbose_logging_ = enabled;
-    if (ws_client_) {
-        ws_client_->setVerboseLogging(enabled);
+    for (const auto& connection : connections_) {
+        connection->setVerboseLogging(enabled);
     }
 }
 
-void CoinbaseHandler::subscribe(const std::string& symbol) {
-    if (!isConnected()) {
-        std::cerr << "Not connected, cannot subscribe to " << symbol << std::endl;
+void CoinbaseHandler::enablePipeline(size_t capacity, int worker_cpu) {
+    for (const auto& connection : connections_) {
+        connection->enablePipeline(capacity, worker_cpu);
+    }
+}
+
+PipelineStats CoinbaseHandler::getPipelineStats() const {
+    PipelineStats total;
+    for (const auto& connection : connections_) {
+        PipelineStats stats = connection->getPipelineStats();
+        total.depth += stats.depth;
+        total.max_depth = std::max(total.max_depth, stats.max_depth);
+        total.capacity += stats.capacity;
+        total.enqueued += stats.enqueued;
+        total.processed += stats.processed;
+        total.full_events += stats.full_events;
+    }
+    return total;
+}
+
+void CoinbaseHandler::enableSharding(size_t shard_count, size_t capacity, const std::vector<int>& worker_cpus,
+                                     bool local_memory) {
+    if (isConnected()) {
+        std::cerr << "Cannot enable sharding while connected" << std::endl;
         return;
     }
 
-    // Create order book if it doesn't exist
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (order_books_.find(symbol) == order_books_.end()) {
-            order_books_[symbol] = std::make_shared<OrderBook>(symbol);
+    shards_.enableSharding(
+        shard_count, capacity,
+        [this](Shard& shard, std::string_view payload, const MessageTiming& timing) {
+            handleMessage(shard, payload, timing);
+        },
+        worker_cpus, local_memory);
+    shards_.getPipeline()->setMultiProducer(sharedFeed());
+}
+
+std::vector<ShardStats> CoinbaseHandler::getShardStats() const {
+    return shards_.getStats();
+}
+
+std::vector<LatencySummary> CoinbaseHandler::getLatencyStats() const {
+    // Each connection and shard records on its own thread; merge a copy
+    auto merged = std::make_unique<StageLatency>();
+    for (const auto& connection : connections_) {
+        merged->merge(connection->getLatency());
+    }
+    shards_.mergeLatency(*merged);
+    return merged->summarize();
+}
+
+void CoinbaseHandler::enableCapture(const std::string& path) {
+    capture_ = std::make_unique<CaptureWriter>(path);
+}
+
+void CoinbaseHandler::subscribe(const std::string& symbol) {
+    // Create the symbol's book in its shard if it doesn't exist, on the
+    // shard worker's NUMA node when placement is on
+    ProductBooks created;
+    shards_.add(symbol, [this, &symbol, &created](ProductBooks& books, int node) {
+        if (book_mode_ == BookMode::ORDERS) {
+            books.orders = std::allocate_shared<OrderBook>(NodeAllocator<OrderBook>(node), symbol);
+        } else {
+            books.levels = std::allocate_shared<LevelBook>(NodeAllocator<LevelBook>(node), symbol);
         }
+        books.sync = std::make_shared<ProductSync>();
+        created = books;
+    });
+
+    // A new book starts from its checkpoint; nothing feeds it until the
+    // subscription below goes out
+    if (checkpoints_ && created.sync) {
+        restoreCheckpoint(symbol, created);
+    }
+
+    // Pick the product's connections: the least loaded one and the ones
+    // after it, one per copy
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        routes_.assign(symbol);
+        publishCopies(symbol, true);
     }
 
     // Create subscription message for Coinbase public feed
-    // Subscribe to level2 for full order book depth
+    // Subscribe to the book channel for full order book depth
     json subscription = {
         {"type", "subscribe"},
         {"product_ids", {symbol}},
-        {"channels", {"level2", "ticker", "heartbeat"}}
+        {"channels", channels()}
     };
 
     // Send subscription message
     if (verbose_logging_) {
         std::cout << "Sending subscription: " << subscription.dump() << std::endl;
     }
-    ws_client_->send(subscription.dump());
+    sendToProduct(symbol, subscription.dump());
 }
 
 void CoinbaseHandler::unsubscribe(const std::string& symbol) {
-    if (!isConnected()) {
-        return;
-    }
-
     // Create unsubscription message
     json unsubscription = {
         {"type", "unsubscribe"},
         {"product_ids", {symbol}},
-        {"channels", {"level2", "heartbeat", "ticker"}}
+        {"channels", channels()}
     };
 
     // Send unsubscription message
-    ws_client_->send(unsubscription.dump());
+    sendToProduct(symbol, unsubscription.dump());
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        routes_.release(symbol);
+        publishCopies(symbol, false);
+    }
 
     // Remove order book
+    shards_.remove(symbol);
+}
+
+void CoinbaseHandler::sendToProduct(const std::string& symbol, const std::string& message) {
+    std::vector<size_t> route;
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        order_books_.erase(symbol);
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        if (const std::vector<size_t>* found = routes_.find(symbol)) {
+            route = *found;
+        }
+    }
+
+    for (size_t connection : route) {
+        connections_[connection]->send(message);
+    }
+}
+
+size_t CoinbaseHandler::primaryConnection(const std::vector<size_t>& route) const {
+    return ConnectionRoutes::primary(route, [this](size_t connection) {
+        return connections_[connection]->isConnected();
+    });
+}
+
+CoinbaseHandler::ProductCopies* CoinbaseHandler::findCopies(std::string_view symbol) const {
+    const CopyTable& copies = copies_.get();
+    auto it = copies.find(symbol);
+    return it != copies.end() ? it->second.get() : nullptr;
+}
+
+void CoinbaseHandler::publishCopies(const std::string& symbol, bool subscribed) {
+    std::shared_ptr<const CopyTable> current = copies_.load();
+    if ((current->count(symbol) != 0) == subscribed) {
+        return;
     }
+
+    auto copies = std::make_shared<CopyTable>(*current);
+    if (subscribed) {
+        auto product = std::make_shared<ProductCopies>();
+        product->route = *routes_.find(symbol);
+        copies->emplace(symbol, std::move(product));
+    } else {
+        copies->erase(symbol);
+    }
+    copies_.publish(std::move(copies));
+}
+
+std::vector<size_t> CoinbaseHandler::getRoute(const std::string& symbol) const {
+    std::lock_guard<std::mutex> lock(routes_mutex_);
+    const std::vector<size_t>* route = routes_.find(symbol);
+    return route ? *route : std::vector<size_t>{};
 }
 
 std::shared_ptr<OrderBook> CoinbaseHandler::getOrderBook(const std::string& symbol) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = order_books_.find(symbol);
-    if (it != order_books_.end()) {
-        return it->second;
+    ProductBooks books;
+    return shards_.find(symbol, books) ? books.orders : nullptr;
+}
+
+std::shared_ptr<LevelBook> CoinbaseHandler::getLevelBook(const std::string& symbol) {
+    ProductBooks books;
+    return shards_.find(symbol, books) ? books.levels : nullptr;
+}
+
+std::shared_ptr<BookView> CoinbaseHandler::getBookView(const std::string& symbol) {
+    ProductBooks books;
+    if (!shards_.find(symbol, books)) {
+        return nullptr;
+    }
+    if (books.orders) {
+        return books.orders;
     }
-    return nullptr;
+    return books.levels;
+}
+
+template <typename Apply>
+bool CoinbaseHandler::withBook(const ProductBooks& books, Apply&& apply) {
+    if (books.orders) {
+        apply(*books.orders);
+    } else if (books.levels) {
+        apply(*books.levels);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void CoinbaseHandler::enableCheckpoints(const std::string& directory, std::chrono::seconds interval) {
+    checkpoints_ = std::make_unique<CheckpointWriter>(directory);
+    checkpoint_interval_ns_ = static_cast<uint64_t>(std::chrono::nanoseconds(interval).count());
 }
 
-void CoinbaseHandler::handleMessage(const std::string& message) {
+size_t CoinbaseHandler::saveCheckpoints() {
+    if (!checkpoints_) {
+        return 0;
+    }
+
+    size_t saved = 0;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        Shard& shard = shards_[i];
+        std::vector<std::pair<std::string, ProductBooks>> books;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            books.assign(shard.books.begin(), shard.books.end());
+        }
+
+        // A book waiting on a snapshot is stale, and its checkpoint would be
+        // worse than the one already on disk
+        for (const auto& [symbol, product] : books) {
+            if (product.sync->ready.load(std::memory_order_acquire) && !product.sync->sequence.isSyncing()) {
+                checkpoints_->submit(captureCheckpoint(symbol, product));
+                ++saved;
+            }
+        }
+    }
+    checkpoints_->flush();
+    return saved;
+}
+
+bool CoinbaseHandler::isBookReady(const std::string& symbol) const {
+    return shards_.isReady(symbol);
+}
+
+bool CoinbaseHandler::waitForBooks(const std::vector<std::string>& symbols, std::chrono::milliseconds timeout) {
+    return shards_.waitReady(symbols, timeout);
+}
+
+void CoinbaseHandler::restoreCheckpoint(const std::string& symbol, const ProductBooks& books) {
+    BookCheckpoint checkpoint;
+    if (!loadCheckpoint(checkpointPath(checkpoints_->getDirectory(), symbol), checkpoint)) {
+        return;
+    }
+
+    // A checkpoint of the other book model or scale would load garbage
+    withBook(books, [&](auto& book) {
+        if (checkpoint.symbol != symbol || checkpoint.orders != (book_mode_ == BookMode::ORDERS) ||
+            checkpoint.scale.price_decimals != book.getScale().price_decimals ||
+            checkpoint.scale.size_decimals != book.getScale().size_decimals) {
+            std::cerr << "Ignoring checkpoint for " << symbol << ": it does not match the book" << std::endl;
+            return;
+        }
+
+        book.loadSnapshot(checkpoint.entries.data(), checkpoint.entries.size());
+        books.sync->checkpoint_sequence = checkpoint.sequence;
+        if (verbose_logging_) {
+            std::cout << "Restored " << symbol << " from checkpoint at sequence " << checkpoint.sequence << " ("
+                      << checkpoint.entries.size() << " entries, "
+                      << (wallClockNanos() - checkpoint.saved_ns) / 1000000000ULL << "s old)" << std::endl;
+        }
+    });
+}
+
+void CoinbaseHandler::catchUpCheckpoint(const std::string& symbol, const ProductBooks& books, Shard& shard) {
+    ProductSync& sync = *books.sync;
+    uint64_t restored = sync.checkpoint_sequence;
+    sync.checkpoint_sequence = 0;
+
+    // The checkpoint stands in for a snapshot taken at its sequence
+    bool live = sync.sequence.onSnapshot(restored, [&](std::string_view text) {
+        CoinbaseMessage held;
+        if (decodeCoinbaseMessage(text, held)) {
+            applyBookUpdate(held, books, shard);
+        }
+    });
+    if (!live) {
+        std::cerr << "Checkpoint for " << symbol << " at " << restored
+                  << " is behind the feed; waiting for a snapshot" << std::endl;
+        return;
+    }
+    shards_.markReady(sync.ready);
+}
+
+BookCheckpoint CoinbaseHandler::captureCheckpoint(const std::string& symbol, const ProductBooks& books) {
+    BookCheckpoint checkpoint;
+    checkpoint.symbol = symbol;
+    checkpoint.sequence = books.sync->sequence.getLastSequence();
+    checkpoint.saved_ns = wallClockNanos();
+    checkpoint.orders = books.orders != nullptr;
+    withBook(books, [&checkpoint](auto& book) {
+        checkpoint.scale = book.getScale();
+        book.exportBook(checkpoint.entries);
+    });
+    return checkpoint;
+}
+
+void CoinbaseHandler::checkpointIfDue(const std::string& symbol, const ProductBooks& books) {
+    ProductSync& sync = *books.sync;
+    if (!checkpoints_ || checkpoint_interval_ns_ == 0 || sync.checkpoint_countdown-- > 0) {
+        return;
+    }
+    sync.checkpoint_countdown = kCheckpointCheckInterval;
+
+    uint64_t now = wallClockNanos();
+    if (sync.next_checkpoint_ns == 0) {
+        // The first interval runs from when the book went live
+        sync.next_checkpoint_ns = now + checkpoint_interval_ns_;
+        return;
+    }
+    if (now < sync.next_checkpoint_ns) {
+        return;
+    }
+    sync.next_checkpoint_ns = now + checkpoint_interval_ns_;
+
+    // Copying the book is the only cost on the feed thread; the writer
+    // thread does the disk I/O
+    checkpoints_->submit(captureCheckpoint(symbol, books));
+}
+
+void CoinbaseHandler::injectMessage(std::string_view message, size_t connection) {
+    uint64_t now = readCycles();
+    dispatchMessage(connection, message, MessageTiming{now, now});
+}
+
+void CoinbaseHandler::dispatchMessage(size_t connection, std::string_view message, const MessageTiming& timing) {
+    if (redundant_ && !acceptCopy(connection, message)) {
+        return;
+    }
+    deliverMessage(connection, message, timing);
+}
+
+void CoinbaseHandler::deliverMessage(size_t connection, std::string_view message, const MessageTiming& timing) {
+    if (capture_) {
+        capture_->append(wallClockNanos(), static_cast<uint16_t>(connection), message);
+    }
+
+    if (ShardedPipeline* sharding = shards_.getPipeline()) {
+        sharding->push(peekProductId(message), message, timing);
+    } else if (sharedFeed()) {
+        Shard& shard = shards_[0];
+        std::lock_guard<std::mutex> lock(shard.feed_mutex);
+        handleMessage(shard, message, timing);
+    } else {
+        handleMessage(shards_[0], message, timing);
+    }
+}
+
+bool CoinbaseHandler::acceptCopy(size_t connection, std::string_view message) {
+    std::string_view product_id = peekProductId(message);
+    if (product_id.empty()) {
+        return true;
+    }
+    ProductCopies* copies = findCopies(product_id);
+    if (copies == nullptr) {
+        return true;
+    }
+
+    // Sequenced copies: the first to arrive wins, so the copies behind it
+    // are neither captured nor handed to the shard. Tickers repeat the
+    // sequence of the match they report, so they are counted apart.
+    std::string_view sequence_text = peekScalar(message, "\"sequence\"");
+    if (!sequence_text.empty()) {
+        uint64_t sequence = 0;
+        auto [end, ec] = std::from_chars(sequence_text.data(), sequence_text.data() + sequence_text.size(), sequence);
+        std::string_view type = peekString(message, "\"type\"");
+        if (ec != std::errc() || end != sequence_text.data() + sequence_text.size() || type == "snapshot") {
+            return true;
+        }
+
+        // Raise the last sequence unless another connection's copy already
+        // took it
+        std::atomic<uint64_t>& last = copies->sequences[type == "ticker" ? 1 : type == "heartbeat" ? 2 : 0];
+        uint64_t seen = last.load(std::memory_order_relaxed);
+        do {
+            if (sequence <= seen) {
+                return false;
+            }
+        } while (!last.compare_exchange_weak(seen, sequence, std::memory_order_relaxed));
+        return true;
+    }
+
+    // Unsequenced copies cannot be told apart, so only the primary's count
+    return primaryConnection(copies->route) == connection;
+}
+
+void CoinbaseHandler::handleMessage(Shard& shard, std::string_view message, const MessageTiming& timing) {
+    uint64_t picked = readCycles();
+    shard.latency.record(LatencyStage::HANDOFF, timing.deframed, picked);
+
     try {
-        // Parse the JSON message
-        json j = json::parse(message);
+        // Decode the fields we use in one pass, without building a document
+        CoinbaseMessage m;
+        if (!decodeCoinbaseMessage(message, m)) {
+            std::cerr << "Error processing message: malformed JSON" << std::endl;
+            return;
+        }
+
+        uint64_t parsed = readCycles();
+        shard.latency.record(LatencyStage::PARSE, picked, parsed);
 
-        // Get the message type
-        std::string type = j["type"];
         if (verbose_logging_) {
-            std::cout << "Received message type: " << type << std::endl;
+            std::cout << "Received message type: " << m.type_name << std::endl;
         }
 
-        if (type == "snapshot") {
-            processSnapshot(j);
-        } else if (type == "l2update") {
-            // Process level2 updates
-            processL2Update(j);
-        } else if (type == "ticker") {
-            // Process ticker data
-            if (verbose_logging_) {
-                std::cout << "Received ticker: " << j.dump(2) << std::endl;
+        switch (m.type) {
+            case CoinbaseMessageType::SNAPSHOT:
+            case CoinbaseMessageType::L2UPDATE:
+            case CoinbaseMessageType::L3UPDATE:
+            case CoinbaseMessageType::RECEIVED:
+            case CoinbaseMessageType::OPEN:
+            case CoinbaseMessageType::DONE:
+            case CoinbaseMessageType::MATCH:
+            case CoinbaseMessageType::CHANGE: {
+                processBookMessage(m, shard);
+                uint64_t applied = readCycles();
+                shard.latency.record(LatencyStage::APPLY, parsed, applied);
+                shard.latency.record(LatencyStage::TOTAL, timing.read, applied);
+                break;
             }
-            
-            // For ticker data, update the order book with best bid/ask
-            if (j.contains("product_id") && 
-                j.contains("best_bid") && j.contains("best_ask") &&
-                j.contains("best_bid_size") && j.contains("best_ask_size")) {
-                
-                processTicker(j);
+            case CoinbaseMessageType::TICKER:
+                // Process ticker data
+                if (verbose_logging_) {
+                    std::cout << "Received ticker: " << m.text << std::endl;
+                }
+
+                // Ticker data only validates the book's best bid/ask
+                if (CoinbaseMessage::has(m.product_id) &&
+                    CoinbaseMessage::has(m.best_bid) && CoinbaseMessage::has(m.best_ask) &&
+                    CoinbaseMessage::has(m.best_bid_size) && CoinbaseMessage::has(m.best_ask_size)) {
+                    processTicker(m, shard);
+                }
+                break;
+            case CoinbaseMessageType::ERROR:
+                std::cerr << "Coinbase API error: " << m.message << std::endl;
+                break;
+            case CoinbaseMessageType::SUBSCRIPTIONS:
+                if (verbose_logging_) {
+                    std::cout << "Subscribed to channels: " << m.text << std::endl;
+                }
+                break;
+            default:
+                // Handle other message types
+                if (verbose_logging_) {
+                    std::cout << "Unhandled message type: " << m.type_name << std::endl;
+                }
+                break;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error processing message: " << e.what() << std::endl;
+    }
+}
+
+void CoinbaseHandler::processBookMessage(const CoinbaseMessage& m, Shard& shard) {
+    // Check if product_id exists in this message
+    if (!CoinbaseMessage::has(m.product_id)) {
+        std::cerr << "Message " << m.type_name << " missing product_id field" << std::endl;
+        return;
+    }
+
+    // Get the product ID (symbol)
+    std::string symbol(m.product_id);
+
+    ProductBooks books;
+    if (!BookShards<Shard>::find(shard, symbol, books)) {
+        std::cerr << "Order book not found for symbol: " << symbol << std::endl;
+        return;
+    }
+    ProductSync& sync = *books.sync;
+
+    try {
+        uint64_t sequence = CoinbaseMessage::has(m.sequence) ? parseSequence(m.sequence) : 0;
+
+        if (m.type == CoinbaseMessageType::SNAPSHOT) {
+            // A book caught up from its checkpoint can already be past the
+            // snapshot; loading it would only roll the book back
+            if (sequence != 0 && !sync.sequence.isSyncing() && sequence <= sync.sequence.getLastSequence()) {
+                return;
             }
-        } else if (type == "l3update" || type == "received" || type == "open" ||
-                  type == "done" || type == "match" || type == "change") {
-            processL3Update(j);
-        } else if (type == "error") {
-            std::cerr << "Coinbase API error: " << j["message"] << std::endl;
-        } else if (type == "subscriptions") {
-            if (verbose_logging_) {
-                std::cout << "Subscribed to channels: " << j.dump(2) << std::endl;
+            if (!processSnapshot(m, books, shard)) {
+                return;
             }
-        } else {
-            // Handle other message types
-            if (verbose_logging_) {
-                std::cout << "Unhandled message type: " << type << std::endl;
+            sync.ticker_mismatches = 0;
+            sync.snapshot_fetched_ns = 0;
+
+            // Catch up on the updates held while the snapshot was pending
+            bool live = sync.sequence.onSnapshot(sequence, [&](std::string_view text) {
+                CoinbaseMessage held;
+                if (decodeCoinbaseMessage(text, held)) {
+                    applyBookUpdate(held, books, shard);
+                }
+            });
+            if (!live) {
+                std::cerr << "Sequence gap replaying updates for " << symbol << ", resyncing" << std::endl;
+                requestSnapshot(symbol, sync, ResyncReason::SEQUENCE_GAP);
+                return;
             }
+            sync.checkpoint_sequence = 0;
+            shards_.markReady(sync.ready);
+            checkpointIfDue(symbol, books);
+            return;
+        }
+
+        SequenceCheck check = CoinbaseMessage::has(m.sequence)
+            ? sync.sequence.check(sequence, m.text)
+            : sync.sequence.checkUnsequenced();
+
+        switch (check) {
+            case SequenceCheck::APPLY:
+                applyBookUpdate(m, books, shard);
+                checkpointIfDue(symbol, books);
+                break;
+            case SequenceCheck::GAP:
+                std::cerr << "Sequence gap for " << symbol << " after " << sync.sequence.getLastSequence()
+                          << " (got " << sequence << "), resyncing" << std::endl;
+                requestSnapshot(symbol, sync, ResyncReason::SEQUENCE_GAP);
+                break;
+            case SequenceCheck::BUFFERED:
+                if (sync.checkpoint_sequence != 0) {
+                    catchUpCheckpoint(symbol, books, shard);
+                }
+                // Held updates need a base: ask for a snapshot unless the
+                // checkpoint just provided one
+                if (sync.sequence.isSyncing()) {
+                    fetchSnapshot(symbol, sync);
+                }
+                break;
+            case SequenceCheck::STALE:
+                break;
         }
     } catch (const std::exception& e) {
-        std::cerr << "Error processing message: " << e.what() << std::endl;
+        std::cerr << "Error processing " << m.type_name << " message: " << e.what() << std::endl;
     }
 }
 
-void CoinbaseHandler::processSnapshot(const nlohmann::json& j) {
-    if (verbose_logging_) {
-        std::cout << "Processing snapshot: " << j.dump(2) << std::endl;
+void CoinbaseHandler::applyBookUpdate(const CoinbaseMessage& m, const ProductBooks& books, Shard& shard) {
+    if (m.type == CoinbaseMessageType::L2UPDATE) {
+        processL2Update(m, books, shard);
+    } else {
+        processL3Update(m, books);
     }
+}
 
-    // Check if product_id exists in this message
-    if (!j.contains("product_id")) {
-        std::cerr << "Snapshot missing product_id field" << std::endl;
+void CoinbaseHandler::requestSnapshot(const std::string& symbol, ProductSync& sync, ResyncReason reason) {
+    // A gap has already put the tracker into syncing; a failed validation
+    // has not
+    sync.sequence.beginResync();
+    sync.ticker_mismatches = 0;
+
+    if (resync_callback_) {
+        resync_callback_(symbol, reason);
+    }
+
+    if (book_mode_ == BookMode::ORDERS) {
+        fetchSnapshot(symbol, sync);
         return;
     }
 
-    // Get the product ID (symbol)
-    std::string symbol = j["product_id"];
+    // Coinbase sends a fresh level2 snapshot on every new subscription
+    json unsubscription = {
+        {"type", "unsubscribe"},
+        {"product_ids", {symbol}},
+        {"channels", {"level2"}}
+    };
+    json subscription = {
+        {"type", "subscribe"},
+        {"product_ids", {symbol}},
+        {"channels", {"level2"}}
+    };
 
-    // Get the order book
-    auto order_book = getOrderBook(symbol);
-    if (!order_book) {
-        std::cerr << "Order book not found for symbol: " << symbol << std::endl;
+    ProductCopies* copies = findCopies(symbol);
+    if (copies == nullptr) {
         return;
     }
 
-    // Check if bids and asks fields are in the message
-    if (!j.contains("bids") || !j.contains("asks")) {
-        std::cerr << "Snapshot missing bids or asks fields" << std::endl;
+    // Only the primary's snapshot is applied, so only it re-subscribes
+    if (verbose_logging_) {
+        std::cout << "Requesting snapshot: " << subscription.dump() << std::endl;
+    }
+    const auto& connection = connections_[primaryConnection(copies->route)];
+    connection->send(unsubscription.dump());
+    connection->send(subscription.dump());
+}
+
+void CoinbaseHandler::fetchSnapshot(const std::string& symbol, ProductSync& sync) {
+    if (!snapshot_fetches_) {
         return;
     }
 
-    try {
-        // Process bids
-        for (const auto& bid : j["bids"]) {
-            // Each bid is [price, size, order_id]
-            double price = std::stod(bid[0].get<std::string>());
-            double size = std::stod(bid[1].get<std::string>());
-            std::string order_id = bid.size() > 2 ? bid[2].get<std::string>() : "bid-" + bid[0].get<std::string>();
-
-            // Create and add the order
-            auto order = std::make_shared<Order>(
-                order_id, OrderSide::BUY, price, size,
-                std::chrono::duration_cast<std::chrono::nanoseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()
-                )
-            );
-            order_book->addOrder(order);
+    // Injected and replayed feeds have no REST API behind them
+    ProductCopies* copies = findCopies(symbol);
+    if (copies == nullptr || !connections_[primaryConnection(copies->route)]->isConnected()) {
+        return;
+    }
+
+    uint64_t now = wallClockNanos();
+    if (sync.snapshot_fetched_ns != 0 && now - sync.snapshot_fetched_ns < kSnapshotRetryNs) {
+        return;
+    }
+    sync.snapshot_fetched_ns = now;
+
+    if (verbose_logging_) {
+        std::cout << "Fetching snapshot for " << symbol << std::endl;
+    }
+    snapshot_fetches_->submit([&symbol](std::vector<std::string>& pending) {
+        if (std::find(pending.begin(), pending.end(), symbol) == pending.end()) {
+            pending.push_back(symbol);
         }
+    });
+}
 
-        // Process asks
-        for (const auto& ask : j["asks"]) {
-            // Each ask is [price, size, order_id]
-            double price = std::stod(ask[0].get<std::string>());
-            double size = std::stod(ask[1].get<std::string>());
-            std::string order_id = ask.size() > 2 ? ask[2].get<std::string>() : "ask-" + ask[0].get<std::string>();
-
-            // Create and add the order
-            auto order = std::make_shared<Order>(
-                order_id, OrderSide::SELL, price, size,
-                std::chrono::duration_cast<std::chrono::nanoseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()
-                )
-            );
-            order_book->addOrder(order);
+void CoinbaseHandler::fetchSnapshots(const std::vector<std::string>& symbols) {
+    std::string body;
+    std::string message;
+    for (const std::string& symbol : symbols) {
+        ProductCopies* copies = findCopies(symbol);
+        if (copies == nullptr) {
+            continue;
         }
+        size_t connection = primaryConnection(copies->route);
 
-        if (verbose_logging_) {
-            std::cout << "Processed snapshot with " << j["bids"].size() << " bids and "
-                    << j["asks"].size() << " asks" << std::endl;
+        // Fetched after the subscription went out, so the updates held
+        // since then cover everything after the snapshot
+        if (!connections_[connection]->isConnected() ||
+            !httpsGet(kRestHost, kPort, "/products/" + symbol + "/book?level=3", body)) {
+            continue;
+        }
+        if (!coinbaseRestSnapshot(symbol, body, message)) {
+            std::cerr << "Malformed snapshot for " << symbol << std::endl;
+            continue;
+        }
+
+        // A disconnect while fetching leaves no feed to apply it to
+        if (connections_[connection]->isConnected()) {
+            uint64_t now = readCycles();
+            deliverMessage(connection, message, MessageTiming{now, now});
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error processing snapshot data: " << e.what() << std::endl;
     }
 }
 
-void CoinbaseHandler::processL3Update(const nlohmann::json& j) {
-    // In sandbox, we might not receive L3 updates, but let's keep the code for future use
+bool CoinbaseHandler::processSnapshot(const CoinbaseMessage& m, const ProductBooks& books, Shard& shard) {
     if (verbose_logging_) {
-        std::cout << "Processing L3 update: " << j.dump(2) << std::endl;
+        std::cout << "Processing snapshot: " << m.text << std::endl;
     }
 
-    // These are the fields we expect in L3 updates
-    if (!j.contains("product_id")) {
-        std::cerr << "L3 update missing product_id field" << std::endl;
-        return;
+    // Check if bids and asks fields are in the message
+    if (!CoinbaseMessage::has(m.bids) || !CoinbaseMessage::has(m.asks)) {
+        std::cerr << "Snapshot missing bids or asks fields" << std::endl;
+        return false;
     }
 
-    // Get the product ID (symbol)
-    std::string symbol = j["product_id"];
+    bool loaded = false;
+    withBook(books, [&](auto& book) {
+        try {
+            const ProductScale& scale = book.getScale();
+            shard.batch.clear();
+
+            // Each level is [price, size, order_id]
+            auto addLevels = [&](std::string_view levels, OrderSide side) {
+                bool ok = forEachRow(levels, [&](const JsonRow& level) {
+                    if (level.size() < 2) {
+                        throw std::runtime_error("Snapshot level has fewer than 2 fields");
+                    }
+                    LevelUpdate update;
+                    update.side = side;
+                    update.price = parseScaled(level[0], scale.price_decimals);
+                    update.size = parseScaled(level[1], scale.size_decimals);
+                    if (level.size() > 2) {
+                        update.order_id = OrderId::fromString(level[2]);
+                    }
+                    shard.batch.push_back(update);
+                });
+                if (!ok) {
+                    throw std::runtime_error("Malformed snapshot levels");
+                }
+            };
+
+            addLevels(m.bids, OrderSide::BUY);
+            size_t bid_count = shard.batch.size();
+            addLevels(m.asks, OrderSide::SELL);
+
+            // Replace the book in one lock acquisition and one notification
+            book.loadSnapshot(shard.batch.data(), shard.batch.size());
+            loaded = true;
+
+            if (verbose_logging_) {
+                std::cout << "Processed snapshot with " << bid_count << " bids and "
+                        << shard.batch.size() - bid_count << " asks" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing snapshot data: " << e.what() << std::endl;
+        }
+    });
+
+    return loaded;
+}
 
-    // Get the order book
-    auto order_book = getOrderBook(symbol);
+void CoinbaseHandler::processL3Update(const CoinbaseMessage& m, const ProductBooks& books) {
+    // In sandbox, we might not receive L3 updates, but let's keep the code for future use
+    if (verbose_logging_) {
+        std::cout << "Processing L3 update: " << m.text << std::endl;
+    }
+
+    // Aggregated books have no orders to apply L3 messages to
+    const std::shared_ptr<OrderBook>& order_book = books.orders;
     if (!order_book) {
-        std::cerr << "Order book not found for symbol: " << symbol << std::endl;
+        if (verbose_logging_) {
+            std::cout << "Ignoring L3 message for aggregated book: " << m.product_id << std::endl;
+        }
         return;
     }
 
-    // Get the message type
-    std::string type = j["type"];
+    const ProductScale& scale = order_book->getScale();
 
     try {
         // Different message types have different fields
-        if (type == "received" || type == "open") {
+        if (m.type == CoinbaseMessageType::RECEIVED) {
+            // Accepted by the matching engine, but only on the book once an
+            // open says so (with what is left after it took liquidity)
+            return;
+        }
+
+        if (m.type == CoinbaseMessageType::OPEN) {
+            // The full channel sends what the order rests with as
+            // remaining_size; older L3 feeds sent size
+            std::string_view rest = CoinbaseMessage::has(m.remaining_size) ? m.remaining_size : m.size;
+
             // Check if we have all the required fields
-            if (!j.contains("order_id") || !j.contains("side") || !j.contains("price") || !j.contains("size")) {
-                std::cerr << "Missing fields in received/open message" << std::endl;
+            if (!CoinbaseMessage::has(m.order_id) || !CoinbaseMessage::has(m.side) ||
+                !CoinbaseMessage::has(m.price) || !CoinbaseMessage::has(rest)) {
+                std::cerr << "Missing fields in open message" << std::endl;
                 return;
             }
 
             // New order
-            std::string order_id = j["order_id"];
-            std::string side_str = j["side"];
-            OrderSide side = convertOrderSide(side_str);
-            double price = std::stod(j["price"].get<std::string>());
-            double size = std::stod(j["size"].get<std::string>());
+            OrderId order_id = OrderId::fromString(m.order_id);
+            OrderSide side = m.order_side;
+            Price price = parseScaled(m.price, scale.price_decimals);
+            Quantity size = parseScaled(rest, scale.size_decimals);
 
             // Process as a new order
             order_book->processL3Update("open", order_id, side, price, size);
 
-        } else if (type == "done") {
+        } else if (m.type == CoinbaseMessageType::DONE) {
             // Check if we have the order_id field
-            if (!j.contains("order_id")) {
+            if (!CoinbaseMessage::has(m.order_id)) {
                 std::cerr << "Missing order_id in done message" << std::endl;
                 return;
             }
 
             // Order removed
-            std::string order_id = j["order_id"];
-            order_book->processL3Update("done", order_id, OrderSide::BUY, 0.0, 0.0);
+            OrderId order_id = OrderId::fromString(m.order_id);
+            order_book->processL3Update("done", order_id, OrderSide::BUY, 0, 0);
 
-        } else if (type == "match") {
+        } else if (m.type == CoinbaseMessageType::MATCH) {
             // Check if we have all the required fields
-            if (!j.contains("maker_order_id") || !j.contains("size")) {
+            if (!CoinbaseMessage::has(m.maker_order_id) || !CoinbaseMessage::has(m.size)) {
                 std::cerr << "Missing fields in match message" << std::endl;
                 return;
             }
 
             // Order matched (partial or full fill)
-            std::string maker_order_id = j["maker_order_id"];
-            double size = std::stod(j["size"].get<std::string>());
-
-            // Process the maker order
-            auto maker_order = order_book->getOrder(maker_order_id);
-            if (maker_order) {
-                double new_size = maker_order->getSize() - size;
-                if (new_size <= 0) {
-                    // Fully filled, remove order
-                    order_book->processL3Update("done", maker_order_id, maker_order->getSide(), 0.0, 0.0);
-                } else {
-                    // Partially filled, update size
-                    order_book->processL3Update("change", maker_order_id, maker_order->getSide(),
-                                               maker_order->getPrice(), new_size);
-                }
+            OrderId maker_order_id = OrderId::fromString(m.maker_order_id);
+            Quantity size = parseScaled(m.size, scale.size_decimals);
+
+            // Report the trade while the maker is still on the book
+            if (trade_callback_ && CoinbaseMessage::has(m.price) && CoinbaseMessage::has(m.side)) {
+                trade_callback_(std::string(m.product_id),
+                                Trade{m.order_side, parseScaled(m.price, scale.price_decimals), size});
             }
 
-        } else if (type == "change") {
+            // Reduce the maker order, removing it once fully filled
+            order_book->reduceOrder(maker_order_id, size);
+
+        } else if (m.type == CoinbaseMessageType::CHANGE) {
             // Check if we have all the required fields
-            if (!j.contains("order_id") || !j.contains("new_size")) {
+            if (!CoinbaseMessage::has(m.order_id) || !CoinbaseMessage::has(m.new_size)) {
                 std::cerr << "Missing fields in change message" << std::endl;
                 return;
             }
 
             // Order size changed
-            std::string order_id = j["order_id"];
-            double new_size = std::stod(j["new_size"].get<std::string>());
-
-            // Get the order to determine the side
-            auto order = order_book->getOrder(order_id);
-            if (order) {
-                order_book->processL3Update("change", order_id, order->getSide(),
-                                           order->getPrice(), new_size);
-            }
+            OrderId order_id = OrderId::fromString(m.order_id);
+            Quantity new_size = parseScaled(m.new_size, scale.size_decimals);
+
+            // The book already knows the order's side and price
+            order_book->modifyOrder(order_id, new_size);
         }
     } catch (const std::exception& e) {
         std::cerr << "Error processing L3 update: " << e.what() << std::endl;
     }
 }
 
-void CoinbaseHandler::processTicker(const nlohmann::json& j) {
+void CoinbaseHandler::processTicker(const CoinbaseMessage& m, Shard& shard) {
     // Get the product ID (symbol)
-    std::string symbol = j["product_id"];
+    std::string symbol(m.product_id);
 
-    // Get the order book
-    auto order_book = getOrderBook(symbol);
-    if (!order_book) {
+    ProductBooks books;
+    if (!BookShards<Shard>::find(shard, symbol, books)) {
         std::cerr << "Order book not found for symbol: " << symbol << std::endl;
         return;
     }
+    ProductSync& sync = *books.sync;
 
-    try {
-        // Helper function to handle both string and numeric values in JSON
-        auto getDoubleValue = [](const json& value) -> double {
-            if (value.is_string()) {
-                return std::stod(value.get<std::string>());
-            } else if (value.is_number()) {
-                return value.get<double>();
+    // Aggregated books see trades only through tickers
+    if (trade_callback_ && books.levels) {
+        reportTickerTrade(m, books);
+    }
+
+    // Nothing to check while the book is being rebuilt
+    if (sync.sequence.isSyncing()) {
+        return;
+    }
+
+    withBook(books, [&](auto& book) {
+        try {
+            const ProductScale& scale = book.getScale();
+
+            // Get best bid and ask (fields may be strings or numbers)
+            Price best_bid_price = parseScaled(m.best_bid, scale.price_decimals);
+            Price best_ask_price = parseScaled(m.best_ask, scale.price_decimals);
+
+            // Compare with the book's touch; only a mismatch that persists
+            // across several tickers means the book has drifted
+            TopOfBook top = book.getTopOfBook();
+            if (top.hasBid() && top.hasAsk() &&
+                top.bid_price == best_bid_price && top.ask_price == best_ask_price) {
+                sync.ticker_mismatches = 0;
+                return;
             }
-            throw std::runtime_error("Value is neither string nor number");
-        };
-
-        // Get best bid and ask
-        double best_bid_price = getDoubleValue(j["best_bid"]);
-        double best_bid_size = getDoubleValue(j["best_bid_size"]);
-        double best_ask_price = getDoubleValue(j["best_ask"]);
-        double best_ask_size = getDoubleValue(j["best_ask_size"]);
-
-        // Generate a unique sequence ID
-        std::string sequence_str;
-        if (j["sequence"].is_number()) {
-            sequence_str = std::to_string(j["sequence"].get<int64_t>());
-        } else {
-            sequence_str = j["sequence"].get<std::string>();
-        }
 
-        // Update the order book with best bid
-        auto bid_order = std::make_shared<Order>(
-            "bid-" + sequence_str, 
-            OrderSide::BUY, 
-            best_bid_price, 
-            best_bid_size,
-            std::chrono::duration_cast<std::chrono::nanoseconds>(
-                std::chrono::system_clock::now().time_since_epoch()
-            )
-        );
-        
-        // Update the order book with best ask
-        auto ask_order = std::make_shared<Order>(
-            "ask-" + sequence_str, 
-            OrderSide::SELL, 
-            best_ask_price, 
-            best_ask_size,
-            std::chrono::duration_cast<std::chrono::nanoseconds>(
-                std::chrono::system_clock::now().time_since_epoch()
-            )
-        );
-
-        // Clear existing orders and add new ones
-        // This is a simplified approach - in a real system, you'd want to maintain the full order book
-        order_book->clear();
-        order_book->addOrder(bid_order);
-        order_book->addOrder(ask_order);
-        
-        if (verbose_logging_) {
-            std::cout << "Updated order book: Best bid=" << best_bid_price 
-                    << " (" << best_bid_size << "), Best ask=" 
-                    << best_ask_price << " (" << best_ask_size << ")" << std::endl;
+            if (verbose_logging_) {
+                std::cout << "Ticker disagrees with book: ticker bid=" << scale.formatPrice(best_bid_price)
+                        << " ask=" << scale.formatPrice(best_ask_price) << ", book bid="
+                        << scale.formatPrice(top.bid_price) << " ask=" << scale.formatPrice(top.ask_price) << std::endl;
+            }
+
+            if (++sync.ticker_mismatches >= kTickerMismatchLimit) {
+                std::cerr << "Book for " << symbol << " disagrees with the ticker, resyncing" << std::endl;
+                requestSnapshot(symbol, sync, ResyncReason::VALIDATION);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing ticker data: " << e.what() << std::endl;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error processing ticker data: " << e.what() << std::endl;
-    }
+    });
 }
 
-OrderSide CoinbaseHandler::convertOrderSide(const std::string& side) {
-    if (side == "buy") {
-        return OrderSide::BUY;
-    } else {
-        return OrderSide::SELL;
+void CoinbaseHandler::reportTickerTrade(const CoinbaseMessage& m, const ProductBooks& books) {
+    if (!CoinbaseMessage::has(m.price) || !CoinbaseMessage::has(m.last_size) || !CoinbaseMessage::has(m.side)) {
+        return;
+    }
+
+    ProductSync& sync = *books.sync;
+    if (CoinbaseMessage::has(m.sequence)) {
+        uint64_t sequence = parseSequence(m.sequence);
+        if (sequence <= sync.last_ticker_trade) {
+            return;
+        }
+        sync.last_ticker_trade = sequence;
     }
+
+    // A ticker's side is the taker's; the maker rested on the other side
+    const ProductScale& scale = books.levels->getScale();
+    OrderSide maker_side = opposite(m.order_side);
+    trade_callback_(std::string(m.product_id),
+                    Trade{maker_side, parseScaled(m.price, scale.price_decimals),
+                          parseScaled(m.last_size, scale.size_decimals)});
 }
 
-void CoinbaseHandler::processL2Update(const nlohmann::json& j) {
+void CoinbaseHandler::processL2Update(const CoinbaseMessage& m, const ProductBooks& books, Shard& shard) {
     if (verbose_logging_) {
-        std::cout << "Processing L2 update: " << j.dump(2) << std::endl;
+        std::cout << "Processing L2 update: " << m.text << std::endl;
     }
 
     // Check required fields
-    if (!j.contains("product_id") || !j.contains("changes")) {
+    if (!CoinbaseMessage::has(m.changes)) {
         std::cerr << "L2 update missing required fields" << std::endl;
         return;
     }
 
-    // Get the product ID (symbol)
-    std::string symbol = j["product_id"];
-
-    // Get the order book
-    auto order_book = getOrderBook(symbol);
-    if (!order_book) {
-        std::cerr << "Order book not found for symbol: " << symbol << std::endl;
-        return;
-    }
+    withBook(books, [&](auto& book) {
+        try {
+            const ProductScale& scale = book.getScale();
+            shard.batch.clear();
 
-    try {
-        // Process the changes
-        for (const auto& change : j["changes"]) {
-            // Each change is [side, price, size]
-            std::string side_str = change[0];
-            double price = std::stod(change[1].get<std::string>());
-            double size = std::stod(change[2].get<std::string>());
-            
-            OrderSide side = (side_str == "buy") ? OrderSide::BUY : OrderSide::SELL;
-            
-            // Generate a unique order ID based on side and price
-            std::string order_id = (side == OrderSide::BUY ? "bid-" : "ask-") + change[1].get<std::string>();
-            
-            // If size is 0, remove the price level
-            if (size <= 0.0) {
-                order_book->removeOrdersByPrice(price, side);
-            } else {
-                // Either add a new order or update existing one
-                auto existing_orders = order_book->getOrdersByPrice(price, side);
-                
-                if (existing_orders.empty()) {
-                    // Add new order
-                    auto order = std::make_shared<Order>(
-                        order_id, side, price, size,
-                        std::chrono::duration_cast<std::chrono::nanoseconds>(
-                            std::chrono::system_clock::now().time_since_epoch()
-                        )
-                    );
-                    order_book->addOrder(order);
-                } else {
-                    // Update existing order
-                    for (auto& order : existing_orders) {
-                        if (order->getOrderId() == order_id) {
-                            order_book->updateOrderSize(order_id, size);
-                            break;
-                        }
-                    }
+            // Each change is [side, price, size]; a size of 0 removes the level
+            bool ok = forEachRow(m.changes, [&](const JsonRow& change) {
+                if (change.size() < 3) {
+                    throw std::runtime_error("L2 change has fewer than 3 fields");
                 }
+                LevelUpdate update;
+                update.side = coinbaseSide(change[0]);
+                update.price = parseScaled(change[1], scale.price_decimals);
+                update.size = parseScaled(change[2], scale.size_decimals);
+                shard.batch.push_back(update);
+            });
+            if (!ok) {
+                throw std::runtime_error("Malformed changes");
             }
-        }
 
-        if (verbose_logging_) {
-            std::cout << "Processed L2 update with " << j["changes"].size() << " changes" << std::endl;
+            // Apply the change set in one lock acquisition and one notification
+            book.applyUpdates(shard.batch.data(), shard.batch.size());
+
+            if (verbose_logging_) {
+                std::cout << "Processed L2 update with " << shard.batch.size() << " changes" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing L2 update: " << e.what() << std::endl;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error processing L2 update: " << e.what() << std::endl;
-    }
+    });
 }
 
 } // namespace clunk
\ No newline at end of file
@@ -1,22 +1,54 @@
 #pragma once
 
 #include "feed_handler.h"
+#include "book_shards.h"
+#include "book_checkpoint.h"
+#include "capture_log.h"
+#include "coinbase_decoder.h"
+#include "sequence_tracker.h"
+#include "network/connection_routes.h"
 #include "network/websocket_client.h"
+#include "orderbook/level_book.h"
 #include "orderbook/order_book.h"
-#include <nlohmann/json.hpp>
+#include "utils/background_writer.h"
+#include "utils/published.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <map>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace clunk {
 
-// Handler for Coinbase's L3 market data feed
+// How the handler models each product's book
+enum class BookMode : uint8_t {
+    LEVELS,     // Aggregated LevelBook: L2 channel, one size per price
+    ORDERS      // Order-level OrderBook: required for L3 messages
+};
+
+// Handler for Coinbase's market data feed
+//
+// LEVELS books follow the level2 channel, which carries no sequence
+// numbers and sends a snapshot with every new subscription. ORDERS books
+// follow the sequenced full channel: its messages are held until the
+// book has a base to apply them to (a checkpoint, or a level-3 snapshot
+// fetched over REST once the first one arrives), and a jump in sequence
+// numbers fetches a fresh snapshot.
+//
+// Connections recover on their own (see ReconnectPolicy): each restored
+// session re-subscribes its products. LEVELS books are rebuilt from the
+// snapshots the new subscriptions deliver; ORDERS books see a gap and
+// fetch one.
 class CoinbaseHandler : public FeedHandler {
 public:
     // Constructor
-    CoinbaseHandler();
+    explicit CoinbaseHandler(BookMode mode = BookMode::LEVELS);
 
     // Destructor
     ~CoinbaseHandler() override;
@@ -27,21 +59,142 @@ public:
     // Disconnect from the feed
     void disconnect() override;
 
-    // Subscribe to a symbol
+    // Start the shard workers without connecting, to handle injected
+    // messages only (connect() does this too)
+    void startWorkers();
+
+    // Subscribe to a symbol (kept across reconnects; before connect() it is
+    // sent once the connection is up)
     void subscribe(const std::string& symbol) override;
 
     // Unsubscribe from a symbol
     void unsubscribe(const std::string& symbol) override;
 
-    // Check if connected
+    // Check if connected (at least one connection is up)
     bool isConnected() const override;
 
+    // Spread subscriptions over `connections` WebSocket connections, each
+    // with its own I/O thread and TLS session, and subscribe every product
+    // on `redundancy` of them. Sequenced messages are taken from whichever
+    // copy arrives first and later copies are dropped as stale. Unsequenced
+    // ones (level2) come from the product's first live connection, so a
+    // stalled or lost connection fails over to the next. Call before
+    // enablePipeline(), enableSharding() and connect().
+    void enableConnectionPool(size_t connections, size_t redundancy = 1);
+
+    // Number of connections, and how many are currently up
+    size_t getConnectionCount() const { return connections_.size(); }
+    size_t getConnectedCount() const;
+
+    // Connections a symbol is subscribed on, in failover order (empty if
+    // it is not subscribed)
+    std::vector<size_t> getRoute(const std::string& symbol) const;
+
     // Enable/disable verbose logging
     void setVerboseLogging(bool enabled);
 
-    // Get an order book for a symbol
+    // Reconnect and heartbeat settings for every connection (call before
+    // connect(), and after enableConnectionPool())
+    void setReconnectPolicy(const ReconnectPolicy& policy);
+
+    // Reconnect attempts made, summed over the connections
+    uint64_t getReconnectCount() const;
+
+    // Pin connection i's I/O thread to io_cpus[i] if given and
+    // non-negative, and busy-poll the sockets instead of blocking (see
+    // WebSocketClient::setBusyPoll). Kept across enableConnectionPool();
+    // call before connect().
+    void setIoThreads(const std::vector<int>& io_cpus, bool busy_poll = false);
+
+    // Set the resync callback (call before connect())
+    void setResyncCallback(ResyncCallback callback) { resync_callback_ = std::move(callback); }
+
+    // Set the trade callback (call before connect()). In ORDERS mode trades
+    // come from match messages; in LEVELS mode, which has none, from the
+    // last trade each ticker carries (Coinbase batches tickers during
+    // bursts, so this can undercount).
+    void setTradeCallback(TradeCallback callback) { trade_callback_ = std::move(callback); }
+
+    // Parse and apply messages on a dedicated worker thread fed by a
+    // lock-free ring from the I/O thread (see WebSocketClient::enablePipeline)
+    void enablePipeline(size_t capacity, int worker_cpu = -1);
+
+    // Pipeline queue depth and back-pressure counters, summed over the
+    // connections (max_depth is the deepest of any)
+    PipelineStats getPipelineStats() const;
+
+    // Parse and apply messages on `shard_count` worker threads instead,
+    // each owning the books of the products routed to it, so books of
+    // different products never share a thread or a lock. Shard i's worker
+    // is pinned to worker_cpus[i] if given. With `local_memory`, each
+    // pinned shard's books are allocated on its worker's NUMA node, and the
+    // worker prefers that node for everything the books grow into. Call
+    // before connect() and subscribe().
+    void enableSharding(size_t shard_count, size_t capacity, const std::vector<int>& worker_cpus = {},
+                        bool local_memory = false);
+
+    // Per-shard queue counters and product counts (empty when not sharded)
+    std::vector<ShardStats> getShardStats() const;
+
+    // Latency percentiles of each stage, merged over the connections and
+    // shards (see FeedHandler)
+    std::vector<LatencySummary> getLatencyStats() const override;
+
+    // Append every message the handler applies to a capture file at `path`,
+    // stamped with its receive time and connection, for replay with
+    // ReplayFeedHandler. Only the copy chosen from redundant connections is
+    // recorded. Throws std::runtime_error if the file cannot be created.
+    // Call before connect().
+    void enableCapture(const std::string& path);
+
+    // Messages captured so far (0 when capture is off)
+    uint64_t getCapturedCount() const { return capture_ ? capture_->getRecordCount() : 0; }
+
+    // Save each product's book to `directory` every `interval` (0: only on
+    // saveCheckpoints()), and start newly subscribed products from the
+    // checkpoints found there. An ORDERS book restored at sequence N stays
+    // unready and holds updates like any syncing book; once the first
+    // held update arrives it replays those after N and goes live without
+    // waiting for a snapshot, unless some were missed (it then fetches
+    // one). LEVELS checkpoints
+    // carry no sequence (level2 has none), so they only give a readable
+    // book until the snapshot lands. Call before subscribe() and connect().
+    void enableCheckpoints(const std::string& directory, std::chrono::seconds interval);
+
+    // Save every ready book's checkpoint now and wait for the writes;
+    // returns how many were saved. Call after disconnect(), so no feed
+    // thread is applying updates.
+    size_t saveCheckpoints();
+
+    // Checkpoints written so far, and writes that failed
+    uint64_t getCheckpointCount() const { return checkpoints_ ? checkpoints_->getWrittenCount() : 0; }
+    uint64_t getCheckpointFailures() const { return checkpoints_ ? checkpoints_->getFailedCount() : 0; }
+
+    // Whether a symbol's book has been built from a snapshot or a caught-up
+    // checkpoint (it stays ready through later resyncs)
+    bool isBookReady(const std::string& symbol) const;
+
+    // Block until every symbol's book is ready or `timeout` passes; returns
+    // whether they all are
+    bool waitForBooks(const std::vector<std::string>& symbols, std::chrono::milliseconds timeout) override;
+
+    // Handle a message as if it had arrived on `connection` (replay and
+    // testing; call from one thread, as an I/O thread would). Its latency
+    // is timed from this call.
+    void injectMessage(std::string_view message, size_t connection = 0);
+
+    // Book model used for newly subscribed products
+    BookMode getBookMode() const { return book_mode_; }
+
+    // Get the order-level book for a symbol (null in LEVELS mode)
     std::shared_ptr<OrderBook> getOrderBook(const std::string& symbol);
 
+    // Get the aggregated book for a symbol (null in ORDERS mode)
+    std::shared_ptr<LevelBook> getLevelBook(const std::string& symbol);
+
+    // Get whichever book a symbol has, for display and analytics
+    std::shared_ptr<BookView> getBookView(const std::string& symbol) override;
+
 private:
     // Coinbase API details - Using public WebSocket feed
     // The wss:// prefix is handled by the WebSocket client
@@ -49,29 +202,196 @@ private:
     static constexpr const char* kPort = "443";
     static constexpr const char* kPath = "/ws";
 
-    // Websocket client
-    std::shared_ptr<WebSocketClient> ws_client_;
+    // REST API, for the level-3 snapshots the full channel does not send
+    static constexpr const char* kRestHost = "api.exchange.coinbase.com";
+
+    // How long a snapshot fetch may be outstanding before it is retried
+    static constexpr uint64_t kSnapshotRetryNs = 15000000000ULL;
+
+    // Websocket clients, one per pooled connection
+    std::vector<std::shared_ptr<WebSocketClient>> connections_;
+
+    // I/O thread placement applied to every connection
+    std::vector<int> io_cpus_;
+    bool busy_poll_ = false;
+
+    // Connections each product is subscribed on (first live one is primary)
+    ConnectionRoutes routes_;
+    mutable std::mutex routes_mutex_;
+    bool redundant_ = false;        // Products have more than one copy
+
+    // What the feed threads need to pick a product's copy: its route, and
+    // the last sequence accepted from any connection for book messages,
+    // tickers and heartbeats (raised without a lock as copies arrive)
+    struct ProductCopies {
+        std::vector<size_t> route;
+        std::array<std::atomic<uint64_t>, 3> sequences{};
+    };
+    using CopyTable = std::map<std::string, std::shared_ptr<ProductCopies>, std::less<>>;
+
+    // Each product's copies, republished from routes_ under routes_mutex_
+    // as products come and go, and read by the feed threads without it
+    Published<CopyTable> copies_;
+
+    // Consecutive tickers that disagree with the book before it is resynced
+    // (the ticker and level2 channels are not exactly interleaved, so a
+    // single mismatch is expected now and then)
+    static constexpr uint32_t kTickerMismatchLimit = 3;
 
-    // Order books by symbol
-    std::unordered_map<std::string, std::shared_ptr<OrderBook>> order_books_;
+    // Feed-thread state of one product's book
+    struct ProductSync {
+        SequenceTracker sequence;
+        uint32_t ticker_mismatches = 0;
+        uint64_t last_ticker_trade = 0;     // Sequence of the last reported ticker trade
+        uint64_t checkpoint_sequence = 0;   // Restored checkpoint awaiting catch-up (0: none)
+        uint64_t snapshot_fetched_ns = 0;   // When a REST snapshot was last asked for (0: none pending)
+        uint64_t next_checkpoint_ns = 0;    // When the book is next due for a checkpoint
+        uint32_t checkpoint_countdown = 0;  // Updates until the clock is next checked
+        std::atomic<bool> ready{false};     // Built once; read by waitForBooks()
+    };
 
-    // Mutex for protecting order books
-    std::mutex mutex_;
+    // Each product has exactly one of the two books, per book_mode_
+    struct ProductBooks {
+        std::shared_ptr<OrderBook> orders;
+        std::shared_ptr<LevelBook> levels;
+        std::shared_ptr<ProductSync> sync;
+    };
+
+    // The books of the products handled on one thread
+    struct Shard {
+        // Books by symbol
+        std::unordered_map<std::string, ProductBooks> books;
+
+        // Mutex for protecting the book map
+        std::mutex mutex;
+
+        // Reusable buffer for building batched book updates (a shard's
+        // messages are handled on one thread at a time)
+        std::vector<LevelUpdate> batch;
+
+        // Serializes handling when several connections feed the shard
+        // directly rather than through a ShardedPipeline
+        std::mutex feed_mutex;
+
+        // Handoff, parse and apply latency of the shard's messages
+        StageLatency latency;
+    };
+
+    // Book model for new subscriptions
+    BookMode book_mode_;
+
+    // Books by shard: one shard, or one per worker once sharding is enabled
+    BookShards<Shard> shards_;
 
     // Verbose logging flag
     bool verbose_logging_;
 
-    // Handle a message from the feed
-    void handleMessage(const std::string& message);
+    // Notified when a book needs a resync
+    ResyncCallback resync_callback_;
+
+    // Notified of every trade
+    TradeCallback trade_callback_;
+
+    // Capture of the applied messages (null when off)
+    std::unique_ptr<CaptureWriter> capture_;
+
+    // Updates between clock reads for the checkpoint interval
+    static constexpr uint32_t kCheckpointCheckInterval = 256;
+
+    // Background checkpoint writes (null when off) and their interval
+    std::unique_ptr<CheckpointWriter> checkpoints_;
+    uint64_t checkpoint_interval_ns_ = 0;
+
+    // Fetches ORDERS books' snapshots, off the feed threads (null in
+    // LEVELS mode). Declared last: its thread hands snapshots to the shards.
+    std::unique_ptr<BackgroundWriter<std::vector<std::string>>> snapshot_fetches_;
+
+    // Channels a product is subscribed to, and the one its book follows
+    std::vector<std::string> channels() const;
+    const char* bookChannel() const { return book_mode_ == BookMode::ORDERS ? "full" : "level2"; }
+
+    // Whether messages reach the shards from more than one thread
+    bool sharedFeed() const { return connections_.size() > 1 || snapshot_fetches_ != nullptr; }
+
+    // Create a connection whose messages are tagged with `index`
+    std::shared_ptr<WebSocketClient> makeConnection(size_t index);
+
+    // Send to every connection a product is subscribed on
+    void sendToProduct(const std::string& symbol, const std::string& message);
+
+    // Re-subscribe a connection's products once its session is up
+    void onConnected(size_t connection, bool reconnected);
+
+    // Hand a message from connection `connection` to its shard, unless
+    // another connection's copy got there first
+    void dispatchMessage(size_t connection, std::string_view message, const MessageTiming& timing);
+
+    // Capture a message and hand it to its shard
+    void deliverMessage(size_t connection, std::string_view message, const MessageTiming& timing);
+
+    // Whether a message from `connection` is the copy to apply (records a
+    // sequenced one as seen)
+    bool acceptCopy(size_t connection, std::string_view message);
+
+    // First live connection of a product's route (the first one if none is)
+    size_t primaryConnection(const std::vector<size_t>& route) const;
+
+    // A product's copies as this thread last saw them (null if it is not
+    // subscribed); valid until the thread's next lookup
+    ProductCopies* findCopies(std::string_view symbol) const;
+
+    // Add or drop a product's copies (under routes_mutex_)
+    void publishCopies(const std::string& symbol, bool subscribed);
+
+    // Handle a message on its shard's thread
+    void handleMessage(Shard& shard, std::string_view message, const MessageTiming& timing);
+
+    // Sequence-check a snapshot or incremental update and apply, hold or
+    // drop it
+    void processBookMessage(const CoinbaseMessage& message, Shard& shard);
+
+    // Apply an incremental update that passed the sequence check
+    void applyBookUpdate(const CoinbaseMessage& message, const ProductBooks& books, Shard& shard);
+
+    // Hold the product's updates until a fresh snapshot arrives, asking for
+    // one: LEVELS books re-subscribe to level2, ORDERS books fetch it
+    void requestSnapshot(const std::string& symbol, ProductSync& sync, ResyncReason reason);
+
+    // Queue a REST snapshot of a syncing ORDERS book, unless one is already
+    // on its way or the product's connection is down
+    void fetchSnapshot(const std::string& symbol, ProductSync& sync);
+
+    // Fetch each symbol's level-3 book and hand it to its shard as a
+    // snapshot message (on the fetch thread)
+    void fetchSnapshots(const std::vector<std::string>& symbols);
 
     // Process different message types
-    void processSnapshot(const nlohmann::json& json);
-    void processL3Update(const nlohmann::json& json);
-    void processTicker(const nlohmann::json& json);
-    void processL2Update(const nlohmann::json& json);
+    bool processSnapshot(const CoinbaseMessage& message, const ProductBooks& books, Shard& shard);
+    void processL3Update(const CoinbaseMessage& message, const ProductBooks& books);
+    void processTicker(const CoinbaseMessage& message, Shard& shard);
+    void processL2Update(const CoinbaseMessage& message, const ProductBooks& books, Shard& shard);
+
+    // Call `apply(book)` with the product's book, whichever type it is;
+    // returns false if it has none
+    template <typename Apply>
+    static bool withBook(const ProductBooks& books, Apply&& apply);
+
+    // Load a product's book from its checkpoint, if one matches the book
+    void restoreCheckpoint(const std::string& symbol, const ProductBooks& books);
+
+    // Replay the updates held since the restored checkpoint, going live if
+    // none are missing (tried once, on the first held update)
+    void catchUpCheckpoint(const std::string& symbol, const ProductBooks& books, Shard& shard);
+
+    // Copy a product's book into a checkpoint
+    static BookCheckpoint captureCheckpoint(const std::string& symbol, const ProductBooks& books);
+
+    // Checkpoint a live book once its interval has passed
+    void checkpointIfDue(const std::string& symbol, const ProductBooks& books);
 
-    // Convert Coinbase order side to internal order side
-    OrderSide convertOrderSide(const std::string& side);
+    // Report a ticker's last trade, once per sequence (copies from redundant
+    // connections share it)
+    void reportTickerTrade(const CoinbaseMessage& message, const ProductBooks& books);
 };
 
 } // namespace clunk
\ No newline at end of file
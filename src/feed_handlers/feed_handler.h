@@ -1,12 +1,42 @@
 #pragma once
 
+#include "network/pipeline_latency.h"
+#include "orderbook/book_view.h"
+#include "orderbook/order.h"
+#include <chrono>
 #include <string>
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace clunk {
 
+// One trade reported by a venue, in the product's ticks and lots
+struct Trade {
+    OrderSide maker_side = OrderSide::BUY;  // Side of the resting order that filled
+    Price price = 0;
+    Quantity size = 0;
+};
+
+// Why a product's book is being rebuilt from a fresh snapshot
+enum class ResyncReason : uint8_t {
+    SEQUENCE_GAP,   // Messages were missed
+    VALIDATION,     // The book kept disagreeing with the venue's top of book
+    RECONNECT       // Its connection dropped and was restored
+};
+
+// Callback run on a feed thread when a product's book needs a resync; the
+// book stays readable meanwhile but is stale until its snapshot arrives
+using ResyncCallback = std::function<void(const std::string& symbol, ResyncReason reason)>;
+
+// Callback run on a feed thread for every trade on a product, before the
+// book applies it
+using TradeCallback = std::function<void(const std::string& symbol, const Trade& trade)>;
+
 // Abstract base class for feed handlers
+//
+// Every handler keeps one book per subscribed symbol, so display, shared
+// memory publication and analytics work the same whichever venue feeds it.
 class FeedHandler {
 public:
     // Constructor
@@ -29,6 +59,17 @@ public:
 
     // Check if connected
     virtual bool isConnected() const = 0;
+
+    // Get a symbol's book (null if it is not subscribed)
+    virtual std::shared_ptr<BookView> getBookView(const std::string& symbol) = 0;
+
+    // Block until every symbol's book has been built or `timeout` passes;
+    // returns whether they all have
+    virtual bool waitForBooks(const std::vector<std::string>& symbols, std::chrono::milliseconds timeout) = 0;
+
+    // Latency percentiles of each stage from socket read to book publish
+    // (stages with no samples are left out)
+    virtual std::vector<LatencySummary> getLatencyStats() const = 0;
 };
 
 } // namespace clunk
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "kraken_decoder.h"
+#include "utils/json_utils.h"
+#include <nlohmann/json.hpp>
+
+namespace clunk {
+
+using json = nlohmann::json;
+
+namespace {
+
+// Read a string value, treating anything else (e.g. null) as absent
+bool readOptionalString(JsonScanner& scanner, std::string_view& out) {
+    return scanner.peek() == JsonType::STRING ? scanner.readString(out) : scanner.skipValue();
+}
+
+// Append each {"price": ..., "qty": ...} entry of a raw levels array
+bool addLevels(std::string_view array, OrderSide side, BookEvent& event) {
+    if (array.data() == nullptr) {
+        return true;
+    }
+
+    JsonScanner scanner(array);
+    if (!scanner.beginArray()) {
+        return false;
+    }
+    while (scanner.nextElement()) {
+        LevelText level;
+        level.side = side;
+        if (!scanner.beginObject()) {
+            return false;
+        }
+        std::string_view key;
+        while (scanner.nextKey(key)) {
+            bool ok = key == "price" ? scanner.readScalar(level.price)
+                    : key == "qty" ? scanner.readScalar(level.size)
+                    : scanner.skipValue();
+            if (!ok) {
+                return false;
+            }
+        }
+        if (scanner.failed() || level.price.data() == nullptr || level.size.data() == nullptr) {
+            return false;
+        }
+        event.levels.push_back(level);
+    }
+    return !scanner.failed();
+}
+
+// Add the event of one "book" data entry
+bool addBook(JsonScanner& scanner, BookEventType type, BookEvents& out) {
+    std::string_view symbol;
+    std::string_view bids;
+    std::string_view asks;
+    std::string_view key;
+    while (scanner.nextKey(key)) {
+        bool ok = key == "symbol" ? readOptionalString(scanner, symbol)
+                : key == "bids" ? scanner.readRaw(bids)
+                : key == "asks" ? scanner.readRaw(asks)
+                : scanner.skipValue();
+        if (!ok) {
+            return false;
+        }
+    }
+    if (scanner.failed() || symbol.empty()) {
+        return false;
+    }
+
+    // Bids first, so a snapshot arrives in the order loadSnapshot() takes
+    BookEvent& event = out.add(type, symbol);
+    return addLevels(bids, OrderSide::BUY, event) && addLevels(asks, OrderSide::SELL, event);
+}
+
+// Add the event of one "trade" data entry
+bool addTrade(JsonScanner& scanner, BookEvents& out) {
+    std::string_view symbol;
+    std::string_view side;
+    std::string_view price;
+    std::string_view size;
+    std::string_view key;
+    while (scanner.nextKey(key)) {
+        bool ok = key == "symbol" ? readOptionalString(scanner, symbol)
+                : key == "side" ? readOptionalString(scanner, side)
+                : key == "price" ? scanner.readScalar(price)
+                : key == "qty" ? scanner.readScalar(size)
+                : scanner.skipValue();
+        if (!ok) {
+            return false;
+        }
+    }
+    if (scanner.failed() || symbol.empty() || price.data() == nullptr || size.data() == nullptr) {
+        return false;
+    }
+
+    // The side is the taker's; the resting order was on the other one
+    BookEvent& event = out.add(BookEventType::TRADE, symbol);
+    event.maker_side = !side.empty() && side[0] == 'b' ? OrderSide::SELL : OrderSide::BUY;
+    event.price = price;
+    event.size = size;
+    return true;
+}
+
+} // namespace
+
+std::string KrakenDecoder::request(const char* method, const char* channel, const std::string& symbol) const {
+    json params = {
+        {"channel", channel},
+        {"symbol", json::array({symbol})}
+    };
+    if (std::string_view(channel) == "book") {
+        params["depth"] = depth_;
+    }
+    json message = {
+        {"method", method},
+        {"params", params}
+    };
+    return message.dump();
+}
+
+std::vector<std::string> KrakenDecoder::subscribeMessages(const std::string& symbol) const {
+    return {request("subscribe", "book", symbol), request("subscribe", "trade", symbol)};
+}
+
+std::vector<std::string> KrakenDecoder::unsubscribeMessages(const std::string& symbol) const {
+    return {request("unsubscribe", "book", symbol), request("unsubscribe", "trade", symbol)};
+}
+
+std::vector<std::string> KrakenDecoder::resyncMessages(const std::string& symbol) const {
+    // Every book subscription starts with a snapshot
+    return {request("unsubscribe", "book", symbol), request("subscribe", "book", symbol)};
+}
+
+std::string_view KrakenDecoder::peekSymbol(std::string_view text) const {
+    return peekString(text, "\"symbol\"");
+}
+
+bool KrakenDecoder::decode(std::string_view text, BookEvents& out) const {
+    // Keys can come in any order, so the data array is walked once the
+    // channel and type are known
+    std::string_view channel;
+    std::string_view type;
+    std::string_view data;
+    std::string_view success;
+    std::string_view error;
+    std::string_view symbol;
+
+    JsonScanner scanner(text);
+    if (!scanner.beginObject()) {
+        return false;
+    }
+    std::string_view key;
+    while (scanner.nextKey(key)) {
+        bool ok = key == "channel" ? readOptionalString(scanner, channel)
+                : key == "type" ? readOptionalString(scanner, type)
+                : key == "data" ? scanner.readRaw(data)
+                : key == "success" ? scanner.readRaw(success)
+                : key == "error" ? readOptionalString(scanner, error)
+                : key == "symbol" ? readOptionalString(scanner, symbol)
+                : scanner.skipValue();
+        if (!ok) {
+            return false;
+        }
+    }
+    if (scanner.failed() || !scanner.atEnd()) {
+        return false;
+    }
+
+    // Request acknowledgements only matter when they fail
+    if (success == "false") {
+        BookEvent& event = out.add(BookEventType::ERROR, symbol);
+        event.message = error;
+        return true;
+    }
+
+    bool book = channel == "book";
+    if ((!book && channel != "trade") || data.data() == nullptr) {
+        return true;
+    }
+    BookEventType book_type;
+    if (type == "update") {
+        book_type = BookEventType::UPDATE;
+    } else if (type == "snapshot" && book) {
+        book_type = BookEventType::SNAPSHOT;
+    } else {
+        return true;
+    }
+
+    JsonScanner entries(data);
+    if (!entries.beginArray()) {
+        return false;
+    }
+    while (entries.nextElement()) {
+        if (!entries.beginObject()) {
+            return false;
+        }
+        if (!(book ? addBook(entries, book_type, out) : addTrade(entries, out))) {
+            return false;
+        }
+    }
+    return !entries.failed();
+}
+
+} // namespace clunk
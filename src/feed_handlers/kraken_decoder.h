@@ -0,0 +1,49 @@
+#pragma once
+
+#include "venue_decoder.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clunk {
+
+// Decoder for Kraken's v2 WebSocket API: the "book" channel (a snapshot on
+// subscription, then level updates) and the "trade" channel
+//
+// Symbols are Kraken's, e.g. "BTC/USD". Book messages carry no sequence
+// numbers, so a missed update only shows up as the connection dropping;
+// the restored session's snapshots rebuild the books. The per-update CRC32
+// checksum needs the venue's exact decimal rendering of each level and is
+// not verified.
+class KrakenDecoder : public VenueDecoder {
+public:
+    static constexpr size_t kDefaultDepth = 100;
+
+    // Subscribe to `depth` levels per side (10, 25, 100, 500 or 1000)
+    explicit KrakenDecoder(size_t depth = kDefaultDepth) : depth_(depth) {}
+
+    // Venue details (see VenueDecoder)
+    const char* getName() const override { return "Kraken"; }
+    VenueEndpoint getEndpoint() const override { return VenueEndpoint{"ws.kraken.com", "443", "/v2"}; }
+    size_t getBookDepth() const override { return depth_; }
+
+    // Book and trade channel requests (see VenueDecoder); a resync
+    // re-subscribes the book alone
+    std::vector<std::string> subscribeMessages(const std::string& symbol) const override;
+    std::vector<std::string> unsubscribeMessages(const std::string& symbol) const override;
+    std::vector<std::string> resyncMessages(const std::string& symbol) const override;
+
+    // Book snapshots and updates, live trades (the recent trades replayed
+    // on subscription are skipped) and rejected requests
+    std::string_view peekSymbol(std::string_view text) const override;
+    bool decode(std::string_view text, BookEvents& out) const override;
+
+private:
+    size_t depth_;
+
+    // A subscribe or unsubscribe request for one channel
+    std::string request(const char* method, const char* channel, const std::string& symbol) const;
+};
+
+} // namespace clunk
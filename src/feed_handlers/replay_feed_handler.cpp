@@ -0,0 +1,154 @@
+#include "replay_feed_handler.h"
+#include "utils/thread_utils.h"
+#include <iostream>
+
+namespace clunk {
+
+ReplayFeedHandler::ReplayFeedHandler(const std::string& path, BookMode mode)
+    : reader_(path), handler_(mode) {
+}
+
+ReplayFeedHandler::~ReplayFeedHandler() {
+    disconnect();
+}
+
+void ReplayFeedHandler::connect() {
+    if (thread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stop_ = false;
+    }
+    reader_.rewind();
+    messages_.store(0, std::memory_order_relaxed);
+    bytes_.store(0, std::memory_order_relaxed);
+    elapsed_ns_.store(0, std::memory_order_relaxed);
+    finished_.store(false, std::memory_order_relaxed);
+
+    handler_.startWorkers();
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this]() { run(); });
+}
+
+void ReplayFeedHandler::disconnect() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    finish();
+}
+
+void ReplayFeedHandler::wait() {
+    finish();
+}
+
+void ReplayFeedHandler::finish() {
+    if (thread_.joinable()) {
+        thread_.join();
+        handler_.disconnect();
+    }
+}
+
+void ReplayFeedHandler::subscribe(const std::string& symbol) {
+    handler_.subscribe(symbol);
+}
+
+void ReplayFeedHandler::unsubscribe(const std::string& symbol) {
+    handler_.unsubscribe(symbol);
+}
+
+std::shared_ptr<SimulatedExecution> ReplayFeedHandler::simulate(const std::string& symbol, size_t sweep_depth) {
+    std::shared_ptr<SimulatedExecution>& simulation = simulations_[symbol];
+    if (simulation) {
+        return simulation;
+    }
+
+    // Route trades on the first simulation
+    if (simulations_.size() == 1) {
+        handler_.setTradeCallback([this](const std::string& product, const Trade& trade) {
+            auto it = simulations_.find(product);
+            if (it != simulations_.end()) {
+                it->second->onTrade(trade);
+            }
+        });
+    }
+
+    handler_.subscribe(symbol);
+    simulation = std::make_shared<SimulatedExecution>(handler_.getBookView(symbol), sweep_depth);
+    return simulation;
+}
+
+ReplayStats ReplayFeedHandler::getStats() const {
+    ReplayStats stats;
+    stats.messages = messages_.load(std::memory_order_relaxed);
+    stats.bytes = bytes_.load(std::memory_order_relaxed);
+    stats.elapsed = std::chrono::nanoseconds(elapsed_ns_.load(std::memory_order_relaxed));
+    stats.finished = finished_.load(std::memory_order_acquire);
+    stats.truncated = stats.finished && reader_.truncated();
+    return stats;
+}
+
+void ReplayFeedHandler::run() {
+    using Clock = std::chrono::steady_clock;
+
+    if (replay_cpu_ >= 0 && !pinCurrentThread(replay_cpu_)) {
+        std::cerr << "Could not pin replay thread to CPU " << replay_cpu_ << std::endl;
+    }
+
+    const Clock::time_point start = Clock::now();
+    uint64_t first_ns = 0;
+    bool first = true;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+
+    auto publish = [&]() {
+        messages_.store(messages, std::memory_order_relaxed);
+        bytes_.store(bytes, std::memory_order_relaxed);
+        elapsed_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(),
+                          std::memory_order_relaxed);
+    };
+
+    CaptureRecord record;
+    while (reader_.next(record)) {
+        if (speed_ > 0.0) {
+            if (first) {
+                first_ns = record.receive_ns;
+                first = false;
+            }
+
+            // Keep the recorded spacing from the first record
+            auto offset = std::chrono::nanoseconds(static_cast<int64_t>(
+                static_cast<double>(record.receive_ns - first_ns) / speed_));
+            std::unique_lock<std::mutex> lock(stop_mutex_);
+            if (stop_cv_.wait_until(lock, start + offset, [this]() { return stop_; })) {
+                break;
+            }
+        } else if (messages % 1024 == 0) {
+            std::lock_guard<std::mutex> lock(stop_mutex_);
+            if (stop_) {
+                break;
+            }
+        }
+
+        handler_.injectMessage(record.payload);
+        ++messages;
+        bytes += record.payload.size();
+
+        // Publish progress now and then rather than per record
+        if (messages % 1024 == 0) {
+            publish();
+        }
+    }
+
+    publish();
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        finished_.store(!stop_, std::memory_order_release);
+    }
+    running_.store(false, std::memory_order_release);
+}
+
+} // namespace clunk
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "feed_handler.h"
+#include "capture_log.h"
+#include "coinbase_handler.h"
+#include "backtest/simulated_execution.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace clunk {
+
+// Progress of a replay
+struct ReplayStats {
+    uint64_t messages = 0;          // Records fed to the books
+    uint64_t bytes = 0;             // Payload bytes fed
+    std::chrono::nanoseconds elapsed{0};
+    bool finished = false;          // Reached the end of the capture
+    bool truncated = false;         // The capture ends partway through a record
+
+    // Records fed per second of replay
+    double messagesPerSecond() const {
+        return elapsed.count() > 0 ? static_cast<double>(messages) * 1e9 / static_cast<double>(elapsed.count()) : 0.0;
+    }
+};
+
+// Feed handler that replays a capture file instead of connecting to a venue
+//
+// Records are read from a memory mapping and handed to a CoinbaseHandler
+// that never connects, so books are built by exactly the code that builds
+// them live: decoding, sequence checks, resync requests (which go nowhere)
+// and sharding. At speed 0 records are fed back to back, which makes a
+// replay of a real session a throughput benchmark; at speed 1 they keep
+// their recorded spacing, to reproduce a session's timing.
+class ReplayFeedHandler : public FeedHandler {
+public:
+    // Open the capture at `path`; throws std::runtime_error if it cannot be
+    // read (see CaptureReader)
+    explicit ReplayFeedHandler(const std::string& path, BookMode mode = BookMode::LEVELS);
+
+    // Destructor
+    ~ReplayFeedHandler() override;
+
+    // Start replaying on a background thread
+    void connect() override;
+
+    // Stop replaying and let queued messages drain into the books
+    void disconnect() override;
+
+    // Build a book for a symbol; messages for other products are ignored
+    // (call before connect())
+    void subscribe(const std::string& symbol) override;
+
+    // Drop a symbol's book
+    void unsubscribe(const std::string& symbol) override;
+
+    // Check if the replay is still running
+    bool isConnected() const override { return running_.load(std::memory_order_acquire); }
+
+    // Books, readiness and latency of the handler the records are fed to
+    std::shared_ptr<BookView> getBookView(const std::string& symbol) override { return handler_.getBookView(symbol); }
+    bool waitForBooks(const std::vector<std::string>& symbols, std::chrono::milliseconds timeout) override {
+        return handler_.waitForBooks(symbols, timeout);
+    }
+    std::vector<LatencySummary> getLatencyStats() const override { return handler_.getLatencyStats(); }
+
+    // Replay speed relative to the recording: 0 (the default) feeds records
+    // as fast as possible, 1 at the recorded pace, 2 twice as fast. Call
+    // before connect().
+    void setSpeed(double speed) { speed_ = speed; }
+
+    // Pin the replay thread, which stands in for the I/O thread, to `cpu`
+    // (< 0: leave it floating). Call before connect().
+    void setReplayCpu(int cpu) { replay_cpu_ = cpu; }
+
+    // Simulate orders against a symbol's replayed book, subscribing to it
+    // if needed (call before connect()). The venue's trades are fed to the
+    // simulation on the replay thread, where its trade callback runs.
+    std::shared_ptr<SimulatedExecution> simulate(const std::string& symbol,
+                                                 size_t sweep_depth = SimulatedExecution::kDefaultSweepDepth);
+
+    // Block until the whole capture has been fed, then drain as disconnect()
+    void wait();
+
+    // Replay progress
+    ReplayStats getStats() const;
+
+    // The handler the records are fed to, to enable sharding, set callbacks
+    // and read books
+    CoinbaseHandler& getHandler() { return handler_; }
+
+private:
+    CaptureReader reader_;
+    CoinbaseHandler handler_;
+    double speed_ = 0.0;
+    int replay_cpu_ = -1;
+
+    // Simulations by symbol, fixed once replaying
+    std::unordered_map<std::string, std::shared_ptr<SimulatedExecution>> simulations_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> finished_{false};
+
+    // Wakes a paced replay early on disconnect()
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stop_ = false;
+
+    // Progress, written by the replay thread
+    std::atomic<uint64_t> messages_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<int64_t> elapsed_ns_{0};
+
+    // Replay thread body
+    void run();
+
+    // Join the replay thread and drain the handler
+    void finish();
+};
+
+} // namespace clunk
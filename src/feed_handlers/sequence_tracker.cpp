@@ -0,0 +1,60 @@
+#include "sequence_tracker.h"
+
+namespace clunk {
+
+SequenceTracker::SequenceTracker(size_t max_pending) : max_pending_(max_pending) {}
+
+SequenceCheck SequenceTracker::check(uint64_t sequence, std::string_view text) {
+    if (syncing_) {
+        hold(sequence, text);
+        return SequenceCheck::BUFFERED;
+    }
+
+    if (has_baseline_) {
+        if (sequence <= last_sequence_) {
+            ++stats_.stale;
+            return SequenceCheck::STALE;
+        }
+        if (sequence != last_sequence_ + 1) {
+            recordGap(sequence);
+            syncing_ = true;
+            hold(sequence, text);
+            return SequenceCheck::GAP;
+        }
+    }
+
+    has_baseline_ = true;
+    last_sequence_ = sequence;
+    return SequenceCheck::APPLY;
+}
+
+SequenceCheck SequenceTracker::checkUnsequenced() {
+    if (syncing_) {
+        ++stats_.stale;
+        return SequenceCheck::STALE;
+    }
+    return SequenceCheck::APPLY;
+}
+
+bool SequenceTracker::beginResync() {
+    if (syncing_) {
+        return false;
+    }
+    syncing_ = true;
+    return true;
+}
+
+void SequenceTracker::hold(uint64_t sequence, std::string_view text) {
+    if (pending_.size() >= max_pending_) {
+        ++stats_.overflows;
+        pending_.clear();
+    }
+    pending_.push_back(Pending{sequence, std::string(text)});
+}
+
+void SequenceTracker::recordGap(uint64_t sequence) {
+    ++stats_.gaps;
+    stats_.missed += sequence - last_sequence_ - 1;
+}
+
+} // namespace clunk
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clunk {
+
+// What to do with a message once its sequence number has been checked
+enum class SequenceCheck : uint8_t {
+    APPLY,      // Next in sequence (or the first seen): apply it
+    STALE,      // Already reflected in the book: drop it
+    BUFFERED,   // A snapshot is pending: held for replay
+    GAP         // Messages were missed: held, and a snapshot is needed
+};
+
+// Gap and resync counters for one product
+struct SequenceStats {
+    uint64_t gaps = 0;          // Gaps detected
+    uint64_t missed = 0;        // Sequence numbers skipped over by gaps
+    uint64_t stale = 0;         // Duplicate or out-of-date messages dropped
+    uint64_t replayed = 0;      // Buffered messages applied after a snapshot
+    uint64_t overflows = 0;     // Times the buffer filled and was discarded
+};
+
+// Per-product sequence tracking for an incremental feed
+//
+// The tracker starts out syncing. Until the first snapshot, messages are
+// copied into a buffer instead of being applied. Once live, each message
+// must carry the next sequence number: older ones are dropped, and a jump
+// is a gap, which puts the tracker back into syncing until the handler
+// delivers a fresh snapshot. onSnapshot() then replays the buffered
+// messages that postdate the snapshot, so the book catches up in place
+// rather than being cleared and rebuilt.
+//
+// Not thread-safe: drive it from the thread that applies the messages.
+class SequenceTracker {
+public:
+    static constexpr size_t kDefaultMaxPending = 65536;
+
+    // Constructor; past `max_pending` held messages the buffer is discarded
+    // (the replay will then hit a gap and ask for another snapshot)
+    explicit SequenceTracker(size_t max_pending = kDefaultMaxPending);
+
+    // Check a message carrying `sequence`. `text` is copied if it is held.
+    SequenceCheck check(uint64_t sequence, std::string_view text);
+
+    // Check a message without a sequence number: APPLY when live, STALE
+    // while syncing, since the pending snapshot supersedes it
+    SequenceCheck checkUnsequenced();
+
+    // Stop applying messages until the next snapshot (e.g. the book failed
+    // validation). Returns false if already syncing.
+    bool beginResync();
+
+    // A snapshot was applied. `sequence` is the last message it reflects,
+    // or 0 if the feed does not say. In that case the buffered messages
+    // are treated as older than the snapshot and discarded, and the next
+    // sequenced message sets the baseline.
+    //
+    // Buffered messages after `sequence` are passed to `replay(text)` in
+    // order. Returns false if they skip a sequence number. The tracker is
+    // then syncing again, keeping the messages from the gap on, and needs
+    // another snapshot.
+    template <typename Replay>
+    bool onSnapshot(uint64_t sequence, Replay&& replay);
+
+    // Whether messages are being held for a snapshot
+    bool isSyncing() const { return syncing_; }
+
+    // Last applied sequence number (0 before the first one)
+    uint64_t getLastSequence() const { return last_sequence_; }
+
+    // Number of held messages
+    size_t getPendingCount() const { return pending_.size(); }
+
+    // Counters
+    const SequenceStats& getStats() const { return stats_; }
+
+private:
+    struct Pending {
+        uint64_t sequence;
+        std::string text;
+    };
+
+    size_t max_pending_;
+    std::vector<Pending> pending_;
+    uint64_t last_sequence_ = 0;
+    bool has_baseline_ = false;
+    bool syncing_ = true;
+    SequenceStats stats_;
+
+    // Hold a message for replay
+    void hold(uint64_t sequence, std::string_view text);
+
+    // Record a jump from last_sequence_ to `sequence`
+    void recordGap(uint64_t sequence);
+};
+
+template <typename Replay>
+bool SequenceTracker::onSnapshot(uint64_t sequence, Replay&& replay) {
+    syncing_ = false;
+    has_baseline_ = sequence != 0;
+    last_sequence_ = sequence;
+
+    if (!has_baseline_) {
+        stats_.stale += pending_.size();
+        pending_.clear();
+        return true;
+    }
+
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        const Pending& pending = pending_[i];
+        if (pending.sequence <= last_sequence_) {
+            ++stats_.stale;
+            continue;
+        }
+        if (pending.sequence != last_sequence_ + 1) {
+            // Still missing messages: keep the rest for the next snapshot
+            recordGap(pending.sequence);
+            syncing_ = true;
+            pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(i));
+            return false;
+        }
+        replay(std::string_view(pending.text));
+        last_sequence_ = pending.sequence;
+        ++stats_.replayed;
+    }
+
+    pending_.clear();
+    return true;
+}
+
+} // namespace clunk
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "orderbook/fixed_point.h"
+#include "orderbook/order.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clunk {
+
+// What one normalized venue event does to a book
+enum class BookEventType : uint8_t {
+    SNAPSHOT,   // Replace the book with `levels`
+    UPDATE,     // Set each of `levels` (a size of 0 removes the level)
+    TRADE,      // One trade: `maker_side`, `price`, `size`
+    ERROR       // The venue rejected a request: `message`
+};
+
+// One level of a snapshot or update, as the venue's decimal text, so it
+// can be parsed straight into ticks and lots at the book's scale
+struct LevelText {
+    OrderSide side = OrderSide::BUY;
+    std::string_view price;
+    std::string_view size;
+};
+
+// A venue message reduced to what the shared book stage applies
+//
+// Views point into the message text and are only valid while it is.
+struct BookEvent {
+    BookEventType type = BookEventType::UPDATE;
+    std::string_view symbol;            // The venue's product ID
+    uint64_t sequence = 0;              // Per-product sequence (0: the venue sends none)
+    std::vector<LevelText> levels;      // Snapshots give bids then asks, best first
+
+    // TRADE fields
+    OrderSide maker_side = OrderSide::BUY;
+    std::string_view price;
+    std::string_view size;
+
+    // ERROR text
+    std::string_view message;
+};
+
+// The events decoded from one message, reused from message to message so
+// decoding stops allocating once the level lists have grown
+class BookEvents {
+public:
+    // Start a new event, keeping the storage of the one it reuses
+    BookEvent& add(BookEventType type, std::string_view symbol) {
+        if (count_ == events_.size()) {
+            events_.emplace_back();
+        }
+        BookEvent& event = events_[count_++];
+        event.type = type;
+        event.symbol = symbol;
+        event.sequence = 0;
+        event.levels.clear();
+        event.price = {};
+        event.size = {};
+        event.message = {};
+        return event;
+    }
+
+    // Forget every event
+    void clear() { count_ = 0; }
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    const BookEvent& operator[](size_t index) const { return events_[index]; }
+    const BookEvent* begin() const { return events_.data(); }
+    const BookEvent* end() const { return events_.data() + count_; }
+
+private:
+    std::vector<BookEvent> events_;
+    size_t count_ = 0;
+};
+
+// WebSocket endpoint of a venue's market data feed
+struct VenueEndpoint {
+    std::string host;
+    std::string port;
+    std::string path;
+};
+
+// The venue-specific half of a feed: where to connect, how to subscribe,
+// and how to turn its messages into BookEvents
+//
+// Decoders are stateless, so one can serve every shard's thread at once.
+// Everything else (sequencing, resyncs, batching, sharding, the books)
+// is the shared stage in VenueFeedHandler.
+class VenueDecoder {
+public:
+    virtual ~VenueDecoder() = default;
+
+    // Venue name, for logs
+    virtual const char* getName() const = 0;
+
+    // Where to connect
+    virtual VenueEndpoint getEndpoint() const = 0;
+
+    // Fixed-point scale for a product's book
+    virtual ProductScale getScale(const std::string& symbol) const { return ProductScale::forSymbol(symbol); }
+
+    // Levels per side the venue maintains for each book (0: the whole book).
+    // Levels pushed past it are dropped, since their updates stop.
+    virtual size_t getBookDepth() const { return 0; }
+
+    // Messages that subscribe to or unsubscribe from a product's book and
+    // trades; subscribing must make the venue send a snapshot
+    virtual std::vector<std::string> subscribeMessages(const std::string& symbol) const = 0;
+    virtual std::vector<std::string> unsubscribeMessages(const std::string& symbol) const = 0;
+
+    // Messages that make the venue send a fresh snapshot of a product's book
+    virtual std::vector<std::string> resyncMessages(const std::string& symbol) const = 0;
+
+    // Product ID of a message without decoding it (empty if none), so the
+    // I/O thread can route it to the product's shard
+    virtual std::string_view peekSymbol(std::string_view text) const = 0;
+
+    // Append the events in a message to `out`; messages with no bearing on
+    // the books (heartbeats, acknowledgements) add none. Returns false if
+    // the message is malformed.
+    virtual bool decode(std::string_view text, BookEvents& out) const = 0;
+};
+
+} // namespace clunk
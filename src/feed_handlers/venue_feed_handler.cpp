@@ -0,0 +1,308 @@
+#include "venue_feed_handler.h"
+#include "utils/node_allocator.h"
+#include "utils/time_utils.h"
+#include <algorithm>
+#include <iostream>
+
+namespace clunk {
+
+VenueFeedHandler::VenueFeedHandler(std::unique_ptr<VenueDecoder> decoder)
+    : decoder_(std::move(decoder)), book_depth_(decoder_->getBookDepth()) {
+    VenueEndpoint endpoint = decoder_->getEndpoint();
+    connection_ = std::make_shared<WebSocketClient>(endpoint.host, endpoint.port);
+    connection_->setPath(endpoint.path);
+    connection_->setMessageCallback([this](std::string_view message, const MessageTiming& timing) {
+        dispatchMessage(message, timing);
+    });
+    connection_->setConnectCallback([this](bool reconnected) { onConnected(reconnected); });
+}
+
+VenueFeedHandler::~VenueFeedHandler() {
+    disconnect();
+}
+
+void VenueFeedHandler::connect() {
+    shards_.start();
+    connection_->connect();
+}
+
+void VenueFeedHandler::disconnect() {
+    connection_->disconnect();
+
+    // Let the shards finish what the I/O thread already queued
+    shards_.stop();
+}
+
+bool VenueFeedHandler::isConnected() const {
+    return connection_->isConnected();
+}
+
+void VenueFeedHandler::setVerboseLogging(bool enabled) {
+    verbose_logging_ = enabled;
+    connection_->setVerboseLogging(enabled);
+}
+
+void VenueFeedHandler::setIoThread(int cpu, bool busy_poll) {
+    connection_->setIoCpu(cpu);
+    connection_->setBusyPoll(busy_poll);
+}
+
+void VenueFeedHandler::enableSharding(size_t shard_count, size_t capacity, const std::vector<int>& worker_cpus,
+                                      bool local_memory) {
+    if (isConnected()) {
+        std::cerr << "Cannot enable sharding while connected" << std::endl;
+        return;
+    }
+
+    shards_.enableSharding(
+        shard_count, capacity,
+        [this](Shard& shard, std::string_view payload, const MessageTiming& timing) {
+            handleMessage(shard, payload, timing);
+        },
+        worker_cpus, local_memory);
+}
+
+std::vector<ShardStats> VenueFeedHandler::getShardStats() const {
+    return shards_.getStats();
+}
+
+std::vector<LatencySummary> VenueFeedHandler::getLatencyStats() const {
+    // The connection and each shard record on their own threads; merge a copy
+    auto merged = std::make_unique<StageLatency>();
+    merged->merge(connection_->getLatency());
+    shards_.mergeLatency(*merged);
+    return merged->summarize();
+}
+
+void VenueFeedHandler::subscribe(const std::string& symbol) {
+    // Create the symbol's book in its shard, on the shard worker's NUMA
+    // node when placement is on
+    shards_.add(symbol, [this, &symbol](ProductBooks& books, int node) {
+        books.book = std::allocate_shared<LevelBook>(NodeAllocator<LevelBook>(node), symbol,
+                                                     decoder_->getScale(symbol));
+        books.sync = std::make_shared<ProductSync>();
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(symbols_mutex_);
+        if (std::find(symbols_.begin(), symbols_.end(), symbol) != symbols_.end()) {
+            return;
+        }
+        symbols_.push_back(symbol);
+    }
+    sendAll(decoder_->subscribeMessages(symbol));
+}
+
+void VenueFeedHandler::unsubscribe(const std::string& symbol) {
+    sendAll(decoder_->unsubscribeMessages(symbol));
+    {
+        std::lock_guard<std::mutex> lock(symbols_mutex_);
+        symbols_.erase(std::remove(symbols_.begin(), symbols_.end(), symbol), symbols_.end());
+    }
+
+    shards_.remove(symbol);
+}
+
+void VenueFeedHandler::sendAll(const std::vector<std::string>& messages) {
+    for (const std::string& message : messages) {
+        if (verbose_logging_) {
+            std::cout << "Sending to " << decoder_->getName() << ": " << message << std::endl;
+        }
+        connection_->send(message);
+    }
+}
+
+void VenueFeedHandler::onConnected(bool reconnected) {
+    std::vector<std::string> symbols;
+    {
+        std::lock_guard<std::mutex> lock(symbols_mutex_);
+        symbols = symbols_;
+    }
+
+    for (const std::string& symbol : symbols) {
+        sendAll(decoder_->subscribeMessages(symbol));
+        if (reconnected && resync_callback_) {
+            resync_callback_(symbol, ResyncReason::RECONNECT);
+        }
+    }
+}
+
+std::shared_ptr<LevelBook> VenueFeedHandler::getLevelBook(const std::string& symbol) {
+    ProductBooks books;
+    return shards_.find(symbol, books) ? books.book : nullptr;
+}
+
+bool VenueFeedHandler::isBookReady(const std::string& symbol) const {
+    return shards_.isReady(symbol);
+}
+
+bool VenueFeedHandler::waitForBooks(const std::vector<std::string>& symbols, std::chrono::milliseconds timeout) {
+    return shards_.waitReady(symbols, timeout);
+}
+
+void VenueFeedHandler::injectMessage(std::string_view message) {
+    uint64_t now = readCycles();
+    dispatchMessage(message, MessageTiming{now, now});
+}
+
+void VenueFeedHandler::dispatchMessage(std::string_view message, const MessageTiming& timing) {
+    if (ShardedPipeline* sharding = shards_.getPipeline()) {
+        sharding->push(decoder_->peekSymbol(message), message, timing);
+    } else {
+        handleMessage(shards_[0], message, timing);
+    }
+}
+
+void VenueFeedHandler::handleMessage(Shard& shard, std::string_view message, const MessageTiming& timing) {
+    uint64_t picked = readCycles();
+    shard.latency.record(LatencyStage::HANDOFF, timing.deframed, picked);
+
+    shard.events.clear();
+    if (!decoder_->decode(message, shard.events)) {
+        decode_errors_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Error processing " << decoder_->getName() << " message: malformed" << std::endl;
+        return;
+    }
+    if (shard.events.empty()) {
+        if (verbose_logging_) {
+            std::cout << "Ignored " << decoder_->getName() << " message: " << message << std::endl;
+        }
+        return;
+    }
+
+    uint64_t parsed = readCycles();
+    shard.latency.record(LatencyStage::PARSE, picked, parsed);
+
+    bool book_event = false;
+    for (const BookEvent& event : shard.events) {
+        processEvent(event, message, shard);
+        book_event = book_event || event.type == BookEventType::SNAPSHOT || event.type == BookEventType::UPDATE;
+    }
+
+    if (book_event) {
+        uint64_t applied = readCycles();
+        shard.latency.record(LatencyStage::APPLY, parsed, applied);
+        shard.latency.record(LatencyStage::TOTAL, timing.read, applied);
+    }
+}
+
+void VenueFeedHandler::processEvent(const BookEvent& event, std::string_view message, Shard& shard) {
+    if (event.type == BookEventType::ERROR) {
+        std::cerr << decoder_->getName() << " API error" << (event.symbol.empty() ? "" : " for ")
+                  << event.symbol << ": " << event.message << std::endl;
+        return;
+    }
+
+    ProductBooks books;
+    std::string symbol(event.symbol);
+    if (!BookShards<Shard>::find(shard, symbol, books)) {
+        if (verbose_logging_) {
+            std::cerr << "Order book not found for symbol: " << symbol << std::endl;
+        }
+        return;
+    }
+    ProductSync& sync = *books.sync;
+
+    switch (event.type) {
+        case BookEventType::SNAPSHOT: {
+            if (!parseLevels(event, *books.book, shard)) {
+                return;
+            }
+
+            // Replace the book in one lock acquisition and one notification
+            books.book->loadSnapshot(shard.batch.data(), shard.batch.size());
+
+            // Catch up on the updates held while the snapshot was pending
+            bool live = sync.sequence.onSnapshot(event.sequence, [&](std::string_view text) {
+                shard.replay.clear();
+                if (!decoder_->decode(text, shard.replay)) {
+                    return;
+                }
+                for (const BookEvent& held : shard.replay) {
+                    if (held.type == BookEventType::UPDATE && held.symbol == event.symbol) {
+                        applyUpdate(held, books, shard);
+                    }
+                }
+            });
+            if (!live) {
+                std::cerr << "Sequence gap replaying updates for " << symbol << ", resyncing" << std::endl;
+                requestSnapshot(symbol, sync, ResyncReason::SEQUENCE_GAP);
+                return;
+            }
+            shards_.markReady(sync.ready);
+            break;
+        }
+        case BookEventType::UPDATE: {
+            // A held message is decoded again on replay, so it is kept whole
+            SequenceCheck check = event.sequence != 0 ? sync.sequence.check(event.sequence, message)
+                                                      : sync.sequence.checkUnsequenced();
+            switch (check) {
+                case SequenceCheck::APPLY:
+                    applyUpdate(event, books, shard);
+                    break;
+                case SequenceCheck::GAP:
+                    std::cerr << "Sequence gap for " << symbol << " after " << sync.sequence.getLastSequence()
+                              << " (got " << event.sequence << "), resyncing" << std::endl;
+                    requestSnapshot(symbol, sync, ResyncReason::SEQUENCE_GAP);
+                    break;
+                case SequenceCheck::STALE:
+                case SequenceCheck::BUFFERED:
+                    break;
+            }
+            break;
+        }
+        case BookEventType::TRADE:
+            if (trade_callback_) {
+                const ProductScale& scale = books.book->getScale();
+                Trade trade;
+                trade.maker_side = event.maker_side;
+                if (!parseDecimal(event.price, scale.price_decimals, trade.price) ||
+                    !parseDecimal(event.size, scale.size_decimals, trade.size)) {
+                    decode_errors_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                trade_callback_(symbol, trade);
+            }
+            break;
+        case BookEventType::ERROR:
+            break;
+    }
+}
+
+bool VenueFeedHandler::parseLevels(const BookEvent& event, const LevelBook& book, Shard& shard) {
+    const ProductScale& scale = book.getScale();
+    shard.batch.clear();
+    for (const LevelText& level : event.levels) {
+        LevelUpdate update;
+        update.side = level.side;
+        if (!parseDecimal(level.price, scale.price_decimals, update.price) ||
+            !parseDecimal(level.size, scale.size_decimals, update.size)) {
+            decode_errors_.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "Malformed level in " << decoder_->getName() << " message for " << event.symbol << ": "
+                      << level.price << " " << level.size << std::endl;
+            return false;
+        }
+        shard.batch.push_back(update);
+    }
+    return true;
+}
+
+void VenueFeedHandler::applyUpdate(const BookEvent& event, const ProductBooks& books, Shard& shard) {
+    if (!parseLevels(event, *books.book, shard)) {
+        return;
+    }
+
+    // The change set goes in under one lock acquisition and one notification,
+    // trimmed to the depth the venue keeps up to date
+    books.book->applyUpdates(shard.batch.data(), shard.batch.size(), book_depth_);
+}
+
+void VenueFeedHandler::requestSnapshot(const std::string& symbol, ProductSync& sync, ResyncReason reason) {
+    sync.sequence.beginResync();
+    if (resync_callback_) {
+        resync_callback_(symbol, reason);
+    }
+    sendAll(decoder_->resyncMessages(symbol));
+}
+
+} // namespace clunk
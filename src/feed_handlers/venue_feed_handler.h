@@ -0,0 +1,186 @@
+#pragma once
+
+#include "feed_handler.h"
+#include "book_shards.h"
+#include "sequence_tracker.h"
+#include "venue_decoder.h"
+#include "network/websocket_client.h"
+#include "orderbook/level_book.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace clunk {
+
+// Feed handler for any venue a VenueDecoder describes
+//
+// One WebSocketClient carries the feed. The decoder turns each message
+// into normalized BookEvents, and the stage shared by every venue applies
+// them to one LevelBook per product: sequence checks with held updates
+// replayed over the next snapshot, a resync request on a gap, each
+// snapshot or update applied under one lock and one notification, and
+// optionally a ShardedPipeline spreading products over worker threads.
+// After the batch and event buffers have grown, applying a message
+// allocates nothing. The connection recovers on its own (see
+// ReconnectPolicy), re-subscribing every product, and the snapshots of the
+// new subscriptions rebuild the books.
+class VenueFeedHandler : public FeedHandler {
+public:
+    // Constructor
+    explicit VenueFeedHandler(std::unique_ptr<VenueDecoder> decoder);
+
+    // Destructor
+    ~VenueFeedHandler() override;
+
+    // Connect to the venue (and start the shard workers)
+    void connect() override;
+
+    // Disconnect, letting the shards finish what was already queued
+    void disconnect() override;
+
+    // Subscribe to a symbol, in the venue's naming (kept across
+    // reconnects; before connect() it is sent once the connection is up)
+    void subscribe(const std::string& symbol) override;
+
+    // Unsubscribe from a symbol and drop its book
+    void unsubscribe(const std::string& symbol) override;
+
+    // Check if connected
+    bool isConnected() const override;
+
+    // The venue's decoder
+    const VenueDecoder& getDecoder() const { return *decoder_; }
+
+    // Enable/disable verbose logging
+    void setVerboseLogging(bool enabled);
+
+    // Reconnect and heartbeat settings (call before connect())
+    void setReconnectPolicy(const ReconnectPolicy& policy) { connection_->setReconnectPolicy(policy); }
+
+    // Reconnect attempts made since connect()
+    uint64_t getReconnectCount() const { return connection_->getReconnectCount(); }
+
+    // Pin the I/O thread to `cpu` (< 0: leave it floating), and busy-poll
+    // its socket instead of blocking (see WebSocketClient). Call before
+    // connect().
+    void setIoThread(int cpu, bool busy_poll = false);
+
+    // Set the resync callback (call before connect())
+    void setResyncCallback(ResyncCallback callback) { resync_callback_ = std::move(callback); }
+
+    // Set the trade callback (call before connect())
+    void setTradeCallback(TradeCallback callback) { trade_callback_ = std::move(callback); }
+
+    // Apply messages on `shard_count` worker threads, each owning the books
+    // of the products routed to it, as CoinbaseHandler::enableSharding()
+    // does. Call before connect() and subscribe().
+    void enableSharding(size_t shard_count, size_t capacity, const std::vector<int>& worker_cpus = {},
+                        bool local_memory = false);
+
+    // Per-shard queue counters and product counts (empty when not sharded)
+    std::vector<ShardStats> getShardStats() const;
+
+    // Latency percentiles of each stage, merged over the connection and
+    // shards (see FeedHandler)
+    std::vector<LatencySummary> getLatencyStats() const override;
+
+    // Messages the decoder rejected, and events that could not be applied
+    uint64_t getDecodeErrorCount() const { return decode_errors_.load(std::memory_order_relaxed); }
+
+    // Handle a message as if it had arrived on the connection (testing;
+    // call from one thread, as the I/O thread would)
+    void injectMessage(std::string_view message);
+
+    // Get a symbol's book
+    std::shared_ptr<LevelBook> getLevelBook(const std::string& symbol);
+    std::shared_ptr<BookView> getBookView(const std::string& symbol) override { return getLevelBook(symbol); }
+
+    // Whether a symbol's book has been built from a snapshot (it stays
+    // ready through later resyncs)
+    bool isBookReady(const std::string& symbol) const;
+
+    // Block until every symbol's book is ready or `timeout` passes
+    bool waitForBooks(const std::vector<std::string>& symbols, std::chrono::milliseconds timeout) override;
+
+private:
+    // Feed-thread state of one product's book
+    struct ProductSync {
+        SequenceTracker sequence;
+        std::atomic<bool> ready{false};     // Built once; read by waitForBooks()
+    };
+
+    struct ProductBooks {
+        std::shared_ptr<LevelBook> book;
+        std::shared_ptr<ProductSync> sync;
+    };
+
+    // The books of the products handled on one thread
+    struct Shard {
+        // Books by symbol
+        std::unordered_map<std::string, ProductBooks> books;
+
+        // Mutex for protecting the book map
+        std::mutex mutex;
+
+        // Reusable buffers for decoded events and parsed levels (a shard's
+        // messages are handled on one thread at a time), and for decoding
+        // held updates while a snapshot replays them
+        BookEvents events;
+        BookEvents replay;
+        std::vector<LevelUpdate> batch;
+
+        // Handoff, parse and apply latency of the shard's messages
+        StageLatency latency;
+    };
+
+    std::unique_ptr<VenueDecoder> decoder_;
+    size_t book_depth_;
+
+    // The venue connection
+    std::shared_ptr<WebSocketClient> connection_;
+
+    // Subscribed symbols, re-sent on every new session
+    std::vector<std::string> symbols_;
+    mutable std::mutex symbols_mutex_;
+
+    // Books by shard: one shard, or one per worker once sharding is enabled
+    BookShards<Shard> shards_;
+
+    bool verbose_logging_ = false;
+    std::atomic<uint64_t> decode_errors_{0};
+
+    ResyncCallback resync_callback_;
+    TradeCallback trade_callback_;
+
+    // Re-subscribe every product once a session is up
+    void onConnected(bool reconnected);
+
+    // Hand a message to its shard
+    void dispatchMessage(std::string_view message, const MessageTiming& timing);
+
+    // Decode and apply a message on its shard's thread
+    void handleMessage(Shard& shard, std::string_view message, const MessageTiming& timing);
+
+    // Sequence-check one event of `message` and apply, hold or drop it
+    void processEvent(const BookEvent& event, std::string_view message, Shard& shard);
+
+    // Parse an event's levels into the shard's batch at the book's scale;
+    // false if one is malformed
+    bool parseLevels(const BookEvent& event, const LevelBook& book, Shard& shard);
+
+    // Apply an update that passed the sequence check
+    void applyUpdate(const BookEvent& event, const ProductBooks& books, Shard& shard);
+
+    // Ask the venue for a fresh snapshot, holding updates until it arrives
+    void requestSnapshot(const std::string& symbol, ProductSync& sync, ResyncReason reason);
+
+    // Send each of `messages` on the connection
+    void sendAll(const std::vector<std::string>& messages);
+};
+
+} // namespace clunk
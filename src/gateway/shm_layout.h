@@ -0,0 +1,84 @@
+#pragma once
+
+#include "utils/seqlock.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace clunk {
+
+// Layout of the shared-memory region ShmPublisher writes and ShmBookReader
+// maps, shared by both sides of the process boundary
+//
+// The region is a header followed by `capacity` product slots. Each slot
+// holds the product's name and scale, fixed once the product is counted,
+// and two sequence-locked values: the top of book, small enough for one
+// cache line pair, and depth up to kShmMaxDepth levels per side. Prices and
+// sizes are the book's ticks and lots; scale them by the slot's decimals.
+// Only clunk writes; readers map the region read-only.
+
+constexpr char kShmMagic[8] = {'C', 'L', 'U', 'N', 'K', 'S', 'H', 'M'};
+constexpr uint32_t kShmVersion = 1;
+constexpr size_t kShmMaxDepth = 32;
+constexpr size_t kShmSymbolSize = 32;
+
+// Best bid and ask of one product
+struct ShmQuote {
+    int64_t bid_price = 0;
+    int64_t bid_size = 0;
+    int64_t ask_price = std::numeric_limits<int64_t>::max();
+    int64_t ask_size = 0;
+    uint64_t sequence = 0;          // Book mutation count (TopOfBook::sequence)
+    uint64_t publish_ns = 0;        // Wall clock when written
+
+    bool hasBid() const { return bid_price > 0; }
+    bool hasAsk() const { return ask_price < std::numeric_limits<int64_t>::max(); }
+};
+
+// Up to kShmMaxDepth levels per side of one product, best first
+struct ShmDepth {
+    uint64_t sequence = 0;
+    uint64_t publish_ns = 0;
+    uint32_t bid_count = 0;
+    uint32_t ask_count = 0;
+    int64_t bid_prices[kShmMaxDepth] = {};
+    int64_t bid_sizes[kShmMaxDepth] = {};
+    int64_t ask_prices[kShmMaxDepth] = {};
+    int64_t ask_sizes[kShmMaxDepth] = {};
+};
+
+// One product's slot
+struct ShmProduct {
+    char symbol[kShmSymbolSize] = {};   // NUL-terminated
+    uint8_t price_decimals = 0;         // Digits after the point in one tick
+    uint8_t size_decimals = 0;          // Digits after the point in one lot
+    SeqLock<ShmQuote> quote;
+    SeqLock<ShmDepth> depth;
+};
+
+// Start of the region
+struct ShmHeader {
+    char magic[8] = {};                 // Written last, once the slots are ready
+    uint32_t version = kShmVersion;
+    uint32_t capacity = 0;              // Product slots after the header
+    uint32_t depth = 0;                 // Levels per side published (<= kShmMaxDepth)
+    uint32_t product_size = sizeof(ShmProduct);     // Catches layout mismatches
+
+    // Products in use; slots below it are fully initialized (release/acquire)
+    alignas(64) std::atomic<uint32_t> product_count{0};
+
+    // Wall clock of the writer's last pass, so readers can tell a live
+    // writer from a stale region
+    std::atomic<uint64_t> heartbeat_ns{0};
+};
+
+static_assert(sizeof(ShmHeader) % alignof(ShmProduct) == 0, "Product slots must follow the header aligned");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared-memory atomics must be lock-free");
+
+// Bytes of a region with `capacity` product slots
+constexpr size_t shmRegionSize(size_t capacity) {
+    return sizeof(ShmHeader) + capacity * sizeof(ShmProduct);
+}
+
+} // namespace clunk
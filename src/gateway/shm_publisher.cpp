@@ -0,0 +1,199 @@
+#include "shm_publisher.h"
+#include "utils/thread_utils.h"
+#include "utils/time_utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace clunk {
+
+namespace {
+
+std::runtime_error shmError(const std::string& what, const std::string& name) {
+    return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+ShmPublisher::ShmPublisher(const std::string& name, size_t depth, size_t capacity)
+    : name_(name), depth_(std::min(std::max<size_t>(depth, 1), kShmMaxDepth)),
+      capacity_(std::max<size_t>(capacity, 1)) {
+#if defined(_WIN32)
+    throw std::runtime_error("Shared-memory books are not supported on this platform: " + name);
+#else
+    // A region left by a writer that died is replaced, not reused: readers
+    // still mapping it see its heartbeat stop
+    ::shm_unlink(name_.c_str());
+    int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        throw shmError("Cannot create shared-memory books", name_);
+    }
+
+    size_ = shmRegionSize(capacity_);
+    if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw shmError("Cannot size shared-memory books", name_);
+    }
+
+    void* mapping = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(name_.c_str());
+        throw shmError("Cannot map shared-memory books", name_);
+    }
+
+    // Lay out the header and every slot, then sign the region
+    header_ = new (mapping) ShmHeader();
+    header_->capacity = static_cast<uint32_t>(capacity_);
+    header_->depth = static_cast<uint32_t>(depth_);
+    products_ = reinterpret_cast<ShmProduct*>(static_cast<char*>(mapping) + sizeof(ShmHeader));
+    for (size_t i = 0; i < capacity_; ++i) {
+        new (&products_[i]) ShmProduct();
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, kShmMagic, sizeof(kShmMagic));
+#endif
+
+    entries_.reserve(capacity_);
+    snapshot_.bids.reserve(depth_);
+    snapshot_.asks.reserve(depth_);
+}
+
+ShmPublisher::~ShmPublisher() {
+    stop();
+#if !defined(_WIN32)
+    if (header_ != nullptr) {
+        ::munmap(header_, size_);
+        ::shm_unlink(name_.c_str());
+    }
+#endif
+}
+
+bool ShmPublisher::addBook(const std::string& symbol, std::shared_ptr<BookView> book) {
+    if (!book || entries_.size() == capacity_ || symbol.empty() || symbol.size() >= kShmSymbolSize) {
+        return false;
+    }
+    for (const Entry& entry : entries_) {
+        if (symbol == entry.slot->symbol) {
+            return false;
+        }
+    }
+
+    Entry entry;
+    entry.slot = &products_[entries_.size()];
+    std::memcpy(entry.slot->symbol, symbol.data(), symbol.size());
+    entry.slot->price_decimals = book->getScale().price_decimals;
+    entry.slot->size_decimals = book->getScale().size_decimals;
+    entry.book = std::move(book);
+    entries_.push_back(std::move(entry));
+
+    // Readers see the slot only once it is filled in; its values follow on
+    // the next sweep
+    header_->product_count.store(static_cast<uint32_t>(entries_.size()), std::memory_order_release);
+    return true;
+}
+
+void ShmPublisher::start(std::chrono::microseconds poll_interval, int cpu) {
+    if (running_) {
+        return;
+    }
+
+    running_ = true;
+    thread_ = std::thread([this, poll_interval, cpu]() {
+        if (cpu >= 0 && !pinCurrentThread(cpu)) {
+            std::cerr << "Could not pin shared-memory publisher to CPU " << cpu << std::endl;
+        }
+
+        while (running_) {
+            publish();
+            if (poll_interval.count() > 0) {
+                std::this_thread::sleep_for(poll_interval);
+            }
+        }
+    });
+}
+
+void ShmPublisher::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t ShmPublisher::publish() {
+    uint64_t now_ns = wallClockNanos();
+    size_t published = 0;
+    for (Entry& entry : entries_) {
+        if (publishEntry(entry, now_ns)) {
+            ++published;
+        }
+    }
+
+    header_->heartbeat_ns.store(now_ns, std::memory_order_release);
+    passes_.fetch_add(1, std::memory_order_relaxed);
+    return published;
+}
+
+ShmPublisherStats ShmPublisher::getStats() const {
+    ShmPublisherStats stats;
+    stats.passes = passes_.load(std::memory_order_relaxed);
+    stats.quotes = quotes_.load(std::memory_order_relaxed);
+    stats.depths = depths_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool ShmPublisher::publishEntry(Entry& entry, uint64_t now_ns) {
+    TopOfBook top = entry.book->getTopOfBook();
+    if (entry.published && top.sequence == entry.sequence) {
+        return false;
+    }
+
+    // The touch goes out first: it is what most readers poll
+    ShmQuote quote;
+    quote.bid_price = top.bid_price;
+    quote.bid_size = top.bid_size;
+    quote.ask_price = top.ask_price;
+    quote.ask_size = top.ask_size;
+    quote.sequence = top.sequence;
+    quote.publish_ns = now_ns;
+    entry.slot->quote.store(quote);
+    quotes_.fetch_add(1, std::memory_order_relaxed);
+
+    entry.book->getDepthSnapshot(depth_, snapshot_);
+    depth_copy_.sequence = snapshot_.sequence;
+    depth_copy_.publish_ns = now_ns;
+    depth_copy_.bid_count = static_cast<uint32_t>(snapshot_.bids.size());
+    depth_copy_.ask_count = static_cast<uint32_t>(snapshot_.asks.size());
+    std::copy(snapshot_.bids.prices.begin(), snapshot_.bids.prices.end(), depth_copy_.bid_prices);
+    std::copy(snapshot_.bids.sizes.begin(), snapshot_.bids.sizes.end(), depth_copy_.bid_sizes);
+    std::copy(snapshot_.asks.prices.begin(), snapshot_.asks.prices.end(), depth_copy_.ask_prices);
+    std::copy(snapshot_.asks.sizes.begin(), snapshot_.asks.sizes.end(), depth_copy_.ask_sizes);
+    std::fill(depth_copy_.bid_prices + depth_copy_.bid_count, depth_copy_.bid_prices + depth_, 0);
+    std::fill(depth_copy_.bid_sizes + depth_copy_.bid_count, depth_copy_.bid_sizes + depth_, 0);
+    std::fill(depth_copy_.ask_prices + depth_copy_.ask_count, depth_copy_.ask_prices + depth_, 0);
+    std::fill(depth_copy_.ask_sizes + depth_copy_.ask_count, depth_copy_.ask_sizes + depth_, 0);
+    entry.slot->depth.store(depth_copy_);
+    depths_.fetch_add(1, std::memory_order_relaxed);
+
+    // The depth may be newer than the touch; the next changed sweep fixes
+    // the touch up
+    entry.sequence = top.sequence;
+    entry.published = true;
+    return true;
+}
+
+} // namespace clunk
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "shm_layout.h"
+#include "orderbook/book_view.h"
+#include "orderbook/depth_snapshot.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace clunk {
+
+// Publication counters
+struct ShmPublisherStats {
+    uint64_t passes = 0;        // Sweeps over the books
+    uint64_t quotes = 0;        // Top-of-book writes
+    uint64_t depths = 0;        // Depth writes
+};
+
+// Publishes books into POSIX shared memory for readers in other processes
+// on the host (see ShmBookReader)
+//
+// A publisher thread sweeps the books: a book whose mutation count moved
+// since the last sweep gets its top of book (a wait-free read) and then its
+// depth (one short hold of the book lock) written into its slot. The feed
+// threads do no extra work, and a sweep over idle books touches no lock at
+// all. With a poll interval of 0 the thread spins, for the freshest copy at
+// the cost of a core; give it one with `cpu`.
+class ShmPublisher {
+public:
+    static constexpr size_t kDefaultCapacity = 64;
+    static constexpr size_t kDefaultDepth = 10;
+    static constexpr std::chrono::microseconds kDefaultPollInterval{50};
+
+    // Create the region `name` (e.g. "/clunk"), replacing a stale one, with
+    // slots for `capacity` products publishing `depth` levels per side
+    // (at most kShmMaxDepth); throws std::runtime_error if it cannot
+    explicit ShmPublisher(const std::string& name, size_t depth = kDefaultDepth,
+                          size_t capacity = kDefaultCapacity);
+
+    // Stop, unmap and remove the region (mapped readers keep their copy)
+    ~ShmPublisher();
+
+    ShmPublisher(const ShmPublisher&) = delete;
+    ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+    // Publish `book` as `symbol`; false if the region is full, the name does
+    // not fit or is already published. Call before start().
+    bool addBook(const std::string& symbol, std::shared_ptr<BookView> book);
+
+    // Start the publisher thread, sweeping every `poll_interval` (0: spin),
+    // pinned to `cpu` if >= 0
+    void start(std::chrono::microseconds poll_interval = kDefaultPollInterval, int cpu = -1);
+
+    // Stop the publisher thread
+    void stop();
+
+    // One sweep on the calling thread (when not started); returns the books
+    // that were published
+    size_t publish();
+
+    // Counters so far
+    ShmPublisherStats getStats() const;
+
+    // Region name
+    const std::string& getName() const { return name_; }
+
+private:
+    struct Entry {
+        std::shared_ptr<BookView> book;
+        ShmProduct* slot = nullptr;
+        uint64_t sequence = 0;      // Book mutation count last published
+        bool published = false;
+    };
+
+    std::string name_;
+    size_t depth_;
+    size_t capacity_;
+    size_t size_ = 0;
+    ShmHeader* header_ = nullptr;
+    ShmProduct* products_ = nullptr;
+
+    std::vector<Entry> entries_;
+    DepthSnapshot snapshot_;        // Reused for every depth capture
+    ShmDepth depth_copy_;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    std::atomic<uint64_t> passes_{0};
+    std::atomic<uint64_t> quotes_{0};
+    std::atomic<uint64_t> depths_{0};
+
+    // Write one book's slot if it changed
+    bool publishEntry(Entry& entry, uint64_t now_ns);
+};
+
+} // namespace clunk
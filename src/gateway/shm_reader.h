@@ -0,0 +1,136 @@
+#pragma once
+
+#include "shm_layout.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace clunk {
+
+// Reads books clunk publishes to shared memory (see ShmPublisher)
+//
+// Header-only, so strategy processes can include it with only clunk's src
+// directory on their include path. Reads are a sequence-locked copy out of
+// the mapped slot: no system call, no lock shared with the writer, no
+// serialization. Product indexes are stable for the region's lifetime; a
+// restarted writer creates a new region, so reopen when getHeartbeatNanos()
+// stops advancing.
+class ShmBookReader {
+public:
+    // Retries of a read that keeps overlapping the writer before giving up
+    static constexpr int kMaxReadAttempts = 1 << 16;
+
+    // Map the region `name` (e.g. "/clunk"); throws std::runtime_error if it
+    // does not exist or is not a clunk region of this version
+    explicit ShmBookReader(const std::string& name) {
+#if defined(_WIN32)
+        throw std::runtime_error("Shared-memory books are not supported on this platform: " + name);
+#else
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            throw error("Cannot open shared-memory books", name);
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw error("Cannot stat shared-memory books", name);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ < sizeof(ShmHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Not a clunk shared-memory region: " + name);
+        }
+
+        void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw error("Cannot map shared-memory books", name);
+        }
+        header_ = static_cast<const ShmHeader*>(mapping);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (std::memcmp(header_->magic, kShmMagic, sizeof(kShmMagic)) != 0 || header_->version != kShmVersion ||
+            header_->product_size != sizeof(ShmProduct) || size_ < shmRegionSize(header_->capacity)) {
+            ::munmap(mapping, size_);
+            header_ = nullptr;
+            throw std::runtime_error("Not a clunk shared-memory region (or unsupported version): " + name);
+        }
+        products_ = reinterpret_cast<const ShmProduct*>(reinterpret_cast<const char*>(header_) + sizeof(ShmHeader));
+#endif
+    }
+
+    // Destructor (unmaps)
+    ~ShmBookReader() {
+#if !defined(_WIN32)
+        if (header_ != nullptr) {
+            ::munmap(const_cast<ShmHeader*>(header_), size_);
+        }
+#endif
+    }
+
+    ShmBookReader(const ShmBookReader&) = delete;
+    ShmBookReader& operator=(const ShmBookReader&) = delete;
+
+    // Products published so far
+    size_t getProductCount() const { return header_->product_count.load(std::memory_order_acquire); }
+
+    // Index of `symbol`, or -1 if it is not published (yet)
+    int findProduct(std::string_view symbol) const {
+        size_t count = getProductCount();
+        for (size_t i = 0; i < count; ++i) {
+            if (getSymbol(i) == symbol) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    // A product's name and scale (index < getProductCount())
+    std::string_view getSymbol(size_t index) const { return products_[index].symbol; }
+    int getPriceDecimals(size_t index) const { return products_[index].price_decimals; }
+    int getSizeDecimals(size_t index) const { return products_[index].size_decimals; }
+
+    // Levels per side the writer publishes
+    size_t getDepth() const { return header_->depth; }
+
+    // Copy a product's top of book; false if every attempt overlapped a
+    // write (e.g. the writer died mid-store)
+    bool readQuote(size_t index, ShmQuote& out) const { return read(products_[index].quote, out); }
+
+    // Copy a product's depth; false as for readQuote()
+    bool readDepth(size_t index, ShmDepth& out) const { return read(products_[index].depth, out); }
+
+    // Wall clock of the writer's last publishing pass
+    uint64_t getHeartbeatNanos() const { return header_->heartbeat_ns.load(std::memory_order_acquire); }
+
+private:
+    const ShmHeader* header_ = nullptr;
+    const ShmProduct* products_ = nullptr;
+    size_t size_ = 0;
+
+    template <typename T>
+    static bool read(const SeqLock<T>& slot, T& out) {
+        for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+            if (slot.tryLoad(out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static std::runtime_error error(const std::string& what, const std::string& name) {
+        return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+    }
+};
+
+} // namespace clunk
@@ -1,10 +1,17 @@
 #include "feed_handlers/coinbase_handler.h"
+#include "feed_handlers/kraken_decoder.h"
+#include "feed_handlers/replay_feed_handler.h"
+#include "feed_handlers/venue_feed_handler.h"
+#include "gateway/shm_publisher.h"
 #include "visualization/console_visualizer.h"
 #include <iostream>
 #include <chrono>
+#include <ctime>
 #include <thread>
 #include <csignal>
 #include <atomic>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <algorithm>
@@ -13,6 +20,16 @@
 // Global flag for handling Ctrl+C
 std::atomic<bool> running(true);
 
+// Ring size per shard when --shards is given without --pipeline
+constexpr size_t kDefaultShardCapacity = 4096;
+
+// Subscribe to every requested symbol
+void subscribeAll(clunk::FeedHandler& handler, const std::vector<std::string>& symbols) {
+    for (const std::string& symbol : symbols) {
+        handler.subscribe(symbol);
+    }
+}
+
 // ANSI color codes for terminal output
 namespace Color {
     const std::string RESET = "\033[0m";
@@ -55,29 +72,105 @@ void printUsage(const std::string& program_name) {
     std::cout << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  -h, --help                 Display this help message" << std::endl;
-    std::cout << "  -s, --symbol SYMBOL        Trading symbol (default: BTC-USD)" << std::endl;
+    std::cout << "  -s, --symbol SYMBOLS       Trading symbol(s), comma separated; the first is displayed" << std::endl;
+    std::cout << "                             (default: BTC-USD)" << std::endl;
     std::cout << "  -d, --depth DEPTH          Order book depth to display (default: 10)" << std::endl;
     std::cout << "  -r, --refresh RATE         Refresh rate in milliseconds (default: 500)" << std::endl;
     std::cout << "  -v, --verbose              Enable verbose output" << std::endl;
     std::cout << "  -c, --no-color-changes     Disable highlighting of price/size changes" << std::endl;
     std::cout << "  -t, --highlight-time TIME  Duration to highlight changes (default: 2 refreshes)" << std::endl;
+    std::cout << "  -b, --book MODE            Book model: levels (L2, default) or orders (L3)" << std::endl;
+    std::cout << "  -p, --pipeline SIZE        Parse on a worker thread fed by a SIZE-slot ring" << std::endl;
+    std::cout << "      --worker-cpu CPU       Pin the pipeline worker to CPU (requires --pipeline)" << std::endl;
+    std::cout << "      --connections N        Spread products over N WebSocket connections (default: 1)" << std::endl;
+    std::cout << "      --redundancy R         Subscribe each product on R of them; first copy wins" << std::endl;
+    std::cout << "      --shards N             Spread products over N worker threads (replaces --pipeline;" << std::endl;
+    std::cout << "                             its SIZE, if given, sets each shard's ring)" << std::endl;
+    std::cout << "      --shard-cpus LIST      Pin shard workers to these CPUs, comma separated" << std::endl;
+    std::cout << "      --numa                 Allocate each shard's books on its worker's NUMA node" << std::endl;
+    std::cout << "                             (requires --shard-cpus)" << std::endl;
+    std::cout << "      --io-cpus LIST         Pin connection I/O threads (or the replay thread) to these" << std::endl;
+    std::cout << "                             CPUs, comma separated" << std::endl;
+    std::cout << "      --busy-poll            Spin the I/O threads on their sockets instead of sleeping" << std::endl;
+    std::cout << "      --render-cpu CPU       Pin the display thread to CPU" << std::endl;
+    std::cout << "      --headless             No display; print a stats line every refresh instead" << std::endl;
+    std::cout << "      --shm NAME             Publish every book to shared memory NAME (e.g. /clunk)" << std::endl;
+    std::cout << "                             for local readers, at the display depth" << std::endl;
+    std::cout << "      --shm-cpu CPU          Pin the shared-memory publisher to CPU and let it spin" << std::endl;
+    std::cout << "      --checkpoint-dir DIR   Save each book to DIR (which must exist) and start from" << std::endl;
+    std::cout << "                             the checkpoints found there" << std::endl;
+    std::cout << "      --checkpoint-interval S" << std::endl;
+    std::cout << "                             Seconds between checkpoints (default: 30; 0: on exit only)" << std::endl;
+    std::cout << "      --capture FILE         Record every applied message to FILE for --replay" << std::endl;
+    std::cout << "      --replay FILE          Rebuild the books from a capture instead of connecting" << std::endl;
+    std::cout << "      --replay-speed X       Replay at X times the recorded pace (default: 0, as fast" << std::endl;
+    std::cout << "                             as possible, reporting throughput)" << std::endl;
+    std::cout << "      --venue VENUE          Market data venue: coinbase (default) or kraken, whose" << std::endl;
+    std::cout << "                             symbols look like BTC/USD (L2 books; no connection pool," << std::endl;
+    std::cout << "                             capture or checkpoints)" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << program_name << " -s ETH-USD" << std::endl;
     std::cout << "  " << program_name << " --symbol BTC-USD --depth 15 --refresh 1000" << std::endl;
     std::cout << "  " << program_name << " --symbol BTC-USD --no-color-changes" << std::endl;
+    std::cout << "  " << program_name << " --symbol BTC-USD,ETH-USD --headless --refresh 1000" << std::endl;
+    std::cout << "  " << program_name << " --symbol BTC-USD --pipeline 4096 --worker-cpu 2" << std::endl;
+    std::cout << "  " << program_name << " --symbol BTC-USD,ETH-USD,SOL-USD --shards 2 --shard-cpus 2,3" << std::endl;
+    std::cout << "  " << program_name << " --symbol BTC-USD,ETH-USD --shards 2 --shard-cpus 2,3 --numa --io-cpus 1 --busy-poll" << std::endl;
+    std::cout << "  " << program_name << " --symbol BTC-USD,ETH-USD --connections 2 --redundancy 2" << std::endl;
+    std::cout << "  " << program_name << " --symbol BTC-USD,ETH-USD --capture session.clunkcap" << std::endl;
+    std::cout << "  " << program_name << " --symbol BTC-USD --checkpoint-dir books --checkpoint-interval 10" << std::endl;
+    std::cout << "  " << program_name << " --symbol BTC-USD,ETH-USD --replay session.clunkcap --shards 2" << std::endl;
+    std::cout << "  " << program_name << " --venue kraken --symbol BTC/USD,ETH/USD --shards 2" << std::endl;
     std::cout << std::endl;
 }
 
+// Split a comma-separated list, dropping empty entries
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        if (end > start) {
+            items.push_back(list.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
 // Parse command line arguments
 struct ProgramOptions {
-    std::string symbol = "BTC-USD";
+    std::vector<std::string> symbols = {"BTC-USD"};     // The first is displayed
     size_t depth = 10;
     int refresh_rate = 500;
     bool verbose = false;
     bool show_help = false;
     bool highlight_changes = true;
     int highlight_duration = 2;
+    clunk::BookMode book_mode = clunk::BookMode::LEVELS;
+    size_t pipeline_capacity = 0;   // 0: parse on the I/O thread
+    int worker_cpu = -1;
+    size_t connections = 1;
+    size_t redundancy = 1;
+    size_t shards = 0;              // 0: no sharding
+    std::vector<int> shard_cpus;
+    bool numa = false;              // Place shard books on their workers' nodes
+    std::vector<int> io_cpus;       // Per connection (the replay thread uses the first)
+    bool busy_poll = false;
+    int render_cpu = -1;
+    bool headless = false;          // Stats lines instead of the display
+    std::string shm_name;           // Empty: no shared-memory publication
+    int shm_cpu = -1;               // Pinned publishers spin
+    std::string checkpoint_dir;     // Empty: no checkpoints
+    int checkpoint_interval = 30;   // Seconds; 0: on exit only
+    std::string capture_path;       // Empty: no capture
+    std::string replay_path;        // Empty: connect to the live feed
+    double replay_speed = 0.0;      // 0: as fast as possible
+    std::string venue = "coinbase"; // coinbase or kraken
 };
 
 ProgramOptions parseCommandLine(int argc, char* argv[]) {
@@ -92,7 +185,10 @@ ProgramOptions parseCommandLine(int argc, char* argv[]) {
             options.show_help = true;
         } else if (arg == "-s" || arg == "--symbol") {
             if (i + 1 < args.size()) {
-                options.symbol = args[++i];
+                std::vector<std::string> symbols = splitList(args[++i]);
+                if (!symbols.empty()) {
+                    options.symbols = symbols;
+                }
             }
         } else if (arg == "-d" || arg == "--depth") {
             if (i + 1 < args.size()) {
@@ -114,6 +210,140 @@ ProgramOptions parseCommandLine(int argc, char* argv[]) {
             options.verbose = true;
         } else if (arg == "-c" || arg == "--no-color-changes") {
             options.highlight_changes = false;
+        } else if (arg == "-b" || arg == "--book") {
+            if (i + 1 < args.size()) {
+                const std::string& mode = args[++i];
+                if (mode == "levels") {
+                    options.book_mode = clunk::BookMode::LEVELS;
+                } else if (mode == "orders") {
+                    options.book_mode = clunk::BookMode::ORDERS;
+                } else {
+                    std::cerr << "Invalid book mode: " << mode << std::endl;
+                }
+            }
+        } else if (arg == "-p" || arg == "--pipeline") {
+            if (i + 1 < args.size()) {
+                try {
+                    options.pipeline_capacity = std::stoul(args[++i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid pipeline size: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--worker-cpu") {
+            if (i + 1 < args.size()) {
+                try {
+                    options.worker_cpu = std::stoi(args[++i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid worker CPU: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--connections") {
+            if (i + 1 < args.size()) {
+                try {
+                    options.connections = std::stoul(args[++i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid connection count: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--redundancy") {
+            if (i + 1 < args.size()) {
+                try {
+                    options.redundancy = std::stoul(args[++i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid redundancy: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--shards") {
+            if (i + 1 < args.size()) {
+                try {
+                    options.shards = std::stoul(args[++i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid shard count: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--shard-cpus") {
+            if (i + 1 < args.size()) {
+                try {
+                    for (const std::string& cpu : splitList(args[++i])) {
+                        options.shard_cpus.push_back(std::stoi(cpu));
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid shard CPU list: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--numa") {
+            options.numa = true;
+        } else if (arg == "--io-cpus") {
+            if (i + 1 < args.size()) {
+                try {
+                    for (const std::string& cpu : splitList(args[++i])) {
+                        options.io_cpus.push_back(std::stoi(cpu));
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid I/O CPU list: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--busy-poll") {
+            options.busy_poll = true;
+        } else if (arg == "--render-cpu") {
+            if (i + 1 < args.size()) {
+                try {
+                    options.render_cpu = std::stoi(args[++i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid render CPU: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--shm") {
+            if (i + 1 < args.size()) {
+                options.shm_name = args[++i];
+            }
+        } else if (arg == "--shm-cpu") {
+            if (i + 1 < args.size()) {
+                try {
+                    options.shm_cpu = std::stoi(args[++i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid shared-memory publisher CPU: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--checkpoint-dir") {
+            if (i + 1 < args.size()) {
+                options.checkpoint_dir = args[++i];
+            }
+        } else if (arg == "--checkpoint-interval") {
+            if (i + 1 < args.size()) {
+                try {
+                    options.checkpoint_interval = std::max(std::stoi(args[++i]), 0);
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid checkpoint interval: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--capture") {
+            if (i + 1 < args.size()) {
+                options.capture_path = args[++i];
+            }
+        } else if (arg == "--replay") {
+            if (i + 1 < args.size()) {
+                options.replay_path = args[++i];
+            }
+        } else if (arg == "--replay-speed") {
+            if (i + 1 < args.size()) {
+                try {
+                    options.replay_speed = std::stod(args[++i]);
+                } catch (const std::exception& e) {
+                    std::cerr << "Invalid replay speed: " << args[i] << std::endl;
+                }
+            }
+        } else if (arg == "--venue") {
+            if (i + 1 < args.size()) {
+                const std::string& venue = args[++i];
+                if (venue == "coinbase" || venue == "kraken") {
+                    options.venue = venue;
+                } else {
+                    std::cerr << "Invalid venue: " << venue << std::endl;
+                }
+            }
         } else if (arg == "-t" || arg == "--highlight-time") {
             if (i + 1 < args.size()) {
                 try {
@@ -128,6 +358,325 @@ ProgramOptions parseCommandLine(int argc, char* argv[]) {
     return options;
 }
 
+// Print per-shard counters (nothing when not sharded)
+void printShardStats(const std::vector<clunk::ShardStats>& shard_stats) {
+    for (size_t i = 0; i < shard_stats.size(); ++i) {
+        const clunk::ShardStats& shard = shard_stats[i];
+        std::cout << "Shard " << i << ": " << shard.keys << " products, "
+                  << shard.pipeline.processed << "/" << shard.pipeline.enqueued << " messages processed, "
+                  << "max depth " << shard.pipeline.max_depth << "/" << shard.pipeline.capacity << ", "
+                  << shard.pipeline.full_events << " full-ring waits";
+        if (shard.cpu >= 0) {
+            std::cout << ", CPU " << shard.cpu << (shard.pinned ? "" : " (not pinned)");
+        }
+        if (shard.node >= 0) {
+            std::cout << ", node " << shard.node;
+        }
+        std::cout << std::endl;
+    }
+}
+
+// Level changes that took the books' best-level fast path, over `symbols`
+clunk::TouchStats totalTouchStats(clunk::FeedHandler& handler, const std::vector<std::string>& symbols) {
+    clunk::TouchStats total;
+    for (const std::string& symbol : symbols) {
+        if (std::shared_ptr<clunk::BookView> book = handler.getBookView(symbol)) {
+            total += book->getTouchStats();
+        }
+    }
+    return total;
+}
+
+// Print the touch fast path's hit rate (nothing if no level changed)
+void printTouchStats(const clunk::TouchStats& stats) {
+    if (stats.updates == 0) {
+        return;
+    }
+    std::cout << "Touch fast path: " << std::fixed << std::setprecision(1) << stats.hitRate() * 100.0
+              << "% of " << stats.updates << " level changes (" << stats.at_touch << " at the best, "
+              << stats.inside << " inside it)" << std::endl;
+}
+
+// Print each pipeline stage's latency percentiles
+void printLatencyStats(const clunk::FeedHandler& handler) {
+    std::vector<clunk::LatencySummary> stages = handler.getLatencyStats();
+    if (stages.empty()) {
+        return;
+    }
+
+    std::cout << "Latency (us)      count        p50        p99      p99.9        max" << std::endl;
+    for (const clunk::LatencySummary& stage : stages) {
+        std::cout << std::left << std::setw(10) << clunk::latencyStageName(stage.stage) << std::right
+                  << std::setw(12) << stage.count << std::fixed << std::setprecision(2)
+                  << std::setw(11) << stage.p50_ns / 1000.0
+                  << std::setw(11) << stage.p99_ns / 1000.0
+                  << std::setw(11) << stage.p999_ns / 1000.0
+                  << std::setw(11) << stage.max_ns / 1000.0 << std::endl;
+    }
+}
+
+// Publish every subscribed book to shared memory if requested (null if not)
+std::unique_ptr<clunk::ShmPublisher> startShmPublisher(clunk::FeedHandler& handler,
+                                                       const ProgramOptions& options) {
+    if (options.shm_name.empty()) {
+        return nullptr;
+    }
+
+    auto publisher = std::make_unique<clunk::ShmPublisher>(options.shm_name, options.depth,
+                                                           std::max(options.symbols.size(), size_t(1)));
+    for (const std::string& symbol : options.symbols) {
+        if (!publisher->addBook(symbol, handler.getBookView(symbol))) {
+            std::cerr << Color::YELLOW << "Not publishing " << symbol << " to shared memory" << Color::RESET << std::endl;
+        }
+    }
+
+    // A pinned publisher has the core to itself: spin for the freshest copy
+    publisher->start(options.shm_cpu >= 0 ? std::chrono::microseconds(0) : clunk::ShmPublisher::kDefaultPollInterval,
+                     options.shm_cpu);
+    std::cout << "Publishing books to shared memory " << options.shm_name << std::endl;
+    return publisher;
+}
+
+// Print the shared-memory publisher's counters (nothing without one)
+void printShmStats(const clunk::ShmPublisher* publisher) {
+    if (!publisher) {
+        return;
+    }
+    clunk::ShmPublisherStats stats = publisher->getStats();
+    std::cout << "Shared memory: " << stats.quotes << " top-of-book and " << stats.depths << " depth writes over "
+              << stats.passes << " sweeps" << std::endl;
+}
+
+// Print a one-line summary every refresh period while `active()` holds, in
+// place of the display: the first symbol's touch, book updates per second
+// over every symbol, the feed's end-to-end latency and, given a counter,
+// resyncs so far
+void runHeadless(clunk::FeedHandler& handler, const ProgramOptions& options,
+                 const std::atomic<uint64_t>* resyncs, const std::function<bool()>& active) {
+    auto totalSequence = [&handler, &options]() {
+        uint64_t total = 0;
+        for (const std::string& symbol : options.symbols) {
+            if (std::shared_ptr<clunk::BookView> book = handler.getBookView(symbol)) {
+                total += book->getTopOfBook().sequence;
+            }
+        }
+        return total;
+    };
+
+    auto period = std::chrono::milliseconds(std::max(options.refresh_rate, 1));
+    auto last_time = std::chrono::steady_clock::now();
+    uint64_t last_sequence = totalSequence();
+
+    while (running && active()) {
+        // Sleep in short steps so Ctrl+C and the end of a replay are prompt
+        auto next = last_time + period;
+        while (running && active() && std::chrono::steady_clock::now() < next) {
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                next - std::chrono::steady_clock::now(), std::chrono::milliseconds(100)));
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        uint64_t sequence = totalSequence();
+        double seconds = std::chrono::duration<double>(now - last_time).count();
+        double rate = seconds > 0.0 ? static_cast<double>(sequence - last_sequence) / seconds : 0.0;
+        last_time = now;
+        last_sequence = sequence;
+
+        std::time_t wall = std::time(nullptr);
+        std::tm local{};
+        char clock[16] = "";
+        if (localtime_r(&wall, &local)) {
+            std::strftime(clock, sizeof(clock), "%H:%M:%S", &local);
+        }
+
+        std::cout << clock << " " << options.symbols.front();
+        if (std::shared_ptr<clunk::BookView> book = handler.getBookView(options.symbols.front())) {
+            clunk::TopOfBook top = book->getTopOfBook();
+            const clunk::ProductScale& scale = book->getScale();
+            std::cout << " " << (top.hasBid() ? scale.formatPrice(top.bid_price) : "-")
+                      << " / " << (top.hasAsk() ? scale.formatPrice(top.ask_price) : "-");
+        }
+        std::cout << " | " << std::fixed << std::setprecision(1) << rate << " updates/s";
+        for (const clunk::LatencySummary& stage : handler.getLatencyStats()) {
+            if (stage.stage == clunk::LatencyStage::TOTAL && stage.count > 0) {
+                std::cout << " | latency p50 " << std::setprecision(2) << stage.p50_ns / 1000.0
+                          << " us, p99 " << stage.p99_ns / 1000.0 << " us";
+            }
+        }
+        if (resyncs) {
+            std::cout << " | resyncs " << resyncs->load();
+        }
+        std::cout << std::endl;
+    }
+}
+
+// Rebuild the books from a capture file; displays the first symbol when
+// paced (or prints stats lines when headless), then reports replay
+// throughput
+int runReplay(const ProgramOptions& options) {
+    try {
+        clunk::ReplayFeedHandler replay(options.replay_path, options.book_mode);
+        clunk::CoinbaseHandler& handler = replay.getHandler();
+        handler.setVerboseLogging(options.verbose);
+        replay.setSpeed(options.replay_speed);
+        replay.setReplayCpu(options.io_cpus.empty() ? -1 : options.io_cpus.front());
+
+        if (options.shards > 0) {
+            size_t capacity = options.pipeline_capacity > 0 ? options.pipeline_capacity : kDefaultShardCapacity;
+            handler.enableSharding(options.shards, capacity, options.shard_cpus, options.numa);
+            std::cout << "Sharded parsing: " << options.shards << " workers, " << capacity << " slot rings" << std::endl;
+        }
+
+        subscribeAll(handler, options.symbols);
+        std::unique_ptr<clunk::ShmPublisher> publisher = startShmPublisher(handler, options);
+
+        std::cout << "Replaying " << Color::YELLOW << options.replay_path << Color::RESET;
+        if (options.replay_speed > 0.0) {
+            std::cout << " at " << options.replay_speed << "x recorded pace";
+        } else {
+            std::cout << " as fast as possible";
+        }
+        std::cout << std::endl;
+
+        replay.connect();
+
+        if (options.headless) {
+            runHeadless(handler, options, nullptr, [&replay]() { return replay.isConnected(); });
+        } else if (options.replay_speed > 0.0) {
+            clunk::ConsoleVisualizer visualizer(handler.getBookView(options.symbols.front()));
+            visualizer.setDepth(options.depth);
+            visualizer.setChangeHighlighting(options.highlight_changes);
+            visualizer.setChangeHighlightDuration(options.highlight_duration);
+            visualizer.setLatencySource([&handler]() { return handler.getLatencyStats(); });
+            visualizer.setRenderCpu(options.render_cpu);
+            visualizer.start(options.refresh_rate);
+
+            while (running && replay.isConnected()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            visualizer.stop();
+        } else {
+            while (running && replay.isConnected()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+        replay.disconnect();
+        if (publisher) {
+            publisher->stop();
+        }
+
+        clunk::ReplayStats stats = replay.getStats();
+        double seconds = std::chrono::duration<double>(stats.elapsed).count();
+        std::cout << Color::GREEN << (stats.finished ? "Replay complete" : "Replay stopped") << Color::RESET << std::endl;
+        std::cout << "Replayed " << stats.messages << " messages (" << std::fixed << std::setprecision(1)
+                  << static_cast<double>(stats.bytes) / (1024.0 * 1024.0) << " MiB) in "
+                  << std::setprecision(3) << seconds << " s: "
+                  << std::setprecision(0) << stats.messagesPerSecond() << " messages/s" << std::endl;
+        if (stats.truncated) {
+            std::cerr << Color::YELLOW << "Capture ends partway through a record" << Color::RESET << std::endl;
+        }
+        printShardStats(handler.getShardStats());
+        printTouchStats(totalTouchStats(handler, options.symbols));
+        printLatencyStats(handler);
+        printShmStats(publisher.get());
+    } catch (const std::exception& e) {
+        std::cerr << Color::RED << "Error: " << e.what() << Color::RESET << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// Stream any other venue through VenueFeedHandler; displays the first
+// symbol (or prints stats lines when headless) until Ctrl+C
+int runVenue(ProgramOptions options) {
+    // The default symbol is Coinbase's; Kraken names it BTC/USD
+    if (options.symbols == std::vector<std::string>{"BTC-USD"}) {
+        options.symbols = {"BTC/USD"};
+    }
+
+    try {
+        std::atomic<uint64_t> resyncs{0};
+        clunk::VenueFeedHandler handler(std::make_unique<clunk::KrakenDecoder>());
+        const char* venue = handler.getDecoder().getName();
+        handler.setVerboseLogging(options.verbose);
+        handler.setResyncCallback([&resyncs](const std::string&, clunk::ResyncReason) { ++resyncs; });
+
+        if (!options.io_cpus.empty() || options.busy_poll) {
+            handler.setIoThread(options.io_cpus.empty() ? -1 : options.io_cpus.front(), options.busy_poll);
+        }
+        if (options.shards > 0) {
+            size_t capacity = options.pipeline_capacity > 0 ? options.pipeline_capacity : kDefaultShardCapacity;
+            handler.enableSharding(options.shards, capacity, options.shard_cpus, options.numa);
+            std::cout << "Sharded parsing: " << options.shards << " workers, " << capacity << " slot rings" << std::endl;
+        }
+
+        std::cout << "Connecting to " << venue << "..." << std::endl;
+        handler.connect();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(15);
+        while (running && !handler.isConnected() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (!handler.isConnected()) {
+            std::cerr << Color::RED << "Failed to connect to " << venue << Color::RESET << std::endl;
+            handler.disconnect();
+            return 1;
+        }
+        std::cout << Color::GREEN << "Connected to " << venue << Color::RESET << std::endl;
+
+        subscribeAll(handler, options.symbols);
+        std::unique_ptr<clunk::ShmPublisher> publisher = startShmPublisher(handler, options);
+
+        std::cout << "Waiting for the books (this may take a moment)..." << std::endl;
+        if (!handler.waitForBooks(options.symbols, std::chrono::seconds(15))) {
+            std::cerr << Color::YELLOW << "Not every book is ready yet; showing them as they arrive" << Color::RESET
+                      << std::endl;
+        }
+
+        std::unique_ptr<clunk::ConsoleVisualizer> visualizer;
+        if (!options.headless) {
+            visualizer = std::make_unique<clunk::ConsoleVisualizer>(handler.getBookView(options.symbols.front()));
+            visualizer->setDepth(options.depth);
+            visualizer->setChangeHighlighting(options.highlight_changes);
+            visualizer->setChangeHighlightDuration(options.highlight_duration);
+            visualizer->setLatencySource([&handler]() { return handler.getLatencyStats(); });
+            visualizer->setRenderCpu(options.render_cpu);
+            visualizer->start(options.refresh_rate);
+        }
+
+        std::cout << "Press " << Color::BOLD << "Ctrl+C" << Color::RESET << " to exit" << std::endl;
+        if (options.headless) {
+            runHeadless(handler, options, &resyncs, []() { return true; });
+        }
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        clunk::TouchStats touch_stats = totalTouchStats(handler, options.symbols);
+        if (visualizer) {
+            visualizer->stop();
+        }
+        if (publisher) {
+            publisher->stop();
+        }
+        std::cout << "Disconnecting from " << venue << "..." << std::endl;
+        handler.disconnect();
+
+        std::cout << Color::GREEN << "Shutdown complete" << Color::RESET << std::endl;
+        std::cout << "Reconnects: " << handler.getReconnectCount() << ", book resyncs: " << resyncs
+                  << ", malformed messages: " << handler.getDecodeErrorCount() << std::endl;
+        printShardStats(handler.getShardStats());
+        printTouchStats(touch_stats);
+        printLatencyStats(handler);
+        printShmStats(publisher.get());
+    } catch (const std::exception& e) {
+        std::cerr << Color::RED << "Error: " << e.what() << Color::RESET << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
 // Main function
 int main(int argc, char* argv[]) {
     // Set up signal handling
@@ -145,19 +694,36 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
-    std::cout << "Starting with symbol: " << Color::YELLOW << options.symbol << Color::RESET << std::endl;
+    if (!options.replay_path.empty()) {
+        return runReplay(options);
+    }
+    if (options.venue != "coinbase") {
+        return runVenue(options);
+    }
+
+    const std::string& display_symbol = options.symbols.front();
+
+    std::cout << "Starting with symbol" << (options.symbols.size() > 1 ? "s: " : ": ") << Color::YELLOW;
+    for (size_t i = 0; i < options.symbols.size(); ++i) {
+        std::cout << (i ? ", " : "") << options.symbols[i];
+    }
+    std::cout << Color::RESET << std::endl;
     std::cout << "Order book depth: " << options.depth << std::endl;
     std::cout << "Refresh rate: " << options.refresh_rate << " ms" << std::endl;
     std::cout << "Change highlighting: " << (options.highlight_changes ? "enabled" : "disabled") << std::endl;
     if (options.highlight_changes) {
         std::cout << "Highlight duration: " << options.highlight_duration << " refreshes" << std::endl;
     }
+    std::cout << "Book model: " << (options.book_mode == clunk::BookMode::LEVELS ? "levels" : "orders") << std::endl;
     std::cout << "Using Coinbase Exchange for market data" << std::endl;
     std::cout << std::endl;
 
     try {
+        // Count books that had to be rebuilt (gaps, drift, reconnects)
+        std::atomic<uint64_t> resyncs{0};
+
         // Create the Coinbase handler
-        clunk::CoinbaseHandler handler;
+        clunk::CoinbaseHandler handler(options.book_mode);
         
         // Set verbose logging based on command line option
         handler.setVerboseLogging(options.verbose);
@@ -166,6 +732,63 @@ int main(int argc, char* argv[]) {
             std::cout << "Created Coinbase handler with verbose logging enabled" << std::endl;
         }
 
+        // Report resyncs as they happen
+        handler.setResyncCallback([&resyncs, verbose = options.verbose](const std::string& symbol, clunk::ResyncReason reason) {
+            ++resyncs;
+            if (verbose) {
+                const char* why = reason == clunk::ResyncReason::SEQUENCE_GAP ? "sequence gap"
+                                : reason == clunk::ResyncReason::VALIDATION ? "ticker mismatch" : "reconnect";
+                std::cerr << "Resyncing " << symbol << " (" << why << ")" << std::endl;
+            }
+        });
+
+        // Open several connections if requested
+        if (options.connections > 1 || options.redundancy > 1) {
+            handler.enableConnectionPool(options.connections, options.redundancy);
+            std::cout << "Connections: " << handler.getConnectionCount() << ", each product on "
+                      << std::min(std::max<size_t>(options.redundancy, 1), handler.getConnectionCount()) << std::endl;
+        }
+
+        // Place the I/O threads if requested
+        if (!options.io_cpus.empty() || options.busy_poll) {
+            handler.setIoThreads(options.io_cpus, options.busy_poll);
+            std::cout << "I/O threads: " << (options.busy_poll ? "busy polling" : "blocking");
+            for (size_t i = 0; i < options.io_cpus.size(); ++i) {
+                std::cout << (i ? "," : ", CPUs ") << options.io_cpus[i];
+            }
+            std::cout << std::endl;
+        }
+
+        // Record the session if requested
+        if (!options.capture_path.empty()) {
+            handler.enableCapture(options.capture_path);
+            std::cout << "Capturing to " << options.capture_path << std::endl;
+        }
+
+        // Move parsing off the I/O thread if requested
+        if (options.shards > 0) {
+            size_t capacity = options.pipeline_capacity > 0 ? options.pipeline_capacity : kDefaultShardCapacity;
+            handler.enableSharding(options.shards, capacity, options.shard_cpus, options.numa);
+            std::cout << "Sharded parsing: " << options.shards << " workers, " << capacity << " slot rings" << std::endl;
+        } else if (options.pipeline_capacity > 0) {
+            handler.enablePipeline(options.pipeline_capacity, options.worker_cpu);
+            std::cout << "Pipelined parsing: " << options.pipeline_capacity << " slot ring";
+            if (options.worker_cpu >= 0) {
+                std::cout << ", worker on CPU " << options.worker_cpu;
+            }
+            std::cout << std::endl;
+        }
+
+        // Checkpoint the books, starting from the last ones saved
+        if (!options.checkpoint_dir.empty()) {
+            handler.enableCheckpoints(options.checkpoint_dir, std::chrono::seconds(options.checkpoint_interval));
+            std::cout << "Checkpointing to " << options.checkpoint_dir;
+            if (options.checkpoint_interval > 0) {
+                std::cout << " every " << options.checkpoint_interval << "s";
+            }
+            std::cout << std::endl;
+        }
+
         // Connect to Coinbase
         std::cout << "Connecting to Coinbase..." << std::endl;
         handler.connect();
@@ -201,34 +824,43 @@ int main(int argc, char* argv[]) {
 
         std::cout << Color::GREEN << "Connected to Coinbase" << Color::RESET << std::endl;
 
-        // Subscribe to the symbol
-        std::cout << "Subscribing to " << Color::YELLOW << options.symbol << Color::RESET << "..." << std::endl;
-        handler.subscribe(options.symbol);
+        // Subscribe to the symbols
+        std::cout << "Subscribing to " << Color::YELLOW << options.symbols.size() << " symbol(s)" << Color::RESET << "..." << std::endl;
+        subscribeAll(handler, options.symbols);
+        std::unique_ptr<clunk::ShmPublisher> publisher = startShmPublisher(handler, options);
 
-        // Wait for initial data
-        std::cout << "Waiting for initial data (this may take a moment)..." << std::endl;
-        std::this_thread::sleep_for(std::chrono::seconds(3));
+        // Wait for every book to be built from its snapshot or checkpoint
+        std::cout << "Waiting for the books (this may take a moment)..." << std::endl;
+        if (!handler.waitForBooks(options.symbols, std::chrono::seconds(15))) {
+            std::cerr << Color::YELLOW << "Not every book is ready yet; showing them as they arrive" << Color::RESET
+                      << std::endl;
+        }
 
         // Get the order book
-        auto order_book = handler.getOrderBook(options.symbol);
+        auto order_book = handler.getBookView(display_symbol);
         if (!order_book) {
-            std::cerr << Color::RED << "No order book found for " << options.symbol << Color::RESET << std::endl;
+            std::cerr << Color::RED << "No order book found for " << display_symbol << Color::RESET << std::endl;
             std::cerr << "This symbol may not be available in the Coinbase API." << std::endl;
             std::cerr << "Try a different symbol like ETH-BTC or BTC-USD." << std::endl;
             handler.disconnect();
             return 1;
         }
 
-        // Create the console visualizer
-        clunk::ConsoleVisualizer visualizer(order_book);
-        
-        // Apply user options to visualizer
-        visualizer.setDepth(options.depth);
-        visualizer.setChangeHighlighting(options.highlight_changes);
-        visualizer.setChangeHighlightDuration(options.highlight_duration);
-        
-        // Start visualization
-        visualizer.start(options.refresh_rate);
+        // Create the console visualizer, unless only stats lines are wanted
+        std::unique_ptr<clunk::ConsoleVisualizer> visualizer;
+        if (!options.headless) {
+            visualizer = std::make_unique<clunk::ConsoleVisualizer>(order_book);
+
+            // Apply user options to visualizer
+            visualizer->setDepth(options.depth);
+            visualizer->setChangeHighlighting(options.highlight_changes);
+            visualizer->setChangeHighlightDuration(options.highlight_duration);
+            visualizer->setLatencySource([&handler]() { return handler.getLatencyStats(); });
+            visualizer->setRenderCpu(options.render_cpu);
+
+            // Start visualization
+            visualizer->start(options.refresh_rate);
+        }
 
         // Main loop - keep running until Ctrl+C
         std::cout << "Press " << Color::BOLD << "Ctrl+C" << Color::RESET << " to exit" << std::endl;
@@ -236,42 +868,68 @@ int main(int argc, char* argv[]) {
         // Track execution time for performance metrics
         auto start_time = std::chrono::high_resolution_clock::now();
         
+        // Connections recover on their own; the handler restores the
+        // subscriptions and rebuilds the books
+        if (options.headless) {
+            runHeadless(handler, options, &resyncs, []() { return true; });
+        }
         while (running) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-            // Check if we're still connected
-            if (!handler.isConnected()) {
-                std::cout << Color::YELLOW << "Connection to Coinbase lost, attempting to reconnect..." << Color::RESET << std::endl;
-
-                // Try to reconnect
-                handler.connect();
-
-                // Wait a bit for the connection to establish
-                std::this_thread::sleep_for(std::chrono::seconds(2));
-
-                if (handler.isConnected()) {
-                    std::cout << Color::GREEN << "Reconnected to Coinbase, resubscribing to " << options.symbol << "..." << Color::RESET << std::endl;
-                    handler.subscribe(options.symbol);
-                }
-            }
         }
 
         // Calculate execution time
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::seconds>(end_time - start_time).count();
         
-        // Clean up
-        std::cout << "Unsubscribing from " << options.symbol << "..." << std::endl;
-        handler.unsubscribe(options.symbol);
+        // Read the books' counters while they still exist
+        clunk::TouchStats touch_stats = totalTouchStats(handler, options.symbols);
+
+        // Clean up; checkpointed books have to outlive the connections, whose
+        // closing ends their subscriptions anyway
+        if (options.checkpoint_dir.empty()) {
+            std::cout << "Unsubscribing..." << std::endl;
+            for (const std::string& symbol : options.symbols) {
+                handler.unsubscribe(symbol);
+            }
+        }
+
+        if (visualizer) {
+            std::cout << "Stopping visualization..." << std::endl;
+            visualizer->stop();
+        }
 
-        std::cout << "Stopping visualization..." << std::endl;
-        visualizer.stop();
+        if (publisher) {
+            publisher->stop();
+        }
 
         std::cout << "Disconnecting from Coinbase..." << std::endl;
         handler.disconnect();
 
+        if (!options.checkpoint_dir.empty()) {
+            size_t saved = handler.saveCheckpoints();
+            std::cout << "Saved " << saved << " checkpoint(s) to " << options.checkpoint_dir << " ("
+                      << handler.getCheckpointCount() << " written, " << handler.getCheckpointFailures()
+                      << " failed this session)" << std::endl;
+        }
+
         std::cout << Color::GREEN << "Shutdown complete" << Color::RESET << std::endl;
         std::cout << "Session duration: " << duration << " seconds" << std::endl;
+        std::cout << "Reconnects: " << handler.getReconnectCount() << ", book resyncs: " << resyncs << std::endl;
+        if (!options.capture_path.empty()) {
+            std::cout << "Captured " << handler.getCapturedCount() << " messages to " << options.capture_path << std::endl;
+        }
+
+        if (options.pipeline_capacity > 0) {
+            clunk::PipelineStats stats = handler.getPipelineStats();
+            std::cout << "Pipeline: " << stats.processed << "/" << stats.enqueued << " messages processed, "
+                      << "max depth " << stats.max_depth << "/" << stats.capacity << ", "
+                      << stats.full_events << " full-ring waits" << std::endl;
+        }
+
+        printShardStats(handler.getShardStats());
+        printTouchStats(touch_stats);
+        printLatencyStats(handler);
+        printShmStats(publisher.get());
     } catch (const std::exception& e) {
         std::cerr << Color::RED << "Error: " << e.what() << Color::RESET << std::endl;
         return 1;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace clunk {
+
+// Which pooled connections each product is subscribed on
+//
+// A new product goes to the least loaded connection and, for each further
+// copy, the connections after it, so products spread evenly and every
+// copy of a product is on a different connection. The first live
+// connection of a product's route is its primary: the one whose
+// unsequenced messages are applied and which asks for snapshots.
+//
+// Not thread-safe: the owner guards it.
+class ConnectionRoutes {
+public:
+    // Constructor (one connection, one copy)
+    ConnectionRoutes() { reset(1, 1); }
+
+    // Forget every route and spread later ones over `connections`
+    // connections with `redundancy` copies (clamped to 1..connections)
+    void reset(size_t connections, size_t redundancy) {
+        connections = std::max<size_t>(connections, 1);
+        redundancy_ = std::min(std::max<size_t>(redundancy, 1), connections);
+        load_.assign(connections, 0);
+        routes_.clear();
+    }
+
+    // Route `symbol`, or keep its existing route; returns the route
+    const std::vector<size_t>& assign(const std::string& symbol) {
+        std::vector<size_t>& route = routes_[symbol];
+        if (route.empty()) {
+            size_t first = static_cast<size_t>(std::min_element(load_.begin(), load_.end()) - load_.begin());
+            for (size_t i = 0; i < redundancy_; ++i) {
+                size_t connection = (first + i) % load_.size();
+                route.push_back(connection);
+                ++load_[connection];
+            }
+        }
+        return route;
+    }
+
+    // Forget `symbol`'s route
+    void release(const std::string& symbol) {
+        auto it = routes_.find(symbol);
+        if (it == routes_.end()) {
+            return;
+        }
+        for (size_t connection : it->second) {
+            --load_[connection];
+        }
+        routes_.erase(it);
+    }
+
+    // `symbol`'s route (null if it has none)
+    const std::vector<size_t>* find(const std::string& symbol) const {
+        auto it = routes_.find(symbol);
+        return it != routes_.end() ? &it->second : nullptr;
+    }
+
+    // Products routed over `connection`
+    std::vector<std::string> symbolsOn(size_t connection) const {
+        std::vector<std::string> symbols;
+        for (const auto& [symbol, route] : routes_) {
+            if (std::find(route.begin(), route.end(), connection) != route.end()) {
+                symbols.push_back(symbol);
+            }
+        }
+        return symbols;
+    }
+
+    // First connection of `route` for which `is_up(connection)` holds (the
+    // first one if none does)
+    template <typename IsUp>
+    static size_t primary(const std::vector<size_t>& route, IsUp&& is_up) {
+        for (size_t connection : route) {
+            if (is_up(connection)) {
+                return connection;
+            }
+        }
+        return route.front();
+    }
+
+    // Copies per product, and products routed over a connection
+    size_t getRedundancy() const { return redundancy_; }
+    size_t getLoad(size_t connection) const { return load_[connection]; }
+
+private:
+    size_t redundancy_ = 1;
+    std::vector<size_t> load_;
+    std::unordered_map<std::string, std::vector<size_t>> routes_;
+};
+
+} // namespace clunk
@@ -0,0 +1,68 @@
+#include "https_client.h"
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/ssl.hpp>
+#include <iostream>
+
+namespace clunk {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+using tcp = net::ip::tcp;
+
+bool httpsGet(const std::string& host, const std::string& port, const std::string& target, std::string& body,
+              std::chrono::seconds timeout) {
+    try {
+        net::io_context ioc;
+
+        // Same TLS settings as the feed connections
+        ssl::context ctx(ssl::context::tlsv12_client);
+        ctx.set_options(ssl::context::default_workarounds | ssl::context::no_sslv2 | ssl::context::no_sslv3);
+        ctx.set_verify_mode(ssl::verify_none);
+
+        beast::ssl_stream<beast::tcp_stream> stream(ioc, ctx);
+        if (!SSL_set_tlsext_host_name(stream.native_handle(), host.c_str())) {
+            std::cerr << "Could not set SNI hostname for " << host << std::endl;
+            return false;
+        }
+
+        tcp::resolver resolver(ioc);
+        beast::get_lowest_layer(stream).expires_after(timeout);
+        beast::get_lowest_layer(stream).connect(resolver.resolve(host, port));
+        stream.handshake(ssl::stream_base::client);
+
+        http::request<http::empty_body> request(http::verb::get, target, 11);
+        request.set(http::field::host, host);
+        request.set(http::field::user_agent, "clunk");
+        request.set(http::field::accept, "application/json");
+        http::write(stream, request);
+
+        beast::flat_buffer buffer;
+        http::response_parser<http::string_body> parser;
+        parser.body_limit(kMaxHttpsBody);
+        http::read(stream, buffer, parser);
+
+        http::response<http::string_body> response = parser.release();
+        if (response.result() != http::status::ok) {
+            std::cerr << "GET " << host << target << " returned " << response.result_int() << std::endl;
+            return false;
+        }
+        body = std::move(response.body());
+
+        // The server may drop the connection without a close_notify
+        beast::error_code ignored;
+        beast::get_lowest_layer(stream).expires_after(std::chrono::seconds(1));
+        stream.shutdown(ignored);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "GET " << host << target << " failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+} // namespace clunk
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace clunk {
+
+// Largest response body httpsGet() accepts (a busy product's level-3 book
+// runs to tens of megabytes)
+constexpr size_t kMaxHttpsBody = 256 * 1024 * 1024;
+
+// Fetch https://`host`:`port``target` with a blocking GET into `body`
+//
+// For occasional requests from a thread that may block (e.g. REST book
+// snapshots); the feed itself stays on WebSocketClient. Each call opens
+// its own TLS session and gives up after `timeout`. Returns false, with
+// the reason on stderr, on any failure or a non-200 status.
+bool httpsGet(const std::string& host, const std::string& port, const std::string& target, std::string& body,
+              std::chrono::seconds timeout = std::chrono::seconds(10));
+
+} // namespace clunk
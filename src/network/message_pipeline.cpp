@@ -0,0 +1,105 @@
+#include "message_pipeline.h"
+#include "utils/thread_utils.h"
+#include <iostream>
+
+namespace clunk {
+
+namespace {
+
+// Empty polls the worker spins through before it starts yielding
+constexpr int kSpinPolls = 1024;
+
+} // namespace
+
+MessagePipeline::MessagePipeline(size_t capacity, Handler handler, int worker_cpu, bool local_memory)
+    : queue_(capacity), handler_(std::move(handler)), worker_cpu_(worker_cpu), local_memory_(local_memory) {
+}
+
+MessagePipeline::~MessagePipeline() {
+    stop();
+}
+
+void MessagePipeline::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+
+    worker_ = std::thread([this]() { run(); });
+}
+
+void MessagePipeline::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void MessagePipeline::push(std::string_view payload, const MessageTiming& timing) {
+    Incoming incoming{payload, timing};
+    if (!queue_.tryPush(incoming)) {
+        full_events_.fetch_add(1, std::memory_order_relaxed);
+        while (!queue_.tryPush(incoming)) {
+            std::this_thread::yield();
+        }
+    }
+    enqueued_.fetch_add(1, std::memory_order_relaxed);
+
+    size_t depth = queue_.size();
+    if (depth > max_depth_.load(std::memory_order_relaxed)) {
+        max_depth_.store(depth, std::memory_order_relaxed);
+    }
+}
+
+PipelineStats MessagePipeline::getStats() const {
+    PipelineStats stats;
+    stats.depth = queue_.size();
+    stats.max_depth = max_depth_.load(std::memory_order_relaxed);
+    stats.capacity = queue_.capacity();
+    stats.enqueued = enqueued_.load(std::memory_order_relaxed);
+    stats.processed = processed_.load(std::memory_order_relaxed);
+    stats.full_events = full_events_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MessagePipeline::run() {
+    if (worker_cpu_ >= 0) {
+        pinned_ = pinCurrentThread(worker_cpu_);
+        if (!pinned_) {
+            std::cerr << "Could not pin pipeline worker to CPU " << worker_cpu_ << std::endl;
+        } else if (local_memory_ && !preferNode(cpuNode(worker_cpu_))) {
+            std::cerr << "Could not prefer the local NUMA node of CPU " << worker_cpu_ << std::endl;
+        }
+    }
+
+    int idle_polls = 0;
+    while (running_.load(std::memory_order_acquire)) {
+        if (drain() != 0) {
+            idle_polls = 0;
+        } else if (++idle_polls > kSpinPolls) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Finish whatever the producer queued before stop()
+    drain();
+}
+
+size_t MessagePipeline::drain() {
+    size_t count = 0;
+    while (Slot* slot = queue_.front()) {
+        try {
+            handler_(slot->payload, slot->timing);
+        } catch (const std::exception& e) {
+            std::cerr << "Error in pipeline handler: " << e.what() << std::endl;
+        }
+        queue_.pop();
+        processed_.fetch_add(1, std::memory_order_relaxed);
+        ++count;
+    }
+    return count;
+}
+
+} // namespace clunk
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "pipeline_latency.h"
+#include "utils/spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace clunk {
+
+// Counters reported by a MessagePipeline
+struct PipelineStats {
+    size_t depth = 0;           // Payloads currently queued
+    size_t max_depth = 0;       // Deepest the ring has been
+    size_t capacity = 0;        // Ring size
+    uint64_t enqueued = 0;      // Payloads handed over by the I/O thread
+    uint64_t processed = 0;     // Payloads the worker has finished
+    uint64_t full_events = 0;   // Pushes that found the ring full and waited
+};
+
+// Hands deframed payloads from the I/O thread to a dedicated worker thread
+//
+// The I/O thread only copies each payload (and its receive stamps) into a
+// preallocated ring slot;
+// the worker runs the (parse + book update) callback. When the ring is full
+// the producer waits for a free slot rather than dropping data, since a
+// skipped update would corrupt the book; full_events records how often that
+// back-pressure happened, and so whether the ring or the worker needs to
+// grow.
+class MessagePipeline {
+public:
+    using Handler = std::function<void(std::string_view payload, const MessageTiming& timing)>;
+
+    // Constructor (capacity in payloads; worker_cpu < 0 leaves it
+    // unpinned). With `local_memory`, a pinned worker also prefers its
+    // CPU's NUMA node for the memory it allocates.
+    MessagePipeline(size_t capacity, Handler handler, int worker_cpu = -1, bool local_memory = false);
+
+    // Destructor (drains and joins the worker)
+    ~MessagePipeline();
+
+    MessagePipeline(const MessagePipeline&) = delete;
+    MessagePipeline& operator=(const MessagePipeline&) = delete;
+
+    // Start the worker thread
+    void start();
+
+    // Process everything already queued, then join the worker
+    void stop();
+
+    // Copy a payload into the ring (producer thread only)
+    void push(std::string_view payload, const MessageTiming& timing = {});
+
+    // Snapshot of the counters (any thread)
+    PipelineStats getStats() const;
+
+    // Whether the worker was successfully pinned to its CPU
+    bool isPinned() const { return pinned_; }
+
+private:
+    // A payload as handed over by push()
+    struct Incoming {
+        std::string_view payload;
+        MessageTiming timing;
+    };
+
+    // Ring slot; assignment reuses the string's capacity
+    struct Slot {
+        std::string payload;
+        MessageTiming timing;
+
+        Slot& operator=(const Incoming& incoming) {
+            payload.assign(incoming.payload.data(), incoming.payload.size());
+            timing = incoming.timing;
+            return *this;
+        }
+    };
+
+    SpscQueue<Slot> queue_;
+    Handler handler_;
+    int worker_cpu_;
+    bool local_memory_;
+
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> pinned_{false};
+
+    // Counters (written by one thread each, read by any)
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> processed_{0};
+    std::atomic<uint64_t> full_events_{0};
+    std::atomic<size_t> max_depth_{0};
+
+    // Worker loop
+    void run();
+
+    // Run the handler on every queued payload; returns how many there were
+    size_t drain();
+};
+
+} // namespace clunk
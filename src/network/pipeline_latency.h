@@ -0,0 +1,106 @@
+#pragma once
+
+#include "utils/latency_histogram.h"
+#include "utils/time_utils.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace clunk {
+
+// Stages a market data message passes through, each timed from the end of
+// the one before
+enum class LatencyStage : uint8_t {
+    DEFRAME,    // Socket read completed -> WebSocket frame decoded
+    HANDOFF,    // Frame decoded -> picked up for parsing (the ring wait, if pipelined)
+    PARSE,      // Message decoded
+    APPLY,      // Sequence-checked, applied and published to book readers
+    TOTAL,      // Socket read completed -> book published
+    COUNT
+};
+
+constexpr size_t kLatencyStageCount = static_cast<size_t>(LatencyStage::COUNT);
+
+// Display name of a stage
+inline const char* latencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::DEFRAME: return "deframe";
+        case LatencyStage::HANDOFF: return "handoff";
+        case LatencyStage::PARSE: return "parse";
+        case LatencyStage::APPLY: return "apply";
+        case LatencyStage::TOTAL: return "total";
+        default: return "?";
+    }
+}
+
+// When a message's bytes came off the socket and when its frame was
+// decoded, as readCycles() stamps (0 when unknown)
+struct MessageTiming {
+    uint64_t read = 0;
+    uint64_t deframed = 0;
+};
+
+// Latency of one stage in nanoseconds
+struct LatencySummary {
+    LatencyStage stage = LatencyStage::TOTAL;
+    uint64_t count = 0;
+    double mean_ns = 0.0;
+    double p50_ns = 0.0;
+    double p99_ns = 0.0;
+    double p999_ns = 0.0;
+    double max_ns = 0.0;
+};
+
+// One histogram of cycle counts per stage
+//
+// Like LatencyHistogram, written by one thread at a time: each I/O thread
+// and each shard keeps its own, and readers merge them.
+class StageLatency {
+public:
+    // Record the time from `start` to `end` (readCycles() stamps; skipped
+    // when `start` is unknown, clamped to 0 if the counters disagree)
+    void record(LatencyStage stage, uint64_t start, uint64_t end) {
+        if (start != 0) {
+            histograms_[static_cast<size_t>(stage)].record(end > start ? end - start : 0);
+        }
+    }
+
+    // Add another thread's histograms to these
+    void merge(const StageLatency& other) {
+        for (size_t i = 0; i < kLatencyStageCount; ++i) {
+            histograms_[i].merge(other.histograms_[i]);
+        }
+    }
+
+    // Histogram of one stage, in cycles
+    const LatencyHistogram& get(LatencyStage stage) const {
+        return histograms_[static_cast<size_t>(stage)];
+    }
+
+    // Per-stage summaries in nanoseconds, skipping stages with no samples
+    std::vector<LatencySummary> summarize() const {
+        const CycleClock& clock = CycleClock::instance();
+        std::vector<LatencySummary> summaries;
+        for (size_t i = 0; i < kLatencyStageCount; ++i) {
+            HistogramSummary h = histograms_[i].summarize();
+            if (h.count == 0) {
+                continue;
+            }
+            LatencySummary summary;
+            summary.stage = static_cast<LatencyStage>(i);
+            summary.count = h.count;
+            summary.mean_ns = h.mean * clock.nanosPerCycle();
+            summary.p50_ns = clock.toNanos(h.p50);
+            summary.p99_ns = clock.toNanos(h.p99);
+            summary.p999_ns = clock.toNanos(h.p999);
+            summary.max_ns = clock.toNanos(h.max);
+            summaries.push_back(summary);
+        }
+        return summaries;
+    }
+
+private:
+    LatencyHistogram histograms_[kLatencyStageCount];
+};
+
+} // namespace clunk
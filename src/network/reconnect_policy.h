@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace clunk {
+
+// When a WebSocketClient reconnects and how it checks a live connection
+//
+// After a failure the client waits initial_delay, then twice as long
+// after each further failure in a row, up to max_delay. A successful
+// handshake resets the count. While connected it pings every
+// ping_interval and treats idle_timeout without any incoming frame
+// (data, pong or feed heartbeat) as a dead connection.
+struct ReconnectPolicy {
+    bool enabled = true;
+    std::chrono::milliseconds initial_delay{50};
+    std::chrono::milliseconds max_delay{5000};
+    std::chrono::milliseconds ping_interval{5000};     // 0: no pings or idle check
+    std::chrono::milliseconds idle_timeout{10000};     // 0: no idle check
+
+    // Delay before reconnect attempt `failures` (0 for the first retry)
+    std::chrono::milliseconds delayFor(uint32_t failures) const {
+        std::chrono::milliseconds delay = initial_delay;
+        for (uint32_t i = 0; i < failures && delay < max_delay; ++i) {
+            delay *= 2;
+        }
+        return std::min(delay, max_delay);
+    }
+};
+
+} // namespace clunk
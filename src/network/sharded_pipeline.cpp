@@ -0,0 +1,112 @@
+#include "sharded_pipeline.h"
+#include "utils/thread_utils.h"
+#include <algorithm>
+
+namespace clunk {
+
+ShardedPipeline::ShardedPipeline(size_t shard_count, size_t capacity, Handler handler,
+                                 const std::vector<int>& worker_cpus, bool local_memory) {
+    shard_count = std::max<size_t>(shard_count, 1);
+    shards_.resize(shard_count);
+    push_mutexes_ = std::make_unique<std::mutex[]>(shard_count);
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        Shard& shard = shards_[i];
+        shard.cpu = i < worker_cpus.size() ? worker_cpus[i] : -1;
+        shard.node = local_memory ? cpuNode(shard.cpu) : -1;
+        shard.pipeline = std::make_unique<MessagePipeline>(
+            capacity,
+            [handler, i](std::string_view payload, const MessageTiming& timing) { handler(i, payload, timing); },
+            shard.cpu, local_memory);
+    }
+}
+
+void ShardedPipeline::start() {
+    for (Shard& shard : shards_) {
+        shard.pipeline->start();
+    }
+}
+
+void ShardedPipeline::stop() {
+    for (Shard& shard : shards_) {
+        shard.pipeline->stop();
+    }
+}
+
+size_t ShardedPipeline::assign(const std::string& key) {
+    std::lock_guard<std::mutex> lock(routes_mutex_);
+    std::shared_ptr<const RouteTable> current = routes_.load();
+    auto it = current->find(key);
+    if (it != current->end()) {
+        return it->second;
+    }
+
+    size_t target = 0;
+    for (size_t i = 1; i < shards_.size(); ++i) {
+        if (shards_[i].keys < shards_[target].keys) {
+            target = i;
+        }
+    }
+    ++shards_[target].keys;
+
+    auto routes = std::make_shared<RouteTable>(*current);
+    routes->emplace(key, target);
+    routes_.publish(std::move(routes));
+    return target;
+}
+
+void ShardedPipeline::unassign(const std::string& key) {
+    std::lock_guard<std::mutex> lock(routes_mutex_);
+    std::shared_ptr<const RouteTable> current = routes_.load();
+    auto it = current->find(key);
+    if (it == current->end()) {
+        return;
+    }
+    --shards_[it->second].keys;
+
+    auto routes = std::make_shared<RouteTable>(*current);
+    routes->erase(key);
+    routes_.publish(std::move(routes));
+}
+
+size_t ShardedPipeline::shardFor(std::string_view key) const {
+    if (shards_.size() == 1 || key.empty()) {
+        return 0;
+    }
+
+    const RouteTable& routes = routes_.get();
+    auto it = routes.find(key);
+    return it != routes.end() ? it->second : 0;
+}
+
+void ShardedPipeline::push(std::string_view key, std::string_view payload, const MessageTiming& timing) {
+    push(shardFor(key), payload, timing);
+}
+
+void ShardedPipeline::push(size_t shard, std::string_view payload, const MessageTiming& timing) {
+    if (multi_producer_) {
+        std::lock_guard<std::mutex> lock(push_mutexes_[shard]);
+        shards_[shard].pipeline->push(payload, timing);
+        return;
+    }
+    shards_[shard].pipeline->push(payload, timing);
+}
+
+std::vector<ShardStats> ShardedPipeline::getStats() const {
+    std::vector<ShardStats> stats(shards_.size());
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            stats[i].keys = shards_[i].keys;
+        }
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        stats[i].pipeline = shards_[i].pipeline->getStats();
+        stats[i].cpu = shards_[i].cpu;
+        stats[i].pinned = shards_[i].pipeline->isPinned();
+        stats[i].node = shards_[i].node;
+    }
+    return stats;
+}
+
+} // namespace clunk
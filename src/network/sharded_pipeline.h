@@ -0,0 +1,111 @@
+#pragma once
+
+#include "message_pipeline.h"
+#include "utils/published.h"
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clunk {
+
+// Counters for one shard of a ShardedPipeline
+struct ShardStats {
+    PipelineStats pipeline;     // The shard's ring and worker
+    size_t keys = 0;            // Keys (e.g. products) routed to the shard
+    int cpu = -1;               // CPU the worker was asked to run on (-1: any)
+    bool pinned = false;        // Whether pinning succeeded
+    int node = -1;              // NUMA node of its memory (-1: not placed)
+};
+
+// Fans payloads out from one producer thread to N MessagePipelines, one
+// worker thread per shard, by a routing key such as the product ID
+//
+// Each key is assigned to the shard with the fewest keys, so every payload
+// for a key runs on one worker and in order. State owned by a key (its
+// book) is then only ever touched by that worker, and different keys
+// never contend. Payloads whose key is not assigned go to shard 0.
+//
+// Routes are an immutable table replaced whole by assign() and
+// unassign() (see Published), so routing a payload looks its key up
+// without a lock or a copy of the key, and never waits on subscribers
+// or getStats().
+class ShardedPipeline {
+public:
+    // Called on shard `shard`'s worker for each payload routed there
+    using Handler = std::function<void(size_t shard, std::string_view payload, const MessageTiming& timing)>;
+
+    // Constructor; shard i's worker is pinned to worker_cpus[i] if given
+    // and non-negative. With `local_memory`, each pinned worker allocates
+    // from its CPU's NUMA node (see nodeFor()).
+    ShardedPipeline(size_t shard_count, size_t capacity, Handler handler,
+                    const std::vector<int>& worker_cpus = {}, bool local_memory = false);
+
+    ShardedPipeline(const ShardedPipeline&) = delete;
+    ShardedPipeline& operator=(const ShardedPipeline&) = delete;
+
+    // Number of shards
+    size_t size() const { return shards_.size(); }
+
+    // Allow push() from several producer threads (e.g. one per connection),
+    // serializing pushes into each shard's ring. Call before start().
+    void setMultiProducer(bool enabled) { multi_producer_ = enabled; }
+
+    // Start every worker
+    void start();
+
+    // Process everything already queued, then join every worker
+    void stop();
+
+    // Route `key` to the least loaded shard (or keep its existing one);
+    // returns the shard
+    size_t assign(const std::string& key);
+
+    // Forget `key`'s route
+    void unassign(const std::string& key);
+
+    // Shard for `key` (0 if unassigned; any thread)
+    size_t shardFor(std::string_view key) const;
+
+    // NUMA node state owned by `shard` should be allocated on (-1: no
+    // placement, or the node is unknown)
+    int nodeFor(size_t shard) const { return shards_[shard].node; }
+
+    // Copy a payload into the ring of the shard for `key` (the producer
+    // thread only, unless multi-producer)
+    void push(std::string_view key, std::string_view payload, const MessageTiming& timing = {});
+
+    // Copy a payload into a given shard's ring (as above)
+    void push(size_t shard, std::string_view payload, const MessageTiming& timing = {});
+
+    // Per-shard counters (any thread)
+    std::vector<ShardStats> getStats() const;
+
+private:
+    struct Shard {
+        std::unique_ptr<MessagePipeline> pipeline;
+        size_t keys = 0;
+        int cpu = -1;
+        int node = -1;
+    };
+
+    std::vector<Shard> shards_;
+
+    // One lock per shard ring, taken only in multi-producer mode
+    std::unique_ptr<std::mutex[]> push_mutexes_;
+    bool multi_producer_ = false;
+
+    // Key to shard; std::less<> lets producers look keys up by string_view
+    using RouteTable = std::map<std::string, size_t, std::less<>>;
+
+    // Current routes, replaced (never modified) under routes_mutex_, which
+    // also guards the shards' key counts
+    Published<RouteTable> routes_;
+    mutable std::mutex routes_mutex_;
+};
+
+} // namespace clunk
@@ -1,4 +1,5 @@
 #include "websocket_client.h"
+#include "utils/thread_utils.h"
 #include <iostream>
 #include <openssl/err.h>
 #include <string>
@@ -7,6 +8,19 @@
 
 namespace clunk {
 
+namespace {
+
+// Minimum free space offered to each socket read
+constexpr size_t kReadChunk = 16384;
+
+// Give up looking for the end of the handshake response after this much
+constexpr size_t kMaxHandshakeSize = 16384;
+
+// Client frame masking key (fixed for simplicity)
+constexpr std::array<uint8_t, 4> kMaskKey = {0x12, 0x34, 0x56, 0x78};
+
+} // namespace
+
 WebSocketClient::WebSocketClient(const std::string& host, const std::string& port)
     : host_(host), port_(port), running_(false), connected_(false), verbose_logging_(false) {
     
@@ -36,25 +50,119 @@ void WebSocketClient::connect() {
     }
 
     running_ = true;
+    failures_ = 0;
+    sessions_ = 0;
+    reconnects_ = 0;
+    if (pipeline_) {
+        pipeline_->start();
+    }
+
     io_thread_ = std::thread([this]() {
+        if (io_cpu_ >= 0) {
+            io_pinned_ = pinCurrentThread(io_cpu_);
+            if (!io_pinned_) {
+                std::cerr << "Could not pin I/O thread to CPU " << io_cpu_ << std::endl;
+            }
+        }
+
         try {
             // Reset the io_context to make sure it's not in an error state
             ioc_.restart();
 
-            // Create a new SSL stream
-            ssl_stream_ = std::make_unique<ssl::stream<tcp::socket>>(ioc_, ssl_ctx_);
-
             // Connect asynchronously
-            asyncConnect();
-
-            // Run the I/O context
-            ioc_.run();
+            startSession();
+
+            // Run the I/O context (reconnect timers keep it busy); busy
+            // polling finishes the same way, once it is stopped or out of
+            // work
+            if (busy_poll_) {
+                while (!ioc_.stopped()) {
+                    ioc_.poll();
+                }
+            } else {
+                ioc_.run();
+            }
         } catch (const std::exception& e) {
             std::cerr << "Error in connection thread: " << e.what() << std::endl;
         }
     });
 }
 
+void WebSocketClient::startSession() {
+    state_ = ConnectionState::CONNECTING;
+
+    // Frames queued for the previous session are stale
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        send_queue_.clear();
+    }
+
+    // Create a new SSL stream
+    ssl_stream_ = std::make_unique<ssl::stream<tcp::socket>>(ioc_, ssl_ctx_);
+
+    asyncConnect();
+}
+
+void WebSocketClient::onConnectionLost(const char* reason) {
+    // Only the first failure of a session counts; the aborted operations
+    // that follow it are ignored
+    ConnectionState state = state_;
+    if (!running_ || state == ConnectionState::BACKOFF || state == ConnectionState::IDLE) {
+        return;
+    }
+
+    if (connected_.exchange(false)) {
+        std::cerr << "Connection lost (" << reason << ")" << std::endl;
+    }
+
+    boost::system::error_code ignored;
+    heartbeat_timer_.cancel();
+    if (ssl_stream_) {
+        ssl_stream_->lowest_layer().close(ignored);
+    }
+
+    if (!policy_.enabled) {
+        state_ = ConnectionState::IDLE;
+        return;
+    }
+
+    state_ = ConnectionState::BACKOFF;
+    std::chrono::milliseconds delay = policy_.delayFor(failures_++);
+    if (verbose_logging_) {
+        std::cout << "Reconnecting to " << host_ << " in " << delay.count() << " ms" << std::endl;
+    }
+
+    reconnect_timer_.expires_after(delay);
+    reconnect_timer_.async_wait([self = shared_from_this()](boost::system::error_code ec) {
+        if (ec || !self->running_) {
+            return;
+        }
+        ++self->reconnects_;
+        self->startSession();
+    });
+}
+
+void WebSocketClient::scheduleHeartbeat() {
+    if (policy_.ping_interval.count() <= 0) {
+        return;
+    }
+
+    heartbeat_timer_.expires_after(policy_.ping_interval);
+    heartbeat_timer_.async_wait([self = shared_from_this()](boost::system::error_code ec) {
+        if (ec || !self->connected_) {
+            return;
+        }
+
+        auto idle = std::chrono::steady_clock::now() - self->last_receive_;
+        if (self->policy_.idle_timeout.count() > 0 && idle > self->policy_.idle_timeout) {
+            return self->onConnectionLost("no data within idle timeout");
+        }
+
+        self->queueFrame(encodeClientFrame(WsOpcode::PING, {}, kMaskKey));
+        self->scheduleHeartbeat();
+    });
+}
+
 void WebSocketClient::disconnect() {
     if (!running_) {
         return;
@@ -62,6 +170,7 @@ void WebSocketClient::disconnect() {
 
     running_ = false;
     connected_ = false;
+    state_ = ConnectionState::IDLE;
 
     // Close the SSL connection
     if (ssl_stream_) {
@@ -96,6 +205,15 @@ void WebSocketClient::disconnect() {
         io_thread_.join();
     }
 
+    // Drop any pending reconnect or heartbeat
+    reconnect_timer_.cancel();
+    heartbeat_timer_.cancel();
+
+    // Let the worker finish what the I/O thread already queued
+    if (pipeline_) {
+        pipeline_->stop();
+    }
+
     // Reset the SSL stream
     ssl_stream_.reset();
 }
@@ -108,16 +226,41 @@ void WebSocketClient::send(const std::string& message) {
         return;
     }
 
-    // Add message to the send queue
+    if (verbose_logging_) {
+        std::cout << "Sending: " << message << std::endl;
+    }
+
+    queueFrame(encodeClientFrame(WsOpcode::TEXT, message, kMaskKey));
+}
+
+void WebSocketClient::queueFrame(std::string frame) {
+    bool idle;
     {
         std::lock_guard<std::mutex> lock(queue_mutex_);
-        send_queue_.push_back(message);
+        idle = send_queue_.empty();
+        send_queue_.push_back(std::move(frame));
     }
 
-    // Start sending if not already sending
-    if (send_queue_.size() == 1) {
-        asyncSend();
+    // Writes are started on the I/O thread so two never overlap
+    if (idle) {
+        net::post(ioc_, [self = shared_from_this()]() { self->asyncSend(); });
+    }
+}
+
+void WebSocketClient::enablePipeline(size_t capacity, int worker_cpu) {
+    if (running_) {
+        std::cerr << "Cannot enable the message pipeline while connected" << std::endl;
+        return;
     }
+
+    pipeline_ = std::make_unique<MessagePipeline>(
+        capacity,
+        [this](std::string_view payload, const MessageTiming& timing) { dispatchPayload(payload, timing); },
+        worker_cpu);
+}
+
+PipelineStats WebSocketClient::getPipelineStats() const {
+    return pipeline_ ? pipeline_->getStats() : PipelineStats{};
 }
 
 void WebSocketClient::setVerboseLogging(bool enabled) {
@@ -196,8 +339,11 @@ void WebSocketClient::performWebSocketHandshake() {
     // Generate a random WebSocket key
     std::string key = generateWebSocketKey();
     
-    // Construct the WebSocket upgrade request
-    std::string request = 
+    // Start the new connection with an empty receive buffer
+    frame_parser_.reset();
+
+    // Construct the WebSocket upgrade request (kept alive until written)
+    auto request = std::make_shared<std::string>(
         "GET " + path_ + " HTTP/1.1\r\n"
         "Host: " + host_ + "\r\n"
         "Upgrade: websocket\r\n"
@@ -210,13 +356,13 @@ void WebSocketClient::performWebSocketHandshake() {
         "Cache-Control: no-cache\r\n"
         "Pragma: no-cache\r\n"
         "Origin: https://pro.coinbase.com\r\n"
-        "Sec-WebSocket-Protocol: json\r\n\r\n";
+        "Sec-WebSocket-Protocol: json\r\n\r\n");
 
     // Send the request
     net::async_write(
         *ssl_stream_,
-        net::buffer(request),
-        [self = shared_from_this()](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
+        net::buffer(*request),
+        [self = shared_from_this(), request](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
             if (ec) {
                 std::cerr << "Failed to send WebSocket upgrade request: " << ec.message() << std::endl;
                 return self->handleError(ec, "websocket_request");
@@ -229,17 +375,33 @@ void WebSocketClient::performWebSocketHandshake() {
 }
 
 void WebSocketClient::readWebSocketResponse() {
-    auto buffer = std::make_shared<std::vector<char>>(2048);
-    
+    // The response is read straight into the frame buffer, so frames the
+    // server sends right behind it are kept rather than dropped
+    char* data = frame_parser_.prepare(2048);
+
     ssl_stream_->async_read_some(
-        net::buffer(*buffer),
-        [self = shared_from_this(), buffer](boost::system::error_code ec, std::size_t bytes_transferred) {
+        net::buffer(data, frame_parser_.writable()),
+        [self = shared_from_this()](boost::system::error_code ec, std::size_t bytes_transferred) {
             if (ec) {
                 std::cerr << "Failed to read WebSocket response: " << ec.message() << std::endl;
                 return self->handleError(ec, "websocket_response");
             }
 
-            std::string response(buffer->data(), bytes_transferred);
+            self->frame_parser_.commit(bytes_transferred);
+            self->read_cycles_ = readCycles();
+            std::string_view buffered = self->frame_parser_.buffered();
+
+            size_t header_end = buffered.find("\r\n\r\n");
+            if (header_end == std::string_view::npos) {
+                if (buffered.size() < kMaxHandshakeSize) {
+                    // Headers continue in the next read
+                    return self->readWebSocketResponse();
+                }
+                header_end = buffered.size() - 4;
+            }
+
+            std::string response(buffered.substr(0, header_end + 4));
+            self->frame_parser_.consume(response.size());
             if (self->verbose_logging_) {
                 std::cout << "WebSocket response: " << response << std::endl;
             }
@@ -248,10 +410,23 @@ void WebSocketClient::readWebSocketResponse() {
             if (response.find("HTTP/1.1 101") != std::string::npos && 
                 response.find("Upgrade: websocket") != std::string::npos) {
                 self->connected_ = true;
+                self->state_ = ConnectionState::CONNECTED;
+                self->failures_ = 0;
+                self->last_receive_ = std::chrono::steady_clock::now();
                 std::cout << "WebSocket connected to " << self->host_ << self->path_ << std::endl;
 
-                // Start reading messages
-                self->asyncRead();
+                // Restore whatever the owner had set up on the old session
+                bool reconnected = self->sessions_++ > 0;
+                if (self->connect_callback_) {
+                    self->connect_callback_(reconnected);
+                }
+                self->scheduleHeartbeat();
+
+                // Handle any frames that arrived with the response, then
+                // start reading messages
+                if (self->drainFrames()) {
+                    self->asyncRead();
+                }
             } else {
                 std::cerr << "WebSocket handshake failed. Response: " << response << std::endl;
                 boost::system::error_code err = boost::system::errc::make_error_code(boost::system::errc::protocol_error);
@@ -311,30 +486,32 @@ void WebSocketClient::asyncRead() {
         return;
     }
 
-    // Allocate a buffer for the message
-    auto buffer = std::make_shared<std::vector<char>>(16384);
+    // Read into the reusable frame buffer (grown to fit large frames)
+    char* data = frame_parser_.prepare(kReadChunk);
 
-    // Read a message into our buffer
     ssl_stream_->async_read_some(
-        net::buffer(*buffer),
-        [self = shared_from_this(), buffer](boost::system::error_code ec, std::size_t bytes_transferred) {
+        net::buffer(data, frame_parser_.writable()),
+        [self = shared_from_this()](boost::system::error_code ec, std::size_t bytes_transferred) {
             if (ec) {
                 if (ec == net::error::eof) {
-                    self->connected_ = false;
                     if (self->verbose_logging_) {
                         std::cout << "WebSocket connection closed" << std::endl;
                     }
+                    self->onConnectionLost("closed by peer");
                 } else {
                     self->handleError(ec, "read");
                 }
                 return;
             }
 
-            // Convert to string
-            std::string message(buffer->data(), bytes_transferred);
+            self->frame_parser_.commit(bytes_transferred);
+            self->read_cycles_ = readCycles();
+            self->last_receive_ = std::chrono::steady_clock::now();
 
-            // Process the message
-            self->processMessage(message);
+            // Process every complete frame; a partial one waits for more bytes
+            if (!self->drainFrames()) {
+                return;
+            }
 
             // Continue reading if still connected
             if (self->connected_ && self->running_) {
@@ -344,235 +521,124 @@ void WebSocketClient::asyncRead() {
     );
 }
 
+bool WebSocketClient::drainFrames() {
+    WsMessage message;
+    for (;;) {
+        switch (frame_parser_.next(message)) {
+        case WsFrameParser::Result::MESSAGE:
+            handleFrame(message, MessageTiming{read_cycles_, readCycles()});
+            break;
+        case WsFrameParser::Result::NEED_MORE:
+            return true;
+        case WsFrameParser::Result::ERROR: {
+            boost::system::error_code err =
+                boost::system::errc::make_error_code(boost::system::errc::protocol_error);
+            handleError(err, "frame");
+            return false;
+        }
+        }
+    }
+}
+
 void WebSocketClient::asyncSend() {
     if (!connected_ || !running_) {
         return;
     }
 
-    std::string message;
+    // The front frame stays queued (and its buffer alive) until written
+    const std::string* frame;
     {
         std::lock_guard<std::mutex> lock(queue_mutex_);
         if (send_queue_.empty()) {
             return;
         }
-        message = send_queue_.front();
+        frame = &send_queue_.front();
     }
 
-    // WebSocket framing - creating a simple frame for text data
-    std::vector<uint8_t> frame;
-    
-    // First byte: FIN bit (1) + opcode (1 for text)
-    frame.push_back(0x81);
-    
-    // Second byte onwards: payload length + masking
-    size_t payload_length = message.size();
-    
-    if (payload_length < 126) {
-        // Mask bit (1) + 7-bit payload length
-        frame.push_back(static_cast<uint8_t>(0x80 | payload_length));
-    } else if (payload_length <= 0xFFFF) {
-        // Mask bit (1) + 126
-        frame.push_back(0x80 | 126);
-        // 16-bit length
-        frame.push_back(static_cast<uint8_t>((payload_length >> 8) & 0xFF));
-        frame.push_back(static_cast<uint8_t>(payload_length & 0xFF));
-    } else {
-        // Mask bit (1) + 127
-        frame.push_back(0x80 | 127);
-        // 64-bit length
-        for (int i = 7; i >= 0; --i) {
-            frame.push_back(static_cast<uint8_t>((payload_length >> (i * 8)) & 0xFF));
-        }
-    }
-    
-    // Masking key (4 bytes)
-    std::array<uint8_t, 4> mask_key = {0x12, 0x34, 0x56, 0x78}; // Fixed for simplicity
-    for (uint8_t byte : mask_key) {
-        frame.push_back(byte);
-    }
-    
-    // Apply masking to payload
-    for (size_t i = 0; i < message.size(); ++i) {
-        frame.push_back(message[i] ^ mask_key[i % 4]);
-    }
-    
     // Send the WebSocket frame
     net::async_write(
         *ssl_stream_,
-        net::buffer(frame),
-        [self = shared_from_this(), message](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
+        net::buffer(*frame),
+        [self = shared_from_this()](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
             if (ec) {
                 self->handleError(ec, "write");
                 return;
             }
 
-            if (self->verbose_logging_) {
-                std::cout << "Sent: " << message << std::endl;
-            }
-
-            // Remove the sent message and send the next one if available
+            // Remove the sent frame and send the next one if available
+            bool more;
             {
                 std::lock_guard<std::mutex> lock(self->queue_mutex_);
                 self->send_queue_.pop_front();
-                
-                if (!self->send_queue_.empty()) {
-                    // Send the next message
-                    self->asyncSend();
-                }
+                more = !self->send_queue_.empty();
+            }
+
+            if (more) {
+                self->asyncSend();
             }
         }
     );
 }
 
 void WebSocketClient::handleError(const boost::system::error_code& ec, const char* what) {
-    std::cerr << "Error in " << what << ": " << ec.message() << std::endl;
-    
-    if (connected_) {
-        connected_ = false;
-        std::cerr << "Connection lost" << std::endl;
+    // Operations cancelled by closing a lost session's socket
+    if (ec == net::error::operation_aborted) {
+        return;
     }
+
+    std::cerr << "Error in " << what << ": " << ec.message() << std::endl;
+    onConnectionLost(what);
 }
 
-void WebSocketClient::processMessage(const std::string& message) {
-    // Simplified WebSocket frame parsing
-    if (message.empty()) {
-        return;
-    }
-    
-    // Extract payload from WebSocket frame - improved implementation
-    size_t header_size = 2;
-    uint8_t first_byte = static_cast<uint8_t>(message[0]);
-    uint8_t second_byte = static_cast<uint8_t>(message[1]);
-    bool is_masked = second_byte & 0x80;
-    uint8_t payload_len = second_byte & 0x7F;
-    size_t real_payload_len = 0;
-    
-    if (payload_len == 126) {
-        // 16-bit length
-        if (message.size() < 4) {
-            if (verbose_logging_) {
-                std::cerr << "Incomplete WebSocket frame" << std::endl;
-            }
-            return;
-        }
-        header_size += 2;
-        real_payload_len = (static_cast<uint16_t>(static_cast<uint8_t>(message[2])) << 8) | 
-                           static_cast<uint16_t>(static_cast<uint8_t>(message[3]));
-    } else if (payload_len == 127) {
-        // 64-bit length (we only use the lowest 32 bits)
-        if (message.size() < 10) {
-            if (verbose_logging_) {
-                std::cerr << "Incomplete WebSocket frame" << std::endl;
-            }
-            return;
-        }
-        header_size += 8;
-        real_payload_len = 0;
-        for (size_t i = 0; i < 8; ++i) {
-            real_payload_len = (real_payload_len << 8) | static_cast<uint8_t>(message[2 + i]);
-        }
-    } else {
-        real_payload_len = payload_len;
-    }
-    
-    // If masked, we need to account for the 4-byte mask
-    if (is_masked) {
-        header_size += 4;
-    }
-    
-    if (message.size() < header_size + real_payload_len) {
-        if (verbose_logging_) {
-            std::cerr << "Incomplete WebSocket frame: expected " << (header_size + real_payload_len) 
-                  << " bytes, got " << message.size() << " bytes" << std::endl;
-        }
-        return;
-    }
-    
-    // Extract and process the payload
-    std::string payload;
-    
-    if (is_masked) {
-        // Apply masking if needed
-        std::array<uint8_t, 4> mask;
-        for (size_t i = 0; i < 4; ++i) {
-            mask[i] = static_cast<uint8_t>(message[header_size - 4 + i]);
-        }
-        
-        payload.resize(real_payload_len);
-        for (size_t i = 0; i < real_payload_len; ++i) {
-            if (header_size + i < message.size()) {
-                payload[i] = message[header_size + i] ^ mask[i % 4];
-            } else {
-                if (verbose_logging_) {
-                    std::cerr << "Frame boundary error in masked payload" << std::endl;
-                }
-                return;
-            }
-        }
-    } else {
-        // No masking
-        if (header_size + real_payload_len <= message.size()) {
-            payload = message.substr(header_size, real_payload_len);
-        } else {
-            if (verbose_logging_) {
-                std::cerr << "Frame boundary error in unmasked payload" << std::endl;
-            }
-            return;
-        }
-    }
-    
-    // Check if this is a control frame (opcode 0x8, 0x9, or 0xA)
-    uint8_t opcode = first_byte & 0x0F;
-    if (opcode == 0x8) {
-        // Close frame
+void WebSocketClient::handleFrame(const WsMessage& message, const MessageTiming& timing) {
+    switch (message.opcode) {
+    case WsOpcode::CLOSE:
         if (verbose_logging_) {
             std::cout << "Received WebSocket close frame" << std::endl;
         }
-        connected_ = false;
+        onConnectionLost("close frame");
         return;
-    } else if (opcode == 0x9) {
-        // Ping frame, respond with pong
+
+    case WsOpcode::PING:
+        // Respond with a (masked) pong carrying the same payload
         if (verbose_logging_) {
             std::cout << "Received WebSocket ping" << std::endl;
         }
-        // Send pong with the same payload
-        std::vector<uint8_t> pong_frame;
-        pong_frame.push_back(0x8A); // FIN bit + Pong opcode
-        
-        if (payload.size() < 126) {
-            pong_frame.push_back(static_cast<uint8_t>(payload.size()));
-        } else if (payload.size() <= 0xFFFF) {
-            pong_frame.push_back(126);
-            pong_frame.push_back(static_cast<uint8_t>((payload.size() >> 8) & 0xFF));
-            pong_frame.push_back(static_cast<uint8_t>(payload.size() & 0xFF));
-        }
-        
-        for (auto c : payload) {
-            pong_frame.push_back(static_cast<uint8_t>(c));
-        }
-        
-        net::async_write(
-            *ssl_stream_,
-            net::buffer(pong_frame),
-            [](boost::system::error_code, std::size_t) {}
-        );
+        queueFrame(encodeClientFrame(WsOpcode::PONG, message.payload, kMaskKey));
         return;
-    } else if (opcode == 0xA) {
-        // Pong frame
+
+    case WsOpcode::PONG:
         if (verbose_logging_) {
             std::cout << "Received WebSocket pong" << std::endl;
         }
         return;
+
+    default:
+        break;
     }
-    
+
     // Process the text or binary payload
-    if (message_callback_ && !payload.empty()) {
+    if (message.payload.empty()) {
+        return;
+    }
+
+    latency_.record(LatencyStage::DEFRAME, timing.read, timing.deframed);
+
+    if (pipeline_) {
+        pipeline_->push(message.payload, timing);
+    } else {
+        dispatchPayload(message.payload, timing);
+    }
+}
+
+void WebSocketClient::dispatchPayload(std::string_view payload, const MessageTiming& timing) {
+    if (message_callback_) {
         try {
             if (verbose_logging_) {
                 std::cout << "Received payload (" << payload.size() << " bytes): " 
-                      << (payload.size() > 100 ? payload.substr(0, 100) + "..." : payload) << std::endl;
+                      << payload.substr(0, 100) << (payload.size() > 100 ? "..." : "") << std::endl;
             }
-            message_callback_(payload);
+            message_callback_(payload, timing);
         } catch (const std::exception& e) {
             std::cerr << "Error in message callback: " << e.what() << std::endl;
         }
@@ -1,10 +1,17 @@
 #pragma once
 
+#include "message_pipeline.h"
+#include "pipeline_latency.h"
+#include "reconnect_policy.h"
+#include "websocket_frame.h"
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/system/error_code.hpp>
+#include <chrono>
 #include <functional>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <thread>
 #include <atomic>
@@ -17,10 +24,29 @@ namespace net = boost::asio;
 namespace ssl = boost::asio::ssl;
 using tcp = boost::asio::ip::tcp;
 
-// Callback type for receiving messages
-using MessageCallback = std::function<void(const std::string&)>;
+// Callback type for receiving messages (the view is only valid during the
+// call: it points into the client's receive buffer). `timing` carries the
+// message's socket read and deframe stamps.
+using MessageCallback = std::function<void(std::string_view payload, const MessageTiming& timing)>;
+
+// Callback run on the I/O thread each time the WebSocket handshake
+// completes; `reconnected` is false for the first session after connect()
+using ConnectCallback = std::function<void(bool reconnected)>;
+
+// Where a client is in its connection cycle
+enum class ConnectionState : uint8_t {
+    IDLE,           // Not started, stopped, or failed with reconnects off
+    CONNECTING,     // Resolving, TCP/TLS or WebSocket handshake
+    CONNECTED,      // Handshake done, frames flowing
+    BACKOFF         // Waiting out the delay before the next attempt
+};
 
 // Simple WebSocket client for connecting to exchange APIs
+//
+// Failures (I/O errors, a close frame, or an idle connection) are handled
+// on the I/O thread: the socket is closed and a timer schedules the next
+// attempt per the ReconnectPolicy, so recovery never waits on a caller
+// polling isConnected().
 class WebSocketClient : public std::enable_shared_from_this<WebSocketClient> {
 public:
     // Constructor
@@ -42,17 +68,57 @@ public:
     void setMessageCallback(MessageCallback callback) {
         message_callback_ = callback;
     }
+
+    // Set the callback for completed handshakes (call before connect())
+    void setConnectCallback(ConnectCallback callback) {
+        connect_callback_ = std::move(callback);
+    }
+
+    // Set the reconnect and heartbeat settings (call before connect())
+    void setReconnectPolicy(const ReconnectPolicy& policy) {
+        policy_ = policy;
+    }
     
     // Set the path for WebSocket handshake
     void setPath(const std::string& path) {
         path_ = path;
     }
 
+    // Hand payloads to a dedicated worker thread through a lock-free ring of
+    // `capacity` payloads instead of running the callback on the I/O thread
+    // (worker_cpu < 0 leaves the worker unpinned). Call before connect().
+    void enablePipeline(size_t capacity, int worker_cpu = -1);
+
+    // Pipeline counters (all zero when pipelining is off)
+    PipelineStats getPipelineStats() const;
+
+    // Pin the I/O thread to `cpu` (< 0: leave it floating). Call before
+    // connect().
+    void setIoCpu(int cpu) { io_cpu_ = cpu; }
+
+    // Spin the I/O thread on poll() instead of sleeping in run(), trading
+    // a busy core for no wakeup latency on each read. Best paired with
+    // setIoCpu() on an otherwise idle core. Call before connect().
+    void setBusyPoll(bool enabled) { busy_poll_ = enabled; }
+
+    // Whether the I/O thread was successfully pinned to its CPU
+    bool isIoPinned() const { return io_pinned_; }
+
     // Check if connected
     bool isConnected() const {
         return connected_;
     }
 
+    // Current connection state
+    ConnectionState getState() const { return state_; }
+
+    // Reconnect attempts made since connect()
+    uint64_t getReconnectCount() const { return reconnects_; }
+
+    // Time from socket read to decoded frame, per message (DEFRAME stage;
+    // read from any thread)
+    const StageLatency& getLatency() const { return latency_; }
+
     // Enable/disable verbose logging
     void setVerboseLogging(bool enabled);
 
@@ -66,18 +132,52 @@ private:
     std::unique_ptr<ssl::stream<tcp::socket>> ssl_stream_;
 
     std::thread io_thread_;
+    int io_cpu_ = -1;
+    bool busy_poll_ = false;
+    std::atomic<bool> io_pinned_{false};
     std::atomic<bool> running_;
     std::atomic<bool> connected_;
+    std::atomic<ConnectionState> state_{ConnectionState::IDLE};
 
     MessageCallback message_callback_;
+    ConnectCallback connect_callback_;
+
+    // Reconnect state (I/O thread only, apart from the counter)
+    ReconnectPolicy policy_;
+    net::steady_timer reconnect_timer_{ioc_};
+    net::steady_timer heartbeat_timer_{ioc_};
+    std::chrono::steady_clock::time_point last_receive_;
+    uint32_t failures_ = 0;         // Failed attempts since the last session
+    uint64_t sessions_ = 0;         // Completed handshakes since connect()
+    std::atomic<uint64_t> reconnects_{0};
+
+    // Optional I/O -> worker handoff (null: callback runs on io_thread_)
+    std::unique_ptr<MessagePipeline> pipeline_;
 
-    // Message queue
+    // Encoded outgoing frames; only the I/O thread writes to the socket
     std::deque<std::string> send_queue_;
     std::mutex queue_mutex_;
 
+    // Receive buffer and frame parser (I/O thread only)
+    WsFrameParser frame_parser_;
+
+    // Stamp of the latest completed socket read, and the deframe latency
+    // of the messages it finished (I/O thread only)
+    uint64_t read_cycles_ = 0;
+    StageLatency latency_;
+
     // Verbose logging flag
     bool verbose_logging_;
 
+    // Start a connection attempt on a fresh stream
+    void startSession();
+
+    // Tear down a failed or dead session and schedule the next attempt
+    void onConnectionLost(const char* reason);
+
+    // Ping and check for an idle connection every ping_interval
+    void scheduleHeartbeat();
+
     // Connect to the server asynchronously
     void asyncConnect();
 
@@ -87,11 +187,21 @@ private:
     // Send messages from the queue
     void asyncSend();
 
+    // Queue an encoded frame and start writing if the socket is idle
+    void queueFrame(std::string frame);
+
+    // Parse every complete frame in the receive buffer; false on a
+    // protocol error
+    bool drainFrames();
+
     // Handle connection failure
     void handleError(const boost::system::error_code& ec, const char* what);
 
-    // Process received message
-    void processMessage(const std::string& message);
+    // Handle one reassembled message or control frame
+    void handleFrame(const WsMessage& message, const MessageTiming& timing);
+
+    // Run the message callback on a payload
+    void dispatchPayload(std::string_view payload, const MessageTiming& timing);
     
     // WebSocket-specific methods
     void performWebSocketHandshake();
@@ -0,0 +1,184 @@
+#include "websocket_frame.h"
+#include <algorithm>
+#include <cstring>
+
+namespace clunk {
+
+WsFrameParser::WsFrameParser(size_t initial_capacity, size_t max_message_size)
+    : buffer_(std::max<size_t>(initial_capacity, 16)), max_message_size_(max_message_size) {
+}
+
+char* WsFrameParser::prepare(size_t min_free) {
+    size_t unparsed = write_ - read_;
+
+    // Slide the partial frame (usually a few bytes) back to the front
+    if (unparsed == 0) {
+        read_ = write_ = 0;
+    } else if (read_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + read_, unparsed);
+        read_ = 0;
+        write_ = unparsed;
+    }
+
+    // Make room for the rest of the pending frame in one go
+    size_t needed = std::max(min_free, pending_frame_ > unparsed ? pending_frame_ - unparsed : 0);
+    if (buffer_.size() - write_ < needed) {
+        buffer_.resize(std::max(write_ + needed, buffer_.size() * 2));
+    }
+
+    return buffer_.data() + write_;
+}
+
+WsFrameParser::Result WsFrameParser::next(WsMessage& out) {
+    for (;;) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer_.data() + read_);
+        size_t available = write_ - read_;
+
+        if (available < 2) {
+            pending_frame_ = 2;
+            return Result::NEED_MORE;
+        }
+
+        bool fin = data[0] & 0x80;
+        uint8_t opcode = data[0] & 0x0F;
+        bool masked = data[1] & 0x80;
+        uint64_t length = data[1] & 0x7F;
+        size_t header = 2;
+
+        if (length == 126) {
+            header += 2;
+            if (available < header) {
+                pending_frame_ = header;
+                return Result::NEED_MORE;
+            }
+            length = (static_cast<uint64_t>(data[2]) << 8) | data[3];
+        } else if (length == 127) {
+            header += 8;
+            if (available < header) {
+                pending_frame_ = header;
+                return Result::NEED_MORE;
+            }
+            length = 0;
+            for (size_t i = 0; i < 8; ++i) {
+                length = (length << 8) | data[2 + i];
+            }
+        }
+
+        if (length > max_message_size_) {
+            return Result::ERROR;
+        }
+
+        size_t mask_offset = header;
+        if (masked) {
+            header += 4;
+        }
+
+        size_t frame_size = header + static_cast<size_t>(length);
+        if (available < frame_size) {
+            pending_frame_ = frame_size;
+            return Result::NEED_MORE;
+        }
+        pending_frame_ = 0;
+
+        // Servers must not mask, but unmask in place if one does
+        char* payload = buffer_.data() + read_ + header;
+        if (masked) {
+            uint8_t mask[4];
+            std::memcpy(mask, data + mask_offset, 4);
+            for (size_t i = 0; i < length; ++i) {
+                payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+            }
+        }
+
+        std::string_view view(payload, static_cast<size_t>(length));
+        read_ += frame_size;
+
+        // Control frames are never fragmented and may arrive mid-message
+        if (opcode & 0x8) {
+            if (!fin || length > 125) {
+                return Result::ERROR;
+            }
+            out.opcode = static_cast<WsOpcode>(opcode);
+            out.payload = view;
+            return Result::MESSAGE;
+        }
+
+        if (opcode == static_cast<uint8_t>(WsOpcode::CONTINUATION)) {
+            if (!in_fragment_ || fragments_.size() + view.size() > max_message_size_) {
+                return Result::ERROR;
+            }
+            fragments_.append(view);
+            if (!fin) {
+                continue;
+            }
+            in_fragment_ = false;
+            out.opcode = fragment_opcode_;
+            out.payload = fragments_;
+            return Result::MESSAGE;
+        }
+
+        if (opcode != static_cast<uint8_t>(WsOpcode::TEXT) &&
+            opcode != static_cast<uint8_t>(WsOpcode::BINARY)) {
+            return Result::ERROR;
+        }
+
+        // A new data message may not start inside a fragmented one
+        if (in_fragment_) {
+            return Result::ERROR;
+        }
+
+        if (fin) {
+            // Unfragmented: hand out the bytes where they landed
+            out.opcode = static_cast<WsOpcode>(opcode);
+            out.payload = view;
+            return Result::MESSAGE;
+        }
+
+        in_fragment_ = true;
+        fragment_opcode_ = static_cast<WsOpcode>(opcode);
+        fragments_.assign(view);
+    }
+}
+
+void WsFrameParser::reset() {
+    read_ = write_ = 0;
+    pending_frame_ = 0;
+    in_fragment_ = false;
+    fragments_.clear();
+}
+
+std::string encodeClientFrame(WsOpcode opcode, std::string_view payload,
+                              const std::array<uint8_t, 4>& mask) {
+    std::string frame;
+    frame.reserve(payload.size() + 14);
+
+    // FIN bit + opcode
+    frame.push_back(static_cast<char>(0x80 | static_cast<uint8_t>(opcode)));
+
+    // Mask bit + payload length (7-bit, 16-bit or 64-bit)
+    size_t length = payload.size();
+    if (length < 126) {
+        frame.push_back(static_cast<char>(0x80 | length));
+    } else if (length <= 0xFFFF) {
+        frame.push_back(static_cast<char>(0x80 | 126));
+        frame.push_back(static_cast<char>((length >> 8) & 0xFF));
+        frame.push_back(static_cast<char>(length & 0xFF));
+    } else {
+        frame.push_back(static_cast<char>(0x80 | 127));
+        for (int i = 7; i >= 0; --i) {
+            frame.push_back(static_cast<char>((static_cast<uint64_t>(length) >> (i * 8)) & 0xFF));
+        }
+    }
+
+    // Masking key, then the masked payload
+    for (uint8_t byte : mask) {
+        frame.push_back(static_cast<char>(byte));
+    }
+    for (size_t i = 0; i < length; ++i) {
+        frame.push_back(static_cast<char>(payload[i] ^ mask[i & 3]));
+    }
+
+    return frame;
+}
+
+} // namespace clunk
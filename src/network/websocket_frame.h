@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clunk {
+
+// WebSocket opcodes (RFC 6455 section 5.2)
+enum class WsOpcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xA
+};
+
+// A complete message (data frames reassembled) or control frame
+struct WsMessage {
+    WsOpcode opcode = WsOpcode::TEXT;
+    std::string_view payload;
+
+    bool isControl() const { return static_cast<uint8_t>(opcode) & 0x8; }
+};
+
+// Incremental WebSocket frame parser over a reusable receive buffer
+//
+// Socket reads land directly in the parser's buffer (prepare() / commit()),
+// and next() parses frames in place: a single-frame message is returned as
+// a view into the buffer with no copy, which covers nearly all feed traffic.
+// Only fragmented messages are assembled, into a second reusable buffer.
+// Frames larger than the buffer grow it to fit, and frames split across
+// reads simply wait for more bytes, so neither is dropped or truncated.
+// Control frames interleaved with a fragmented message are returned as they
+// arrive, as the RFC allows.
+//
+// Views returned by next() stay valid until the next call to next() or
+// prepare().
+class WsFrameParser {
+public:
+    enum class Result {
+        MESSAGE,    // `out` holds a message or control frame
+        NEED_MORE,  // Buffered bytes end mid-frame
+        ERROR       // Protocol violation or message over the size limit
+    };
+
+    // Constructor
+    explicit WsFrameParser(size_t initial_capacity = 16384,
+                           size_t max_message_size = 64 * 1024 * 1024);
+
+    // Writable region of at least `min_free` bytes (more if the pending
+    // frame needs it); compacts or grows the buffer as needed
+    char* prepare(size_t min_free);
+
+    // Bytes writable at the pointer returned by prepare()
+    size_t writable() const { return buffer_.size() - write_; }
+
+    // Mark `bytes` written at prepare()'s pointer as received
+    void commit(size_t bytes) { write_ += bytes; }
+
+    // Parse the next message or control frame
+    Result next(WsMessage& out);
+
+    // Received bytes not yet parsed (e.g. a handshake response)
+    std::string_view buffered() const {
+        return std::string_view(buffer_.data() + read_, write_ - read_);
+    }
+
+    // Drop `bytes` from the front of the buffered data
+    void consume(size_t bytes) { read_ += bytes; }
+
+    // Forget buffered data and any partial message (e.g. on reconnect)
+    void reset();
+
+    size_t capacity() const { return buffer_.size(); }
+
+private:
+    std::vector<char> buffer_;      // Receive buffer, [read_, write_) unparsed
+    size_t read_ = 0;
+    size_t write_ = 0;
+    size_t pending_frame_ = 0;      // Size of the incomplete frame at read_
+
+    std::string fragments_;         // Reassembly buffer for fragmented messages
+    WsOpcode fragment_opcode_ = WsOpcode::TEXT;
+    bool in_fragment_ = false;
+
+    size_t max_message_size_;
+};
+
+// Encode a client frame (FIN set, payload masked with `mask` as the RFC
+// requires of clients)
+std::string encodeClientFrame(WsOpcode opcode, std::string_view payload,
+                              const std::array<uint8_t, 4>& mask);
+
+} // namespace clunk
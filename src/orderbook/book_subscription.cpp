@@ -0,0 +1,85 @@
+#include "book_subscription.h"
+#include <algorithm>
+
+namespace clunk {
+
+BookSubscription::BookSubscription(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)),
+      slots_(new SeqLock<LevelDelta>[capacity_]),
+      pending_(new std::atomic<bool>[capacity_]),
+      ready_(capacity_),
+      // Each slot can be released once per pass of its own, plus once
+      // for a delivery that was still in flight when it was reclaimed
+      released_(capacity_ * 2),
+      index_(capacity_),
+      slot_keys_(capacity_, 0),
+      in_use_(capacity_, 0) {
+    free_.reserve(capacity_);
+    for (size_t i = capacity_; i > 0; --i) {
+        pending_[i - 1].store(false, std::memory_order_relaxed);
+        free_.push_back(static_cast<uint32_t>(i - 1));
+    }
+}
+
+void BookSubscription::publish(const LevelDelta& delta) {
+    reclaim();
+
+    uint64_t key = keyFor(delta.side, delta.price);
+    uint32_t slot;
+    if (const uint32_t* found = index_.find(key)) {
+        slot = *found;
+    } else {
+        if (free_.empty()) {
+            // Every slot holds a distinct pending price: lose this change
+            // and have the consumer resynchronise from a snapshot
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            resync_.store(true, std::memory_order_release);
+            return;
+        }
+        slot = free_.back();
+        free_.pop_back();
+        index_.insert(key, slot);
+        slot_keys_[slot] = key;
+        in_use_[slot] = 1;
+    }
+
+    slots_[slot].store(delta);
+
+    // Queue the slot unless it is already waiting for the consumer, in
+    // which case the consumer will read the value just stored
+    if (!pending_[slot].exchange(true, std::memory_order_acq_rel)) {
+        ready_.tryPush(slot);
+    }
+}
+
+void BookSubscription::reclaim() {
+    while (uint32_t* next = released_.front()) {
+        uint32_t slot = *next;
+        released_.pop();
+
+        // A slot changed again since its delivery is still queued; one
+        // released twice is only freed once
+        if (in_use_[slot] && !pending_[slot].load(std::memory_order_acquire)) {
+            index_.erase(slot_keys_[slot]);
+            in_use_[slot] = 0;
+            free_.push_back(slot);
+        }
+    }
+}
+
+std::shared_ptr<BookSubscription> BookSubscribers::add(size_t capacity) {
+    auto subscription = std::make_shared<BookSubscription>(capacity);
+    subscriptions_.push_back(subscription);
+    return subscription;
+}
+
+bool BookSubscribers::remove(const std::shared_ptr<BookSubscription>& subscription) {
+    auto it = std::find(subscriptions_.begin(), subscriptions_.end(), subscription);
+    if (it == subscriptions_.end()) {
+        return false;
+    }
+    subscriptions_.erase(it);
+    return true;
+}
+
+} // namespace clunk
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "order.h"
+#include "utils/flat_hash_map.h"
+#include "utils/seqlock.h"
+#include "utils/spsc_queue.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace clunk {
+
+// New aggregated size of one level, as delivered to book subscribers
+//
+// Sizes are absolute, so a delta can be applied (or applied again) without
+// knowing what came before it. `sequence` is the book mutation that made
+// the change visible, matching TopOfBook::sequence and
+// DepthSnapshot::sequence.
+struct LevelDelta {
+    OrderSide side = OrderSide::BUY;
+    Price price = 0;
+    Quantity size = 0;          // 0 when the level was removed
+    uint64_t sequence = 0;
+};
+
+// One consumer's feed of level deltas from a book
+//
+// The book's writer publishes every level change into the subscription
+// while it holds the book mutex, which costs a hash probe and a seqlock
+// store and never waits on the consumer. Pending changes are kept one per
+// (side, price): if the consumer falls behind, later changes to a price
+// overwrite the queued one instead of queueing behind it, so a slow
+// consumer sees fewer, fresher deltas rather than an ever longer backlog.
+//
+// Ready slots travel to the consumer over one SPSC ring and consumed slots
+// come back over another, so the writer recycles them without locking. A
+// delta may occasionally be delivered twice; sizes are absolute, so
+// re-applying it is harmless.
+//
+// When the book is replaced wholesale (snapshot, clear), or more distinct
+// prices are pending than the subscription has slots, deltas alone can no
+// longer rebuild the book. needsResync() then reports true once: the
+// consumer should take a getDepthSnapshot() and ignore deltas whose
+// sequence is not newer than the snapshot's.
+//
+// Exactly one thread may consume (poll() and needsResync()).
+class BookSubscription {
+public:
+    static constexpr size_t kDefaultCapacity = 4096;
+
+    // Constructor (`capacity` distinct prices may be pending at once)
+    explicit BookSubscription(size_t capacity = kDefaultCapacity);
+
+    BookSubscription(const BookSubscription&) = delete;
+    BookSubscription& operator=(const BookSubscription&) = delete;
+
+    // Call `f(const LevelDelta&)` for up to `max` pending deltas, oldest
+    // price first; returns the number delivered (consumer only)
+    template <typename F>
+    size_t poll(F&& f, size_t max = std::numeric_limits<size_t>::max()) {
+        size_t delivered = 0;
+        while (delivered < max) {
+            uint32_t* next = ready_.front();
+            if (next == nullptr) {
+                break;
+            }
+            uint32_t slot = *next;
+            ready_.pop();
+
+            // Clear the flag before reading, so a change the writer makes
+            // from here on queues the slot again rather than being missed
+            pending_[slot].exchange(false, std::memory_order_acq_rel);
+            LevelDelta delta = slots_[slot].load();
+            f(delta);
+
+            released_.tryPush(slot);
+            ++delivered;
+        }
+        return delivered;
+    }
+
+    // Whether deltas alone no longer describe the book; true once per
+    // snapshot, clear or overflow (consumer only)
+    bool needsResync() { return resync_.exchange(false, std::memory_order_acquire); }
+
+    // Changes dropped because every slot was pending
+    uint64_t getDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Distinct prices that may be pending at once
+    size_t capacity() const { return capacity_; }
+
+    // Queue (or overwrite) the pending delta for the change's price
+    // (book writer only)
+    void publish(const LevelDelta& delta);
+
+    // Report that the book was replaced wholesale (book writer only)
+    void invalidate() { resync_.store(true, std::memory_order_release); }
+
+private:
+    size_t capacity_;
+
+    // Latest delta per slot, and whether it is queued in ready_
+    std::unique_ptr<SeqLock<LevelDelta>[]> slots_;
+    std::unique_ptr<std::atomic<bool>[]> pending_;
+
+    SpscQueue<uint32_t> ready_;         // Writer -> consumer
+    SpscQueue<uint32_t> released_;      // Consumer -> writer
+
+    // Writer side: which slot holds each pending price
+    FlatHashMap<uint64_t, uint32_t> index_;
+    std::vector<uint64_t> slot_keys_;
+    std::vector<uint8_t> in_use_;
+    std::vector<uint32_t> free_;
+
+    std::atomic<bool> resync_{false};
+    std::atomic<uint64_t> dropped_{0};
+
+    static uint64_t keyFor(OrderSide side, Price price) {
+        return (static_cast<uint64_t>(price) << 1) | (side == OrderSide::SELL ? 1 : 0);
+    }
+
+    // Return consumed slots to the free list (writer only)
+    void reclaim();
+};
+
+// The subscriptions of one book, fanned out to by its writer
+//
+// Mutated and published to under the owning book's mutex.
+class BookSubscribers {
+public:
+    // Register a new subscription
+    std::shared_ptr<BookSubscription> add(size_t capacity);
+
+    // Drop a subscription; returns false if it was not registered
+    bool remove(const std::shared_ptr<BookSubscription>& subscription);
+
+    bool empty() const { return subscriptions_.empty(); }
+    size_t size() const { return subscriptions_.size(); }
+
+    // Deliver one level change to every subscription
+    void publish(const LevelDelta& delta) {
+        for (const auto& subscription : subscriptions_) {
+            subscription->publish(delta);
+        }
+    }
+
+    // Tell every subscription the book was replaced wholesale
+    void invalidate() {
+        for (const auto& subscription : subscriptions_) {
+            subscription->invalidate();
+        }
+    }
+
+private:
+    std::vector<std::shared_ptr<BookSubscription>> subscriptions_;
+};
+
+} // namespace clunk
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "order.h"
+#include "depth_snapshot.h"
+#include "book_subscription.h"
+#include "touch_stats.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clunk {
+
+// Best bid/ask snapshot published by a book after every mutation
+//
+// Empty sides report a price of 0 (bids) / kNoAsk (asks) and a size of 0.
+// `sequence` counts the book's mutations, so readers can tell whether
+// anything changed since their last poll.
+struct TopOfBook {
+    Price bid_price = 0;
+    Quantity bid_size = 0;
+    Price ask_price = std::numeric_limits<Price>::max();
+    Quantity ask_size = 0;
+    uint64_t sequence = 0;
+
+    bool hasBid() const { return bid_price > 0; }
+    bool hasAsk() const { return ask_price < std::numeric_limits<Price>::max(); }
+};
+
+// One entry of a batched book update (see applyUpdates() / loadSnapshot())
+//
+// `order_id` names the order to add or resize; a null ID stands for the
+// aggregated level at (side, price), as L2 feeds send it. A size of 0 (or
+// less) removes the order. Level-only books ignore the ID.
+struct LevelUpdate {
+    OrderSide side = OrderSide::BUY;
+    Price price = 0;
+    Quantity size = 0;
+    OrderId order_id;
+};
+
+// Read-only view of a book, shared by the order-level and level-only books
+//
+// Consumers that only display or analyse depth (the console visualizer)
+// take a BookView so they work on either book. The concrete books are
+// final, so their own callers never pay for the virtual dispatch.
+class BookView {
+public:
+    virtual ~BookView() = default;
+
+    // Symbol and fixed-point scale of the book's prices and sizes
+    virtual const std::string& getSymbol() const = 0;
+    virtual const ProductScale& getScale() const = 0;
+
+    // Consistent best bid/ask snapshot
+    virtual TopOfBook getTopOfBook() const = 0;
+
+    // Capture up to `depth` levels of both sides into `out`
+    virtual void getDepthSnapshot(size_t depth, DepthSnapshot& out) const = 0;
+
+    // Replace `out` with the whole book in the form loadSnapshot() takes:
+    // bids then asks, best first, each level's orders in time priority
+    // (level-only books give one entry per level), under one lock
+    virtual void exportBook(std::vector<LevelUpdate>& out) const = 0;
+
+    // Have the writer publish an immutable `depth`-level snapshot every
+    // `interval` mutations (0: only on publishDepth()), into pre-sized
+    // buffers it recycles; calling again changes the depth and interval
+    virtual void enableDepthPublishing(size_t depth, uint64_t interval = 1) = 0;
+
+    // Publish a snapshot now; false if publishing is disabled or readers
+    // pin every buffer
+    virtual bool publishDepth() = 0;
+
+    // Latest published snapshot, pinned until the handle is dropped (empty
+    // before the first publication). Wait-free with respect to the writer:
+    // readers never take the book mutex, however many there are.
+    virtual PublishedDepth getPublishedDepth() const = 0;
+
+    // Resting orders (level-only books count one per level)
+    virtual size_t getOrderCount() const = 0;
+
+    // Levels per side
+    virtual size_t getBidLevelCount() const = 0;
+    virtual size_t getAskLevelCount() const = 0;
+
+    // Total size resting at (side, price), or 0
+    virtual Quantity getLevelSize(OrderSide side, Price price) const = 0;
+
+    // How many level changes took the best-level fast path
+    virtual TouchStats getTouchStats() const = 0;
+
+    // Receive every level change from now on as coalesced deltas (see
+    // BookSubscription); start from a getDepthSnapshot()
+    virtual std::shared_ptr<BookSubscription> subscribe(
+        size_t capacity = BookSubscription::kDefaultCapacity) = 0;
+
+    // Stop delivering to a subscription; returns false if it was not one
+    // of this book's
+    virtual bool unsubscribe(const std::shared_ptr<BookSubscription>& subscription) = 0;
+};
+
+} // namespace clunk
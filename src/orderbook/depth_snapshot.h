@@ -0,0 +1,68 @@
+#pragma once
+
+#include "fixed_point.h"
+#include "utils/aligned_allocator.h"
+#include "utils/snapshot_buffer.h"
+#include <cstdint>
+
+namespace clunk {
+
+// One side of a depth snapshot in structure-of-arrays form
+//
+// Prices and sizes (ticks and lots) live in separate cache-line aligned
+// arrays, best level first, so metric kernels can stream either with
+// vector loads. Row i of both arrays describes the same level.
+struct DepthSide {
+    AlignedVector<Price> prices;
+    AlignedVector<Quantity> sizes;
+
+    size_t size() const { return prices.size(); }
+    bool empty() const { return prices.empty(); }
+
+    void clear() {
+        prices.clear();
+        sizes.clear();
+    }
+
+    void reserve(size_t depth) {
+        prices.reserve(depth);
+        sizes.reserve(depth);
+    }
+
+    void push(Price price, Quantity size) {
+        prices.push_back(price);
+        sizes.push_back(size);
+    }
+};
+
+// Both sides of a book captured under one lock
+//
+// Reusing a snapshot across calls keeps its arrays' capacity, so repeated
+// captures at the same depth do not allocate.
+struct DepthSnapshot {
+    DepthSide bids;
+    DepthSide asks;
+    uint64_t sequence = 0;  // Book mutation count at capture (TopOfBook::sequence)
+
+    // Whole-book counts at capture, so readers of a published snapshot need
+    // not take the book lock for them
+    size_t bid_levels = 0;
+    size_t ask_levels = 0;
+    size_t orders = 0;
+
+    void clear() {
+        bids.clear();
+        asks.clear();
+        sequence = 0;
+        bid_levels = 0;
+        ask_levels = 0;
+        orders = 0;
+    }
+};
+
+// Depth snapshots a book publishes for wait-free readers, and a reader's
+// pinned view of the latest one (see BookView::getPublishedDepth())
+using DepthBuffer = SnapshotBuffer<DepthSnapshot>;
+using PublishedDepth = DepthBuffer::Handle;
+
+} // namespace clunk
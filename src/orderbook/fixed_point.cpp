@@ -0,0 +1,189 @@
+#include "fixed_point.h"
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace clunk {
+
+namespace {
+
+// Quote increments of common Coinbase products (digits after the point).
+// Sizes keep 8 digits, which covers every Coinbase base increment.
+const std::unordered_map<std::string, uint8_t>& knownPriceDecimals() {
+    static const std::unordered_map<std::string, uint8_t> table = {
+        {"BTC-USD", 2}, {"ETH-USD", 2}, {"SOL-USD", 2}, {"LTC-USD", 2},
+        {"BTC-EUR", 2}, {"ETH-EUR", 2}, {"BTC-GBP", 2}, {"BTC-USDC", 2},
+        {"XRP-USD", 4}, {"ADA-USD", 4}, {"DOGE-USD", 5}, {"ETH-BTC", 5},
+    };
+    return table;
+}
+
+int64_t roundScaled(double value, int decimals) {
+    return static_cast<int64_t>(std::llround(value * static_cast<double>(decimalScale(decimals))));
+}
+
+} // namespace
+
+ProductScale ProductScale::forSymbol(const std::string& symbol) {
+    const auto& table = knownPriceDecimals();
+    auto it = table.find(symbol);
+    if (it != table.end()) {
+        return ProductScale(it->second, 8);
+    }
+    return ProductScale();
+}
+
+bool ProductScale::parsePrice(std::string_view text, Price& out) const {
+    return parseFixed(text, price_decimals, out);
+}
+
+bool ProductScale::parseSize(std::string_view text, Quantity& out) const {
+    return parseFixed(text, size_decimals, out);
+}
+
+Price ProductScale::toPrice(double price) const {
+    return roundScaled(price, price_decimals);
+}
+
+Quantity ProductScale::toQuantity(double size) const {
+    return roundScaled(size, size_decimals);
+}
+
+double ProductScale::toDouble(Price price) const {
+    return static_cast<double>(price) / static_cast<double>(decimalScale(price_decimals));
+}
+
+double ProductScale::sizeToDouble(Quantity size) const {
+    return static_cast<double>(size) / static_cast<double>(decimalScale(size_decimals));
+}
+
+std::string ProductScale::formatPrice(Price price) const {
+    return formatFixed(price, price_decimals);
+}
+
+std::string ProductScale::formatSize(Quantity size) const {
+    return formatFixed(size, size_decimals);
+}
+
+bool parseFixed(std::string_view text, int decimals, int64_t& out) {
+    constexpr uint64_t kLimit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+
+    size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        ++i;
+    }
+
+    uint64_t value = 0;
+    int fraction_digits = -1;       // -1 until the decimal point is seen
+    bool any_digit = false;
+    bool round_up = false;
+
+    for (; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '.') {
+            if (fraction_digits >= 0) {
+                return false;
+            }
+            fraction_digits = 0;
+            continue;
+        }
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        any_digit = true;
+
+        if (fraction_digits >= decimals) {
+            // Past the scale: only the first extra digit decides rounding
+            if (fraction_digits == decimals) {
+                round_up = c >= '5';
+                ++fraction_digits;
+            }
+            continue;
+        }
+
+        uint64_t digit = static_cast<uint64_t>(c - '0');
+        if (value > (kLimit - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+        if (fraction_digits >= 0) {
+            ++fraction_digits;
+        }
+    }
+
+    if (!any_digit) {
+        return false;
+    }
+
+    // Pad missing fraction digits out to the full scale
+    for (int digits = fraction_digits < 0 ? 0 : fraction_digits; digits < decimals; ++digits) {
+        if (value > kLimit / 10) {
+            return false;
+        }
+        value *= 10;
+    }
+
+    if (round_up) {
+        if (value == kLimit) {
+            return false;
+        }
+        ++value;
+    }
+
+    out = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    return true;
+}
+
+bool parseDecimal(std::string_view text, int decimals, int64_t& out) {
+    if (parseFixed(text, decimals, out)) {
+        return true;
+    }
+
+    char buffer[64];
+    if (text.empty() || text.size() >= sizeof(buffer) || text.find_first_of("eE") == std::string_view::npos) {
+        return false;
+    }
+    std::memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+    char* end = nullptr;
+    double value = std::strtod(buffer, &end);
+    if (end != buffer + text.size() || !std::isfinite(value)) {
+        return false;
+    }
+    out = roundScaled(value, decimals);
+    return true;
+}
+
+std::string formatFixed(int64_t value, int decimals) {
+    std::string result;
+    appendFixed(result, value, decimals);
+    return result;
+}
+
+void appendFixed(std::string& out, int64_t value, int decimals) {
+    bool negative = value < 0;
+    uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    uint64_t scale = static_cast<uint64_t>(decimalScale(decimals));
+
+    // 20 digits for the integer part, one for the sign
+    char digits[24];
+    if (negative) {
+        out.push_back('-');
+    }
+    char* end = std::to_chars(digits, digits + sizeof(digits), magnitude / scale).ptr;
+    out.append(digits, end);
+
+    if (decimals > 0) {
+        end = std::to_chars(digits, digits + sizeof(digits), magnitude % scale).ptr;
+        out.push_back('.');
+        out.append(static_cast<size_t>(decimals) - static_cast<size_t>(end - digits), '0');
+        out.append(digits, end);
+    }
+}
+
+} // namespace clunk
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace clunk {
+
+// Price in integer ticks of a product's quote increment
+using Price = int64_t;
+
+// Size in integer lots of a product's base increment
+using Quantity = int64_t;
+
+// Fixed-point scale of one product
+//
+// Prices and sizes are held as integer multiples of 10^-decimals, so level
+// keys compare exactly (65000.01 and 65000.010000001 can no longer split a
+// level) and arithmetic on them never drifts. Feed values are parsed straight
+// from their decimal strings; doubles only appear at the display edge.
+struct ProductScale {
+    uint8_t price_decimals = 8;    // Digits after the point in one tick
+    uint8_t size_decimals = 8;     // Digits after the point in one lot
+
+    constexpr ProductScale() = default;
+    constexpr ProductScale(uint8_t price_digits, uint8_t size_digits)
+        : price_decimals(price_digits), size_decimals(size_digits) {}
+
+    // Scale for a product ID (known Coinbase increments, else a fine default)
+    static ProductScale forSymbol(const std::string& symbol);
+
+    // Parse a feed decimal string into ticks/lots
+    bool parsePrice(std::string_view text, Price& out) const;
+    bool parseSize(std::string_view text, Quantity& out) const;
+
+    // Convert from doubles (rounded to the nearest tick/lot)
+    Price toPrice(double price) const;
+    Quantity toQuantity(double size) const;
+
+    // Convert back to doubles for display and analytics
+    double toDouble(Price price) const;
+    double sizeToDouble(Quantity size) const;
+
+    // Exact decimal rendering, e.g. "65000.01"
+    std::string formatPrice(Price price) const;
+    std::string formatSize(Quantity size) const;
+};
+
+// Parse a plain decimal ("123", "-0.5", "65000.01") scaled by 10^decimals
+//
+// Digits past `decimals` are rounded half away from zero. Returns false on
+// malformed input or if the scaled value does not fit in 64 bits.
+bool parseFixed(std::string_view text, int decimals, int64_t& out);
+
+// parseFixed(), also accepting a bare number in exponent form ("1e-05", as
+// JSON encoders write small values), which is rounded through a double
+bool parseDecimal(std::string_view text, int decimals, int64_t& out);
+
+// Render a value scaled by 10^decimals as an exact decimal string
+std::string formatFixed(int64_t value, int decimals);
+
+// Append the same rendering to `out`, reusing its capacity (for hot display
+// paths that build text in place)
+void appendFixed(std::string& out, int64_t value, int decimals);
+
+// 10^decimals as an integer (decimals <= 18)
+constexpr int64_t decimalScale(int decimals) {
+    int64_t result = 1;
+    for (int i = 0; i < decimals; ++i) {
+        result *= 10;
+    }
+    return result;
+}
+
+} // namespace clunk
@@ -0,0 +1,359 @@
+#include "level_book.h"
+#include <algorithm>
+
+namespace clunk {
+
+namespace {
+
+// Touch slot for a side's map
+template <typename Levels, typename Touch>
+Touch touchOf(Levels& levels) {
+    return levels.empty() ? Touch() : Touch{levels.begin()->first, &levels.begin()->second};
+}
+
+template <typename Levels>
+Quantity sizeAt(const Levels& levels, Price price) {
+    auto it = levels.find(price);
+    return it == levels.end() ? 0 : it->second;
+}
+
+template <typename Levels>
+std::vector<std::pair<Price, Quantity>> topLevels(const Levels& levels, size_t depth) {
+    std::vector<std::pair<Price, Quantity>> result;
+    result.reserve(std::min(depth, levels.size()));
+    for (auto it = levels.begin(); it != levels.end() && result.size() < depth; ++it) {
+        result.emplace_back(it->first, it->second);
+    }
+    return result;
+}
+
+template <typename Levels>
+void captureSide(const Levels& levels, size_t depth, DepthSide& out) {
+    out.reserve(std::min(depth, levels.size()));
+    size_t count = 0;
+    for (auto it = levels.begin(); it != levels.end() && count < depth; ++it, ++count) {
+        out.push(it->first, it->second);
+    }
+}
+
+} // namespace
+
+LevelBook::LevelBook(const std::string& symbol)
+    : LevelBook(symbol, ProductScale::forSymbol(symbol)) {
+}
+
+LevelBook::LevelBook(const std::string& symbol, ProductScale scale)
+    : symbol_(symbol),
+      scale_(scale),
+      bids_(BidLevels::key_compare(), Allocator(&level_arena_)),
+      asks_(AskLevels::key_compare(), Allocator(&level_arena_)) {
+}
+
+void LevelBook::reserve(size_t level_count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    level_arena_.reserve(level_count);
+}
+
+bool LevelBook::setLevel(OrderSide side, Price price, Quantity size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!apply(side, price, size)) {
+        return false;
+    }
+
+    // Notify subscribers
+    notifyUpdate();
+    return true;
+}
+
+Quantity LevelBook::getLevel(OrderSide side, Price price) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const Touch& touch = side == OrderSide::BUY ? bid_touch_ : ask_touch_;
+    if (touch.size != nullptr && price == touch.price) {
+        return *touch.size;
+    }
+    return side == OrderSide::BUY ? sizeAt(bids_, price) : sizeAt(asks_, price);
+}
+
+size_t LevelBook::applyUpdates(const LevelUpdate* updates, size_t count, size_t depth_limit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t applied = 0;
+    for (size_t i = 0; i < count; ++i) {
+        applied += apply(updates[i].side, updates[i].price, updates[i].size) ? 1 : 0;
+    }
+
+    // Levels pushed out of the venue's depth get no more updates
+    if (depth_limit != 0) {
+        for (; bids_.size() > depth_limit; ++applied) {
+            apply(OrderSide::BUY, bids_.rbegin()->first, 0);
+        }
+        for (; asks_.size() > depth_limit; ++applied) {
+            apply(OrderSide::SELL, asks_.rbegin()->first, 0);
+        }
+    }
+
+    // One publication and one notification for the whole batch
+    if (applied != 0) {
+        notifyUpdate();
+    }
+
+    return applied;
+}
+
+void LevelBook::loadSnapshot(const LevelUpdate* levels, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    bids_.clear();
+    asks_.clear();
+    level_arena_.reserve(count + count / 4);
+
+    for (size_t i = 0; i < count; ++i) {
+        const LevelUpdate& level = levels[i];
+        if (level.size <= 0) {
+            continue;
+        }
+
+        // Best-first input always lands at the end of the tree
+        if (level.side == OrderSide::BUY) {
+            bids_.try_emplace(bids_.end(), level.price, 0)->second += level.size;
+        } else {
+            asks_.try_emplace(asks_.end(), level.price, 0)->second += level.size;
+        }
+    }
+
+    refreshTouches();
+
+    // Subscribers rebuild from a snapshot instead of one delta per level
+    subscribers_.invalidate();
+
+    // Notify subscribers
+    notifyUpdate();
+}
+
+Price LevelBook::getSpread() const {
+    // One snapshot, so the bid and ask come from the same book state
+    TopOfBook top = top_.load();
+
+    if (top.hasBid() && top.hasAsk()) {
+        return top.ask_price - top.bid_price;
+    }
+
+    return 0;
+}
+
+double LevelBook::getMidpointPrice() const {
+    TopOfBook top = top_.load();
+
+    if (top.hasBid() && top.hasAsk()) {
+        return scale_.toDouble(top.bid_price + top.ask_price) / 2.0;
+    }
+
+    return 0.0;
+}
+
+std::vector<std::pair<Price, Quantity>> LevelBook::getBidLevels(size_t depth) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return topLevels(bids_, depth);
+}
+
+std::vector<std::pair<Price, Quantity>> LevelBook::getAskLevels(size_t depth) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return topLevels(asks_, depth);
+}
+
+void LevelBook::getDepthSnapshot(size_t depth, DepthSnapshot& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    captureDepth(depth, out);
+}
+
+void LevelBook::exportBook(std::vector<LevelUpdate>& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out.clear();
+    out.reserve(bids_.size() + asks_.size());
+    for (const auto& [price, size] : bids_) {
+        out.push_back(LevelUpdate{OrderSide::BUY, price, size, OrderId()});
+    }
+    for (const auto& [price, size] : asks_) {
+        out.push_back(LevelUpdate{OrderSide::SELL, price, size, OrderId()});
+    }
+}
+
+void LevelBook::enableDepthPublishing(size_t depth, uint64_t interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Size the buffers up front while no reader can hold one yet; later
+    // depth increases grow them on the next publications instead
+    if (published_depth_.getPublishedCount() == 0) {
+        published_depth_.prepare([depth](DepthSnapshot& snapshot) {
+            snapshot.bids.reserve(depth);
+            snapshot.asks.reserve(depth);
+        });
+    }
+
+    publish_depth_ = depth;
+    publish_interval_ = depth != 0 ? interval : 0;
+    if (publish_depth_ != 0) {
+        publishDepthLocked();
+    }
+}
+
+bool LevelBook::publishDepth() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return publish_depth_ != 0 && publishDepthLocked();
+}
+
+std::shared_ptr<BookSubscription> LevelBook::subscribe(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.add(capacity);
+}
+
+bool LevelBook::unsubscribe(const std::shared_ptr<BookSubscription>& subscription) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.remove(subscription);
+}
+
+TouchStats LevelBook::getTouchStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return touch_stats_;
+}
+
+size_t LevelBook::getOrderCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bids_.size() + asks_.size();
+}
+
+size_t LevelBook::getBidLevelCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bids_.size();
+}
+
+size_t LevelBook::getAskLevelCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return asks_.size();
+}
+
+void LevelBook::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    bids_.clear();
+    asks_.clear();
+    refreshTouches();
+    subscribers_.invalidate();
+
+    // Notify subscribers
+    notifyUpdate();
+}
+
+bool LevelBook::apply(OrderSide side, Price price, Quantity size) {
+    bool changed = side == OrderSide::BUY ? setSize(bids_, bid_touch_, price, size)
+                                          : setSize(asks_, ask_touch_, price, size);
+    if (changed && !subscribers_.empty()) {
+        LevelDelta delta;
+        delta.side = side;
+        delta.price = price;
+        delta.size = size > 0 ? size : 0;
+        delta.sequence = mutation_count_ + 1;   // Visible once notifyUpdate() runs
+        subscribers_.publish(delta);
+    }
+    return changed;
+}
+
+template <typename Levels>
+bool LevelBook::setSize(Levels& levels, Touch& touch, Price price, Quantity size) {
+    using Compare = typename Levels::key_compare;
+    ++touch_stats_.updates;
+
+    // At the touch: resize in the slot, or drop the tree's first node
+    if (touch.size != nullptr && price == touch.price) {
+        ++touch_stats_.at_touch;
+        if (size > 0) {
+            if (*touch.size == size) {
+                return false;
+            }
+            *touch.size = size;
+            return true;
+        }
+        levels.erase(levels.begin());
+        touch = touchOf<Levels, Touch>(levels);
+        return true;
+    }
+
+    // Inside the touch (or on an empty side): a new first node
+    if (touch.size == nullptr || Compare()(price, touch.price)) {
+        ++touch_stats_.inside;
+        if (size <= 0) {
+            return false;
+        }
+        auto it = levels.emplace_hint(levels.begin(), price, size);
+        touch = Touch{price, &it->second};
+        return true;
+    }
+
+    // Behind the touch: the general tree path, which cannot move the best
+    if (size <= 0) {
+        return levels.erase(price) != 0;
+    }
+
+    auto [it, inserted] = levels.try_emplace(price, size);
+    if (inserted) {
+        return true;
+    }
+    if (it->second == size) {
+        return false;
+    }
+    it->second = size;
+    return true;
+}
+
+void LevelBook::refreshTouches() {
+    bid_touch_ = touchOf<BidLevels, Touch>(bids_);
+    ask_touch_ = touchOf<AskLevels, Touch>(asks_);
+}
+
+void LevelBook::notifyUpdate() {
+    TopOfBook top;
+    top.sequence = ++mutation_count_;
+
+    if (bid_touch_.size != nullptr) {
+        top.bid_price = bid_touch_.price;
+        top.bid_size = *bid_touch_.size;
+    }
+    if (ask_touch_.size != nullptr) {
+        top.ask_price = ask_touch_.price;
+        top.ask_size = *ask_touch_.size;
+    }
+
+    top_.store(top);
+
+    if (publish_interval_ != 0 && mutation_count_ - published_at_ >= publish_interval_) {
+        publishDepthLocked();
+    }
+}
+
+void LevelBook::captureDepth(size_t depth, DepthSnapshot& out) const {
+    out.clear();
+    out.sequence = mutation_count_;
+    out.bid_levels = bids_.size();
+    out.ask_levels = asks_.size();
+    out.orders = bids_.size() + asks_.size();
+    captureSide(bids_, depth, out.bids);
+    captureSide(asks_, depth, out.asks);
+}
+
+bool LevelBook::publishDepthLocked() {
+    published_at_ = mutation_count_;
+
+    // Readers pin every other buffer: keep the previous snapshot current
+    DepthSnapshot* out = published_depth_.beginWrite();
+    if (out == nullptr) {
+        return false;
+    }
+
+    captureDepth(publish_depth_, *out);
+    published_depth_.publish();
+    return true;
+}
+
+} // namespace clunk
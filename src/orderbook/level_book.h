@@ -0,0 +1,187 @@
+#pragma once
+
+#include "book_view.h"
+#include "utils/memory_pool.h"
+#include "utils/seqlock.h"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clunk {
+
+// Aggregated (L2) book holding one size per price level
+//
+// L2 feeds only ever say "the size at this price is now N", so this book
+// stores exactly that: a price -> size map per side, with map nodes drawn
+// from a per-book slab arena. Compared with modelling each level as a
+// synthetic order in OrderBook, a change costs one tree lookup, with no
+// pooled Order, no order-index entry and no level queue.
+//
+// Each side's best level is also kept in a cache-line slot: changes at the
+// touch (most of an L2 feed, and every ticker-driven check) update it
+// without walking the tree, and a new best level is inserted with a
+// begin() hint.
+//
+// Writers take the book mutex; best bid/ask reads go through the same
+// seqlock-published TopOfBook as OrderBook, so pollers never block the
+// feed thread, and level changes reach subscribers the same way too.
+class LevelBook final : public BookView {
+public:
+    // Constructor (scale defaults to ProductScale::forSymbol(symbol))
+    explicit LevelBook(const std::string& symbol);
+    LevelBook(const std::string& symbol, ProductScale scale);
+
+    // Books own arena-backed levels and cannot be copied
+    LevelBook(const LevelBook&) = delete;
+    LevelBook& operator=(const LevelBook&) = delete;
+
+    // Symbol getter
+    const std::string& getSymbol() const override { return symbol_; }
+
+    // Fixed-point scale of this book's prices and sizes
+    const ProductScale& getScale() const override { return scale_; }
+
+    // Pre-size the level arena
+    void reserve(size_t level_count);
+
+    // Set the size at (side, price); a size of 0 (or less) removes the
+    // level. Returns true if the book changed.
+    bool setLevel(OrderSide side, Price price, Quantity size);
+
+    // Size resting at (side, price), or 0
+    Quantity getLevel(OrderSide side, Price price) const;
+    Quantity getLevelSize(OrderSide side, Price price) const override { return getLevel(side, price); }
+
+    // Apply a batch of level changes (e.g. one l2update change set) under a
+    // single lock acquisition, publishing and notifying once; returns the
+    // number of changes that altered the book. With a `depth_limit`, levels
+    // past that many per side are then dropped (and counted), for venues
+    // that only maintain the top of the book.
+    size_t applyUpdates(const LevelUpdate* updates, size_t count, size_t depth_limit = 0);
+
+    // Replace the book's contents with a snapshot under a single lock
+    // acquisition, publishing and notifying once. Levels given best-first
+    // per side are inserted with end hints; entries sharing a price (an L3
+    // snapshot's orders) are summed, and zero sizes are skipped.
+    void loadSnapshot(const LevelUpdate* levels, size_t count);
+
+    // Consistent best bid/ask snapshot (lock-free; never blocks writers)
+    TopOfBook getTopOfBook() const override { return top_.load(); }
+
+    // Get best bid and ask (0 / kNoAsk when the side is empty)
+    Price getBestBid() const { return top_.load().bid_price; }
+    Price getBestAsk() const { return top_.load().ask_price; }
+
+    // Get bid-ask spread in ticks
+    Price getSpread() const;
+
+    // Get midpoint price (in price units; the midpoint may fall between ticks)
+    double getMidpointPrice() const;
+
+    // Get depth at specified levels as (price, size) pairs (locks and
+    // allocates; frequent readers use getPublishedDepth())
+    std::vector<std::pair<Price, Quantity>> getBidLevels(size_t depth) const;
+    std::vector<std::pair<Price, Quantity>> getAskLevels(size_t depth) const;
+
+    // Capture up to `depth` levels of both sides under one lock into `out`
+    // (reusing its storage)
+    void getDepthSnapshot(size_t depth, DepthSnapshot& out) const override;
+
+    // Every level, for checkpoints (see BookView)
+    void exportBook(std::vector<LevelUpdate>& out) const override;
+
+    // Wait-free depth publication for many readers (see BookView)
+    void enableDepthPublishing(size_t depth, uint64_t interval = 1) override;
+    bool publishDepth() override;
+    PublishedDepth getPublishedDepth() const override { return published_depth_.acquire(); }
+
+    // Get statistics (one "order" per level)
+    size_t getOrderCount() const override;
+    size_t getBidLevelCount() const override;
+    size_t getAskLevelCount() const override;
+
+    // Level changes served by the best-level slots
+    TouchStats getTouchStats() const override;
+
+    // Level change subscriptions (see BookView)
+    std::shared_ptr<BookSubscription> subscribe(
+        size_t capacity = BookSubscription::kDefaultCapacity) override;
+    bool unsubscribe(const std::shared_ptr<BookSubscription>& subscription) override;
+
+    // Remove every level
+    void clear();
+
+    // Best ask reported for an empty ask side
+    static constexpr Price kNoAsk = std::numeric_limits<Price>::max();
+
+private:
+    using Allocator = SlabAllocator<std::pair<const Price, Quantity>>;
+
+    // Both sides iterate best-first (highest bids first, lowest asks first)
+    using BidLevels = std::map<Price, Quantity, std::greater<Price>, Allocator>;
+    using AskLevels = std::map<Price, Quantity, std::less<Price>, Allocator>;
+
+    std::string symbol_;                                // Instrument symbol
+    ProductScale scale_;                                // Tick and lot sizes
+
+    // Per-book arena (declared first so it outlives the maps)
+    SlabArena level_arena_;
+
+    BidLevels bids_;
+    AskLevels asks_;
+
+    // Best level of one side; `size` points into its map node, null while
+    // the side is empty
+    struct alignas(64) Touch {
+        Price price = 0;
+        Quantity* size = nullptr;
+    };
+
+    Touch bid_touch_;
+    Touch ask_touch_;
+    TouchStats touch_stats_;
+
+    // Mutex for thread safety
+    mutable std::mutex mutex_;
+
+    // Top of book, republished under mutex_ after every mutation
+    SeqLock<TopOfBook> top_;
+    uint64_t mutation_count_ = 0;
+
+    // Level delta subscribers (published to under mutex_)
+    BookSubscribers subscribers_;
+
+    // Published depth snapshots (written under mutex_, read wait-free)
+    DepthBuffer published_depth_;
+    size_t publish_depth_ = 0;          // Levels per side; 0 while disabled
+    uint64_t publish_interval_ = 0;     // Mutations between publications
+    uint64_t published_at_ = 0;         // mutation_count_ at the last one
+
+    // Set one level, passing the change to subscribers (caller holds mutex_)
+    bool apply(OrderSide side, Price price, Quantity size);
+
+    // Set or erase one level of a side, through its touch slot when the
+    // price is at or inside the best (caller holds mutex_)
+    template <typename Levels>
+    bool setSize(Levels& levels, Touch& touch, Price price, Quantity size);
+
+    // Point both touch slots at the current best levels (caller holds mutex_)
+    void refreshTouches();
+
+    // Publish the new top of book, and the depth when it is due
+    // (caller holds mutex_)
+    void notifyUpdate();
+
+    // Copy the best `depth` levels per side into `out` (caller holds mutex_)
+    void captureDepth(size_t depth, DepthSnapshot& out) const;
+
+    // Fill a free depth buffer and make it current (caller holds mutex_)
+    bool publishDepthLocked();
+};
+
+} // namespace clunk
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "price_level.h"
+#include "touch_stats.h"
+#include "utils/memory_pool.h"
+#include <functional>
+#include <iterator>
+#include <map>
+#include <type_traits>
+
+namespace clunk {
+
+// Tree-backed level container for one side of a book
+//
+// Levels live in a std::map ordered best-first for the side (descending for
+// bids, ascending for asks), with map nodes drawn from the book's slab
+// arena. Supports any price range at O(log n) per lookup.
+//
+// Most changes hit the touch, so the best level is also kept in its own
+// cache-line slot: lookups at the best price skip the tree walk, and a new
+// level better than the best is inserted with a begin() hint (amortised
+// O(1)). Deeper levels take the general path.
+//
+// Every level container exposes the same interface so BasicOrderBook can be
+// instantiated over either this or PriceLadder:
+//   getOrCreate(price), getOrCreateWorst(price), find(price), removeOrder(order), best(),
+//   nextWorse(price), nextBetter(price), forEach(depth, visitor), size(),
+//   empty(), clear(), touchStats()
+template <OrderSide Side>
+class MapLevels {
+public:
+    using Compare = std::conditional_t<Side == OrderSide::BUY, std::greater<Price>, std::less<Price>>;
+    using Allocator = SlabAllocator<std::pair<const Price, PriceLevel>>;
+
+    // Constructor
+    explicit MapLevels(SlabArena* arena) : levels_(Compare(), Allocator(arena)) {}
+
+    // Touch pointers refer to nodes of this container's own tree
+    MapLevels(const MapLevels&) = delete;
+    MapLevels& operator=(const MapLevels&) = delete;
+
+    // Get the level at `price`, creating it in place if needed
+    PriceLevel& getOrCreate(Price price) {
+        ++stats_.updates;
+        if (touch_.level != nullptr && price == touch_.price) {
+            ++stats_.at_touch;
+            return *touch_.level;
+        }
+        if (touch_.level == nullptr || Compare()(price, touch_.price)) {
+            ++stats_.inside;
+            PriceLevel& level = levels_.try_emplace(levels_.begin(), price, price)->second;
+            touch_ = {price, &level};
+            return level;
+        }
+        return levels_.try_emplace(price, price).first->second;
+    }
+
+    // Get or create the level at `price`, expected to be at or worse than
+    // every existing level (bulk loads in best-first order): the insert is
+    // hinted at the end of the tree. Still correct, only slower, otherwise.
+    PriceLevel& getOrCreateWorst(Price price) {
+        PriceLevel& level = levels_.try_emplace(levels_.end(), price, price)->second;
+        if (touch_.level == nullptr || Compare()(price, touch_.price)) {
+            refreshTouch();
+        }
+        return level;
+    }
+
+    // Find the level at `price`, or nullptr (to change it)
+    PriceLevel* find(Price price) {
+        ++stats_.updates;
+        if (touch_.level != nullptr && price == touch_.price) {
+            ++stats_.at_touch;
+            return touch_.level;
+        }
+        auto it = levels_.find(price);
+        return it == levels_.end() ? nullptr : &it->second;
+    }
+
+    const PriceLevel* find(Price price) const {
+        if (touch_.level != nullptr && price == touch_.price) {
+            return touch_.level;
+        }
+        auto it = levels_.find(price);
+        return it == levels_.end() ? nullptr : &it->second;
+    }
+
+    // Unlink an order from its level, dropping the level once empty;
+    // returns true if the level was dropped
+    bool removeOrder(Order& order) {
+        ++stats_.updates;
+        if (touch_.level != nullptr && order.getPrice() == touch_.price) {
+            ++stats_.at_touch;
+            touch_.level->removeOrder(order);
+            if (!touch_.level->isEmpty()) {
+                return false;
+            }
+
+            // The next best level is the tree's new first node
+            levels_.erase(levels_.begin());
+            refreshTouch();
+            return true;
+        }
+
+        auto it = levels_.find(order.getPrice());
+        if (it == levels_.end()) {
+            return false;
+        }
+
+        it->second.removeOrder(order);
+        if (it->second.isEmpty()) {
+            levels_.erase(it);
+            return true;
+        }
+        return false;
+    }
+
+    // Best level for the side, or nullptr if empty
+    const PriceLevel* best() const {
+        return touch_.level;
+    }
+
+    // Best level strictly worse than `price` (which need not exist), or nullptr
+    const PriceLevel* nextWorse(Price price) const {
+        auto it = levels_.upper_bound(price);
+        return it == levels_.end() ? nullptr : &it->second;
+    }
+
+    // Worst level strictly better than `price` (which need not exist), or nullptr
+    const PriceLevel* nextBetter(Price price) const {
+        auto it = levels_.lower_bound(price);
+        return it == levels_.begin() ? nullptr : &std::prev(it)->second;
+    }
+
+    // Visit up to `depth` levels, best first
+    template <typename Visitor>
+    void forEach(size_t depth, Visitor&& visit) const {
+        size_t count = 0;
+        for (auto it = levels_.begin(); it != levels_.end() && count < depth; ++it, ++count) {
+            visit(it->second);
+        }
+    }
+
+    size_t size() const { return levels_.size(); }
+    bool empty() const { return levels_.empty(); }
+
+    // Drop every level (unlinking their queues)
+    void clear() {
+        levels_.clear();
+        touch_ = Touch();
+    }
+
+    // Lookups served by the best-level slot
+    const TouchStats& touchStats() const { return stats_; }
+
+private:
+    // The best level, or a null level while the side is empty
+    struct alignas(64) Touch {
+        Price price = 0;
+        PriceLevel* level = nullptr;
+    };
+
+    std::map<Price, PriceLevel, Compare, Allocator> levels_;
+    Touch touch_;
+    TouchStats stats_;
+
+    void refreshTouch() {
+        touch_ = levels_.empty() ? Touch() : Touch{levels_.begin()->first, &levels_.begin()->second};
+    }
+};
+
+} // namespace clunk
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "order.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace clunk {
+
+// What happens to the part of an incoming order that does not fill at once
+enum class TimeInForce : uint8_t {
+    GTC,    // Rest the remainder on the book
+    IOC,    // Fill what crosses now, cancel the rest
+    FOK     // Fill the whole size now, or nothing at all
+};
+
+// One execution between an incoming (taker) order and a resting (maker) one
+struct Fill {
+    OrderId maker_id;
+    OrderId taker_id;
+    OrderSide taker_side = OrderSide::BUY;
+    Price price = 0;                // The maker's price
+    Quantity size = 0;
+    Quantity maker_remaining = 0;   // Left on the maker (0: filled and removed)
+};
+
+// Outcome of one submitted order
+struct MatchResult {
+    Quantity filled = 0;
+    Quantity remaining = 0;         // Unfilled: resting if `rested`, else cancelled
+    size_t fill_count = 0;
+    bool rested = false;
+    bool rejected = false;          // Duplicate ID, no size, or an FOK that could
+                                    // not fill completely; the book is unchanged
+};
+
+// Limit that crosses every level, for market orders (use with IOC or FOK)
+inline Price marketLimit(OrderSide side) {
+    return side == OrderSide::BUY ? std::numeric_limits<Price>::max() : std::numeric_limits<Price>::min();
+}
+
+} // namespace clunk
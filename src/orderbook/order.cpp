@@ -3,12 +3,12 @@
 
 namespace clunk {
 
-Order::Order(const std::string& id, OrderSide side, double price, double size,
+Order::Order(const OrderId& id, OrderSide side, Price price, Quantity size,
              std::chrono::nanoseconds timestamp)
     : id_(id), side_(side), price_(price), size_(size), timestamp_(timestamp) {
 }
 
-bool Order::reduceSize(double amount) {
+bool Order::reduceSize(Quantity amount) {
     if (amount <= 0 || amount > size_) {
         return false;
     }
@@ -1,8 +1,12 @@
 #pragma once
 
+#include "fixed_point.h"
+#include "order_id.h"
+#include <boost/intrusive/list_hook.hpp>
 #include <cstdint>
 #include <string>
 #include <chrono>
+#include <type_traits>
 
 namespace clunk {
 
@@ -12,45 +16,78 @@ enum class OrderSide : uint8_t {
     SELL = 1
 };
 
+// Side as a compile-time constant (what withSide() hands its callable)
+template <OrderSide Side>
+using SideConstant = std::integral_constant<OrderSide, Side>;
+
+// The side an order on `side` trades against
+constexpr OrderSide opposite(OrderSide side) {
+    return side == OrderSide::BUY ? OrderSide::SELL : OrderSide::BUY;
+}
+
+// Branch on a runtime side once, calling `f` with a SideConstant so the
+// code behind it is instantiated (and inlined) per side
+template <typename F>
+decltype(auto) withSide(OrderSide side, F&& f) {
+    if (side == OrderSide::BUY) {
+        return f(SideConstant<OrderSide::BUY>());
+    }
+    return f(SideConstant<OrderSide::SELL>());
+}
+
 // Order class representing a single order in the order book
+//
+// Orders resting in an OrderBook live in the book's pool and are threaded
+// onto their PriceLevel's FIFO queue through an intrusive hook, so queueing
+// an order never allocates a list node or touches a reference count. Price
+// and size are fixed-point ticks/lots of the book's ProductScale.
 class Order {
 public:
     // Constructor
-    Order(const std::string& id, OrderSide side, double price, double size,
+    Order(const OrderId& id, OrderSide side, Price price, Quantity size,
           std::chrono::nanoseconds timestamp);
 
     // Copy and move constructors/assignments
+    // (the queue hook is never copied; a copy always starts unqueued)
     Order(const Order& other) = default;
-    Order(Order&& other) noexcept = default;
+    Order(Order&& other) = default;
     Order& operator=(const Order& other) = default;
-    Order& operator=(Order&& other) noexcept = default;
+    Order& operator=(Order&& other) = default;
 
     // Destructor
     ~Order() = default;
 
     // Getters
-    const std::string& getId() const { return id_; }
+    const OrderId& getId() const { return id_; }
     OrderSide getSide() const { return side_; }
-    double getPrice() const { return price_; }
-    double getSize() const { return size_; }
+    Price getPrice() const { return price_; }
+    Quantity getSize() const { return size_; }
     std::chrono::nanoseconds getTimestamp() const { return timestamp_; }
 
     // Setters
-    void setSize(double size) { size_ = size; }
+    void setSize(Quantity size) { size_ = size; }
 
     // Update order size (for partial fills)
-    bool reduceSize(double amount);
+    bool reduceSize(Quantity amount);
+
+    // Check if the order is currently queued at a price level
+    bool isQueued() const { return level_hook_.is_linked(); }
 
     // Comparison operators (for sorting and containers)
     bool operator==(const Order& other) const { return id_ == other.id_; }
     bool operator<(const Order& other) const { return id_ < other.id_; }
 
 private:
-    std::string id_;                       // Unique order ID
+    friend class PriceLevel;
+
+    OrderId id_;                           // Unique order ID
     OrderSide side_;                       // BUY or SELL
-    double price_;                         // Order price
-    double size_;                          // Order size/quantity
+    Price price_;                          // Order price in ticks
+    Quantity size_;                        // Order size in lots
     std::chrono::nanoseconds timestamp_;   // Timestamp when order was received
+
+    // Intrusive hook linking the order into its price level's queue
+    boost::intrusive::list_member_hook<> level_hook_;
 };
 
-} // namespace clunk
\ No newline at end of file
+} // namespace clunk
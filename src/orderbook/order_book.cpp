@@ -2,52 +2,44 @@
 #include <algorithm>
 #include <chrono>
 #include <limits>
+#include <utility>
 
 namespace clunk {
 
-OrderBook::OrderBook(const std::string& symbol)
-    : symbol_(symbol) {
+template <template <OrderSide> class Levels>
+BasicOrderBook<Levels>::BasicOrderBook(const std::string& symbol)
+    : BasicOrderBook(symbol, ProductScale::forSymbol(symbol)) {
 }
 
-bool OrderBook::addOrder(const std::shared_ptr<Order>& order) {
+template <template <OrderSide> class Levels>
+BasicOrderBook<Levels>::BasicOrderBook(const std::string& symbol, ProductScale scale)
+    : symbol_(symbol),
+      scale_(scale),
+      bid_levels_(&level_arena_),
+      ask_levels_(&level_arena_) {
+}
+
+template <template <OrderSide> class Levels>
+BasicOrderBook<Levels>::~BasicOrderBook() {
+    releaseOrders();
+}
+
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::reserve(size_t order_count, size_t level_count) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    // Check if order already exists
-    if (orders_.find(order->getId()) != orders_.end()) {
-        return false;
-    }
+    order_pool_.reserve(order_count);
+    orders_.reserve(order_count);
+    level_arena_.reserve(level_count);
+}
 
-    // Get or create price level
-    double price = order->getPrice();
-    OrderSide side = order->getSide();
-
-    // Use if-else instead of ternary to handle different map types
-    if (side == OrderSide::BUY) {
-        auto it = bid_levels_.find(price);
-        if (it == bid_levels_.end()) {
-            // Create new price level
-            auto level = std::make_unique<PriceLevel>(price);
-            level->addOrder(order);
-            bid_levels_[price] = std::move(level);
-        } else {
-            // Add to existing level
-            it->second->addOrder(order);
-        }
-    } else {
-        auto it = ask_levels_.find(price);
-        if (it == ask_levels_.end()) {
-            // Create new price level
-            auto level = std::make_unique<PriceLevel>(price);
-            level->addOrder(order);
-            ask_levels_[price] = std::move(level);
-        } else {
-            // Add to existing level
-            it->second->addOrder(order);
-        }
-    }
+template <template <OrderSide> class Levels>
+bool BasicOrderBook<Levels>::addOrder(Order order) {
+    std::lock_guard<std::mutex> lock(mutex_);
 
-    // Add to orders map for quick lookup
-    orders_[order->getId()] = order;
+    if (!insertOrder(std::move(order), false)) {
+        return false;
+    }
 
     // Notify subscribers
     notifyUpdate();
@@ -55,76 +47,98 @@ bool OrderBook::addOrder(const std::shared_ptr<Order>& order) {
     return true;
 }
 
-bool OrderBook::removeOrder(const std::string& order_id) {
+template <template <OrderSide> class Levels>
+size_t BasicOrderBook<Levels>::applyUpdates(const LevelUpdate* updates, size_t count) {
+    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+
     std::lock_guard<std::mutex> lock(mutex_);
 
-    auto order_it = orders_.find(order_id);
-    if (order_it == orders_.end()) {
-        return false;
+    size_t applied = 0;
+    for (size_t i = 0; i < count; ++i) {
+        applied += applyUpdate(updates[i], timestamp) ? 1 : 0;
     }
 
-    std::shared_ptr<Order> order = order_it->second;
-    double price = order->getPrice();
-    OrderSide side = order->getSide();
+    // One publication and one notification for the whole batch
+    if (applied != 0) {
+        notifyUpdate();
+    }
 
-    // Use if-else instead of ternary to handle different map types
-    if (side == OrderSide::BUY) {
-        auto level_it = bid_levels_.find(price);
-        if (level_it != bid_levels_.end()) {
-            level_it->second->removeOrder(order_id);
+    return applied;
+}
 
-            // Remove price level if empty
-            if (level_it->second->isEmpty()) {
-                bid_levels_.erase(level_it);
-            }
-        }
-    } else {
-        auto level_it = ask_levels_.find(price);
-        if (level_it != ask_levels_.end()) {
-            level_it->second->removeOrder(order_id);
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::loadSnapshot(const LevelUpdate* levels, size_t count) {
+    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
 
-            // Remove price level if empty
-            if (level_it->second->isEmpty()) {
-                ask_levels_.erase(level_it);
-            }
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    releaseOrders();
+
+    // Size the arenas for the snapshot, with headroom for levels that
+    // appear afterwards
+    size_t headroom = count + count / 4;
+    order_pool_.reserve(headroom);
+    orders_.reserve(headroom);
+    level_arena_.reserve(headroom);
+
+    // Trackers are rebuilt once at the end rather than fed per level
+    loading_ = true;
+
+    for (size_t i = 0; i < count; ++i) {
+        const LevelUpdate& level = levels[i];
+        if (level.size <= 0) {
+            continue;
         }
+
+        OrderId order_id = level.order_id.isNull() ? OrderId::level(level.side, level.price)
+                                                   : level.order_id;
+        insertOrder(Order(order_id, level.side, level.price, level.size, timestamp), true);
     }
 
-    // Remove from orders map
-    orders_.erase(order_it);
+    loading_ = false;
+    if (metrics_enabled_) {
+        rebuildMetrics();
+    }
+
+    // Subscribers rebuild from a snapshot instead of one delta per level
+    subscribers_.invalidate();
 
     // Notify subscribers
     notifyUpdate();
-
-    return true;
 }
 
-bool OrderBook::modifyOrder(const std::string& order_id, double new_size) {
+template <template <OrderSide> class Levels>
+bool BasicOrderBook<Levels>::removeOrder(const OrderId& order_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    auto order_it = orders_.find(order_id);
-    if (order_it == orders_.end()) {
+    Order** slot = orders_.find(order_id);
+    if (slot == nullptr) {
         return false;
     }
 
-    std::shared_ptr<Order> order = order_it->second;
-    double price = order->getPrice();
-    OrderSide side = order->getSide();
+    eraseOrder(*slot);
 
-    // Use if-else instead of ternary to handle different map types
-    bool success = false;
-    if (side == OrderSide::BUY) {
-        auto level_it = bid_levels_.find(price);
-        if (level_it != bid_levels_.end()) {
-            success = level_it->second->updateOrder(order_id, new_size);
-        }
-    } else {
-        auto level_it = ask_levels_.find(price);
-        if (level_it != ask_levels_.end()) {
-            success = level_it->second->updateOrder(order_id, new_size);
-        }
+    // Notify subscribers
+    notifyUpdate();
+
+    return true;
+}
+
+template <template <OrderSide> class Levels>
+bool BasicOrderBook<Levels>::modifyOrder(const OrderId& order_id, Quantity new_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Order** slot = orders_.find(order_id);
+    if (slot == nullptr) {
+        return false;
     }
 
+    Order& order = **slot;
+    bool success = withSide(order.getSide(), [&](auto side) {
+        return resizeOrder<decltype(side)::value>(order, new_size);
+    });
     if (success) {
         // Notify subscribers
         notifyUpdate();
@@ -133,113 +147,262 @@ bool OrderBook::modifyOrder(const std::string& order_id, double new_size) {
     return success;
 }
 
-double OrderBook::getBestBid() const {
+template <template <OrderSide> class Levels>
+bool BasicOrderBook<Levels>::reduceOrder(const OrderId& order_id, Quantity amount) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    if (!bid_levels_.empty()) {
-        return bid_levels_.begin()->first;
+    Order** slot = orders_.find(order_id);
+    if (slot == nullptr) {
+        return false;
+    }
+
+    Order& order = **slot;
+    Quantity new_size = order.getSize() - amount;
+
+    if (new_size <= 0) {
+        // Fully filled, remove order
+        eraseOrder(&order);
+    } else {
+        withSide(order.getSide(), [&](auto side) { resizeOrder<decltype(side)::value>(order, new_size); });
     }
 
-    return 0.0;
+    // Notify subscribers
+    notifyUpdate();
+
+    return true;
 }
 
-double OrderBook::getBestAsk() const {
+template <template <OrderSide> class Levels>
+MatchResult BasicOrderBook<Levels>::submitOrder(Order order, TimeInForce tif, std::vector<Fill>& fills) {
+    fills.clear();
+    MatchResult result;
+    result.remaining = order.getSize();
+
     std::lock_guard<std::mutex> lock(mutex_);
 
-    if (!ask_levels_.empty()) {
-        return ask_levels_.begin()->first;
+    if (order.getSize() <= 0 || orders_.find(order.getId()) != nullptr) {
+        result.rejected = true;
+        return result;
     }
 
-    return std::numeric_limits<double>::max();
+    // Resolve the taker's side once for the whole sweep
+    bool killed = false;
+    Quantity remaining = withSide(order.getSide(), [&](auto side) {
+        constexpr OrderSide Side = decltype(side)::value;
+        if (tif == TimeInForce::FOK && crossingVolume<Side>(order.getPrice(), order.getSize()) < order.getSize()) {
+            killed = true;
+            return order.getSize();
+        }
+        return matchAgainst<Side>(order, order.getSize(), fills);
+    });
+    if (killed) {
+        result.rejected = true;
+        return result;
+    }
+
+    result.filled = order.getSize() - remaining;
+    result.remaining = remaining;
+    result.fill_count = fills.size();
+
+    if (remaining > 0 && tif == TimeInForce::GTC) {
+        order.setSize(remaining);
+        result.rested = insertOrder(std::move(order), false);
+    }
+
+    // One publication for the whole sweep
+    if (result.filled > 0 || result.rested) {
+        notifyUpdate();
+    }
+
+    return result;
+}
+
+template <template <OrderSide> class Levels>
+Price BasicOrderBook<Levels>::getBestBid() const {
+    return top_.load().bid_price;
+}
+
+template <template <OrderSide> class Levels>
+Price BasicOrderBook<Levels>::getBestAsk() const {
+    return top_.load().ask_price;
 }
 
-double OrderBook::getSpread() const {
-    double best_bid = getBestBid();
-    double best_ask = getBestAsk();
+template <template <OrderSide> class Levels>
+Price BasicOrderBook<Levels>::getSpread() const {
+    // One snapshot, so the bid and ask come from the same book state
+    TopOfBook top = top_.load();
 
-    if (best_bid > 0.0 && best_ask < std::numeric_limits<double>::max()) {
-        return best_ask - best_bid;
+    if (top.hasBid() && top.hasAsk()) {
+        return top.ask_price - top.bid_price;
     }
 
-    return 0.0;
+    return 0;
 }
 
-std::vector<std::pair<double, double>> OrderBook::getBidLevels(size_t depth) const {
+template <template <OrderSide> class Levels>
+std::vector<std::pair<Price, Quantity>> BasicOrderBook<Levels>::getBidLevels(size_t depth) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<std::pair<double, double>> result;
+    std::vector<std::pair<Price, Quantity>> result;
+    result.reserve(std::min(depth, bid_levels_.size()));
 
-    size_t count = 0;
-    for (const auto& [price, level] : bid_levels_) {
-        if (count >= depth) break;
-        result.emplace_back(price, level->getTotalSize());
-        ++count;
-    }
+    bid_levels_.forEach(depth, [&result](const PriceLevel& level) {
+        result.emplace_back(level.getPrice(), level.getTotalSize());
+    });
 
     return result;
 }
 
-std::vector<std::pair<double, double>> OrderBook::getAskLevels(size_t depth) const {
+template <template <OrderSide> class Levels>
+std::vector<std::pair<Price, Quantity>> BasicOrderBook<Levels>::getAskLevels(size_t depth) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<std::pair<double, double>> result;
+    std::vector<std::pair<Price, Quantity>> result;
+    result.reserve(std::min(depth, ask_levels_.size()));
 
-    size_t count = 0;
-    for (const auto& [price, level] : ask_levels_) {
-        if (count >= depth) break;
-        result.emplace_back(price, level->getTotalSize());
-        ++count;
-    }
+    ask_levels_.forEach(depth, [&result](const PriceLevel& level) {
+        result.emplace_back(level.getPrice(), level.getTotalSize());
+    });
 
     return result;
 }
 
-double OrderBook::getMidpointPrice() const {
-    double best_bid = getBestBid();
-    double best_ask = getBestAsk();
+template <template <OrderSide> class Levels>
+std::shared_ptr<BookSubscription> BasicOrderBook<Levels>::subscribe(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.add(capacity);
+}
+
+template <template <OrderSide> class Levels>
+bool BasicOrderBook<Levels>::unsubscribe(const std::shared_ptr<BookSubscription>& subscription) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.remove(subscription);
+}
+
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::enableMetrics(const MetricsConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    metrics_enabled_ = true;
+    metrics_config_ = config;
+    rebuildMetrics();
+}
+
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::getDepthSnapshot(size_t depth, DepthSnapshot& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    captureDepth(depth, out);
+}
+
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::exportBook(std::vector<LevelUpdate>& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out.clear();
+    out.reserve(orders_.size());
+
+    auto exportLevel = [&out](const PriceLevel& level) {
+        for (const Order& order : level.getOrders()) {
+            out.push_back(LevelUpdate{order.getSide(), order.getPrice(), order.getSize(), order.getId()});
+        }
+    };
+    bid_levels_.forEach(bid_levels_.size(), exportLevel);
+    ask_levels_.forEach(ask_levels_.size(), exportLevel);
+}
+
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::enableDepthPublishing(size_t depth, uint64_t interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Size the buffers up front while no reader can hold one yet; later
+    // depth increases grow them on the next publications instead
+    if (published_depth_.getPublishedCount() == 0) {
+        published_depth_.prepare([depth](DepthSnapshot& snapshot) {
+            snapshot.bids.reserve(depth);
+            snapshot.asks.reserve(depth);
+        });
+    }
+
+    publish_depth_ = depth;
+    publish_interval_ = depth != 0 ? interval : 0;
+    if (publish_depth_ != 0) {
+        publishDepthLocked();
+    }
+}
+
+template <template <OrderSide> class Levels>
+bool BasicOrderBook<Levels>::publishDepth() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return publish_depth_ != 0 && publishDepthLocked();
+}
+
+template <template <OrderSide> class Levels>
+double BasicOrderBook<Levels>::getMidpointPrice() const {
+    TopOfBook top = top_.load();
 
-    if (best_bid > 0.0 && best_ask < std::numeric_limits<double>::max()) {
-        return (best_bid + best_ask) / 2.0;
+    if (top.hasBid() && top.hasAsk()) {
+        return scale_.toDouble(top.bid_price + top.ask_price) / 2.0;
     }
 
     return 0.0;
 }
 
-std::shared_ptr<Order> OrderBook::getOrder(const std::string& order_id) const {
+template <template <OrderSide> class Levels>
+std::optional<Order> BasicOrderBook<Levels>::getOrder(const OrderId& order_id) const {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    auto it = orders_.find(order_id);
-    if (it != orders_.end()) {
-        return it->second;
+    if (Order* const* slot = orders_.find(order_id)) {
+        return **slot;
     }
 
-    return nullptr;
+    return std::nullopt;
 }
 
-size_t OrderBook::getOrderCount() const {
+template <template <OrderSide> class Levels>
+Quantity BasicOrderBook<Levels>::getLevelSize(OrderSide side, Price price) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const PriceLevel* level = withSide(side, [&](auto side) -> const PriceLevel* {
+        return levels<decltype(side)::value>().find(price);
+    });
+    return level != nullptr ? level->getTotalSize() : 0;
+}
+
+template <template <OrderSide> class Levels>
+TouchStats BasicOrderBook<Levels>::getTouchStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    TouchStats stats = bid_levels_.touchStats();
+    stats += ask_levels_.touchStats();
+    return stats;
+}
+
+template <template <OrderSide> class Levels>
+size_t BasicOrderBook<Levels>::getOrderCount() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return orders_.size();
 }
 
-size_t OrderBook::getBidLevelCount() const {
+template <template <OrderSide> class Levels>
+size_t BasicOrderBook<Levels>::getBidLevelCount() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return bid_levels_.size();
 }
 
-size_t OrderBook::getAskLevelCount() const {
+template <template <OrderSide> class Levels>
+size_t BasicOrderBook<Levels>::getAskLevelCount() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return ask_levels_.size();
 }
 
-void OrderBook::processL3Update(const std::string& type, const std::string& order_id,
-                              OrderSide side, double price, double size) {
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::processL3Update(const std::string& type, const OrderId& order_id,
+                              OrderSide side, Price price, Quantity size) {
     if (type == "open" || type == "received") {
         // New order
-        auto order = std::make_shared<Order>(
+        addOrder(Order(
             order_id, side, price, size,
             std::chrono::duration_cast<std::chrono::nanoseconds>(
                 std::chrono::system_clock::now().time_since_epoch()
             )
-        );
-        addOrder(order);
+        ));
     } else if (type == "match" || type == "change") {
         // Update order size
         modifyOrder(order_id, size);
@@ -249,16 +412,250 @@ void OrderBook::processL3Update(const std::string& type, const std::string& orde
     }
 }
 
-void OrderBook::clear() {
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::clear() {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+
     // Clear all orders and price levels
-    orders_.clear();
-    bid_levels_.clear();
-    ask_levels_.clear();
-    
+    releaseOrders();
+    subscribers_.invalidate();
+
     // Notify subscribers
     notifyUpdate();
 }
 
-} // namespace clunk
\ No newline at end of file
+template <template <OrderSide> class Levels>
+bool BasicOrderBook<Levels>::insertOrder(Order order, bool worst_hint) {
+    // Move the order into its pooled slot and index it, in one probe that
+    // also rejects an ID that is already resting
+    Order* pooled = order_pool_.construct(std::move(order));
+    if (!orders_.insert(pooled->getId(), pooled)) {
+        order_pool_.destroy(pooled);
+        return false;
+    }
+
+    withSide(pooled->getSide(), [&](auto side) { queueOrder<decltype(side)::value>(*pooled, worst_hint); });
+    return true;
+}
+
+template <template <OrderSide> class Levels>
+template <OrderSide Side>
+void BasicOrderBook<Levels>::queueOrder(Order& order, bool worst_hint) {
+    // Get or create the price level and join its queue
+    Levels<Side>& side_levels = levels<Side>();
+    Price price = order.getPrice();
+    PriceLevel* level = worst_hint ? &side_levels.getOrCreateWorst(price) : &side_levels.getOrCreate(price);
+    bool created = level->isEmpty();
+    level->addOrder(order);
+    trackChange<Side>(price, order.getSize(), created, false);
+}
+
+template <template <OrderSide> class Levels>
+template <OrderSide Side>
+bool BasicOrderBook<Levels>::resizeOrder(Order& order, Quantity new_size) {
+    PriceLevel* level = levels<Side>().find(order.getPrice());
+    if (level == nullptr) {
+        return false;
+    }
+
+    Quantity old_size = order.getSize();
+    level->updateOrder(order, new_size);
+    trackChange<Side>(order.getPrice(), new_size - old_size, false, false);
+    return true;
+}
+
+template <template <OrderSide> class Levels>
+bool BasicOrderBook<Levels>::applyUpdate(const LevelUpdate& update, std::chrono::nanoseconds timestamp) {
+    OrderId order_id = update.order_id.isNull() ? OrderId::level(update.side, update.price)
+                                                : update.order_id;
+
+    Order** slot = orders_.find(order_id);
+    if (slot == nullptr) {
+        // Removing an order we do not hold is a no-op
+        return update.size > 0 &&
+               insertOrder(Order(order_id, update.side, update.price, update.size, timestamp), false);
+    }
+
+    Order& order = **slot;
+    if (update.size <= 0) {
+        eraseOrder(&order);
+        return true;
+    }
+
+    withSide(order.getSide(), [&](auto side) { resizeOrder<decltype(side)::value>(order, update.size); });
+    return true;
+}
+
+template <template <OrderSide> class Levels>
+template <OrderSide Side>
+Quantity BasicOrderBook<Levels>::matchAgainst(const Order& taker, Quantity remaining, std::vector<Fill>& fills) {
+    constexpr OrderSide Maker = opposite(Side);
+    using Compare = typename Levels<Maker>::Compare;
+    Levels<Maker>& makers = levels<Maker>();
+
+    while (remaining > 0) {
+        // Stop at the first level the taker's limit does not reach
+        const PriceLevel* best = makers.best();
+        if (best == nullptr || Compare()(taker.getPrice(), best->getPrice())) {
+            break;
+        }
+
+        Price price = best->getPrice();
+        PriceLevel* level = makers.find(price);
+        while (remaining > 0) {
+            Order& maker = *level->front();
+            Quantity size = std::min(remaining, maker.getSize());
+            remaining -= size;
+            fills.push_back({maker.getId(), taker.getId(), Side, price, size, maker.getSize() - size});
+
+            if (size < maker.getSize()) {
+                level->updateOrder(maker, maker.getSize() - size);
+                trackChange<Maker>(price, -size, false, false);
+                break;
+            }
+
+            // The maker is done; the level goes with its last order
+            bool last = level->getOrderCount() == 1;
+            eraseOrder<Maker>(&maker);
+            if (last) {
+                break;
+            }
+        }
+    }
+
+    return remaining;
+}
+
+template <template <OrderSide> class Levels>
+template <OrderSide Side>
+Quantity BasicOrderBook<Levels>::crossingVolume(Price limit, Quantity needed) const {
+    constexpr OrderSide Maker = opposite(Side);
+    using Compare = typename Levels<Maker>::Compare;
+    const Levels<Maker>& makers = levels<Maker>();
+
+    Quantity available = 0;
+    for (const PriceLevel* level = makers.best();
+         level != nullptr && available < needed && !Compare()(limit, level->getPrice());
+         level = makers.nextWorse(level->getPrice())) {
+        available += level->getTotalSize();
+    }
+    return available;
+}
+
+template <template <OrderSide> class Levels>
+template <OrderSide Side>
+void BasicOrderBook<Levels>::eraseOrder(Order* order) {
+    // Unlink from the price level, dropping the level once empty
+    bool dropped = levels<Side>().removeOrder(*order);
+    trackChange<Side>(order->getPrice(), -order->getSize(), false, dropped);
+
+    // Drop the index entry before the pooled slot (and its ID) is destroyed
+    orders_.erase(order->getId());
+    order_pool_.destroy(order);
+}
+
+template <template <OrderSide> class Levels>
+template <OrderSide Side>
+void BasicOrderBook<Levels>::publishLevel(Price price, bool dropped) {
+    LevelDelta delta;
+    delta.side = Side;
+    delta.price = price;
+    delta.sequence = mutation_count_ + 1;   // Visible once publishTop() runs
+    if (!dropped) {
+        // A read, not a change: keep it out of the touch statistics
+        const PriceLevel* level = std::as_const(*this).template levels<Side>().find(price);
+        delta.size = level != nullptr ? level->getTotalSize() : 0;
+    }
+    subscribers_.publish(delta);
+}
+
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::rebuildMetrics() {
+    bid_metrics_.rebuild(bid_levels_, metrics_config_);
+    ask_metrics_.rebuild(ask_levels_, metrics_config_);
+
+    OrderBookMetrics metrics;
+    metrics.bids = bid_metrics_.get();
+    metrics.asks = ask_metrics_.get();
+    metrics.sequence = mutation_count_;
+    metrics_.store(metrics);
+}
+
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::publishTop() {
+    TopOfBook top;
+    top.sequence = ++mutation_count_;
+
+    if (const PriceLevel* best = bid_levels_.best()) {
+        top.bid_price = best->getPrice();
+        top.bid_size = best->getTotalSize();
+    }
+    if (const PriceLevel* best = ask_levels_.best()) {
+        top.ask_price = best->getPrice();
+        top.ask_size = best->getTotalSize();
+    }
+
+    top_.store(top);
+
+    if (metrics_enabled_) {
+        OrderBookMetrics metrics;
+        metrics.bids = bid_metrics_.get();
+        metrics.asks = ask_metrics_.get();
+        metrics.sequence = top.sequence;
+        metrics_.store(metrics);
+    }
+}
+
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::captureDepth(size_t depth, DepthSnapshot& out) const {
+    out.clear();
+    out.sequence = mutation_count_;
+    out.bid_levels = bid_levels_.size();
+    out.ask_levels = ask_levels_.size();
+    out.orders = orders_.size();
+    out.bids.reserve(std::min(depth, bid_levels_.size()));
+    out.asks.reserve(std::min(depth, ask_levels_.size()));
+
+    bid_levels_.forEach(depth, [&out](const PriceLevel& level) {
+        out.bids.push(level.getPrice(), level.getTotalSize());
+    });
+    ask_levels_.forEach(depth, [&out](const PriceLevel& level) {
+        out.asks.push(level.getPrice(), level.getTotalSize());
+    });
+}
+
+template <template <OrderSide> class Levels>
+bool BasicOrderBook<Levels>::publishDepthLocked() {
+    published_at_ = mutation_count_;
+
+    // Readers pin every other buffer: keep the previous snapshot current
+    DepthSnapshot* out = published_depth_.beginWrite();
+    if (out == nullptr) {
+        return false;
+    }
+
+    captureDepth(publish_depth_, *out);
+    published_depth_.publish();
+    return true;
+}
+
+template <template <OrderSide> class Levels>
+void BasicOrderBook<Levels>::releaseOrders() {
+    // Unlink every queue first so no order is destroyed while still linked
+    bid_levels_.clear();
+    ask_levels_.clear();
+
+    for (auto& slot : orders_) {
+        order_pool_.destroy(slot.value);
+    }
+    orders_.clear();
+
+    bid_metrics_.reset(metrics_config_);
+    ask_metrics_.reset(metrics_config_);
+}
+
+// Explicit instantiations for both level containers
+template class BasicOrderBook<MapLevels>;
+template class BasicOrderBook<PriceLadder>;
+
+} // namespace clunk
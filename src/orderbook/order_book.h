@@ -1,90 +1,340 @@
 #pragma once
 
 #include "order.h"
+#include "book_view.h"
+#include "depth_snapshot.h"
 #include "price_level.h"
-#include <map>
+#include "map_levels.h"
+#include "matching.h"
+#include "price_ladder.h"
+#include "analytics/order_book_metrics.h"
+#include "utils/flat_hash_map.h"
+#include "utils/memory_pool.h"
+#include "utils/seqlock.h"
 #include <memory>
+#include <optional>
 #include <vector>
 #include <string>
 #include <mutex>
-#include <functional>
+#include <limits>
+#include <cstdint>
 
 namespace clunk {
 
-// Callback types for order book updates
-using OrderBookUpdateCallback = std::function<void()>;
-
-// OrderBook class implementing a limit order book
-class OrderBook {
+// BasicOrderBook class implementing a limit order book
+//
+// Orders are copied into a pool owned by the book and linked into their
+// price level's FIFO queue intrusively; a flat open-addressing index maps
+// 128-bit order IDs to their pooled slot. Adding, modifying and cancelling an
+// order therefore costs one index probe plus one level lookup, with no
+// reference counting and no string hashing or comparison.
+//
+// Level nodes are drawn from a per-book slab arena and the index is a
+// single inline table, so once reserve() has sized the book (e.g. from a
+// snapshot's depth) steady state processing never calls into the global
+// allocator.
+//
+// Best bid/ask queries read a seqlock-protected TopOfBook record instead of
+// taking the book mutex, so pollers on other threads never stall the feed
+// thread and always see a bid and ask from the same book state. Consumers
+// that follow the depth subscribe() for level deltas, which the writer
+// hands off without waiting on them.
+//
+// Prices and sizes are integer ticks/lots of the book's ProductScale; use
+// getScale() to parse feed strings into them or to convert for display.
+//
+// The level container is a template parameter instantiated once per side
+// (see MapLevels for the interface it must provide). Two books are built:
+//   - OrderBook uses MapLevels (std::map per side), fine for any product.
+//   - LadderOrderBook uses PriceLadder (dense ring around the touch), faster
+//     for liquid products whose activity stays near the mid.
+//
+// Each mutation tests the order's side once and then runs a core
+// instantiated per side, so the container, its comparator and best-level
+// tracking, and the side's metrics tracker are all fixed at compile time
+// inside the insert, resize, erase and matching loops.
+template <template <OrderSide> class Levels>
+class BasicOrderBook final : public BookView {
 public:
-    // Constructor
-    explicit OrderBook(const std::string& symbol);
+    // Constructor (scale defaults to ProductScale::forSymbol(symbol))
+    explicit BasicOrderBook(const std::string& symbol);
+    BasicOrderBook(const std::string& symbol, ProductScale scale);
+
+    // Destructor
+    ~BasicOrderBook() override;
+
+    // Books own pooled orders and cannot be copied
+    BasicOrderBook(const BasicOrderBook&) = delete;
+    BasicOrderBook& operator=(const BasicOrderBook&) = delete;
 
     // Symbol getter
-    const std::string& getSymbol() const { return symbol_; }
+    const std::string& getSymbol() const override { return symbol_; }
+
+    // Fixed-point scale of this book's prices and sizes
+    const ProductScale& getScale() const override { return scale_; }
+
+    // Pre-size the order pool, index and level arenas
+    void reserve(size_t order_count, size_t level_count);
 
     // Order management functions
-    bool addOrder(const std::shared_ptr<Order>& order);
-    bool removeOrder(const std::string& order_id);
-    bool modifyOrder(const std::string& order_id, double new_size);
+    bool addOrder(Order order);
+    bool removeOrder(const OrderId& order_id);
+    bool modifyOrder(const OrderId& order_id, Quantity new_size);
+
+    // Reduce an order by a filled amount, removing it once fully filled
+    bool reduceOrder(const OrderId& order_id, Quantity amount);
+
+    // Match an incoming order against the opposite side in price-time
+    // priority (best price first, oldest order first within a price), then
+    // handle the remainder per `tif`. Fills replace the contents of `fills`
+    // (reusing its storage), in execution order at the makers' prices. The
+    // whole order is matched under one lock acquisition and published once.
+    // There is no self-trade prevention: every resting order is a maker.
+    MatchResult submitOrder(Order order, TimeInForce tif, std::vector<Fill>& fills);
+
+    // Apply a batch of adds, resizes and removals (e.g. one l2update change
+    // set) under a single lock acquisition, publishing and notifying once;
+    // returns the number of updates that changed the book
+    size_t applyUpdates(const LevelUpdate* updates, size_t count);
+
+    // Replace the book's contents with a snapshot under a single lock
+    // acquisition, publishing and notifying once. Levels given best-first per
+    // side (the order exchanges send them in) are inserted with end hints;
+    // any other order is still correct, only slower. Zero-size entries and
+    // repeated order IDs are skipped.
+    void loadSnapshot(const LevelUpdate* levels, size_t count);
+
+    // Consistent best bid/ask snapshot (lock-free; never blocks writers)
+    TopOfBook getTopOfBook() const override { return top_.load(); }
+
+    // Get best bid and ask (0 / kNoAsk when the side is empty)
+    Price getBestBid() const;
+    Price getBestAsk() const;
+
+    // Get bid-ask spread in ticks
+    Price getSpread() const;
+
+    // Get order book depth at specified levels as (price, size) pairs
+    // (locks and allocates; frequent readers use getPublishedDepth())
+    std::vector<std::pair<Price, Quantity>> getBidLevels(size_t depth) const;
+    std::vector<std::pair<Price, Quantity>> getAskLevels(size_t depth) const;
+
+    // Maintain volume/notional metrics (whole side, best N levels, band
+    // around the touch) incrementally on every mutation, starting from the
+    // book's current contents
+    void enableMetrics(const MetricsConfig& config = MetricsConfig());
+
+    // Latest metrics (lock-free; all zero unless enableMetrics() was called)
+    OrderBookMetrics getMetrics() const { return metrics_.load(); }
 
-    // Get best bid and ask
-    double getBestBid() const;
-    double getBestAsk() const;
+    // Capture up to `depth` levels of both sides under one lock into `out`
+    // (reusing its storage)
+    void getDepthSnapshot(size_t depth, DepthSnapshot& out) const override;
 
-    // Get bid-ask spread
-    double getSpread() const;
+    // Every resting order, for checkpoints (see BookView)
+    void exportBook(std::vector<LevelUpdate>& out) const override;
 
-    // Get order book depth at specified levels
-    std::vector<std::pair<double, double>> getBidLevels(size_t depth) const;
-    std::vector<std::pair<double, double>> getAskLevels(size_t depth) const;
+    // Wait-free depth publication for many readers (see BookView)
+    void enableDepthPublishing(size_t depth, uint64_t interval = 1) override;
+    bool publishDepth() override;
+    PublishedDepth getPublishedDepth() const override { return published_depth_.acquire(); }
 
-    // Get midpoint price
+    // Get midpoint price (in price units; the midpoint may fall between ticks)
     double getMidpointPrice() const;
 
-    // Get order by ID
-    std::shared_ptr<Order> getOrder(const std::string& order_id) const;
+    // Get a copy of an order by ID
+    std::optional<Order> getOrder(const OrderId& order_id) const;
+
+    // Total size resting at (side, price), or 0
+    Quantity getLevelSize(OrderSide side, Price price) const override;
+
+    // Level lookups served by the tree levels' best-level slots (always
+    // zero over PriceLadder, which needs none)
+    TouchStats getTouchStats() const override;
 
     // Get statistics
-    size_t getOrderCount() const;
-    size_t getBidLevelCount() const;
-    size_t getAskLevelCount() const;
+    size_t getOrderCount() const override;
+    size_t getBidLevelCount() const override;
+    size_t getAskLevelCount() const override;
 
-    // Set update callback
-    void setUpdateCallback(OrderBookUpdateCallback callback) {
-        update_callback_ = callback;
-    }
+    // Level change subscriptions (see BookView)
+    std::shared_ptr<BookSubscription> subscribe(
+        size_t capacity = BookSubscription::kDefaultCapacity) override;
+    bool unsubscribe(const std::shared_ptr<BookSubscription>& subscription) override;
 
     // Process an L3 update (add, modify, remove)
-    void processL3Update(const std::string& type, const std::string& order_id,
-                        OrderSide side, double price, double size);
+    void processL3Update(const std::string& type, const OrderId& order_id,
+                        OrderSide side, Price price, Quantity size);
 
     // Clear all orders from the order book
     void clear();
 
+    // Best ask reported for an empty ask side
+    static constexpr Price kNoAsk = std::numeric_limits<Price>::max();
+
 private:
+    using OrderIndex = FlatHashMap<OrderId, Order*, OrderIdHash>;
+
     std::string symbol_;                                // Instrument symbol
+    ProductScale scale_;                                // Tick and lot sizes
+
+    // Per-book arenas (declared first so they outlive the containers)
+    ObjectPool<Order> order_pool_;                      // Every resting order
+    SlabArena level_arena_;                             // Level nodes (both sides)
 
-    // Using maps for bid and ask levels ensures price ordering
-    // For bids, we use reverse ordering to get highest bids first
-    std::map<double, std::unique_ptr<PriceLevel>, std::greater<>> bid_levels_;
-    std::map<double, std::unique_ptr<PriceLevel>> ask_levels_;
+    // Level containers iterate best-first for their side
+    // (highest bids first, lowest asks first)
+    Levels<OrderSide::BUY> bid_levels_;
+    Levels<OrderSide::SELL> ask_levels_;
 
-    // Map to quickly look up orders by ID
-    std::unordered_map<std::string, std::shared_ptr<Order>> orders_;
+    // Map to quickly look up pooled orders by ID
+    OrderIndex orders_;
 
     // Mutex for thread safety
     mutable std::mutex mutex_;
 
-    // Callback for order book updates
-    OrderBookUpdateCallback update_callback_;
+    // Top of book, republished under mutex_ after every mutation
+    SeqLock<TopOfBook> top_;
+    uint64_t mutation_count_ = 0;
+
+    // Incremental metrics (updated and republished under mutex_ when enabled)
+    bool metrics_enabled_ = false;
+    MetricsConfig metrics_config_;
+    SideMetricsTracker<Levels<OrderSide::BUY>> bid_metrics_;
+    SideMetricsTracker<Levels<OrderSide::SELL>> ask_metrics_;
+    SeqLock<OrderBookMetrics> metrics_;
 
-    // Notify subscribers of updates
+    // Level delta subscribers (published to under mutex_)
+    BookSubscribers subscribers_;
+
+    // Set while loadSnapshot() inserts; it reports to the trackers and
+    // subscribers once at the end instead of per level
+    bool loading_ = false;
+
+    // Published depth snapshots (written under mutex_, read wait-free)
+    DepthBuffer published_depth_;
+    size_t publish_depth_ = 0;          // Levels per side; 0 while disabled
+    uint64_t publish_interval_ = 0;     // Mutations between publications
+    uint64_t published_at_ = 0;         // mutation_count_ at the last one
+
+    // Per-side state, picked at compile time
+    template <OrderSide Side>
+    Levels<Side>& levels() {
+        if constexpr (Side == OrderSide::BUY) {
+            return bid_levels_;
+        } else {
+            return ask_levels_;
+        }
+    }
+
+    template <OrderSide Side>
+    const Levels<Side>& levels() const {
+        if constexpr (Side == OrderSide::BUY) {
+            return bid_levels_;
+        } else {
+            return ask_levels_;
+        }
+    }
+
+    template <OrderSide Side>
+    SideMetricsTracker<Levels<Side>>& sideMetrics() {
+        if constexpr (Side == OrderSide::BUY) {
+            return bid_metrics_;
+        } else {
+            return ask_metrics_;
+        }
+    }
+
+    // Pool an order and queue it at its level, unless its ID is already
+    // resting; `worst_hint` uses the containers' end-hinted insert for
+    // best-first bulk loads (caller holds mutex_)
+    bool insertOrder(Order order, bool worst_hint);
+
+    // The side-specific halves of the mutations: the public entry points
+    // resolve the order's side once with withSide() and everything below
+    // runs against one side's container, comparator and trackers with no
+    // further side tests (caller holds mutex_)
+    template <OrderSide Side>
+    void queueOrder(Order& order, bool worst_hint);
+
+    // Resize a resting order in place; false if its level is missing
+    template <OrderSide Side>
+    bool resizeOrder(Order& order, Quantity new_size);
+
+    // Unlink an order from its level and return it to the pool
+    template <OrderSide Side>
+    void eraseOrder(Order* order);
+
+    // Fill `remaining` of a `Side` taker against the opposite side's levels
+    // while they cross its limit; returns what is left
+    template <OrderSide Side>
+    Quantity matchAgainst(const Order& taker, Quantity remaining, std::vector<Fill>& fills);
+
+    // Volume on the side opposite `Side` crossing `limit`, counted until it
+    // reaches `needed`
+    template <OrderSide Side>
+    Quantity crossingVolume(Price limit, Quantity needed) const;
+
+    // Apply one batched update (caller holds mutex_)
+    bool applyUpdate(const LevelUpdate& update, std::chrono::nanoseconds timestamp);
+
+    // Erase an order whose side is only known at runtime (caller holds mutex_)
+    void eraseOrder(Order* order) {
+        withSide(order->getSide(), [this, order](auto side) { eraseOrder<decltype(side)::value>(order); });
+    }
+
+    // Release every pooled order (caller holds mutex_)
+    void releaseOrders();
+
+    // Rebuild the metrics trackers from the current levels and publish them
+    // (caller holds mutex_)
+    void rebuildMetrics();
+
+    // Republish the top of book record (and metrics) (caller holds mutex_)
+    void publishTop();
+
+    // Copy the best `depth` levels per side into `out` (caller holds mutex_)
+    void captureDepth(size_t depth, DepthSnapshot& out) const;
+
+    // Fill a free depth buffer and make it current (caller holds mutex_)
+    bool publishDepthLocked();
+
+    // Feed a level size change to the metrics trackers and subscribers
+    // (caller holds mutex_)
+    template <OrderSide Side>
+    void trackChange(Price price, Quantity delta, bool created, bool dropped) {
+        if (loading_) {
+            return;
+        }
+        if (metrics_enabled_) {
+            sideMetrics<Side>().onChange(levels<Side>(), price, delta, created, dropped);
+        }
+        if (!subscribers_.empty()) {
+            publishLevel<Side>(price, dropped);
+        }
+    }
+
+    // Hand the level's new size to every subscriber (caller holds mutex_)
+    template <OrderSide Side>
+    void publishLevel(Price price, bool dropped);
+
+    // Publish the new top of book, and the depth when it is due
+    // (caller holds mutex_)
     void notifyUpdate() {
-        if (update_callback_) {
-            update_callback_();
+        publishTop();
+        if (publish_interval_ != 0 && mutation_count_ - published_at_ >= publish_interval_) {
+            publishDepthLocked();
         }
     }
 };
 
-} // namespace clunk
\ No newline at end of file
+// Tree-backed book (any price range)
+using OrderBook = BasicOrderBook<MapLevels>;
+
+// Array-indexed ladder book (dense window around the touch)
+using LadderOrderBook = BasicOrderBook<PriceLadder>;
+
+extern template class BasicOrderBook<MapLevels>;
+extern template class BasicOrderBook<PriceLadder>;
+
+} // namespace clunk
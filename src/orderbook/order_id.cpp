@@ -0,0 +1,131 @@
+#include "order_id.h"
+#include "order.h"
+
+namespace clunk {
+
+namespace {
+
+// Tagged IDs keep the UUID version nibble (bits 12-15 of hi) clear
+constexpr uint64_t kVersionMask = 0xF000ull;
+constexpr uint64_t kTagPayloadMask = 0x00FFFFFFFFFF0FFFull;
+constexpr int kKindShift = 56;
+
+// Map an ASCII character to its hex value, or -1
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 64-bit FNV-1a with a configurable offset basis
+uint64_t fnv1a(std::string_view text, uint64_t basis) {
+    uint64_t h = basis;
+    for (char c : text) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+// Finalizer spreading FNV output across all bits
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+OrderId tagged(OrderId::Kind kind, uint64_t payload_hi, uint64_t lo) {
+    return OrderId((static_cast<uint64_t>(kind) << kKindShift) | (payload_hi & kTagPayloadMask), lo);
+}
+
+} // namespace
+
+bool OrderId::parseUuid(std::string_view text, OrderId& out) {
+    if (text.size() != 36 || text[8] != '-' || text[13] != '-' ||
+        text[18] != '-' || text[23] != '-') {
+        return false;
+    }
+
+    uint64_t words[2] = {0, 0};
+    int nibble = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (i == 8 || i == 13 || i == 18 || i == 23) {
+            continue;
+        }
+
+        int value = hexValue(text[i]);
+        if (value < 0) {
+            return false;
+        }
+
+        uint64_t& word = words[nibble / 16];
+        word = (word << 4) | static_cast<uint64_t>(value);
+        ++nibble;
+    }
+
+    out = OrderId(words[0], words[1]);
+    return true;
+}
+
+OrderId OrderId::fromString(std::string_view text) {
+    OrderId id;
+    if (parseUuid(text, id)) {
+        return id;
+    }
+
+    return tagged(Kind::HASHED,
+                  mix(fnv1a(text, 0x84222325CBF29CE4ull)),
+                  mix(fnv1a(text, 0xCBF29CE484222325ull)));
+}
+
+OrderId OrderId::level(OrderSide side, Price price) {
+    return tagged(Kind::LEVEL, static_cast<uint64_t>(side) + 1, static_cast<uint64_t>(price));
+}
+
+OrderId::Kind OrderId::kind() const {
+    if ((hi & kVersionMask) == 0) {
+        auto tag = static_cast<uint8_t>(hi >> kKindShift);
+        if (tag == static_cast<uint8_t>(Kind::LEVEL)) return Kind::LEVEL;
+        if (tag == static_cast<uint8_t>(Kind::HASHED)) return Kind::HASHED;
+    }
+    return Kind::EXCHANGE;
+}
+
+std::string OrderId::toString() const {
+    static const char hex[] = "0123456789abcdef";
+
+    switch (kind()) {
+        case Kind::LEVEL: {
+            return std::string((hi & 0xFF) == 1 ? "bid-" : "ask-") +
+                   std::to_string(static_cast<Price>(lo));
+        }
+        case Kind::HASHED: {
+            std::string result = "#";
+            for (int shift = 60; shift >= 0; shift -= 4) {
+                result.push_back(hex[(lo >> shift) & 0xF]);
+            }
+            return result;
+        }
+        case Kind::EXCHANGE:
+        default:
+            break;
+    }
+
+    std::string result;
+    result.reserve(36);
+    for (int i = 0; i < 32; ++i) {
+        if (i == 8 || i == 12 || i == 16 || i == 20) {
+            result.push_back('-');
+        }
+        uint64_t word = i < 16 ? hi : lo;
+        int shift = 60 - 4 * (i % 16);
+        result.push_back(hex[(word >> shift) & 0xF]);
+    }
+    return result;
+}
+
+} // namespace clunk
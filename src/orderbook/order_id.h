@@ -0,0 +1,88 @@
+#pragma once
+
+#include "fixed_point.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace clunk {
+
+// Defined in order.h
+enum class OrderSide : uint8_t;
+
+// Compact 128-bit order identifier
+//
+// Exchange order IDs (Coinbase uses RFC 4122 UUIDs) parse straight into two
+// 64-bit words, so comparing or hashing an ID never touches a string. IDs the
+// book has to invent itself get a tagged form instead:
+//
+//   - Level IDs stand for an aggregated price level (L2 feeds, tickers) and
+//     are built from the side and price in ticks.
+//   - Hashed IDs intern any other string through a 116-bit hash.
+//
+// Tagged IDs set the UUID version nibble to 0, which no RFC 4122 UUID other
+// than the nil UUID uses, and store their kind in the top byte.
+struct OrderId {
+    // Kind of identifier
+    enum class Kind : uint8_t {
+        EXCHANGE = 0,    // Parsed exchange UUID
+        LEVEL = 1,       // Synthetic aggregated price level key
+        HASHED = 2       // Interned arbitrary string
+    };
+
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    constexpr OrderId() = default;
+    constexpr OrderId(uint64_t high, uint64_t low) : hi(high), lo(low) {}
+
+    // Parse a canonical UUID ("xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx")
+    static bool parseUuid(std::string_view text, OrderId& out);
+
+    // Parse a UUID, falling back to a hashed ID for any other string
+    static OrderId fromString(std::string_view text);
+
+    // Synthetic key for the aggregated level at (side, price)
+    static OrderId level(OrderSide side, Price price);
+
+    // Kind of this identifier
+    Kind kind() const;
+
+    // Whether the ID carries any value
+    bool isNull() const { return hi == 0 && lo == 0; }
+
+    // Human-readable form (canonical UUID for exchange IDs)
+    std::string toString() const;
+
+    bool operator==(const OrderId& other) const { return hi == other.hi && lo == other.lo; }
+    bool operator!=(const OrderId& other) const { return !(*this == other); }
+    bool operator<(const OrderId& other) const {
+        return hi < other.hi || (hi == other.hi && lo < other.lo);
+    }
+};
+
+// Fast hasher for OrderId
+//
+// UUID bits are already random, but synthetic level keys are not, so both
+// words are folded together and run through a 64-bit finalizer.
+struct OrderIdHash {
+    size_t operator()(const OrderId& id) const {
+        uint64_t h = id.lo ^ (id.hi * 0x9E3779B97F4A7C15ull);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+};
+
+} // namespace clunk
+
+namespace std {
+
+template <>
+struct hash<clunk::OrderId> : clunk::OrderIdHash {};
+
+} // namespace std
@@ -0,0 +1,409 @@
+#pragma once
+
+#include "price_level.h"
+#include "touch_stats.h"
+#include "utils/memory_pool.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace clunk {
+
+namespace detail {
+
+// Index of the highest set bit (bits != 0)
+inline unsigned highestBit(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, bits);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(bits));
+#endif
+}
+
+// Index of the lowest set bit (bits != 0)
+inline unsigned lowestBit(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+}
+
+} // namespace detail
+
+// Array-indexed level container for one side of a book
+//
+// Levels within a window of kWindowTicks ticks live in a dense ring indexed
+// by `price & (kWindowTicks - 1)`, so finding a level is a mask and an array
+// access instead of a tree walk. An occupancy bitmap (one bit per ring slot)
+// lets the next best level be found a 64-tick word at a time, and the best
+// in-window price is cached so best() is O(1).
+//
+// The window follows the touch: a level arriving better than the current
+// best and outside the window re-centers it there. Levels that fall outside
+// the window, and far-from-touch levels that never entered it, spill into a
+// sparse overflow map (same ordering as MapLevels). Because ring slots depend
+// only on the price, levels that stay in the window are never moved.
+template <OrderSide Side>
+class PriceLadder {
+public:
+    static constexpr size_t kWindowTicks = 4096;
+
+    using Compare = std::conditional_t<Side == OrderSide::BUY, std::greater<Price>, std::less<Price>>;
+    using Allocator = SlabAllocator<std::pair<const Price, PriceLevel>>;
+
+    // Constructor
+    explicit PriceLadder(SlabArena* arena)
+        : overflow_(Compare(), Allocator(arena)) {
+        slots_.reserve(kWindowTicks);
+        for (size_t i = 0; i < kWindowTicks; ++i) {
+            slots_.emplace_back(0);
+        }
+        occupied_.fill(0);
+    }
+
+    // Ladders own level queues and cannot be copied
+    PriceLadder(const PriceLadder&) = delete;
+    PriceLadder& operator=(const PriceLadder&) = delete;
+
+    // Get the level at `price`, creating it if needed
+    PriceLevel& getOrCreate(Price price) {
+        if (!inWindow(price)) {
+            if (count_ != 0 && !better(price, best_)) {
+                return overflow_.try_emplace(price, price).first->second;
+            }
+            recenter(price);
+        }
+        return getOrCreateInWindow(price);
+    }
+
+    // Get or create the level at `price`, expected to be at or worse than
+    // every existing level (bulk loads in best-first order): window levels
+    // are O(1) anyway, and overflow inserts are hinted at the end of the map.
+    // Still correct, only slower, otherwise.
+    PriceLevel& getOrCreateWorst(Price price) {
+        if (!inWindow(price) && count_ != 0 && !better(price, best_)) {
+            return overflow_.try_emplace(overflow_.end(), price, price)->second;
+        }
+        return getOrCreate(price);
+    }
+
+    // Find the level at `price`, or nullptr
+    PriceLevel* find(Price price) {
+        return const_cast<PriceLevel*>(std::as_const(*this).find(price));
+    }
+
+    const PriceLevel* find(Price price) const {
+        if (inWindow(price)) {
+            size_t index = slotOf(price);
+            return isOccupied(index) ? &slots_[index] : nullptr;
+        }
+
+        auto it = overflow_.find(price);
+        return it == overflow_.end() ? nullptr : &it->second;
+    }
+
+    // Unlink an order from its level, dropping the level once empty;
+    // returns true if the level was dropped
+    bool removeOrder(Order& order) {
+        Price price = order.getPrice();
+
+        if (inWindow(price)) {
+            size_t index = slotOf(price);
+            if (!isOccupied(index)) {
+                return false;
+            }
+
+            slots_[index].removeOrder(order);
+            if (slots_[index].isEmpty()) {
+                clearOccupied(index);
+                --count_;
+                if (count_ != 0 && price == best_) {
+                    nextWorse(price, best_);
+                }
+                return true;
+            }
+            return false;
+        }
+
+        auto it = overflow_.find(price);
+        if (it == overflow_.end()) {
+            return false;
+        }
+
+        it->second.removeOrder(order);
+        if (it->second.isEmpty()) {
+            overflow_.erase(it);
+            return true;
+        }
+        return false;
+    }
+
+    // Best level for the side, or nullptr if empty
+    const PriceLevel* best() const {
+        if (count_ == 0) {
+            return overflow_.empty() ? nullptr : &overflow_.begin()->second;
+        }
+
+        const PriceLevel& in_window = slots_[slotOf(best_)];
+        if (!overflow_.empty() && better(overflow_.begin()->first, best_)) {
+            return &overflow_.begin()->second;
+        }
+        return &in_window;
+    }
+
+    // Best level strictly worse than `price` (which need not exist), or nullptr
+    //
+    // The nearest candidate is either in the window (bitmap scan) or in the
+    // overflow map; whichever is better wins.
+    const PriceLevel* nextWorse(Price price) const {
+        const PriceLevel* in_window = nullptr;
+        Price found = 0;
+        if (count_ != 0) {
+            bool hit;
+            if constexpr (Side == OrderSide::BUY) {
+                hit = price - 1 >= low_ && scanDown(std::min(price - 1, high()), found);
+            } else {
+                hit = price + 1 <= high() && scanUp(std::max(price + 1, low_), found);
+            }
+            if (hit) {
+                in_window = &slots_[slotOf(found)];
+            }
+        }
+
+        auto it = overflow_.upper_bound(price);
+        const PriceLevel* in_overflow = it == overflow_.end() ? nullptr : &it->second;
+
+        if (in_window == nullptr || (in_overflow != nullptr && better(in_overflow->getPrice(), found))) {
+            return in_overflow;
+        }
+        return in_window;
+    }
+
+    // Worst level strictly better than `price` (which need not exist), or nullptr
+    const PriceLevel* nextBetter(Price price) const {
+        const PriceLevel* in_window = nullptr;
+        Price found = 0;
+        if (count_ != 0) {
+            bool hit;
+            if constexpr (Side == OrderSide::BUY) {
+                hit = price + 1 <= high() && scanUp(std::max(price + 1, low_), found);
+            } else {
+                hit = price - 1 >= low_ && scanDown(std::min(price - 1, high()), found);
+            }
+            if (hit) {
+                in_window = &slots_[slotOf(found)];
+            }
+        }
+
+        auto it = overflow_.lower_bound(price);
+        const PriceLevel* in_overflow = it == overflow_.begin() ? nullptr : &std::prev(it)->second;
+
+        if (in_window == nullptr || (in_overflow != nullptr && better(found, in_overflow->getPrice()))) {
+            return in_overflow;
+        }
+        return in_window;
+    }
+
+    // Visit up to `depth` levels, best first
+    //
+    // Overflow levels all lie outside the window, so they are either better
+    // than every window level or worse than all of them: visit the better
+    // ones, then the window in bitmap order, then the rest of the overflow.
+    template <typename Visitor>
+    void forEach(size_t depth, Visitor&& visit) const {
+        size_t count = 0;
+        auto it = overflow_.begin();
+
+        if (count_ != 0) {
+            for (; it != overflow_.end() && better(it->first, best_) && count < depth; ++it, ++count) {
+                visit(it->second);
+            }
+
+            Price price = best_;
+            bool more = count < depth;
+            while (more) {
+                visit(slots_[slotOf(price)]);
+                more = ++count < depth && nextWorse(price, price);
+            }
+        }
+
+        for (; it != overflow_.end() && count < depth; ++it, ++count) {
+            visit(it->second);
+        }
+    }
+
+    size_t size() const { return count_ + overflow_.size(); }
+    bool empty() const { return size() == 0; }
+
+    // Number of levels currently held in the dense window
+    size_t windowLevelCount() const { return count_; }
+
+    // Window lookups cost the same at any depth, so the ladder keeps no
+    // best-level slot and reports no touch statistics
+    TouchStats touchStats() const { return TouchStats(); }
+
+    // Drop every level (unlinking their queues)
+    void clear() {
+        for (size_t word = 0; word < occupied_.size(); ++word) {
+            uint64_t bits = occupied_[word];
+            while (bits != 0) {
+                unsigned bit = detail::lowestBit(bits);
+                slots_[word * 64 + bit].clear();
+                bits &= bits - 1;
+            }
+            occupied_[word] = 0;
+        }
+        count_ = 0;
+        overflow_.clear();
+    }
+
+private:
+    static constexpr size_t kMask = kWindowTicks - 1;
+    static constexpr size_t kWords = kWindowTicks / 64;
+    static_assert((kWindowTicks & kMask) == 0 && kWindowTicks >= 64,
+                  "window must be a power of two of at least 64 ticks");
+
+    std::vector<PriceLevel> slots_;                   // Ring of levels, by price & kMask
+    std::array<uint64_t, kWords> occupied_;           // One bit per occupied slot
+    Price low_ = 0;                                   // Lowest price in the window
+    Price best_ = 0;                                  // Best in-window price (count_ > 0)
+    size_t count_ = 0;                                // Occupied in-window levels
+    std::map<Price, PriceLevel, Compare, Allocator> overflow_;  // Levels outside the window
+
+    static bool better(Price a, Price b) { return Compare()(a, b); }
+    static size_t slotOf(Price price) { return static_cast<size_t>(price) & kMask; }
+
+    Price high() const { return low_ + static_cast<Price>(kWindowTicks) - 1; }
+    bool inWindow(Price price) const { return price >= low_ && price <= high(); }
+
+    bool isOccupied(size_t index) const { return (occupied_[index >> 6] >> (index & 63)) & 1; }
+    void setOccupied(size_t index) { occupied_[index >> 6] |= uint64_t(1) << (index & 63); }
+    void clearOccupied(size_t index) { occupied_[index >> 6] &= ~(uint64_t(1) << (index & 63)); }
+
+    // Next occupied in-window price strictly worse than `from`
+    bool nextWorse(Price from, Price& out) const {
+        if constexpr (Side == OrderSide::BUY) {
+            return scanDown(from - 1, out);
+        } else {
+            return scanUp(from + 1, out);
+        }
+    }
+
+    // Highest occupied price in [low_, from]
+    bool scanDown(Price from, Price& out) const {
+        Price price = from;
+        while (price >= low_) {
+            size_t index = slotOf(price);
+            unsigned bit = static_cast<unsigned>(index & 63);
+            uint64_t mask = bit == 63 ? ~uint64_t(0) : (uint64_t(2) << bit) - 1;
+            uint64_t bits = occupied_[index >> 6] & mask;
+            if (bits != 0) {
+                Price found = price - static_cast<Price>(bit - detail::highestBit(bits));
+                if (found < low_) {
+                    return false;
+                }
+                out = found;
+                return true;
+            }
+            price -= static_cast<Price>(bit) + 1;
+        }
+        return false;
+    }
+
+    // Lowest occupied price in [from, high()]
+    bool scanUp(Price from, Price& out) const {
+        Price price = from;
+        Price limit = high();
+        while (price <= limit) {
+            size_t index = slotOf(price);
+            unsigned bit = static_cast<unsigned>(index & 63);
+            uint64_t bits = occupied_[index >> 6] & (~uint64_t(0) << bit);
+            if (bits != 0) {
+                Price found = price + static_cast<Price>(detail::lowestBit(bits) - bit);
+                if (found > limit) {
+                    return false;
+                }
+                out = found;
+                return true;
+            }
+            price += static_cast<Price>(64 - bit);
+        }
+        return false;
+    }
+
+    // Get or create the level at in-window `price`
+    PriceLevel& getOrCreateInWindow(Price price) {
+        size_t index = slotOf(price);
+        if (!isOccupied(index)) {
+            slots_[index] = PriceLevel(price);
+            setOccupied(index);
+            if (count_ == 0 || better(price, best_)) {
+                best_ = price;
+            }
+            ++count_;
+        }
+        return slots_[index];
+    }
+
+    // Move the window so it is centered on `center`, spilling levels that
+    // leave it into the overflow map and pulling overflow levels inside it
+    void recenter(Price center) {
+        Price new_low = center - static_cast<Price>(kWindowTicks / 2);
+        Price new_high = new_low + static_cast<Price>(kWindowTicks) - 1;
+
+        // Spill levels that leave the window
+        for (size_t word = 0; word < kWords && count_ != 0; ++word) {
+            uint64_t bits = occupied_[word];
+            while (bits != 0) {
+                size_t index = word * 64 + detail::lowestBit(bits);
+                bits &= bits - 1;
+
+                Price price = slots_[index].getPrice();
+                if (price < new_low || price > new_high) {
+                    overflow_.emplace(price, std::move(slots_[index]));
+                    clearOccupied(index);
+                    --count_;
+                }
+            }
+        }
+
+        low_ = new_low;
+
+        // Pull overflow levels that now fall inside the window
+        auto first = overflow_.lower_bound(Side == OrderSide::BUY ? new_high : new_low);
+        auto last = overflow_.upper_bound(Side == OrderSide::BUY ? new_low : new_high);
+        for (auto it = first; it != last;) {
+            size_t index = slotOf(it->first);
+            slots_[index] = std::move(it->second);
+            setOccupied(index);
+            ++count_;
+            it = overflow_.erase(it);
+        }
+
+        // Re-derive the cached best from the bitmap
+        if (count_ != 0) {
+            if constexpr (Side == OrderSide::BUY) {
+                scanDown(high(), best_);
+            } else {
+                scanUp(low_, best_);
+            }
+        }
+    }
+};
+
+} // namespace clunk
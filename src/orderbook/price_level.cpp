@@ -2,64 +2,47 @@
 
 namespace clunk {
 
-PriceLevel::PriceLevel(double price)
-    : price_(price), total_size_(0.0) {
+PriceLevel::PriceLevel(Price price)
+    : price_(price), total_size_(0) {
 }
 
-bool PriceLevel::addOrder(const std::shared_ptr<Order>& order) {
+bool PriceLevel::addOrder(Order& order) {
     // Verify the order is at the correct price level
-    if (std::abs(order->getPrice() - price_) > std::numeric_limits<double>::epsilon()) {
+    if (order.getPrice() != price_) {
         return false;
     }
 
-    // Check if order already exists
-    if (orders_.find(order->getId()) != orders_.end()) {
+    // An order can only be queued at one level at a time
+    if (order.isQueued()) {
         return false;
     }
 
-    // Add the order
-    orders_[order->getId()] = order;
-    total_size_ += order->getSize();
+    // Join the back of the queue
+    orders_.push_back(order);
+    total_size_ += order.getSize();
 
     return true;
 }
 
-bool PriceLevel::removeOrder(const std::string& order_id) {
-    auto it = orders_.find(order_id);
-    if (it == orders_.end()) {
-        return false;
-    }
-
+void PriceLevel::removeOrder(Order& order) {
     // Subtract order size from total
-    total_size_ -= it->second->getSize();
+    total_size_ -= order.getSize();
 
-    // Remove the order
-    orders_.erase(it);
-
-    return true;
+    // Unlink the order in O(1)
+    orders_.erase(orders_.iterator_to(order));
 }
 
-bool PriceLevel::updateOrder(const std::string& order_id, double new_size) {
-    auto it = orders_.find(order_id);
-    if (it == orders_.end()) {
-        return false;
-    }
-
-    double old_size = it->second->getSize();
-    it->second->setSize(new_size);
+void PriceLevel::updateOrder(Order& order, Quantity new_size) {
+    Quantity old_size = order.getSize();
+    order.setSize(new_size);
 
     // Update total size
     total_size_ = total_size_ - old_size + new_size;
-
-    return true;
 }
 
-std::shared_ptr<Order> PriceLevel::findOrder(const std::string& order_id) const {
-    auto it = orders_.find(order_id);
-    if (it != orders_.end()) {
-        return it->second;
-    }
-    return nullptr;
+void PriceLevel::clear() {
+    orders_.clear();
+    total_size_ = 0;
 }
 
-} // namespace clunk
\ No newline at end of file
+} // namespace clunk
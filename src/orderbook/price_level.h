@@ -1,44 +1,63 @@
 #pragma once
 
 #include "order.h"
-#include <unordered_map>
-#include <memory>
-#include <limits>
+#include <boost/intrusive/list.hpp>
 
 namespace clunk {
 
 // PriceLevel class representing all orders at a specific price point
+//
+// Orders are kept in arrival (FIFO) order on an intrusive list threaded
+// through the orders themselves. The level never owns its orders: they
+// belong to the OrderBook's pool and must be removed before they are freed.
 class PriceLevel {
 public:
+    // FIFO queue of orders resting at this price
+    using OrderQueue = boost::intrusive::list<
+        Order,
+        boost::intrusive::member_hook<Order, boost::intrusive::list_member_hook<>, &Order::level_hook_>,
+        boost::intrusive::constant_time_size<true>>;
+
     // Constructor
-    explicit PriceLevel(double price);
+    explicit PriceLevel(Price price);
+
+    // Levels own the queue head, so they are movable but not copyable
+    PriceLevel(const PriceLevel&) = delete;
+    PriceLevel& operator=(const PriceLevel&) = delete;
+    PriceLevel(PriceLevel&&) = default;
+    PriceLevel& operator=(PriceLevel&&) = default;
 
     // Getters
-    double getPrice() const { return price_; }
-    double getTotalSize() const { return total_size_; }
+    Price getPrice() const { return price_; }
+    Quantity getTotalSize() const { return total_size_; }
     size_t getOrderCount() const { return orders_.size(); }
 
     // Order management functions
-    bool addOrder(const std::shared_ptr<Order>& order);
-    bool removeOrder(const std::string& order_id);
-    bool updateOrder(const std::string& order_id, double new_size);
+    bool addOrder(Order& order);
+    void removeOrder(Order& order);
+    void updateOrder(Order& order, Quantity new_size);
+
+    // Oldest order at this level (first in line to be filled)
+    const Order* front() const { return orders_.empty() ? nullptr : &orders_.front(); }
+    Order* front() { return orders_.empty() ? nullptr : &orders_.front(); }
+
+    // Orders in time priority
+    const OrderQueue& getOrders() const { return orders_; }
 
-    // Find order by ID
-    std::shared_ptr<Order> findOrder(const std::string& order_id) const;
+    // Unlink every order without touching the orders themselves
+    void clear();
 
     // Check if level is empty
     bool isEmpty() const { return orders_.empty(); }
 
     // Comparison operators (for sorting in the order book)
     bool operator<(const PriceLevel& other) const { return price_ < other.price_; }
-    bool operator==(const PriceLevel& other) const {
-        return std::abs(price_ - other.price_) < std::numeric_limits<double>::epsilon();
-    }
+    bool operator==(const PriceLevel& other) const { return price_ == other.price_; }
 
 private:
-    double price_;                                            // Price of this level
-    double total_size_;                                       // Total size of all orders at this level
-    std::unordered_map<std::string, std::shared_ptr<Order>> orders_;  // Map of order ID to order
+    Price price_;                                             // Price of this level in ticks
+    Quantity total_size_;                                     // Total size of all orders at this level
+    OrderQueue orders_;                                       // Orders in time priority
 };
 
-} // namespace clunk
\ No newline at end of file
+} // namespace clunk
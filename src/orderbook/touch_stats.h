@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+namespace clunk {
+
+// How often level changes landed on a side's best price
+//
+// Tree-backed books keep each side's best level in a dedicated slot, so a
+// change at the touch skips the tree walk, and a new level better than the
+// touch is inserted at the front of the tree without one.
+struct TouchStats {
+    uint64_t updates = 0;       // Level lookups made to change the book
+    uint64_t at_touch = 0;      // ... served from the best-level slot
+    uint64_t inside = 0;        // ... for a new best level
+
+    // Fraction of updates that avoided a tree walk
+    double hitRate() const {
+        return updates != 0 ? static_cast<double>(at_touch + inside) / static_cast<double>(updates) : 0.0;
+    }
+
+    TouchStats& operator+=(const TouchStats& other) {
+        updates += other.updates;
+        at_touch += other.at_touch;
+        inside += other.inside;
+        return *this;
+    }
+};
+
+} // namespace clunk
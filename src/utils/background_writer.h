@@ -0,0 +1,99 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace clunk {
+
+// Hands batches of work to a thread of its own, so the thread producing
+// them never waits on a slow sink (a terminal, a disk)
+//
+// Producers add to a pending batch under the lock with submit(). The
+// thread swaps it out and passes it to `write` without the lock, then
+// clears it, so anything submitted during a write is coalesced into the
+// next one. `Batch` is any container with empty(), clear() and swap().
+//
+// Declare it after the members `write` uses: it starts its thread when
+// constructed and joins it when destroyed.
+template <typename Batch>
+class BackgroundWriter {
+public:
+    // Start the thread, which calls `write(batch)` for each batch taken
+    explicit BackgroundWriter(std::function<void(Batch& batch)> write) : write_(std::move(write)) {
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    // Write what is pending, then stop
+    ~BackgroundWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    BackgroundWriter(const BackgroundWriter&) = delete;
+    BackgroundWriter& operator=(const BackgroundWriter&) = delete;
+
+    // Call `add(pending)` under the lock and wake the thread; returns what
+    // `add` returns
+    template <typename Add>
+    decltype(auto) submit(Add&& add) {
+        struct Notify {
+            std::condition_variable& cv;
+            ~Notify() { cv.notify_one(); }
+        } notify{cv_};
+        std::lock_guard<std::mutex> lock(mutex_);
+        return add(pending_);
+    }
+
+    // Block until everything submitted so far has been written
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this]() { return pending_.empty() && !busy_; });
+    }
+
+private:
+    std::function<void(Batch& batch)> write_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    Batch pending_;         // Submitted, not yet taken by the thread
+    Batch writing_;         // Owned by the thread while it writes
+    bool busy_ = false;
+    bool stopping_ = false;
+
+    std::thread thread_;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+            if (pending_.empty()) {
+                // Stopping with nothing left to write
+                break;
+            }
+
+            writing_.swap(pending_);
+            busy_ = true;
+            lock.unlock();
+            write_(writing_);
+            writing_.clear();
+            lock.lock();
+            busy_ = false;
+            if (pending_.empty()) {
+                idle_cv_.notify_all();
+            }
+        }
+        idle_cv_.notify_all();
+    }
+};
+
+} // namespace clunk
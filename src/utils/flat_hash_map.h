@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace clunk {
+
+// Open-addressing hash map with linear probing
+//
+// Entries live inline in one power-of-two array, so a lookup is usually a
+// single cache line and inserts never allocate until the table has to grow.
+// Erase uses backward-shift deletion, which keeps probe sequences short
+// without tombstones. Keys and values must be cheap to copy (IDs, pointers).
+//
+// Pointers and iterators are invalidated by any insert that grows the table
+// and by erase (which may shift neighbouring entries).
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+public:
+    struct Slot {
+        Key key{};
+        Value value{};
+        bool occupied = false;
+    };
+
+    // Forward iterator over occupied slots
+    template <typename SlotType>
+    class BasicIterator {
+    public:
+        BasicIterator(SlotType* slot, SlotType* end) : slot_(slot), end_(end) { skip(); }
+
+        SlotType& operator*() const { return *slot_; }
+        SlotType* operator->() const { return slot_; }
+
+        BasicIterator& operator++() {
+            ++slot_;
+            skip();
+            return *this;
+        }
+
+        bool operator==(const BasicIterator& other) const { return slot_ == other.slot_; }
+        bool operator!=(const BasicIterator& other) const { return slot_ != other.slot_; }
+
+    private:
+        SlotType* slot_;
+        SlotType* end_;
+
+        void skip() {
+            while (slot_ != end_ && !slot_->occupied) {
+                ++slot_;
+            }
+        }
+    };
+
+    using iterator = BasicIterator<Slot>;
+    using const_iterator = BasicIterator<const Slot>;
+
+    // Constructor
+    explicit FlatHashMap(size_t initial_capacity = 16) {
+        slots_.resize(capacityFor(initial_capacity));
+        mask_ = slots_.size() - 1;
+    }
+
+    // Find the value stored for `key`, or nullptr
+    Value* find(const Key& key) {
+        size_t index = indexFor(key);
+        while (slots_[index].occupied) {
+            if (equal_(slots_[index].key, key)) {
+                return &slots_[index].value;
+            }
+            index = (index + 1) & mask_;
+        }
+        return nullptr;
+    }
+
+    const Value* find(const Key& key) const {
+        return const_cast<FlatHashMap*>(this)->find(key);
+    }
+
+    // Check if `key` is present
+    bool contains(const Key& key) const { return find(key) != nullptr; }
+
+    // Insert a new entry; returns false (and leaves the map unchanged) if
+    // the key already exists
+    bool insert(const Key& key, const Value& value) {
+        size_t index = probe(key);
+        if (slots_[index].occupied) {
+            return false;
+        }
+
+        // Only a new key grows the table, so a duplicate keeps pointers valid
+        if ((size_ + 1) * 2 > slots_.size()) {
+            rehash(slots_.size() * 2);
+            index = probe(key);
+        }
+
+        slots_[index].key = key;
+        slots_[index].value = value;
+        slots_[index].occupied = true;
+        ++size_;
+        return true;
+    }
+
+    // Remove `key`; returns false if it was not present
+    bool erase(const Key& key) {
+        size_t index = indexFor(key);
+        while (slots_[index].occupied) {
+            if (equal_(slots_[index].key, key)) {
+                eraseSlot(index);
+                return true;
+            }
+            index = (index + 1) & mask_;
+        }
+        return false;
+    }
+
+    // Make sure `count` entries fit without growing
+    void reserve(size_t count) {
+        size_t capacity = capacityFor(count);
+        if (capacity > slots_.size()) {
+            rehash(capacity);
+        }
+    }
+
+    // Remove every entry, keeping the allocated table
+    void clear() {
+        for (auto& slot : slots_) {
+            slot = Slot{};
+        }
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return slots_.size(); }
+
+    iterator begin() { return iterator(slots_.data(), slots_.data() + slots_.size()); }
+    iterator end() { return iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size()); }
+    const_iterator begin() const { return const_iterator(slots_.data(), slots_.data() + slots_.size()); }
+    const_iterator end() const {
+        return const_iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size());
+    }
+
+private:
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+    Hash hash_;
+    KeyEqual equal_;
+
+    size_t indexFor(const Key& key) const { return hash_(key) & mask_; }
+
+    // Slot holding `key`, or the empty slot ending its probe run
+    size_t probe(const Key& key) const {
+        size_t index = indexFor(key);
+        while (slots_[index].occupied && !equal_(slots_[index].key, key)) {
+            index = (index + 1) & mask_;
+        }
+        return index;
+    }
+
+    // Smallest power of two keeping `count` entries at or below half load
+    static size_t capacityFor(size_t count) {
+        size_t capacity = 16;
+        while (capacity < count * 2) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole so lookups never need tombstones
+    void eraseSlot(size_t hole) {
+        size_t index = (hole + 1) & mask_;
+        while (slots_[index].occupied) {
+            size_t home = indexFor(slots_[index].key);
+
+            // Move the entry back if its home does not lie in (hole, index]
+            if (((index - home) & mask_) >= ((index - hole) & mask_)) {
+                slots_[hole] = slots_[index];
+                hole = index;
+            }
+            index = (index + 1) & mask_;
+        }
+
+        slots_[hole] = Slot{};
+        --size_;
+    }
+
+    void rehash(size_t new_capacity) {
+        std::vector<Slot> old_slots(new_capacity);
+        old_slots.swap(slots_);
+        mask_ = slots_.size() - 1;
+
+        for (const auto& slot : old_slots) {
+            if (!slot.occupied) {
+                continue;
+            }
+            size_t index = indexFor(slot.key);
+            while (slots_[index].occupied) {
+                index = (index + 1) & mask_;
+            }
+            slots_[index] = slot;
+        }
+    }
+};
+
+} // namespace clunk
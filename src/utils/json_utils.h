@@ -0,0 +1,364 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace clunk {
+
+// Kind of the next JSON value
+enum class JsonType : uint8_t {
+    NONE,       // End of input or malformed
+    OBJECT,
+    ARRAY,
+    STRING,
+    NUMBER,
+    LITERAL     // true, false or null
+};
+
+// Forward-only, allocation-free JSON scanner
+//
+// Walks a message in place instead of building a document: the caller
+// drives it with the schema it expects (open an object, loop over its keys,
+// read the values it needs, skip the rest) and gets string_views into the
+// original text back. Malformed input latches failed() and every later call
+// returns false.
+//
+// String views are the raw bytes between the quotes. Escapes are stepped
+// over but not decoded, which is exact for the ASCII identifiers, enums and
+// decimals market data feeds carry. Skipped containers are bracket-matched
+// rather than fully validated.
+class JsonScanner {
+public:
+    explicit JsonScanner(std::string_view text) : text_(text) {}
+
+    // Whether malformed input was hit
+    bool failed() const { return failed_; }
+
+    // Whether only whitespace remains
+    bool atEnd() {
+        skipWhitespace();
+        return pos_ == text_.size();
+    }
+
+    // Kind of the next value, without consuming it
+    JsonType peek() {
+        skipWhitespace();
+        if (failed_ || pos_ == text_.size()) {
+            return JsonType::NONE;
+        }
+        switch (text_[pos_]) {
+            case '{': return JsonType::OBJECT;
+            case '[': return JsonType::ARRAY;
+            case '"': return JsonType::STRING;
+            case 't': case 'f': case 'n': return JsonType::LITERAL;
+            default: return isNumberChar(text_[pos_]) ? JsonType::NUMBER : JsonType::NONE;
+        }
+    }
+
+    // Enter an object; follow with nextKey() until it returns false
+    bool beginObject() { return open('{'); }
+
+    // Enter an array; follow with nextElement() until it returns false
+    bool beginArray() { return open('['); }
+
+    // Read the next key of the current object, leaving its value next.
+    // Returns false once the closing brace is consumed, or on error.
+    bool nextKey(std::string_view& key) {
+        if (!nextMember('}')) {
+            return false;
+        }
+        if (!readString(key)) {
+            return false;
+        }
+        skipWhitespace();
+        if (pos_ == text_.size() || text_[pos_] != ':') {
+            return fail();
+        }
+        ++pos_;
+        return true;
+    }
+
+    // Position at the next element of the current array. Returns false once
+    // the closing bracket is consumed, or on error.
+    bool nextElement() { return nextMember(']'); }
+
+    // Read a string value
+    bool readString(std::string_view& out) {
+        skipWhitespace();
+        if (failed_ || pos_ == text_.size() || text_[pos_] != '"') {
+            return fail();
+        }
+
+        size_t start = ++pos_;
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c == '"') {
+                out = text_.substr(start, pos_ - start);
+                ++pos_;
+                return true;
+            }
+            if (c == '\\') {
+                // Step over the escaped character (\uXXXX digits are plain)
+                ++pos_;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                return fail();
+            }
+            ++pos_;
+        }
+        return fail();
+    }
+
+    // Read a decimal sent either as a string ("65000.01") or a bare number
+    // (65000.01), returning its text
+    bool readScalar(std::string_view& out) {
+        switch (peek()) {
+            case JsonType::STRING:
+                return readString(out);
+            case JsonType::NUMBER: {
+                size_t start = pos_;
+                while (pos_ < text_.size() && isNumberChar(text_[pos_])) {
+                    ++pos_;
+                }
+                out = text_.substr(start, pos_ - start);
+                return true;
+            }
+            default:
+                return fail();
+        }
+    }
+
+    // Read the raw text of the next value (containers included), so it can
+    // be scanned again later with its own JsonScanner
+    bool readRaw(std::string_view& out) {
+        skipWhitespace();
+        size_t start = pos_;
+        if (!skipValue()) {
+            return false;
+        }
+        out = text_.substr(start, pos_ - start);
+        return true;
+    }
+
+    // Skip the next value
+    bool skipValue() {
+        switch (peek()) {
+            case JsonType::STRING: {
+                std::string_view ignored;
+                return readString(ignored);
+            }
+            case JsonType::NUMBER: {
+                std::string_view ignored;
+                return readScalar(ignored);
+            }
+            case JsonType::LITERAL:
+                return skipLiteral();
+            case JsonType::OBJECT:
+            case JsonType::ARRAY:
+                return skipContainer();
+            default:
+                return fail();
+        }
+    }
+
+private:
+    std::string_view text_;
+    size_t pos_ = 0;
+    bool failed_ = false;
+
+    // Set right after an opening bracket, when no comma is due yet
+    bool first_ = false;
+
+    static bool isNumberChar(char c) {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    bool fail() {
+        failed_ = true;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\n' || text_[pos_] == '\r' || text_[pos_] == '\t')) {
+            ++pos_;
+        }
+    }
+
+    bool open(char bracket) {
+        skipWhitespace();
+        if (failed_ || pos_ == text_.size() || text_[pos_] != bracket) {
+            return fail();
+        }
+        ++pos_;
+        first_ = true;
+        return true;
+    }
+
+    // Consume the separator before the next member, or the closing bracket
+    bool nextMember(char close) {
+        skipWhitespace();
+        if (failed_ || pos_ == text_.size()) {
+            return fail();
+        }
+
+        if (text_[pos_] == close) {
+            ++pos_;
+            first_ = false;
+            return false;
+        }
+
+        if (!first_) {
+            if (text_[pos_] != ',') {
+                return fail();
+            }
+            ++pos_;
+            skipWhitespace();
+            if (pos_ == text_.size() || text_[pos_] == close) {
+                return fail();
+            }
+        }
+        first_ = false;
+        return true;
+    }
+
+    bool skipLiteral() {
+        for (std::string_view literal : {std::string_view("true"), std::string_view("false"),
+                                         std::string_view("null")}) {
+            if (text_.substr(pos_, literal.size()) == literal) {
+                pos_ += literal.size();
+                return true;
+            }
+        }
+        return fail();
+    }
+
+    bool skipContainer() {
+        size_t depth = 0;
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c == '"') {
+                std::string_view ignored;
+                if (!readString(ignored)) {
+                    return false;
+                }
+                continue;
+            }
+            ++pos_;
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    return true;
+                }
+            }
+        }
+        return fail();
+    }
+};
+
+// Up to kMaxFields scalars of one row of an array of arrays, e.g. one
+// ["buy", "65000.01", "0.5"] entry of a Coinbase "changes" list
+struct JsonRow {
+    static constexpr size_t kMaxFields = 4;
+
+    std::string_view fields[kMaxFields];
+    size_t count = 0;
+
+    std::string_view operator[](size_t index) const { return fields[index]; }
+    size_t size() const { return count; }
+};
+
+// Call `f(const JsonRow&)` for every row of `array`, the raw text of an
+// array of arrays of scalars (see JsonScanner::readRaw). Fields past
+// kMaxFields are skipped. Returns false if the text is malformed.
+template <typename F>
+bool forEachRow(std::string_view array, F&& f) {
+    JsonScanner scanner(array);
+    if (!scanner.beginArray()) {
+        return false;
+    }
+
+    while (scanner.nextElement()) {
+        JsonRow row;
+        if (!scanner.beginArray()) {
+            return false;
+        }
+        while (scanner.nextElement()) {
+            bool ok = row.count < JsonRow::kMaxFields ? scanner.readScalar(row.fields[row.count++])
+                                                      : scanner.skipValue();
+            if (!ok) {
+                return false;
+            }
+        }
+        if (scanner.failed()) {
+            return false;
+        }
+        f(row);
+    }
+
+    return !scanner.failed();
+}
+
+// String value of the first `key` (given with its quotes, e.g. "\"symbol\"")
+// in `text`, found by a text search without decoding the message; empty if
+// absent. Only a routing hint: a value of that name nested anywhere, or
+// inside a string, matches too.
+inline std::string_view peekString(std::string_view text, std::string_view key) {
+    size_t pos = text.find(key);
+    if (pos == std::string_view::npos) {
+        return {};
+    }
+
+    pos = text.find_first_not_of(" \t\r\n", pos + key.size());
+    if (pos == std::string_view::npos || text[pos] != ':') {
+        return {};
+    }
+
+    JsonScanner scanner(text.substr(pos + 1));
+    std::string_view value;
+    if (scanner.peek() != JsonType::STRING || !scanner.readString(value)) {
+        return {};
+    }
+    return value;
+}
+
+// Value of the first `key` (quoted, e.g. "\"sequence\"") whose value is a
+// number or a string, found the same way as peekString(); empty if absent
+inline std::string_view peekScalar(std::string_view text, std::string_view key) {
+    size_t pos = text.find(key);
+    if (pos == std::string_view::npos) {
+        return {};
+    }
+
+    pos = text.find_first_not_of(" \t\r\n", pos + key.size());
+    if (pos == std::string_view::npos || text[pos] != ':') {
+        return {};
+    }
+
+    JsonScanner scanner(text.substr(pos + 1));
+    std::string_view value;
+    if (!scanner.readScalar(value)) {
+        return {};
+    }
+    return value;
+}
+
+// Number of elements in `array`, the raw text of an array; 0 if malformed
+inline size_t countElements(std::string_view array) {
+    JsonScanner scanner(array);
+    if (!scanner.beginArray()) {
+        return 0;
+    }
+
+    size_t count = 0;
+    while (scanner.nextElement()) {
+        if (!scanner.skipValue()) {
+            return 0;
+        }
+        ++count;
+    }
+    return scanner.failed() ? 0 : count;
+}
+
+} // namespace clunk
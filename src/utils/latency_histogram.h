@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace clunk {
+
+// Percentiles of a LatencyHistogram, in the unit it recorded
+struct HistogramSummary {
+    uint64_t count = 0;
+    double mean = 0.0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+};
+
+// Log-linear (HDR-style) histogram of non-negative values
+//
+// Values below 64 get a bucket each. Above that, each power of two is split
+// into 32 buckets, so a bucket is never wider than 1/32 (about 3%) of the
+// values in it, and the whole uint64_t range fits in a fixed 1920 counters.
+// Percentiles report the upper edge of their bucket, capped at the largest
+// value recorded.
+//
+// record() is one writer's: relaxed loads and stores with no locked
+// instructions, so recording costs a few nanoseconds. Give each recording
+// thread its own histogram (or serialize its writers) and merge them to
+// read. Readers on any thread see every count that has been stored, though
+// a summary taken mid-record may be one value behind in one field.
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 32;
+    static constexpr size_t kLinearBuckets = 2 * kSubBuckets;
+    static constexpr size_t kBucketCount = kSubBuckets * 58 + kLinearBuckets;
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // Record one value (single writer)
+    void record(uint64_t value) {
+        bump(counts_[bucketFor(value)], 1);
+        bump(count_, 1);
+        bump(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Add another histogram's counts to this one (this histogram's writer)
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            uint64_t count = other.counts_[i].load(std::memory_order_relaxed);
+            if (count != 0) {
+                bump(counts_[i], count);
+            }
+        }
+        bump(count_, other.count_.load(std::memory_order_relaxed));
+        bump(sum_, other.sum_.load(std::memory_order_relaxed));
+        uint64_t max = other.max_.load(std::memory_order_relaxed);
+        if (max > max_.load(std::memory_order_relaxed)) {
+            max_.store(max, std::memory_order_relaxed);
+        }
+    }
+
+    // Drop every value (not concurrently with record())
+    void reset() {
+        for (std::atomic<uint64_t>& count : counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    // Values recorded, and the largest of them
+    uint64_t getCount() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return max_.load(std::memory_order_relaxed); }
+
+    // Smallest bucket edge with at least `percentile` percent of the values
+    // at or below it (0 when empty)
+    uint64_t valueAtPercentile(double percentile) const {
+        uint64_t total = 0;
+        for (const std::atomic<uint64_t>& count : counts_) {
+            total += count.load(std::memory_order_relaxed);
+        }
+        if (total == 0) {
+            return 0;
+        }
+
+        // Rank of the value sought, 1-based and at least 1
+        double wanted = percentile / 100.0 * static_cast<double>(total);
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(wanted + 0.999999));
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(bucketHighest(i), getMax());
+            }
+        }
+        return getMax();
+    }
+
+    // Count, mean, p50, p99, p99.9 and max
+    HistogramSummary summarize() const {
+        HistogramSummary summary;
+        summary.count = getCount();
+        if (summary.count == 0) {
+            return summary;
+        }
+        summary.mean = static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+                       static_cast<double>(summary.count);
+        summary.p50 = valueAtPercentile(50.0);
+        summary.p99 = valueAtPercentile(99.0);
+        summary.p999 = valueAtPercentile(99.9);
+        summary.max = getMax();
+        return summary;
+    }
+
+    // Bucket holding `value`
+    static size_t bucketFor(uint64_t value) {
+        if (value < kLinearBuckets) {
+            return static_cast<size_t>(value);
+        }
+        unsigned shift = highestBit(value) - 5;
+        return shift * kSubBuckets + static_cast<size_t>(value >> shift);
+    }
+
+    // Smallest and largest values of bucket `index`
+    static uint64_t bucketLowest(size_t index) {
+        if (index < kLinearBuckets) {
+            return index;
+        }
+        unsigned shift = static_cast<unsigned>(index / kSubBuckets) - 1;
+        return static_cast<uint64_t>(index - shift * kSubBuckets) << shift;
+    }
+
+    static uint64_t bucketHighest(size_t index) {
+        if (index < kLinearBuckets) {
+            return index;
+        }
+        unsigned shift = static_cast<unsigned>(index / kSubBuckets) - 1;
+        return bucketLowest(index) + ((uint64_t(1) << shift) - 1);
+    }
+
+private:
+    std::atomic<uint64_t> counts_[kBucketCount] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    // Index of the highest set bit (value is non-zero)
+    static unsigned highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+        unsigned bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+};
+
+} // namespace clunk
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace clunk {
+
+// Fixed-size object pool backed by chunked storage and an intrusive free list
+//
+// Slots are carved out of chunks of `chunk_size` objects and recycled through
+// a singly linked free list, so construct/destroy are O(1) and never touch the
+// global heap once the pool has grown to its working size. Objects never move,
+// which makes raw pointers into the pool safe to hold until destroy().
+//
+// The pool does not track live objects: owners must destroy() everything they
+// constructed before the pool itself goes away.
+template <typename T>
+class ObjectPool {
+public:
+    // Constructor
+    explicit ObjectPool(size_t chunk_size = 1024)
+        : chunk_size_(chunk_size > 0 ? chunk_size : 1) {
+    }
+
+    // Pools own raw storage and cannot be copied
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Destructor
+    ~ObjectPool() = default;
+
+    // Construct a new object in a pooled slot
+    template <typename... Args>
+    T* construct(Args&&... args) {
+        if (!free_list_) {
+            grow(chunk_size_);
+        }
+
+        Slot* slot = free_list_;
+        free_list_ = slot->next;
+
+        T* object = ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+        ++live_count_;
+        return object;
+    }
+
+    // Destroy an object and return its slot to the free list
+    void destroy(T* object) {
+        if (!object) {
+            return;
+        }
+
+        object->~T();
+
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = free_list_;
+        free_list_ = slot;
+        --live_count_;
+    }
+
+    // Make sure at least `count` objects fit without further allocation
+    void reserve(size_t count) {
+        if (count > capacity_) {
+            grow(count - capacity_);
+        }
+    }
+
+    // Number of live objects
+    size_t size() const { return live_count_; }
+
+    // Number of slots currently backed by storage
+    size_t capacity() const { return capacity_; }
+
+    // Number of chunks allocated from the heap so far
+    size_t chunkCount() const { return chunks_.size(); }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    size_t chunk_size_;
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    Slot* free_list_ = nullptr;
+    size_t live_count_ = 0;
+    size_t capacity_ = 0;
+
+    // Allocate a new chunk and thread its slots onto the free list
+    void grow(size_t slots) {
+        auto chunk = std::make_unique<Slot[]>(slots);
+        for (size_t i = 0; i < slots; ++i) {
+            chunk[i].next = (i + 1 < slots) ? &chunk[i + 1] : free_list_;
+        }
+        free_list_ = &chunk[0];
+        chunks_.push_back(std::move(chunk));
+        capacity_ += slots;
+    }
+};
+
+// Slab arena handing out blocks of a single size for node-based containers
+//
+// The block size is fixed by the first allocation, which suits an arena that
+// backs exactly one container (std::map or std::unordered_map allocate one
+// node type each). Requests of any other size, such as hash bucket arrays,
+// fall through to the global heap and are counted in heapFallbacks().
+// reserve() can be called before the first allocation: the reservation is
+// applied as soon as the block size is known.
+//
+// Arenas are not thread-safe; they follow the locking of their owner.
+class SlabArena {
+public:
+    // Constructor
+    explicit SlabArena(size_t blocks_per_slab = 1024)
+        : blocks_per_slab_(blocks_per_slab > 0 ? blocks_per_slab : 1) {
+    }
+
+    // Arenas own raw storage and cannot be copied
+    SlabArena(const SlabArena&) = delete;
+    SlabArena& operator=(const SlabArena&) = delete;
+
+    // Destructor
+    ~SlabArena() = default;
+
+    // Allocate a block of `bytes`
+    void* allocate(size_t bytes) {
+        if (block_size_ == 0) {
+            block_size_ = roundUp(bytes);
+            if (pending_reserve_ > 0) {
+                grow(pending_reserve_);
+                pending_reserve_ = 0;
+            }
+        }
+
+        if (roundUp(bytes) != block_size_) {
+            ++heap_fallbacks_;
+            return ::operator new(bytes);
+        }
+
+        if (!free_list_) {
+            grow(blocks_per_slab_);
+        }
+
+        Block* block = free_list_;
+        free_list_ = block->next;
+        ++live_count_;
+        return block;
+    }
+
+    // Return a block previously handed out by allocate()
+    void deallocate(void* p, size_t bytes) {
+        if (!p) {
+            return;
+        }
+
+        if (roundUp(bytes) != block_size_) {
+            ::operator delete(p);
+            return;
+        }
+
+        Block* block = static_cast<Block*>(p);
+        block->next = free_list_;
+        free_list_ = block;
+        --live_count_;
+    }
+
+    // Make sure at least `blocks` blocks fit without further allocation
+    void reserve(size_t blocks) {
+        if (block_size_ == 0) {
+            pending_reserve_ = std::max(pending_reserve_, blocks);
+        } else if (blocks > capacity_) {
+            grow(blocks - capacity_);
+        }
+    }
+
+    // Size of each block in bytes (0 until the first allocation)
+    size_t blockSize() const { return block_size_; }
+
+    // Number of live blocks
+    size_t size() const { return live_count_; }
+
+    // Number of blocks currently backed by storage
+    size_t capacity() const { return capacity_; }
+
+    // Number of slabs allocated from the heap so far
+    size_t slabCount() const { return slabs_.size(); }
+
+    // Number of requests that did not match the block size
+    size_t heapFallbacks() const { return heap_fallbacks_; }
+
+private:
+    struct Block {
+        Block* next;
+    };
+
+    // Slabs are allocated in maximally aligned units of the alignment size
+    struct alignas(std::max_align_t) Unit {
+        unsigned char bytes[alignof(std::max_align_t)];
+    };
+
+    size_t blocks_per_slab_;
+    size_t block_size_ = 0;
+    std::vector<std::unique_ptr<Unit[]>> slabs_;
+    Block* free_list_ = nullptr;
+    size_t live_count_ = 0;
+    size_t capacity_ = 0;
+    size_t pending_reserve_ = 0;
+    size_t heap_fallbacks_ = 0;
+
+    // Blocks are padded to the strictest fundamental alignment
+    static size_t roundUp(size_t bytes) {
+        constexpr size_t align = alignof(std::max_align_t);
+        bytes = std::max(bytes, sizeof(Block));
+        return (bytes + align - 1) & ~(align - 1);
+    }
+
+    // Allocate a new slab and thread its blocks onto the free list
+    void grow(size_t blocks) {
+        size_t units_per_block = block_size_ / sizeof(Unit);
+        auto slab = std::make_unique<Unit[]>(units_per_block * blocks);
+
+        for (size_t i = blocks; i-- > 0;) {
+            auto* block = reinterpret_cast<Block*>(slab.get() + i * units_per_block);
+            block->next = free_list_;
+            free_list_ = block;
+        }
+
+        slabs_.push_back(std::move(slab));
+        capacity_ += blocks;
+    }
+};
+
+// Standard allocator that draws single-object allocations from a SlabArena
+//
+// Intended for node-based containers: every node comes from the arena, while
+// multi-object requests (bucket arrays) go straight to the heap. Copies and
+// rebinds share the same arena, which must outlive the container.
+template <typename T>
+class SlabAllocator {
+public:
+    using value_type = T;
+
+    explicit SlabAllocator(SlabArena* arena) noexcept : arena_(arena) {}
+
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(size_t n) {
+        if (n == 1 && alignof(T) <= alignof(std::max_align_t)) {
+            return static_cast<T*>(arena_->allocate(sizeof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (n == 1 && alignof(T) <= alignof(std::max_align_t)) {
+            arena_->deallocate(p, sizeof(T));
+            return;
+        }
+        ::operator delete(p);
+    }
+
+    SlabArena* arena() const noexcept { return arena_; }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U>& other) const noexcept { return arena_ == other.arena(); }
+
+    template <typename U>
+    bool operator!=(const SlabAllocator<U>& other) const noexcept { return arena_ != other.arena(); }
+
+private:
+    SlabArena* arena_;
+};
+
+} // namespace clunk
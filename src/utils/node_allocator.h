@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace clunk {
+
+// Allocator placing its storage on one NUMA node
+//
+// Each allocation is its own mapping bound (preferred) to the node before
+// any page is touched, so the memory lands there whichever thread first
+// writes it. That makes it suited to a few long-lived objects built on one
+// thread and then owned by a worker pinned elsewhere, such as a shard's
+// books (via std::allocate_shared); it rounds every allocation up to whole
+// pages. A negative node, or a platform without NUMA policy, falls back to
+// the global heap.
+template <typename T>
+class NodeAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = NodeAllocator<U>;
+    };
+
+    explicit NodeAllocator(int node = -1) noexcept : node_(node) {}
+
+    template <typename U>
+    NodeAllocator(const NodeAllocator<U>& other) noexcept : node_(other.node()) {}
+
+    T* allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+        if (node_ >= 0) {
+            void* p = mmap(nullptr, mappedSize(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+
+            // Best effort: without NUMA support the pages go wherever
+            // they are first touched
+            constexpr int kMaskBits = 8 * sizeof(unsigned long);
+            if (node_ < kMaskBits) {
+                unsigned long mask = 1UL << node_;
+                syscall(SYS_mbind, p, mappedSize(bytes), MPOL_PREFERRED, &mask, kMaskBits + 1, 0);
+            }
+            return static_cast<T*>(p);
+        }
+#endif
+        return static_cast<T*>(::operator new(bytes, std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+#if defined(__linux__)
+        if (node_ >= 0) {
+            munmap(p, mappedSize(n * sizeof(T)));
+            return;
+        }
+#endif
+        (void)n;
+        ::operator delete(p, std::align_val_t(alignof(T)));
+    }
+
+    // Node the storage is placed on (-1: global heap)
+    int node() const noexcept { return node_; }
+
+    template <typename U>
+    bool operator==(const NodeAllocator<U>& other) const noexcept { return node_ == other.node(); }
+
+    template <typename U>
+    bool operator!=(const NodeAllocator<U>& other) const noexcept { return node_ != other.node(); }
+
+private:
+    int node_;
+
+#if defined(__linux__)
+    static size_t mappedSize(size_t bytes) {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return (bytes + page - 1) / page * page;
+    }
+#endif
+};
+
+} // namespace clunk
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace clunk {
+
+// An immutable value that many threads read on every message and a few
+// rarely replace, such as a routing table
+//
+// Writers build a new value and publish() it, bumping a version. Each
+// reading thread keeps its own reference to the last value it saw and
+// only refreshes it, under a mutex, once the version has moved on. So a
+// read is one atomic load: no lock and no reference-count traffic.
+//
+// A thread caches one value per type at a time, so a thread reading two
+// Published<T> in turn refreshes on every switch (correct, just slower);
+// the feed threads each read one.
+template <typename T>
+class Published {
+public:
+    // Constructor
+    explicit Published(std::shared_ptr<const T> value = std::make_shared<const T>())
+        : id_(nextId()), value_(std::move(value)) {}
+
+    Published(const Published&) = delete;
+    Published& operator=(const Published&) = delete;
+
+    // The current value, as this thread last refreshed it (any thread). The
+    // reference holds until the thread's next get() on any Published<T>.
+    const T& get() const {
+        Cache& cache = threadCache();
+        uint64_t version = version_.load(std::memory_order_acquire);
+        if (cache.id != id_ || cache.version != version) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cache.value = value_;
+            cache.version = version_.load(std::memory_order_relaxed);
+            cache.id = id_;
+        }
+        return *cache.value;
+    }
+
+    // The latest value, for a writer to copy and change (writers serialize
+    // among themselves)
+    std::shared_ptr<const T> load() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return value_;
+    }
+
+    // Replace the value; readers pick it up on their next get()
+    void publish(std::shared_ptr<const T> value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        value_ = std::move(value);
+        version_.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    struct Cache {
+        uint64_t id = 0;
+        uint64_t version = 0;
+        std::shared_ptr<const T> value;
+    };
+
+    // Distinguishes instances, so one at a reused address never matches a
+    // dead one's cache
+    const uint64_t id_;
+    std::atomic<uint64_t> version_{0};
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<const T> value_;
+
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static Cache& threadCache() {
+        static thread_local Cache cache;
+        return cache;
+    }
+};
+
+} // namespace clunk
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace clunk {
+
+// Single-writer, multi-reader publication of an immutable value
+//
+// The writer fills a free slot in place (so pre-sized containers keep
+// their capacity from one publication to the next) and makes it current
+// with one atomic store. Readers pin the current slot with a reference
+// count and read it directly, for as long as they hold the Handle; they
+// never copy, lock or wait on the writer, and the writer never waits on
+// them: if every slot but the current one is still pinned, the publication
+// is skipped and readers keep the previous value.
+//
+// A reader only retries if the writer republishes between its two loads,
+// so with more than a couple of slots acquisition completes in one pass in
+// practice. beginWrite() and publish() must only be called by one thread
+// at a time (e.g. under the owner's mutex).
+template <typename T>
+class SnapshotBuffer {
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> refs{0};
+        T value{};
+    };
+
+public:
+    static constexpr size_t kDefaultSlots = 4;
+
+    // A pinned, immutable published value (empty before the first publish)
+    class Handle {
+    public:
+        Handle() = default;
+        ~Handle() { release(); }
+
+        Handle(Handle&& other) noexcept : slot_(other.slot_) { other.slot_ = nullptr; }
+        Handle& operator=(Handle&& other) noexcept {
+            if (this != &other) {
+                release();
+                slot_ = other.slot_;
+                other.slot_ = nullptr;
+            }
+            return *this;
+        }
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        explicit operator bool() const { return slot_ != nullptr; }
+        const T& operator*() const { return slot_->value; }
+        const T* operator->() const { return &slot_->value; }
+
+    private:
+        friend class SnapshotBuffer;
+        explicit Handle(Slot* slot) : slot_(slot) {}
+
+        Slot* slot_ = nullptr;
+
+        void release() {
+            if (slot_ != nullptr) {
+                slot_->refs.fetch_sub(1, std::memory_order_release);
+                slot_ = nullptr;
+            }
+        }
+    };
+
+    // Constructor (at least two slots: one current, one being written)
+    explicit SnapshotBuffer(size_t slots = kDefaultSlots)
+        : slot_count_(std::max<size_t>(slots, 2)), slots_(new Slot[slot_count_]) {
+    }
+
+    SnapshotBuffer(const SnapshotBuffer&) = delete;
+    SnapshotBuffer& operator=(const SnapshotBuffer&) = delete;
+
+    // Call `f(T&)` on every slot, e.g. to pre-size them (writer only, and
+    // only while no reader holds a handle)
+    template <typename F>
+    void prepare(F&& f) {
+        for (size_t i = 0; i < slot_count_; ++i) {
+            f(slots_[i].value);
+        }
+    }
+
+    // Slot to fill for the next publication, or nullptr if every other slot
+    // is pinned by readers (writer only)
+    T* beginWrite() {
+        uint32_t current = current_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < slot_count_; ++i) {
+            if (i != current && slots_[i].refs.load(std::memory_order_seq_cst) == 0) {
+                writing_ = static_cast<uint32_t>(i);
+                return &slots_[i].value;
+            }
+        }
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // Make the slot returned by beginWrite() current (writer only)
+    void publish() {
+        current_.store(writing_, std::memory_order_seq_cst);
+        published_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Pin the current value
+    Handle acquire() const {
+        while (true) {
+            uint32_t index = current_.load(std::memory_order_seq_cst);
+            if (index == kNone) {
+                return Handle();
+            }
+
+            // Pin, then confirm the slot was not recycled in between
+            Slot& slot = slots_[index];
+            slot.refs.fetch_add(1, std::memory_order_seq_cst);
+            if (current_.load(std::memory_order_seq_cst) == index) {
+                return Handle(&slot);
+            }
+            slot.refs.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    // Publications made, and skipped because readers pinned every slot
+    uint64_t getPublishedCount() const { return published_.load(std::memory_order_relaxed); }
+    uint64_t getSkippedCount() const { return skipped_.load(std::memory_order_relaxed); }
+
+    size_t slots() const { return slot_count_; }
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    const size_t slot_count_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<uint32_t> current_{kNone};
+    uint32_t writing_ = 0;
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> skipped_{0};
+};
+
+} // namespace clunk
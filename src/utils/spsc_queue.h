@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace clunk {
+
+// Bounded lock-free single-producer/single-consumer ring
+//
+// Slots are allocated once up front and reused: tryPush() assigns into the
+// slot (so a std::string payload keeps its capacity from lap to lap) and the
+// consumer reads it in place with front() before pop() releases it. The
+// producer and consumer indices live on separate cache lines, and each side
+// caches the other's index so the shared line is only re-read when the ring
+// looks full (producer) or empty (consumer).
+//
+// Exactly one thread may push and exactly one thread may pop.
+template <typename T>
+class SpscQueue {
+public:
+    // Constructor (capacity is rounded up to a power of two)
+    explicit SpscQueue(size_t capacity)
+        : slots_(roundUp(capacity)), mask_(slots_.size() - 1) {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Copy a value into the next free slot; false if the ring is full
+    template <typename U>
+    bool tryPush(U&& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == slots_.size()) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == slots_.size()) {
+                return false;
+            }
+        }
+
+        slots_[tail & mask_] = std::forward<U>(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Oldest value, or nullptr if the ring is empty (consumer only)
+    T* front() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    // Release the slot returned by front() (consumer only)
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Approximate number of queued values (exact from either end's thread
+    // when the other side is idle)
+    size_t size() const {
+        // Head first: the tail only grows, so it can never read behind it
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    static size_t roundUp(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<T> slots_;
+    const size_t mask_;
+
+    // Consumer side
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+
+    // Producer side
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+};
+
+} // namespace clunk
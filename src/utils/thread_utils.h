@@ -0,0 +1,88 @@
+#pragma once
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#endif
+
+namespace clunk {
+
+// Pin the calling thread to one CPU
+//
+// Returns false if the platform has no affinity API (e.g. macOS) or the CPU
+// is not available to this process; the thread then keeps floating.
+inline bool pinCurrentThread(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// NUMA node of a CPU, from sysfs (-1 if unknown, e.g. off Linux)
+inline int cpuNode(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0) {
+        return -1;
+    }
+
+    // The CPU's directory links to its node as "node<N>"
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return -1;
+    }
+
+    int node = -1;
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = std::atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+// Make the calling thread's future page allocations prefer `node` (falling
+// back to other nodes when it is full)
+//
+// Pages already touched keep their placement, so call this before the
+// thread builds the state it will own. Returns false off Linux or if the
+// kernel rejects the policy (e.g. no NUMA support).
+inline bool preferNode(int node) {
+#if defined(__linux__)
+    constexpr int kMaskBits = 8 * sizeof(unsigned long);
+    if (node < 0 || node >= kMaskBits) {
+        return false;
+    }
+
+    // The kernel reads one bit fewer than maxnode says
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, kMaskBits + 1) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+} // namespace clunk
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+namespace clunk {
+
+// Wall-clock time in nanoseconds since the Unix epoch, for stamping
+// received messages (comparable across processes and hosts)
+inline uint64_t wallClockNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Raw value of the CPU's cycle counter: the TSC on x86, the virtual counter
+// on ARM64, steady_clock nanoseconds elsewhere
+//
+// A read costs a few nanoseconds and never enters the kernel, so it can
+// stamp every message. Values only mean something as differences, turned
+// into time with CycleClock. The counters of modern CPUs tick at a constant
+// rate and are synchronized across cores, so stamps taken on different
+// threads can be compared.
+inline uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Converts readCycles() differences to nanoseconds
+class CycleClock {
+public:
+    // The process-wide clock (calibrated on first use, which takes about
+    // 10 ms on x86)
+    static const CycleClock& instance() {
+        static const CycleClock clock;
+        return clock;
+    }
+
+    // Nanoseconds per counter tick
+    double nanosPerCycle() const { return nanos_per_cycle_; }
+
+    // A counter difference in nanoseconds
+    double toNanos(uint64_t cycles) const { return static_cast<double>(cycles) * nanos_per_cycle_; }
+
+private:
+    double nanos_per_cycle_ = 1.0;
+
+    CycleClock() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        // Time the TSC against steady_clock over a short spin
+        using Clock = std::chrono::steady_clock;
+        const auto window = std::chrono::milliseconds(10);
+        Clock::time_point start = Clock::now();
+        uint64_t start_cycles = readCycles();
+        Clock::time_point end;
+        do {
+            end = Clock::now();
+        } while (end - start < window);
+        uint64_t cycles = readCycles() - start_cycles;
+        double nanos = std::chrono::duration<double, std::nano>(end - start).count();
+        if (cycles > 0) {
+            nanos_per_cycle_ = nanos / static_cast<double>(cycles);
+        }
+#elif defined(__aarch64__)
+        // The counter's frequency is published by the CPU
+        uint64_t frequency;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+        if (frequency > 0) {
+            nanos_per_cycle_ = 1e9 / static_cast<double>(frequency);
+        }
+#endif
+    }
+};
+
+} // namespace clunk
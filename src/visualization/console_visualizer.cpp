@@ -1,40 +1,64 @@
 #include "console_visualizer.h"
+#include "../utils/thread_utils.h"
 #include <iostream>
-#include <iomanip>
+#include <cstdio>
+#include <ctime>
 #include <string>
 #include <chrono>
 #include <algorithm>
-#include <sstream>
 
 namespace clunk {
 
 // ANSI color codes for terminal output
 namespace Color {
-    const std::string RESET = "\033[0m";
-    const std::string RED = "\033[31m";
-    const std::string GREEN = "\033[32m";
-    const std::string YELLOW = "\033[33m";
-    const std::string BLUE = "\033[34m";
-    const std::string MAGENTA = "\033[35m";
-    const std::string CYAN = "\033[36m";
-    const std::string WHITE = "\033[37m";
-    const std::string BOLD = "\033[1m";
+    constexpr const char* RESET = "\033[0m";
+    constexpr const char* RED = "\033[31m";
+    constexpr const char* GREEN = "\033[32m";
+    constexpr const char* YELLOW = "\033[33m";
+    constexpr const char* BLUE = "\033[34m";
+    constexpr const char* MAGENTA = "\033[35m";
+    constexpr const char* CYAN = "\033[36m";
+    constexpr const char* WHITE = "\033[37m";
+    constexpr const char* BOLD = "\033[1m";
     
     // Bright versions for highlighting changes
-    const std::string BRIGHT_RED = "\033[91m";
-    const std::string BRIGHT_GREEN = "\033[92m";
-    const std::string BRIGHT_YELLOW = "\033[93m";
-    const std::string BRIGHT_BLUE = "\033[94m";
-    const std::string BRIGHT_MAGENTA = "\033[95m";
-    const std::string BRIGHT_CYAN = "\033[96m";
-    const std::string BRIGHT_WHITE = "\033[97m";
+    constexpr const char* BRIGHT_RED = "\033[91m";
+    constexpr const char* BRIGHT_GREEN = "\033[92m";
+    constexpr const char* BRIGHT_YELLOW = "\033[93m";
+    constexpr const char* BRIGHT_BLUE = "\033[94m";
+    constexpr const char* BRIGHT_MAGENTA = "\033[95m";
+    constexpr const char* BRIGHT_CYAN = "\033[96m";
+    constexpr const char* BRIGHT_WHITE = "\033[97m";
     
     // Background colors for more intense highlighting
-    const std::string BG_RED = "\033[41m";
-    const std::string BG_GREEN = "\033[42m";
+    constexpr const char* BG_RED = "\033[41m";
+    constexpr const char* BG_GREEN = "\033[42m";
 }
 
-ConsoleVisualizer::ConsoleVisualizer(std::shared_ptr<OrderBook> order_book)
+namespace {
+
+// printf-style append to a row (cells are short; longer output is cut)
+template <typename... Args>
+void appendFormat(std::string& row, const char* format, Args... args) {
+    char buffer[128];
+    int written = std::snprintf(buffer, sizeof(buffer), format, args...);
+    if (written > 0) {
+        row.append(buffer, std::min(static_cast<size_t>(written), sizeof(buffer) - 1));
+    }
+}
+
+// Pad with spaces to `width` visible columns, `used` of them already taken
+void appendPadding(std::string& row, size_t used, size_t width) {
+    if (used < width) {
+        row.append(width - used, ' ');
+    }
+}
+
+const char* const kRule = "───────────────────────────────────────────────────────────────────────────";
+
+} // namespace
+
+ConsoleVisualizer::ConsoleVisualizer(std::shared_ptr<BookView> order_book)
     : order_book_(order_book), running_(false), depth_(10) {
 }
 
@@ -50,8 +74,23 @@ void ConsoleVisualizer::start(int refresh_rate_ms) {
     running_ = true;
     refresh_rate_ms_ = refresh_rate_ms;
 
+    // Publish the displayed depth only when render() asks for it, so the
+    // feed thread does no depth capture between refreshes
+    if (order_book_) {
+        order_book_->enableDepthPublishing(depth_, 0);
+    }
+
+    // Start from a clear screen; the first frame is drawn in full
+    writer_ = std::make_unique<TerminalWriter>(stdout);
+    writer_->submit("\033[2J");
+    frame_.invalidate();
+
     // Start the visualization thread
     viz_thread_ = std::thread([this, refresh_rate_ms]() {
+        if (render_cpu_ >= 0 && !pinCurrentThread(render_cpu_)) {
+            std::cerr << "Could not pin render thread to CPU " << render_cpu_ << std::endl;
+        }
+
         while (running_) {
             render();
 
@@ -75,51 +114,53 @@ void ConsoleVisualizer::stop() {
     if (viz_thread_.joinable()) {
         viz_thread_.join();
     }
+
+    // Write out the last frame
+    writer_.reset();
 }
 
 ConsoleVisualizer::PriceChangeType ConsoleVisualizer::getPriceChangeType(
-    double price, double size, const std::map<double, double>& prev_levels) {
+    Price price, Quantity size, const DepthSide& prev_levels, std::vector<Highlight>& highlights) {
     
     // If we're not highlighting changes, always return NO_CHANGE
     if (!highlight_changes_) {
         return PriceChangeType::NO_CHANGE;
     }
     
-    auto it = prev_levels.find(price);
-    
-    // If price level didn't exist before
-    if (it == prev_levels.end()) {
-        return PriceChangeType::NEW_PRICE;
+    // A level not shown last refresh is new; else compare its size
+    PriceChangeType change = PriceChangeType::NEW_PRICE;
+    for (size_t i = 0; i < prev_levels.size(); ++i) {
+        if (prev_levels.prices[i] == price) {
+            if (size > prev_levels.sizes[i]) {
+                change = PriceChangeType::INCREASED_SIZE;
+            } else if (size < prev_levels.sizes[i]) {
+                change = PriceChangeType::DECREASED_SIZE;
+            } else {
+                change = PriceChangeType::NO_CHANGE;
+            }
+            break;
+        }
     }
     
-    // Price level existed, check if size changed
-    if (size > it->second) {
-        return PriceChangeType::INCREASED_SIZE;
-    } else if (size < it->second) {
-        return PriceChangeType::DECREASED_SIZE;
-    }
+    auto it = std::find_if(highlights.begin(), highlights.end(),
+                           [price](const Highlight& highlight) { return highlight.price == price; });
     
-    // Size didn't change
-    return PriceChangeType::NO_CHANGE;
-}
-
-std::string ConsoleVisualizer::getPriceColorCode(double price, PriceChangeType change_type) {
-    switch (change_type) {
-        case PriceChangeType::NEW_PRICE:
-            return Color::BRIGHT_YELLOW;
-        case PriceChangeType::INCREASED_SIZE:
-            return Color::BRIGHT_GREEN;
-        case PriceChangeType::DECREASED_SIZE:
-            return Color::BRIGHT_RED;
-        case PriceChangeType::DELETED_PRICE:
-            return Color::BRIGHT_MAGENTA;
-        case PriceChangeType::NO_CHANGE:
-        default:
-            return "";  // No special color
+    // A change (re)starts the level's highlight
+    if (change != PriceChangeType::NO_CHANGE) {
+        if (it != highlights.end()) {
+            it->type = change;
+            it->remaining = change_highlight_duration_;
+        } else {
+            highlights.push_back(Highlight{price, change, change_highlight_duration_});
+        }
+        return change;
     }
+    
+    // Unchanged: keep showing a recent change until its highlight expires
+    return it != highlights.end() ? it->type : PriceChangeType::NO_CHANGE;
 }
 
-std::string ConsoleVisualizer::getSizeColorCode(double price, PriceChangeType change_type) {
+const char* ConsoleVisualizer::getChangeColorCode(PriceChangeType change_type) {
     switch (change_type) {
         case PriceChangeType::NEW_PRICE:
             return Color::BRIGHT_YELLOW;
@@ -131,339 +172,219 @@ std::string ConsoleVisualizer::getSizeColorCode(double price, PriceChangeType ch
             return Color::BRIGHT_MAGENTA;
         case PriceChangeType::NO_CHANGE:
         default:
-            return "";  // No special color
+            return nullptr;  // No special color
     }
 }
 
 void ConsoleVisualizer::updateHighlightTimers() {
-    // Update all bid highlight timers
-    for (auto it = bid_highlight_timers_.begin(); it != bid_highlight_timers_.end();) {
-        it->second--;
-        if (it->second <= 0) {
-            it = bid_highlight_timers_.erase(it);
-        } else {
-            ++it;
+    auto expire = [](std::vector<Highlight>& highlights) {
+        for (Highlight& highlight : highlights) {
+            --highlight.remaining;
         }
-    }
-    
-    // Update all ask highlight timers
-    for (auto it = ask_highlight_timers_.begin(); it != ask_highlight_timers_.end();) {
-        it->second--;
-        if (it->second <= 0) {
-            it = ask_highlight_timers_.erase(it);
-        } else {
-            ++it;
-        }
-    }
+        highlights.erase(std::remove_if(highlights.begin(), highlights.end(),
+                                        [](const Highlight& highlight) { return highlight.remaining <= 0; }),
+                         highlights.end());
+    };
+    expire(bid_highlights_);
+    expire(ask_highlights_);
 }
 
-void ConsoleVisualizer::updatePreviousState(
-    const std::vector<std::pair<double, double>>& bids,
-    const std::vector<std::pair<double, double>>& asks) {
-    
-    // Update previous bid levels
+void ConsoleVisualizer::updatePreviousState(const DepthSnapshot& snapshot, size_t bid_rows, size_t ask_rows) {
+    // Keep the displayed levels (capacity is reused across refreshes)
     prev_bids_.clear();
-    for (const auto& [price, size] : bids) {
-        prev_bids_[price] = size;
+    for (size_t i = 0; i < bid_rows; ++i) {
+        prev_bids_.push(snapshot.bids.prices[i], snapshot.bids.sizes[i]);
     }
     
-    // Update previous ask levels
     prev_asks_.clear();
-    for (const auto& [price, size] : asks) {
-        prev_asks_[price] = size;
+    for (size_t i = 0; i < ask_rows; ++i) {
+        prev_asks_.push(snapshot.asks.prices[i], snapshot.asks.sizes[i]);
     }
     
     // Update previous best bid and ask
-    prev_best_bid_ = bids.empty() ? 0.0 : bids[0].first;
-    prev_best_ask_ = asks.empty() ? 0.0 : asks[0].first;
+    prev_best_bid_ = bid_rows == 0 ? 0 : snapshot.bids.prices[0];
+    prev_best_ask_ = ask_rows == 0 ? 0 : snapshot.asks.prices[0];
 }
 
-std::string ConsoleVisualizer::formatPrice(double price, PriceChangeType change_type) {
-    std::stringstream ss;
+void ConsoleVisualizer::appendPrice(std::string& row, Price price, PriceChangeType change_type, size_t width) {
+    cell_.clear();
+    appendFixed(cell_, price, order_book_->getScale().price_decimals);
     
-    // Apply change highlighting if needed
-    std::string color_code = getPriceColorCode(price, change_type);
-    if (!color_code.empty()) {
-        ss << color_code;
+    // Apply change highlighting if needed; padding stays outside the color
+    const char* color_code = getChangeColorCode(change_type);
+    if (color_code) {
+        row += color_code;
     }
-    
-    ss << std::fixed << std::setprecision(2) << price;
-    
-    // Reset color if we applied one
-    if (!color_code.empty()) {
-        ss << Color::RESET;
+    row += cell_;
+    if (color_code) {
+        row += Color::RESET;
     }
-    
-    return ss.str();
+    appendPadding(row, cell_.size(), width);
 }
 
-std::string ConsoleVisualizer::formatSize(double size, PriceChangeType change_type) {
-    std::stringstream ss;
-    
-    // Apply change highlighting if needed
-    std::string color_code = getSizeColorCode(size, change_type);
-    if (!color_code.empty()) {
-        ss << color_code;
-    }
+void ConsoleVisualizer::appendSize(std::string& row, Quantity lots, PriceChangeType change_type, size_t width) {
+    cell_.clear();
     
     // Format the size
+    double size = order_book_->getScale().sizeToDouble(lots);
     if (size >= 10000) {
-        ss << std::fixed << std::setprecision(1) << (size / 1000) << "K";
+        appendFormat(cell_, "%.1fK", size / 1000);
     } else if (size >= 1000) {
-        ss << std::fixed << std::setprecision(2) << (size / 1000) << "K";
+        appendFormat(cell_, "%.2fK", size / 1000);
     } else if (size >= 100) {
-        ss << std::fixed << std::setprecision(1) << size;
+        appendFormat(cell_, "%.1f", size);
     } else {
-        ss << std::fixed << std::setprecision(size < 1 ? 5 : 2) << size;
+        appendFormat(cell_, "%.*f", size < 1 ? 5 : 2, size);
     }
     
-    // Reset color if we applied one
-    if (!color_code.empty()) {
-        ss << Color::RESET;
+    const char* color_code = getChangeColorCode(change_type);
+    if (color_code) {
+        row += color_code;
     }
-    
-    return ss.str();
+    row += cell_;
+    if (color_code) {
+        row += Color::RESET;
+    }
+    appendPadding(row, cell_.size(), width);
 }
 
-void ConsoleVisualizer::renderProgressBar(std::stringstream& ss, double value, double max_value, 
-                                        int width, bool is_bid) {
-    int filled_width = static_cast<int>((value / max_value) * width);
-    filled_width = std::min(filled_width, width);
+void ConsoleVisualizer::appendProgressBar(std::string& row, double value, double max_value,
+                                          int width, bool is_bid) {
+    int filled_width = max_value > 0 ? static_cast<int>((value / max_value) * width) : 0;
+    filled_width = std::clamp(filled_width, 0, width);
     
-    if (is_bid) {
-        ss << Color::GREEN;
-        for (int i = 0; i < filled_width; ++i) {
-            ss << "█";
-        }
-        ss << Color::RESET;
-    } else {
-        ss << Color::RED;
-        for (int i = 0; i < filled_width; ++i) {
-            ss << "█";
-        }
-        ss << Color::RESET;
+    row += is_bid ? Color::GREEN : Color::RED;
+    for (int i = 0; i < filled_width; ++i) {
+        row += "█";
     }
+    row += Color::RESET;
+    row.append(static_cast<size_t>(width - filled_width), ' ');
 }
 
-void ConsoleVisualizer::calculateHFTMetrics(
-    const std::vector<std::pair<double, double>>& bids,
-    const std::vector<std::pair<double, double>>& asks) {
-    
-    if (bids.empty() || asks.empty()) {
+void ConsoleVisualizer::calculateHFTMetrics(const DepthSnapshot& snapshot) {
+    if (snapshot.bids.empty() || snapshot.asks.empty()) {
         return;
     }
     
-    // Get best bid and ask prices
-    double best_bid = bids[0].first;
-    double best_ask = asks[0].first;
-    double mid_price = (best_bid + best_ask) / 2.0;
-    
-    // Calculate spread in basis points (1 bp = 0.01%)
-    spread_bps_ = ((best_ask - best_bid) / mid_price) * 10000.0;
-    
-    // Calculate bid and ask totals
-    double total_bid_volume = 0.0;
-    double total_ask_volume = 0.0;
-    double total_bid_value = 0.0;  // price * volume
-    double total_ask_value = 0.0;  // price * volume
-    
-    // Calculate bid and ask liquidity depth (within 0.5% of best levels)
-    double bid_boundary = best_bid * 0.995;  // 0.5% below best bid
-    double ask_boundary = best_ask * 1.005;  // 0.5% above best ask
-    bid_liquidity_depth_ = 0.0;
-    ask_liquidity_depth_ = 0.0;
-    
-    // Process bid side
-    for (const auto& [price, size] : bids) {
-        total_bid_volume += size;
-        total_bid_value += price * size;
-        
-        // Add to liquidity depth if within boundary
-        if (price >= bid_boundary) {
-            bid_liquidity_depth_ += size;
-        }
-    }
-    
-    // Process ask side
-    for (const auto& [price, size] : asks) {
-        total_ask_volume += size;
-        total_ask_value += price * size;
-        
-        // Add to liquidity depth if within boundary
-        if (price <= ask_boundary) {
-            ask_liquidity_depth_ += size;
-        }
-    }
-    
-    // Calculate order book imbalance (ratio of bid to ask volume)
-    if (total_ask_volume > 0) {
-        order_book_imbalance_ = total_bid_volume / total_ask_volume;
-    } else {
-        order_book_imbalance_ = 1.0;  // Neutral if no asks
-    }
-    
-    // Calculate market pressure (-1.0 to 1.0, where positive means buy pressure)
-    // A simple formula based on order book imbalance
-    market_pressure_ = (order_book_imbalance_ - 1.0) / (order_book_imbalance_ + 1.0);
-    
-    // Calculate Volume-Weighted Average Price (VWAP)
-    if (total_bid_volume > 0) {
-        vwap_bid_ = total_bid_value / total_bid_volume;
-    }
+    // Metrics are computed on ticks/lots by the vector kernels, then
+    // converted to display units
+    BookMetrics metrics = computeBookMetrics(snapshot);
+    const ProductScale& scale = order_book_->getScale();
+    const double price_unit = static_cast<double>(decimalScale(scale.price_decimals));
+
+    spread_bps_ = metrics.spread_bps;
+    bid_liquidity_depth_ = scale.sizeToDouble(metrics.bid_band_depth);
+    ask_liquidity_depth_ = scale.sizeToDouble(metrics.ask_band_depth);
+    order_book_imbalance_ = metrics.imbalance;
+    market_pressure_ = metrics.pressure;
     
-    if (total_ask_volume > 0) {
-        vwap_ask_ = total_ask_value / total_ask_volume;
+    if (metrics.bid_volume > 0) {
+        vwap_bid_ = metrics.vwap_bid / price_unit;
     }
-    
-    // Simple price impact estimation (very simplified model)
-    // Estimate how much a 1% market order would move the price
-    double market_order_size = (total_bid_volume + total_ask_volume) * 0.01;
-    double cumulative_volume = 0.0;
-    
-    // For a buy market order (walks up the ask side)
-    double impact_price = best_ask;
-    for (const auto& [price, size] : asks) {
-        cumulative_volume += size;
-        impact_price = price;
-        if (cumulative_volume >= market_order_size) {
-            break;
-        }
+    if (metrics.ask_volume > 0) {
+        vwap_ask_ = metrics.vwap_ask / price_unit;
     }
     
-    // Price impact in percentage
-    price_impact_1pct_ = ((impact_price - best_ask) / best_ask) * 100.0;
+    // Estimated move from a market buy of 1% of visible volume
+    price_impact_1pct_ = metrics.buy_impact_pct;
 }
 
 void ConsoleVisualizer::updatePerformanceMetrics() {
-    // Calculate time since last update
-    auto current_time = std::chrono::high_resolution_clock::now();
-    
-    if (last_update_time_.time_since_epoch().count() > 0) {
-        // Calculate processing latency in milliseconds
-        double latency_ms = std::chrono::duration<double, std::milli>(
-            current_time - last_update_time_).count();
-            
-        // Add to the latency queue (keep last 20 measurements)
-        processing_latencies_ms_.push_back(latency_ms);
-        if (processing_latencies_ms_.size() > 20) {
-            processing_latencies_ms_.pop_front();
-        }
-        
-        // Calculate average latency
-        if (!processing_latencies_ms_.empty()) {
-            double total_latency = 0.0;
-            for (double lat : processing_latencies_ms_) {
-                total_latency += lat;
-            }
-            avg_processing_latency_ms_ = total_latency / processing_latencies_ms_.size();
-        }
-    }
-    
-    // Update last update time
-    last_update_time_ = current_time;
-    
-    // Calculate update rate (per second)
-    updates_since_last_refresh_++;
-    
-    // Every second, record the update rate
-    static auto last_rate_update = std::chrono::steady_clock::now();
+    // Book mutations per second, measured over at least a second
     auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_rate_update).count();
-    
-    if (duration >= 1000) {  // 1 second has passed
-        double updates_per_second = (updates_since_last_refresh_ * 1000.0) / duration;
-        
-        // Add to the update rate queue (keep last 5 measurements)
-        update_rates_.push_back(static_cast<int>(updates_per_second));
-        if (update_rates_.size() > 5) {
-            update_rates_.pop_front();
-        }
-        
-        // Calculate average update rate
-        if (!update_rates_.empty()) {
-            int total_rate = 0;
-            for (int rate : update_rates_) {
-                total_rate += rate;
-            }
-            avg_update_rate_ = static_cast<double>(total_rate) / update_rates_.size();
-        }
-        
-        // Reset counters
-        updates_since_last_refresh_ = 0;
-        last_rate_update = now;
+    uint64_t sequence = order_book_->getTopOfBook().sequence;
+    if (last_rate_time_.time_since_epoch().count() == 0) {
+        last_rate_time_ = now;
+        last_rate_sequence_ = sequence;
     }
-}
 
-std::string ConsoleVisualizer::formatPercentage(double value, bool include_sign) {
-    std::stringstream ss;
-    
-    if (include_sign && value > 0) {
-        ss << "+";
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_rate_time_).count();
+    if (elapsed_ms >= 1000) {
+        update_rate_ = static_cast<double>(sequence - last_rate_sequence_) * 1000.0 / elapsed_ms;
+        last_rate_time_ = now;
+        last_rate_sequence_ = sequence;
+    }
+
+    if (latency_source_) {
+        for (const LatencySummary& summary : latency_source_()) {
+            if (summary.stage == LatencyStage::TOTAL) {
+                total_latency_ = summary;
+            }
+        }
     }
-    
-    ss << std::fixed << std::setprecision(2) << value << "%";
-    return ss.str();
 }
 
-std::string ConsoleVisualizer::formatLatency(double latency_ms) {
-    std::stringstream ss;
-    
+void ConsoleVisualizer::appendLatency(std::string& row, double latency_ms) {
     if (latency_ms < 1.0) {
         // Show in microseconds
-        ss << std::fixed << std::setprecision(1) << (latency_ms * 1000.0) << " μs";
+        appendFormat(row, "%.1f μs", latency_ms * 1000.0);
     } else if (latency_ms < 1000.0) {
         // Show in milliseconds
-        ss << std::fixed << std::setprecision(2) << latency_ms << " ms";
+        appendFormat(row, "%.2f ms", latency_ms);
     } else {
         // Show in seconds
-        ss << std::fixed << std::setprecision(3) << (latency_ms / 1000.0) << " s";
+        appendFormat(row, "%.3f s", latency_ms / 1000.0);
     }
-    
-    return ss.str();
 }
 
-void ConsoleVisualizer::renderHFTMetrics(std::stringstream& output) {
-    output << "───────────────────────────────────────────────────────────────────────────\n";
-    output << Color::BOLD << "HFT Metrics:\n" << Color::RESET;
+void ConsoleVisualizer::renderHFTMetrics() {
+    frame_.addRow() += kRule;
+    std::string& title = frame_.addRow();
+    title += Color::BOLD;
+    title += "HFT Metrics:";
+    title += Color::RESET;
     
     // First row: Imbalance, Spread, Market Pressure
-    output << "Book Imbalance: ";
+    std::string& first = frame_.addRow();
+    first += "Book Imbalance: ";
     if (order_book_imbalance_ > 1.05) {
-        output << Color::GREEN;
+        first += Color::GREEN;
     } else if (order_book_imbalance_ < 0.95) {
-        output << Color::RED;
+        first += Color::RED;
     }
-    output << std::fixed << std::setprecision(2) << order_book_imbalance_ << "x" << Color::RESET;
+    appendFormat(first, "%.2fx", order_book_imbalance_);
+    first += Color::RESET;
     
-    output << " | Spread: " << std::fixed << std::setprecision(1) << spread_bps_ << " bps";
+    appendFormat(first, " | Spread: %.1f bps", spread_bps_);
     
-    output << " | Market Pressure: ";
+    first += " | Market Pressure: ";
     if (market_pressure_ > 0.05) {
-        output << Color::GREEN;
+        first += Color::GREEN;
     } else if (market_pressure_ < -0.05) {
-        output << Color::RED;
+        first += Color::RED;
     }
-    output << std::fixed << std::setprecision(2) << market_pressure_ << Color::RESET;
+    appendFormat(first, "%.2f", market_pressure_);
+    first += Color::RESET;
     
-    output << " | Est. 1% Impact: " << formatPercentage(price_impact_1pct_) << "\n";
+    appendFormat(first, " | Est. 1%% Impact: %.2f%%", price_impact_1pct_);
     
     // Second row: VWAP, Liquidity Depth
-    output << "VWAP (Bid/Ask): " << std::fixed << std::setprecision(2) << vwap_bid_ 
-           << " / " << vwap_ask_;
-    
-    output << " | Liquidity Depth (0.5%): " << std::fixed << std::setprecision(2) 
-           << bid_liquidity_depth_ << " / " << ask_liquidity_depth_;
+    std::string& second = frame_.addRow();
+    appendFormat(second, "VWAP (Bid/Ask): %.2f / %.2f", vwap_bid_, vwap_ask_);
+    appendFormat(second, " | Liquidity Depth (0.5%%): %.2f / %.2f", bid_liquidity_depth_, ask_liquidity_depth_);
     
     // Performance metrics
-    output << " | Updates: " << std::fixed << std::setprecision(1) << avg_update_rate_ << "/s";
-    
-    output << " | Latency: ";
-    if (avg_processing_latency_ms_ < 1.0) {
-        output << Color::GREEN;
-    } else if (avg_processing_latency_ms_ > 10.0) {
-        output << Color::RED;
+    appendFormat(second, " | Updates: %.1f/s", update_rate_);
+
+    // Socket read to book published, p50 / p99 / p99.9
+    second += " | Latency: ";
+    if (total_latency_.count == 0) {
+        second += "n/a";
+        return;
     }
-    output << formatLatency(avg_processing_latency_ms_) << Color::RESET << "\n";
+    double p99_ms = total_latency_.p99_ns / 1e6;
+    if (p99_ms < 0.1) {
+        second += Color::GREEN;
+    } else if (p99_ms > 1.0) {
+        second += Color::RED;
+    }
+    appendLatency(second, total_latency_.p50_ns / 1e6);
+    second += " / ";
+    appendLatency(second, p99_ms);
+    second += " / ";
+    appendLatency(second, total_latency_.p999_ns / 1e6);
+    second += Color::RESET;
+    second += " (p50/p99/p99.9)";
 }
 
 void ConsoleVisualizer::render() {
@@ -474,46 +395,73 @@ void ConsoleVisualizer::render() {
     // Update performance metrics
     updatePerformanceMetrics();
 
-    // Instead of clearing the screen, move cursor to the beginning and update in-place
-    // Store the current cursor position so we can restore it at the end
-    std::cout << "\033[s"; // Save cursor position
-    std::cout << "\033[H"; // Move to top-left corner
-    
-    std::stringstream output;
+    frame_.begin();
 
     // Get current time
     auto now = std::chrono::system_clock::now();
     auto time = std::chrono::system_clock::to_time_t(now);
-    std::string time_str = std::ctime(&time);
-    time_str.pop_back();  // Remove trailing newline
-
-    // Print header with project name and symbol
-    output << Color::CYAN << Color::BOLD
-           << "┌─────────────────────────────────────────────────────────────────────────┐\n"
-           << "│                   CLUNK - Order Book Visualization                      │\n"
-           << "└─────────────────────────────────────────────────────────────────────────┘"
-           << Color::RESET << "\n";
-
-    output << "Symbol: " << Color::BOLD << Color::YELLOW << order_book_->getSymbol() 
-           << Color::RESET << " | Time: " << time_str << "\n";
-
-    // Get order book levels
-    auto bids = order_book_->getBidLevels(depth_);
-    auto asks = order_book_->getAskLevels(depth_);
+    char time_str[32] = "";
+    std::tm local_time{};
+    if (localtime_r(&time, &local_time)) {
+        std::strftime(time_str, sizeof(time_str), "%a %b %e %H:%M:%S %Y", &local_time);
+    }
+
+    // Print header with project name and symbol; every row carries its own
+    // colors, since only changed rows are redrawn
+    const char* banner[] = {
+        "┌─────────────────────────────────────────────────────────────────────────┐",
+        "│                   CLUNK - Order Book Visualization                      │",
+        "└─────────────────────────────────────────────────────────────────────────┘"};
+    for (const char* line : banner) {
+        std::string& row = frame_.addRow();
+        row += Color::CYAN;
+        row += Color::BOLD;
+        row += line;
+        row += Color::RESET;
+    }
+
+    std::string& symbol_row = frame_.addRow();
+    symbol_row += "Symbol: ";
+    symbol_row += Color::BOLD;
+    symbol_row += Color::YELLOW;
+    symbol_row += order_book_->getSymbol();
+    symbol_row += Color::RESET;
+    symbol_row += " | Time: ";
+    symbol_row += time_str;
+
+    // Read the last published depth without taking the book lock, asking
+    // for a fresh one only when the book has moved on since
+    TopOfBook top = order_book_->getTopOfBook();
+    PublishedDepth published = order_book_->getPublishedDepth();
+    if (!published || published->sequence != top.sequence) {
+        published = PublishedDepth();
+        order_book_->publishDepth();
+        published = order_book_->getPublishedDepth();
+    }
+    if (!published) {
+        order_book_->getDepthSnapshot(depth_, snapshot_);
+    }
+    const DepthSnapshot& snapshot = published ? *published : snapshot_;
+
+    size_t bid_rows = std::min(depth_, snapshot.bids.size());
+    size_t ask_rows = std::min(depth_, snapshot.asks.size());
 
     // Calculate HFT metrics
-    calculateHFTMetrics(bids, asks);
+    calculateHFTMetrics(snapshot);
 
     // Print order book statistics
-    double best_bid = order_book_->getBestBid();
-    double best_ask = order_book_->getBestAsk();
-    double spread = order_book_->getSpread();
-    double spread_percent = (best_ask > 0) ? (spread / best_ask) * 100.0 : 0.0;
-    double midpoint = order_book_->getMidpointPrice();
+    const ProductScale& scale = order_book_->getScale();
+    Price best_bid = top.bid_price;
+    Price best_ask = top.hasAsk() ? top.ask_price : 0;
+    Price spread = (top.hasBid() && top.hasAsk()) ? best_ask - best_bid : 0;
+    double spread_percent = (best_ask > 0)
+        ? static_cast<double>(spread) * 100.0 / static_cast<double>(best_ask) : 0.0;
+    double midpoint = (top.hasBid() && top.hasAsk())
+        ? scale.toDouble(best_bid + best_ask) / 2.0 : 0.0;
 
     // Determine if best bid/ask changed
-    std::string best_bid_color = Color::GREEN;
-    std::string best_ask_color = Color::RED;
+    const char* best_bid_color = Color::GREEN;
+    const char* best_ask_color = Color::RED;
     
     if (highlight_changes_) {
         if (best_bid > prev_best_bid_) {
@@ -529,168 +477,142 @@ void ConsoleVisualizer::render() {
         }
     }
 
-    output << "───────────────────────────────────────────────────────────────────────────\n";
-    output << "Market Summary:\n";
-    output << "Best Bid: " << best_bid_color << std::fixed << std::setprecision(2) << best_bid << Color::RESET;
-    output << " | Best Ask: " << best_ask_color << std::fixed << std::setprecision(2) << best_ask << Color::RESET;
-    output << " | Spread: " << std::fixed << std::setprecision(2) << spread << " (" << std::fixed << std::setprecision(3) << spread_percent << "%)";
-    output << " | Midpoint: " << Color::CYAN << std::fixed << std::setprecision(2) << midpoint << Color::RESET << "\n";
-
-    output << "Orders: " << order_book_->getOrderCount();
-    output << " | Bid Levels: " << order_book_->getBidLevelCount();
-    output << " | Ask Levels: " << order_book_->getAskLevelCount() << "\n";
+    frame_.addRow() += kRule;
+    frame_.addRow() += "Market Summary:";
+
+    std::string& summary = frame_.addRow();
+    summary += "Best Bid: ";
+    summary += best_bid_color;
+    appendFixed(summary, best_bid, scale.price_decimals);
+    summary += Color::RESET;
+    summary += " | Best Ask: ";
+    summary += best_ask_color;
+    appendFixed(summary, best_ask, scale.price_decimals);
+    summary += Color::RESET;
+    summary += " | Spread: ";
+    appendFixed(summary, spread, scale.price_decimals);
+    appendFormat(summary, " (%.3f%%)", spread_percent);
+    summary += " | Midpoint: ";
+    summary += Color::CYAN;
+    appendFormat(summary, "%.2f", midpoint);
+    summary += Color::RESET;
+
+    // Whole-book counts come with the snapshot, not from the locked book
+    appendFormat(frame_.addRow(), "Orders: %zu | Bid Levels: %zu | Ask Levels: %zu",
+                 snapshot.orders, snapshot.bid_levels, snapshot.ask_levels);
     
     // Render HFT metrics section
-    renderHFTMetrics(output);
+    renderHFTMetrics();
     
-    output << "───────────────────────────────────────────────────────────────────────────\n";
-
-    // Calculate max size for bid and ask to scale bar widths
-    double max_bid_size = 0.0;
-    for (const auto& [price, size] : bids) {
-        max_bid_size = std::max(max_bid_size, size);
-    }
-
-    double max_ask_size = 0.0;
-    for (const auto& [price, size] : asks) {
-        max_ask_size = std::max(max_ask_size, size);
-    }
-
-    double max_size = std::max(max_bid_size, max_ask_size);
-    if (max_size <= 0.0) {
-        max_size = 1.0;  // Avoid division by zero
-    }
+    frame_.addRow() += kRule;
 
-    // Calculate depth statistics
-    double bid_size_total = 0.0;
-    double ask_size_total = 0.0;
+    // Calculate depth statistics for the bar widths
+    Quantity bid_size_total = 0;
+    Quantity ask_size_total = 0;
     
-    for (const auto& [price, size] : bids) {
-        bid_size_total += size;
+    for (size_t i = 0; i < bid_rows; ++i) {
+        bid_size_total += snapshot.bids.sizes[i];
     }
     
-    for (const auto& [price, size] : asks) {
-        ask_size_total += size;
+    for (size_t i = 0; i < ask_rows; ++i) {
+        ask_size_total += snapshot.asks.sizes[i];
     }
 
     // Print table header with improved formatting
-    output << Color::BOLD 
-           << std::left << std::setw(12) << "BIDS" 
-           << std::setw(20) << " " 
-           << "│ " 
-           << std::setw(12) << "ASKS" 
-           << Color::RESET << "\n";
-           
-    output << std::left << std::setw(8) << "Size" 
-           << std::setw(10) << "Price" 
-           << std::setw(14) << "Depth" 
-           << "│ " 
-           << std::setw(10) << "Price" 
-           << std::setw(8) << "Size" 
-           << std::setw(14) << "Depth" 
-           << "\n";
+    std::string& table_title = frame_.addRow();
+    table_title += Color::BOLD;
+    table_title += "BIDS";
+    appendPadding(table_title, 4, 32);
+    table_title += "│ ASKS";
+    table_title += Color::RESET;
+
+    std::string& columns = frame_.addRow();
+    columns += "Size    Price     Depth         │ Price     Size    Depth";
            
-    output << "───────────────────────────────────┼───────────────────────────────────────\n";
+    frame_.addRow() += "───────────────────────────────────┼───────────────────────────────────────";
 
     // Print bid and ask levels with visual depth indicator and change highlighting
     const int bar_width = 10;
+    Quantity cumulative_bid = 0;
+    Quantity cumulative_ask = 0;
     
     for (size_t i = 0; i < depth_; ++i) {
-        std::stringstream line;
+        std::string& line = frame_.addRow();
         
         // Print bid side
-        if (i < bids.size()) {
-            double bid_price = bids[i].first;
-            double bid_size = bids[i].second;
-            double cumulative_bid = 0.0;
-            
-            // Calculate cumulative size up to this level
-            for (size_t j = 0; j <= i; ++j) {
-                cumulative_bid += bids[j].second;
-            }
+        if (i < bid_rows) {
+            Price bid_price = snapshot.bids.prices[i];
+            Quantity bid_size = snapshot.bids.sizes[i];
+            cumulative_bid += bid_size;
             
             // Determine change type for this price level
-            PriceChangeType bid_change = getPriceChangeType(bid_price, bid_size, prev_bids_);
-            
-            // If this price level has a change, update its highlight timer
-            if (bid_change != PriceChangeType::NO_CHANGE) {
-                bid_highlight_timers_[bid_price] = change_highlight_duration_;
-            }
+            PriceChangeType bid_change = getPriceChangeType(bid_price, bid_size, prev_bids_, bid_highlights_);
             
             // Format bid side with appropriate highlighting
-            line << std::left 
-                 << std::setw(8) << formatSize(bid_size, bid_change)
-                 << std::setw(10) << formatPrice(bid_price, bid_change);
+            appendSize(line, bid_size, bid_change, 8);
+            appendPrice(line, bid_price, bid_change, 10);
                  
             // Add visual depth indicator
-            line << std::setw(3) << " ";
-            renderProgressBar(line, cumulative_bid, bid_size_total, bar_width, true);
-            line << std::setw(1) << " ";
+            line += "   ";
+            appendProgressBar(line, static_cast<double>(cumulative_bid),
+                              static_cast<double>(bid_size_total), bar_width, true);
+            line += " ";
         } else {
-            line << std::setw(32) << " ";
+            line.append(32, ' ');
         }
         
         // Center divider
-        line << "│ ";
+        line += "│ ";
         
         // Print ask side with change highlighting
-        if (i < asks.size()) {
-            double ask_price = asks[i].first;
-            double ask_size = asks[i].second;
-            double cumulative_ask = 0.0;
-            
-            // Calculate cumulative size up to this level
-            for (size_t j = 0; j <= i; ++j) {
-                cumulative_ask += asks[j].second;
-            }
+        if (i < ask_rows) {
+            Price ask_price = snapshot.asks.prices[i];
+            Quantity ask_size = snapshot.asks.sizes[i];
+            cumulative_ask += ask_size;
             
             // Determine change type for this price level
-            PriceChangeType ask_change = getPriceChangeType(ask_price, ask_size, prev_asks_);
-            
-            // If this price level has a change, update its highlight timer
-            if (ask_change != PriceChangeType::NO_CHANGE) {
-                ask_highlight_timers_[ask_price] = change_highlight_duration_;
-            }
+            PriceChangeType ask_change = getPriceChangeType(ask_price, ask_size, prev_asks_, ask_highlights_);
             
             // Format ask side with appropriate highlighting
-            line << std::left
-                 << std::setw(10) << formatPrice(ask_price, ask_change)
-                 << std::setw(8) << formatSize(ask_size, ask_change);
+            appendPrice(line, ask_price, ask_change, 10);
+            appendSize(line, ask_size, ask_change, 8);
                  
             // Add visual depth indicator
-            line << std::setw(3) << " ";
-            renderProgressBar(line, cumulative_ask, ask_size_total, bar_width, false);
+            line += "   ";
+            appendProgressBar(line, static_cast<double>(cumulative_ask),
+                              static_cast<double>(ask_size_total), bar_width, false);
         }
-        
-        output << line.str() << "\n";
     }
 
-    output << "───────────────────────────────────────────────────────────────────────────\n";
-    output << "Visualization updates every " << refresh_rate_ms_ << "ms. Press Ctrl+C to exit.\n";
+    frame_.addRow() += kRule;
+    appendFormat(frame_.addRow(), "Visualization updates every %dms. Press Ctrl+C to exit.", refresh_rate_ms_);
     if (highlight_changes_) {
-        output << Color::BRIGHT_GREEN << "▲" << Color::RESET << " = Increased  ";
-        output << Color::BRIGHT_RED << "▼" << Color::RESET << " = Decreased  ";
-        output << Color::BRIGHT_YELLOW << "●" << Color::RESET << " = New Level\n";
-    }
+        std::string& legend = frame_.addRow();
+        legend += Color::BRIGHT_GREEN;
+        legend += "▲";
+        legend += Color::RESET;
+        legend += " = Increased  ";
+        legend += Color::BRIGHT_RED;
+        legend += "▼";
+        legend += Color::RESET;
+        legend += " = Decreased  ";
+        legend += Color::BRIGHT_YELLOW;
+        legend += "●";
+        legend += Color::RESET;
+        legend += " = New Level";
+    }
+
+    // Update highlight timers and store current state for next comparison
+    updateHighlightTimers();
+    updatePreviousState(snapshot, bid_rows, ask_rows);
 
-    // Clear any potential old content - fill lines with spaces up to a reasonable screen width
-    // This avoids artifacts from previous renders that might be longer
-    std::string clear_line(80, ' ');
-    for (size_t i = 0; i < 5; i++) {
-        output << clear_line << "\n";
+    // Hand only the changed rows to the writer; if the terminal fell so far
+    // behind that the writer dropped them, redraw everything next time
+    out_.clear();
+    frame_.diff(out_);
+    if (!out_.empty() && !writer_->submit(out_)) {
+        frame_.invalidate();
     }
-
-    // Output the entire visualization at once to reduce flickering
-    std::cout << output.str();
-    
-    // Flush output to ensure it's displayed
-    std::cout.flush();
-    
-    // Update highlight timers after rendering
-    updateHighlightTimers();
-    
-    // Store current state for next comparison
-    updatePreviousState(bids, asks);
 }
 
-} // namespace clunk
\ No newline at end of file
+} // namespace clunk
@@ -1,23 +1,32 @@
 #pragma once
 
-#include "../orderbook/order_book.h"
+#include "../orderbook/book_view.h"
+#include "../analytics/book_metrics.h"
+#include "../network/pipeline_latency.h"
+#include "display_frame.h"
+#include "terminal_writer.h"
 #include <memory>
 #include <thread>
 #include <atomic>
 #include <functional>
-#include <sstream>
-#include <map>
-#include <unordered_map>
-#include <deque>
+#include <string>
 #include <chrono>
+#include <vector>
 
 namespace clunk {
 
-// Console-based order book visualizer
+// Console-based order book visualizer (renders either book type)
+//
+// Each refresh builds the screen row by row into reused buffers, and only
+// the rows that changed since the last refresh go to the terminal, written
+// by a TerminalWriter thread so a slow terminal never stalls rendering. The
+// displayed depth is published on the render thread's request (when the
+// last snapshot is stale), not after every book mutation, so an idle
+// display costs the feed thread nothing.
 class ConsoleVisualizer {
 public:
     // Constructor
-    explicit ConsoleVisualizer(std::shared_ptr<OrderBook> order_book);
+    explicit ConsoleVisualizer(std::shared_ptr<BookView> order_book);
 
     // Destructor
     ~ConsoleVisualizer();
@@ -25,6 +34,10 @@ public:
     // Start visualization
     void start(int refresh_rate_ms = 500);
 
+    // Pin the render thread to `cpu` (< 0: leave it floating), e.g. away
+    // from the feed's cores. Call before start().
+    void setRenderCpu(int cpu) { render_cpu_ = cpu; }
+
     // Stop visualization
     void stop();
 
@@ -37,6 +50,12 @@ public:
     void setRefreshCallback(std::function<void()> callback) {
         refresh_callback_ = callback;
     }
+
+    // Set where the feed's stage latencies come from (e.g. the handler's
+    // getLatencyStats()); without one no latency is shown
+    void setLatencySource(std::function<std::vector<LatencySummary>()> source) {
+        latency_source_ = std::move(source);
+    }
     
     // Enable/disable highlighting of changes
     void setChangeHighlighting(bool enabled) {
@@ -49,9 +68,10 @@ public:
     }
 
 private:
-    std::shared_ptr<OrderBook> order_book_;
+    std::shared_ptr<BookView> order_book_;
     std::atomic<bool> running_;
     std::thread viz_thread_;
+    int render_cpu_ = -1;
     size_t depth_;
     std::function<void()> refresh_callback_;
     int refresh_rate_ms_ = 500;  // Store refresh rate for display
@@ -60,13 +80,16 @@ private:
     bool highlight_changes_ = true;
     int change_highlight_duration_ = 2;  // Number of refreshes to highlight changes
     
-    // Data structures to track previous state for change highlighting
-    std::map<double, double> prev_bids_;  // Previous bid price -> size
-    std::map<double, double> prev_asks_;  // Previous ask price -> size
-    double prev_best_bid_ = 0.0;
-    double prev_best_ask_ = 0.0;
+    // Levels shown last refresh, for change highlighting
+    DepthSide prev_bids_;
+    DepthSide prev_asks_;
+    Price prev_best_bid_ = 0;
+    Price prev_best_ask_ = 0;
     
-    // HFT metrics
+    // Depth captured each refresh (reused so refreshes do not reallocate)
+    DepthSnapshot snapshot_;
+
+    // HFT metrics (computed from ticks/lots, stored in display units)
     double order_book_imbalance_ = 0.0;     // Ratio of bid volume to ask volume
     double vwap_bid_ = 0.0;                 // Volume-weighted average price for bids
     double vwap_ask_ = 0.0;                 // Volume-weighted average price for asks
@@ -76,21 +99,15 @@ private:
     double ask_liquidity_depth_ = 0.0;      // Cumulative liquidity within 0.5% of best ask
     double spread_bps_ = 0.0;               // Spread in basis points
     
-    // Update rate tracking
-    int updates_since_last_refresh_ = 0;
-    std::deque<int> update_rates_;          // Stores update rates for moving average
-    double avg_update_rate_ = 0.0;          // Average updates per second
-    
-    // Latency tracking
-    using TimePoint = std::chrono::high_resolution_clock::time_point;
-    std::deque<double> processing_latencies_ms_;  // Stores recent processing latencies in ms
-    double avg_processing_latency_ms_ = 0.0;      // Average processing latency in ms
-    TimePoint last_update_time_;                  // Time of last update
-    
-    // Track how long we've been highlighting each price level
-    std::unordered_map<double, int> bid_highlight_timers_;
-    std::unordered_map<double, int> ask_highlight_timers_;
-    
+    // Book update rate, from the book's mutation count once a second
+    std::chrono::steady_clock::time_point last_rate_time_;
+    uint64_t last_rate_sequence_ = 0;
+    double update_rate_ = 0.0;
+
+    // Socket-read-to-book latency, refreshed every render
+    std::function<std::vector<LatencySummary>()> latency_source_;
+    LatencySummary total_latency_;
+
     // For tracking new, updated, deleted price levels
     enum class PriceChangeType {
         NO_CHANGE,
@@ -99,38 +116,52 @@ private:
         DECREASED_SIZE,
         DELETED_PRICE
     };
+
+    // A level still highlighted, and for how many more refreshes
+    struct Highlight {
+        Price price;
+        PriceChangeType type;
+        int remaining;
+    };
+    std::vector<Highlight> bid_highlights_;
+    std::vector<Highlight> ask_highlights_;
+
+    // Screen rows, the diff sent to the terminal, and its writer
+    DisplayFrame frame_;
+    std::string out_;
+    std::string cell_;
+    std::unique_ptr<TerminalWriter> writer_;
     
-    // Get the type of change for a price level
-    PriceChangeType getPriceChangeType(double price, double size, const std::map<double, double>& prev_levels);
+    // Get the type of change for a price level, keeping it highlighted for
+    // the highlight duration
+    PriceChangeType getPriceChangeType(Price price, Quantity size, const DepthSide& prev_levels,
+                                       std::vector<Highlight>& highlights);
     
-    // Determine the appropriate color for a price or size based on its change
-    std::string getPriceColorCode(double price, PriceChangeType change_type);
-    std::string getSizeColorCode(double price, PriceChangeType change_type);
+    // Color for a level's price and size, given its change
+    static const char* getChangeColorCode(PriceChangeType change_type);
     
-    // Update highlight timers and previous state
+    // Count down highlight timers and keep this refresh's levels
     void updateHighlightTimers();
-    void updatePreviousState(const std::vector<std::pair<double, double>>& bids,
-                            const std::vector<std::pair<double, double>>& asks);
+    void updatePreviousState(const DepthSnapshot& snapshot, size_t bid_rows, size_t ask_rows);
                             
     // Calculate HFT metrics
-    void calculateHFTMetrics(const std::vector<std::pair<double, double>>& bids,
-                            const std::vector<std::pair<double, double>>& asks);
+    void calculateHFTMetrics(const DepthSnapshot& snapshot);
     
-    // Update latency and update rate metrics
+    // Update the book update rate and feed latency
     void updatePerformanceMetrics();
 
     // Render the order book
     void render();
     
     // Render HFT metrics section
-    void renderHFTMetrics(std::stringstream& output);
+    void renderHFTMetrics();
+
     
-    // Helper methods for formatting
-    std::string formatPrice(double price, PriceChangeType change_type);
-    std::string formatSize(double size, PriceChangeType change_type);
-    std::string formatPercentage(double value, bool include_sign = false);
-    std::string formatLatency(double latency_ms);
-    void renderProgressBar(std::stringstream& ss, double value, double max_value, int width, bool is_bid);
+    // Helper methods for formatting, appending to a row
+    void appendPrice(std::string& row, Price price, PriceChangeType change_type, size_t width);
+    void appendSize(std::string& row, Quantity size, PriceChangeType change_type, size_t width);
+    static void appendLatency(std::string& row, double latency_ms);
+    static void appendProgressBar(std::string& row, double value, double max_value, int width, bool is_bid);
 };
 
 } // namespace clunk
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "display_frame.h"
+#include <charconv>
+#include <utility>
+
+namespace clunk {
+
+namespace {
+
+// Move the cursor to the start of 0-based `row`
+void appendCursorMove(std::string& out, size_t row) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), row + 1).ptr;
+    out += "\033[";
+    out.append(digits, end);
+    out += ";1H";
+}
+
+} // namespace
+
+DisplayFrame::DisplayFrame(size_t row_capacity) : row_capacity_(row_capacity) {
+}
+
+void DisplayFrame::begin() {
+    count_ = 0;
+}
+
+std::string& DisplayFrame::addRow() {
+    if (count_ == rows_.size()) {
+        rows_.emplace_back().reserve(row_capacity_);
+    }
+    std::string& row = rows_[count_++];
+    row.clear();
+    return row;
+}
+
+size_t DisplayFrame::diff(std::string& out) {
+    size_t written = 0;
+    for (size_t i = 0; i < count_; ++i) {
+        if (!full_redraw_ && i < shown_count_ && rows_[i] == shown_[i]) {
+            continue;
+        }
+        appendCursorMove(out, i);
+        out += rows_[i];
+        out += "\033[K";
+        ++written;
+    }
+
+    // Blank what a longer previous frame left below this one
+    for (size_t i = count_; i < shown_count_; ++i) {
+        appendCursorMove(out, i);
+        out += "\033[K";
+        ++written;
+    }
+
+    // Leave the cursor below the frame, where stray output does least harm
+    if (written != 0) {
+        appendCursorMove(out, count_);
+    }
+
+    // This frame is now on screen; the old rows become the next frame's
+    // buffers
+    std::swap(rows_, shown_);
+    shown_count_ = count_;
+    count_ = 0;
+    full_redraw_ = false;
+    return written;
+}
+
+} // namespace clunk
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace clunk {
+
+// The rows of one rendered screen, diffed against the rows on the terminal
+// so a refresh only writes the rows that changed
+//
+// Rows are built in place into strings that keep their capacity across
+// frames, and diff() appends cursor moves and the changed rows to a
+// caller-owned buffer, so a steady-state refresh does not allocate.
+class DisplayFrame {
+public:
+    // Constructor (row_capacity: bytes reserved per row, escapes included)
+    explicit DisplayFrame(size_t row_capacity = 256);
+
+    // Start a new frame
+    void begin();
+
+    // Append an empty row and return it to write into
+    std::string& addRow();
+
+    // Append to `out` what turns the frame on the terminal into this one:
+    // for each changed row, a cursor move to it, the row, and a clear to
+    // the end of the line; rows the previous frame had beyond this one's are
+    // blanked, and the cursor is left on the row below the frame. This frame
+    // then counts as shown. Returns the rows written.
+    size_t diff(std::string& out);
+
+    // Redraw every row on the next diff(), e.g. after the terminal was
+    // cleared or a write was dropped
+    void invalidate() { full_redraw_ = true; }
+
+    // Rows in the frame being built
+    size_t size() const { return count_; }
+
+private:
+    size_t row_capacity_;
+    std::vector<std::string> rows_;     // Frame being built ([0, count_))
+    std::vector<std::string> shown_;    // Frame on the terminal ([0, shown_count_))
+    size_t count_ = 0;
+    size_t shown_count_ = 0;
+    bool full_redraw_ = true;
+};
+
+} // namespace clunk
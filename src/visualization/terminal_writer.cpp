@@ -0,0 +1,25 @@
+#include "terminal_writer.h"
+
+namespace clunk {
+
+TerminalWriter::TerminalWriter(std::FILE* out, size_t max_pending)
+    : out_(out), max_pending_(max_pending), writer_([this](std::string& bytes) {
+          std::fwrite(bytes.data(), 1, bytes.size(), out_);
+          std::fflush(out_);
+      }) {
+    writer_.submit([](std::string& pending) { pending.reserve(64 * 1024); });
+}
+
+bool TerminalWriter::submit(const std::string& bytes) {
+    return writer_.submit([&](std::string& pending) {
+        if (pending.size() + bytes.size() > max_pending_) {
+            dropped_.fetch_add(pending.size() + bytes.size(), std::memory_order_relaxed);
+            pending.clear();
+            return false;
+        }
+        pending += bytes;
+        return true;
+    });
+}
+
+} // namespace clunk
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "utils/background_writer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace clunk {
+
+// Writes rendered frames to a terminal from its own thread
+//
+// A slow or stalled terminal blocks only this thread: submit() copies the
+// bytes into a pending buffer and returns. Frames submitted while one is
+// being written are coalesced into the next write. If the terminal falls
+// more than `max_pending` bytes behind, submit() drops the pending bytes
+// and returns false, and the caller should redraw in full next time (the
+// dropped diff may have been half the screen).
+class TerminalWriter {
+public:
+    static constexpr size_t kDefaultMaxPending = 1 << 20;
+
+    // Start the writer thread; `out` must outlive the writer
+    explicit TerminalWriter(std::FILE* out, size_t max_pending = kDefaultMaxPending);
+
+    TerminalWriter(const TerminalWriter&) = delete;
+    TerminalWriter& operator=(const TerminalWriter&) = delete;
+
+    // Queue `bytes` for writing; false if the backlog was dropped instead
+    bool submit(const std::string& bytes);
+
+    // Block until everything submitted so far has been written
+    void flush() { writer_.flush(); }
+
+    // Bytes dropped because the terminal fell behind
+    size_t getDroppedBytes() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::FILE* out_;
+    size_t max_pending_;
+    std::atomic<size_t> dropped_{0};
+
+    BackgroundWriter<std::string> writer_;
+};
+
+} // namespace clunk
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include "feed_handlers/book_checkpoint.h"
+#include "feed_handlers/coinbase_handler.h"
+#include "orderbook/level_book.h"
+#include "orderbook/order_book.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+// Checkpoint file in the test's working directory, removed afterwards
+class TempCheckpoint {
+public:
+    explicit TempCheckpoint(const std::string& symbol) : path_(checkpointPath(".", symbol)) {}
+    ~TempCheckpoint() { std::remove(path_.c_str()); }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+Order makeOrder(const char* id, OrderSide side, Price price, Quantity size) {
+    return Order(OrderId::fromString(id), side, price, size, std::chrono::nanoseconds(0));
+}
+
+const char* kSnapshot =
+    R"({"type":"snapshot","product_id":"BTC-USD","sequence":10,)"
+    R"("bids":[["100.00","2","m1"]],"asks":[["101.00","1","a1"]]})";
+
+std::string openMessage(uint64_t sequence, const char* id, const char* price) {
+    return R"({"type":"open","product_id":"BTC-USD","sequence":)" + std::to_string(sequence) +
+           R"(,"order_id":")" + id + R"(","side":"buy","price":")" + price + R"(","size":"1"})";
+}
+
+} // namespace
+
+// Test that a checkpoint reads back exactly as it was saved
+TEST(BookCheckpointTests, SaveLoadRoundTrip) {
+    TempCheckpoint file("ROUND-TRIP");
+
+    BookCheckpoint saved;
+    saved.symbol = "ROUND-TRIP";
+    saved.scale = ProductScale(2, 8);
+    saved.sequence = 42;
+    saved.saved_ns = 123456789;
+    saved.orders = true;
+    saved.entries = {{OrderSide::BUY, 100, 5, OrderId::fromString("b1")},
+                     {OrderSide::SELL, 101, 7, OrderId::fromString("a1")}};
+    ASSERT_TRUE(saveCheckpoint(file.path(), saved));
+
+    BookCheckpoint loaded;
+    ASSERT_TRUE(loadCheckpoint(file.path(), loaded));
+    EXPECT_EQ(loaded.symbol, saved.symbol);
+    EXPECT_EQ(loaded.scale.price_decimals, 2);
+    EXPECT_EQ(loaded.scale.size_decimals, 8);
+    EXPECT_EQ(loaded.sequence, 42u);
+    EXPECT_EQ(loaded.saved_ns, 123456789u);
+    EXPECT_TRUE(loaded.orders);
+    ASSERT_EQ(loaded.entries.size(), 2u);
+    EXPECT_EQ(loaded.entries[1].side, OrderSide::SELL);
+    EXPECT_EQ(loaded.entries[1].price, 101);
+    EXPECT_EQ(loaded.entries[1].size, 7);
+    EXPECT_EQ(loaded.entries[1].order_id, OrderId::fromString("a1"));
+
+    // A truncated file is not a checkpoint
+    std::string bytes(kCheckpointHeaderSize + 2 * kCheckpointEntrySize, '\0');
+    std::FILE* in = std::fopen(file.path().c_str(), "rb");
+    ASSERT_NE(in, nullptr);
+    EXPECT_EQ(std::fread(bytes.data(), 1, bytes.size(), in), bytes.size());
+    std::fclose(in);
+    std::FILE* out = std::fopen(file.path().c_str(), "wb");
+    ASSERT_NE(out, nullptr);
+    std::fwrite(bytes.data(), 1, bytes.size() - 8, out);
+    std::fclose(out);
+    EXPECT_FALSE(loadCheckpoint(file.path(), loaded));
+
+    EXPECT_FALSE(loadCheckpoint("missing.clunkbook", loaded));
+}
+
+// Test that an exported book reloads with its queues in time priority
+TEST(BookCheckpointTests, ExportKeepsTimePriority) {
+    OrderBook book("TEST", ProductScale(2, 8));
+    book.addOrder(makeOrder("b2", OrderSide::BUY, 99, 4));
+    book.addOrder(makeOrder("b1", OrderSide::BUY, 100, 3));
+    book.addOrder(makeOrder("b3", OrderSide::BUY, 100, 1));
+    book.addOrder(makeOrder("a1", OrderSide::SELL, 101, 2));
+
+    std::vector<LevelUpdate> entries;
+    book.exportBook(entries);
+    ASSERT_EQ(entries.size(), 4u);
+    EXPECT_EQ(entries[0].order_id, OrderId::fromString("b1"));
+    EXPECT_EQ(entries[1].order_id, OrderId::fromString("b3"));
+    EXPECT_EQ(entries[2].order_id, OrderId::fromString("b2"));
+    EXPECT_EQ(entries[3].side, OrderSide::SELL);
+
+    OrderBook restored("TEST", ProductScale(2, 8));
+    restored.loadSnapshot(entries.data(), entries.size());
+    std::vector<LevelUpdate> again;
+    restored.exportBook(again);
+    ASSERT_EQ(again.size(), entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        EXPECT_EQ(again[i].order_id, entries[i].order_id);
+    }
+
+    // Level-only books export one entry per level
+    LevelBook levels("TEST", ProductScale(2, 8));
+    levels.setLevel(OrderSide::BUY, 100, 5);
+    levels.setLevel(OrderSide::BUY, 99, 4);
+    levels.setLevel(OrderSide::SELL, 101, 2);
+    levels.exportBook(entries);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].price, 100);
+    EXPECT_EQ(entries[1].price, 99);
+    EXPECT_EQ(entries[2].price, 101);
+}
+
+// Test that a restored book catches up on held updates and becomes ready
+// without a snapshot
+TEST(BookCheckpointTests, RestoredBookCatchesUp) {
+    TempCheckpoint file("BTC-USD");
+    {
+        CoinbaseHandler handler(BookMode::ORDERS);
+        handler.enableCheckpoints(".", std::chrono::seconds(0));
+        handler.subscribe("BTC-USD");
+        EXPECT_FALSE(handler.isBookReady("BTC-USD"));
+
+        handler.injectMessage(kSnapshot);
+        handler.injectMessage(openMessage(11, "m2", "100.00"));
+        EXPECT_TRUE(handler.isBookReady("BTC-USD"));
+        EXPECT_EQ(handler.saveCheckpoints(), 1u);
+    }
+
+    CoinbaseHandler handler(BookMode::ORDERS);
+    handler.enableCheckpoints(".", std::chrono::seconds(0));
+    handler.subscribe("BTC-USD");
+    std::shared_ptr<OrderBook> book = handler.getOrderBook("BTC-USD");
+    ProductScale scale = book->getScale();
+
+    // Readable at once, but not ready until it has caught up
+    EXPECT_EQ(book->getOrderCount(), 3u);
+    EXPECT_EQ(book->getLevelSize(OrderSide::BUY, scale.toPrice(100.00)), scale.toQuantity(3));
+    EXPECT_FALSE(handler.waitForBooks({"BTC-USD"}, std::chrono::milliseconds(0)));
+
+    // An update already in the checkpoint is dropped; the next one applies
+    handler.injectMessage(openMessage(11, "m2", "100.00"));
+    EXPECT_TRUE(handler.isBookReady("BTC-USD"));
+    handler.injectMessage(openMessage(12, "m3", "99.00"));
+    EXPECT_EQ(book->getOrderCount(), 4u);
+    EXPECT_TRUE(handler.waitForBooks({"BTC-USD"}, std::chrono::milliseconds(0)));
+
+    // A snapshot older than the caught-up book is not loaded over it
+    handler.injectMessage(kSnapshot);
+    EXPECT_EQ(book->getOrderCount(), 4u);
+}
+
+// Test that missed updates leave a restored book waiting for its snapshot
+TEST(BookCheckpointTests, GapAfterCheckpointWaitsForSnapshot) {
+    TempCheckpoint file("BTC-USD");
+    {
+        CoinbaseHandler handler(BookMode::ORDERS);
+        handler.enableCheckpoints(".", std::chrono::seconds(0));
+        handler.subscribe("BTC-USD");
+        handler.injectMessage(kSnapshot);
+        EXPECT_EQ(handler.saveCheckpoints(), 1u);
+    }
+
+    CoinbaseHandler handler(BookMode::ORDERS);
+    handler.enableCheckpoints(".", std::chrono::seconds(0));
+    handler.subscribe("BTC-USD");
+    std::shared_ptr<OrderBook> book = handler.getOrderBook("BTC-USD");
+    ASSERT_EQ(book->getOrderCount(), 2u);
+
+    handler.injectMessage(openMessage(20, "m5", "99.00"));
+    handler.injectMessage(openMessage(21, "m6", "99.00"));
+    EXPECT_FALSE(handler.isBookReady("BTC-USD"));
+    EXPECT_EQ(book->getOrderCount(), 2u);
+
+    // The snapshot replays the held updates after it
+    handler.injectMessage(
+        R"({"type":"snapshot","product_id":"BTC-USD","sequence":20,)"
+        R"("bids":[["100.00","2","m1"],["99.00","1","m5"]],"asks":[["101.00","1","a1"]]})");
+    EXPECT_TRUE(handler.isBookReady("BTC-USD"));
+    EXPECT_EQ(book->getOrderCount(), 4u);
+
+    // A checkpoint for the other book model is ignored
+    CoinbaseHandler levels(BookMode::LEVELS);
+    levels.enableCheckpoints(".", std::chrono::seconds(0));
+    levels.subscribe("BTC-USD");
+    EXPECT_EQ(levels.getLevelBook("BTC-USD")->getBidLevelCount(), 0u);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "analytics/book_metrics.h"
+#include "orderbook/order_book.h"
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+
+using namespace clunk;
+
+namespace {
+
+// Side with `n` levels one tick apart from `best`, with random sizes
+DepthSide makeSide(size_t n, Price best, Price step, std::mt19937_64& rng) {
+    std::uniform_int_distribution<Quantity> size_dist(1, 5000000000);
+    DepthSide side;
+    for (size_t i = 0; i < n; ++i) {
+        side.push(best + static_cast<Price>(i) * step, size_dist(rng));
+    }
+    return side;
+}
+
+} // namespace
+
+// Test that the dispatched kernels agree with the scalar reference across
+// lengths that exercise both the vector body and the scalar tail
+TEST(BookMetricsTests, KernelsMatchScalar) {
+    const MetricsKernels& scalar = scalarMetricsKernels();
+    const MetricsKernels& fast = metricsKernels();
+    std::mt19937_64 rng(11);
+
+    for (size_t n : {0, 1, 3, 4, 7, 8, 9, 31, 64, 1000, 4099}) {
+        DepthSide side = makeSide(n, 6500000, -1, rng);
+        const Price* prices = side.prices.data();
+        const Quantity* sizes = side.sizes.data();
+
+        EXPECT_EQ(fast.sumSizes(sizes, n), scalar.sumSizes(sizes, n)) << fast.name << " n=" << n;
+
+        double expected = scalar.sumNotional(prices, sizes, n);
+        EXPECT_NEAR(fast.sumNotional(prices, sizes, n), expected, std::abs(expected) * 1e-12);
+
+        Price threshold = 6500000 - static_cast<Price>(n / 3);
+        EXPECT_EQ(fast.sumSizesAtOrAbove(prices, sizes, n, threshold),
+                  scalar.sumSizesAtOrAbove(prices, sizes, n, threshold));
+        EXPECT_EQ(fast.sumSizesAtOrBelow(prices, sizes, n, threshold),
+                  scalar.sumSizesAtOrBelow(prices, sizes, n, threshold));
+
+        Quantity total = scalar.sumSizes(sizes, n);
+        for (Quantity target : {Quantity(0), total / 7, total / 2, total, total + 1}) {
+            EXPECT_EQ(fast.walkToVolume(sizes, n, target), scalar.walkToVolume(sizes, n, target))
+                << fast.name << " n=" << n << " target=" << target;
+        }
+    }
+}
+
+// Test the metrics on a small hand-checked book
+TEST(BookMetricsTests, ComputesMetrics) {
+    DepthSnapshot snapshot;
+    snapshot.bids.push(10000, 10);
+    snapshot.bids.push(9960, 20);   // Inside 0.5% of 10000 (>= 9950)
+    snapshot.bids.push(9950, 30);   // Exactly on the band edge
+    snapshot.bids.push(9900, 40);
+    snapshot.asks.push(10010, 5);
+    snapshot.asks.push(10060, 15);  // Inside 0.5% of 10010 (<= 10060.05)
+    snapshot.asks.push(10100, 80);
+
+    BookMetrics metrics = computeBookMetrics(snapshot);
+
+    EXPECT_EQ(metrics.bid_volume, 100);
+    EXPECT_EQ(metrics.ask_volume, 100);
+    EXPECT_EQ(metrics.bid_band_depth, 60);
+    EXPECT_EQ(metrics.ask_band_depth, 20);
+    EXPECT_DOUBLE_EQ(metrics.imbalance, 1.0);
+    EXPECT_DOUBLE_EQ(metrics.pressure, 0.0);
+    EXPECT_DOUBLE_EQ(metrics.vwap_bid, (10000.0 * 10 + 9960.0 * 20 + 9950.0 * 30 + 9900.0 * 40) / 100);
+    EXPECT_DOUBLE_EQ(metrics.spread_bps, 10.0 * 20000.0 / 20010.0);
+
+    // 1% of 200 lots is 2: the first ask level covers it; 10% (20 lots)
+    // reaches the second level on both sides
+    EXPECT_EQ(metrics.impact_size, 2);
+    EXPECT_EQ(metrics.buy_impact_price, 10010);
+    EXPECT_DOUBLE_EQ(metrics.buy_impact_pct, 0.0);
+
+    BookMetrics wide = computeBookMetrics(snapshot, 5, 100);
+    EXPECT_EQ(wide.buy_impact_price, 10060);
+    EXPECT_EQ(wide.sell_impact_price, 9960);
+
+    // The scalar kernels give the same answer
+    BookMetrics scalar = computeBookMetrics(snapshot, 5, 100, scalarMetricsKernels());
+    EXPECT_EQ(scalar.bid_band_depth, wide.bid_band_depth);
+    EXPECT_EQ(scalar.buy_impact_price, wide.buy_impact_price);
+}
+
+// Test that a book captures both sides, best first, into aligned arrays
+TEST(BookMetricsTests, BookDepthSnapshot) {
+    OrderBook book("TEST", ProductScale(2, 8));
+    for (int i = 0; i < 20; ++i) {
+        book.addOrder(Order(OrderId::fromString("b" + std::to_string(i)), OrderSide::BUY,
+                            1000 - i, 10 + i, std::chrono::nanoseconds(i)));
+        book.addOrder(Order(OrderId::fromString("a" + std::to_string(i)), OrderSide::SELL,
+                            1001 + i, 10 + i, std::chrono::nanoseconds(i)));
+    }
+
+    DepthSnapshot snapshot;
+    book.getDepthSnapshot(5, snapshot);
+
+    ASSERT_EQ(snapshot.bids.size(), 5);
+    ASSERT_EQ(snapshot.asks.size(), 5);
+    EXPECT_EQ(snapshot.bids.prices[0], 1000);
+    EXPECT_EQ(snapshot.bids.prices[4], 996);
+    EXPECT_EQ(snapshot.asks.prices[0], 1001);
+    EXPECT_EQ(snapshot.asks.sizes[4], 14);
+    EXPECT_EQ(snapshot.sequence, book.getTopOfBook().sequence);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(snapshot.bids.prices.data()) % 64, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(snapshot.asks.sizes.data()) % 64, 0);
+
+    // A deeper capture into the same snapshot replaces the old contents
+    book.getDepthSnapshot(100, snapshot);
+    EXPECT_EQ(snapshot.bids.size(), 20);
+    EXPECT_EQ(snapshot.asks.size(), 20);
+}
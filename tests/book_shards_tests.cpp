@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "feed_handlers/book_shards.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+using namespace clunk;
+
+namespace {
+
+struct TestSync {
+    std::atomic<bool> ready{false};
+};
+
+struct TestBooks {
+    int node = 0;
+    std::shared_ptr<TestSync> sync;
+};
+
+struct TestShard {
+    std::unordered_map<std::string, TestBooks> books;
+    std::mutex mutex;
+    StageLatency latency;
+};
+
+} // namespace
+
+// Test that books are created once per symbol, found, and dropped
+TEST(BookShardsTests, AddsFindsAndRemoves) {
+    BookShards<TestShard> shards;
+    auto create = [](TestBooks& books, int node) {
+        books.node = node;
+        books.sync = std::make_shared<TestSync>();
+    };
+
+    EXPECT_TRUE(shards.add("BTC-USD", create));
+    EXPECT_FALSE(shards.add("BTC-USD", create));
+
+    TestBooks books;
+    ASSERT_TRUE(shards.find("BTC-USD", books));
+    EXPECT_EQ(books.node, -1);
+    EXPECT_FALSE(shards.isReady("BTC-USD"));
+    EXPECT_FALSE(shards.find("ETH-USD", books));
+
+    shards.remove("BTC-USD");
+    EXPECT_FALSE(shards.find("BTC-USD", books));
+    EXPECT_EQ(shards.size(), 1u);
+}
+
+// Test that symbols go to the shards their workers own once sharded
+TEST(BookShardsTests, ShardsBySymbol) {
+    BookShards<TestShard> shards;
+    shards.enableSharding(2, 16, [](TestShard&, std::string_view, const MessageTiming&) {}, {}, false);
+    ASSERT_EQ(shards.size(), 2u);
+
+    auto create = [](TestBooks& books, int) { books.sync = std::make_shared<TestSync>(); };
+    shards.add("BTC-USD", create);
+    shards.add("ETH-USD", create);
+    EXPECT_NE(&shards.shardFor("BTC-USD"), &shards.shardFor("ETH-USD"));
+    EXPECT_EQ(shards.shardFor("BTC-USD").books.count("BTC-USD"), 1u);
+    EXPECT_EQ(shards.getStats().size(), 2u);
+}
+
+// Test that waiting returns once every symbol is marked ready
+TEST(BookShardsTests, WaitsForReady) {
+    BookShards<TestShard> shards;
+    shards.add("BTC-USD", [](TestBooks& books, int) { books.sync = std::make_shared<TestSync>(); });
+    TestBooks books;
+    ASSERT_TRUE(shards.find("BTC-USD", books));
+
+    EXPECT_FALSE(shards.waitReady({"BTC-USD"}, std::chrono::milliseconds(0)));
+    EXPECT_FALSE(shards.waitReady({"ETH-USD"}, std::chrono::milliseconds(0)));
+
+    std::thread feed([&shards, &books]() { shards.markReady(books.sync->ready); });
+    EXPECT_TRUE(shards.waitReady({"BTC-USD"}, std::chrono::seconds(10)));
+    feed.join();
+    EXPECT_TRUE(shards.isReady("BTC-USD"));
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include "orderbook/book_subscription.h"
+#include "orderbook/level_book.h"
+#include "orderbook/order_book.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+// Drain a subscription into a vector
+std::vector<LevelDelta> drain(BookSubscription& subscription) {
+    std::vector<LevelDelta> deltas;
+    subscription.poll([&deltas](const LevelDelta& delta) { deltas.push_back(delta); });
+    return deltas;
+}
+
+Order makeOrder(const char* id, OrderSide side, Price price, Quantity size) {
+    return Order(OrderId::fromString(id), side, price, size, std::chrono::nanoseconds(0));
+}
+
+} // namespace
+
+// Test that pending changes to one price collapse into the latest one
+TEST(BookSubscriptionTests, CoalescesChangesToOnePrice) {
+    LevelBook book("TEST", ProductScale(2, 8));
+    auto subscription = book.subscribe();
+
+    book.setLevel(OrderSide::BUY, 100, 1);
+    book.setLevel(OrderSide::SELL, 101, 4);
+    book.setLevel(OrderSide::BUY, 100, 2);
+    book.setLevel(OrderSide::BUY, 100, 3);
+
+    std::vector<LevelDelta> deltas = drain(*subscription);
+    ASSERT_EQ(deltas.size(), 2u);
+    EXPECT_EQ(deltas[0].side, OrderSide::BUY);
+    EXPECT_EQ(deltas[0].price, 100);
+    EXPECT_EQ(deltas[0].size, 3);
+    EXPECT_EQ(deltas[0].sequence, 4u);
+    EXPECT_EQ(deltas[1].side, OrderSide::SELL);
+    EXPECT_EQ(deltas[1].size, 4);
+    EXPECT_EQ(deltas[1].sequence, 2u);
+
+    // Once consumed, the next change is delivered again
+    book.setLevel(OrderSide::BUY, 100, 0);
+    deltas = drain(*subscription);
+    ASSERT_EQ(deltas.size(), 1u);
+    EXPECT_EQ(deltas[0].size, 0);
+    EXPECT_EQ(deltas[0].sequence, book.getTopOfBook().sequence);
+    EXPECT_FALSE(subscription->needsResync());
+}
+
+// Test that an order book reports aggregated level sizes to every subscriber
+TEST(BookSubscriptionTests, OrderBookPublishesLevelTotals) {
+    OrderBook book("TEST", ProductScale(2, 8));
+    auto strategy = book.subscribe();
+    auto risk = book.subscribe();
+
+    book.addOrder(makeOrder("a", OrderSide::BUY, 100, 2));
+    book.addOrder(makeOrder("b", OrderSide::BUY, 100, 3));
+    EXPECT_EQ(drain(*strategy).back().size, 5);
+
+    book.modifyOrder(OrderId::fromString("a"), 1);
+    book.removeOrder(OrderId::fromString("b"));
+    std::vector<LevelDelta> deltas = drain(*strategy);
+    ASSERT_EQ(deltas.size(), 1u);
+    EXPECT_EQ(deltas[0].size, 1);
+
+    book.reduceOrder(OrderId::fromString("a"), 1);
+    deltas = drain(*strategy);
+    ASSERT_EQ(deltas.size(), 1u);
+    EXPECT_EQ(deltas[0].size, 0);
+
+    // The second subscriber was never polled: one coalesced delta
+    deltas = drain(*risk);
+    ASSERT_EQ(deltas.size(), 1u);
+    EXPECT_EQ(deltas[0].price, 100);
+    EXPECT_EQ(deltas[0].size, 0);
+    EXPECT_EQ(deltas[0].sequence, 5u);
+
+    // Unsubscribed consumers hear nothing more
+    EXPECT_TRUE(book.unsubscribe(risk));
+    EXPECT_FALSE(book.unsubscribe(risk));
+    book.addOrder(makeOrder("c", OrderSide::SELL, 105, 1));
+    EXPECT_TRUE(drain(*risk).empty());
+    EXPECT_EQ(drain(*strategy).size(), 1u);
+}
+
+// Test that snapshots and clears ask for a resync instead of per-level deltas
+TEST(BookSubscriptionTests, SnapshotRequestsResync) {
+    LadderOrderBook book("TEST", ProductScale(2, 8));
+    auto subscription = book.subscribe();
+
+    std::vector<LevelUpdate> levels = {
+        {OrderSide::BUY, 100, 1, OrderId()},
+        {OrderSide::BUY, 99, 2, OrderId()},
+        {OrderSide::SELL, 101, 3, OrderId()},
+    };
+    book.loadSnapshot(levels.data(), levels.size());
+
+    EXPECT_TRUE(drain(*subscription).empty());
+    EXPECT_TRUE(subscription->needsResync());
+    EXPECT_FALSE(subscription->needsResync());
+
+    DepthSnapshot depth;
+    book.getDepthSnapshot(10, depth);
+    EXPECT_EQ(depth.sequence, 1u);
+
+    LevelUpdate change{OrderSide::BUY, 99, 0, OrderId()};
+    book.applyUpdates(&change, 1);
+    std::vector<LevelDelta> deltas = drain(*subscription);
+    ASSERT_EQ(deltas.size(), 1u);
+    EXPECT_GT(deltas[0].sequence, depth.sequence);
+
+    book.clear();
+    EXPECT_TRUE(subscription->needsResync());
+}
+
+// Test that running out of slots drops changes and asks for a resync
+TEST(BookSubscriptionTests, OverflowRequestsResync) {
+    LevelBook book("TEST", ProductScale(2, 8));
+    auto subscription = book.subscribe(2);
+
+    book.setLevel(OrderSide::BUY, 100, 1);
+    book.setLevel(OrderSide::BUY, 99, 1);
+    book.setLevel(OrderSide::BUY, 100, 2);     // Coalesced, no new slot
+    book.setLevel(OrderSide::BUY, 98, 1);      // No slot left
+    EXPECT_EQ(subscription->getDroppedCount(), 1u);
+    EXPECT_TRUE(subscription->needsResync());
+    EXPECT_EQ(drain(*subscription).size(), 2u);
+
+    // Consumed slots are recycled for new prices
+    book.setLevel(OrderSide::BUY, 97, 1);
+    book.setLevel(OrderSide::BUY, 96, 1);
+    EXPECT_EQ(subscription->getDroppedCount(), 1u);
+    EXPECT_EQ(drain(*subscription).size(), 2u);
+}
+
+// Test that a consumer polling while the writer churns ends with the book's
+// levels
+TEST(BookSubscriptionTests, ConsumerTracksConcurrentWriter) {
+    LevelBook book("TEST", ProductScale(2, 8));
+    auto subscription = book.subscribe(64);
+
+    std::map<std::pair<int, Price>, Quantity> mirror;
+    auto apply = [&mirror](const LevelDelta& delta) {
+        auto key = std::make_pair(static_cast<int>(delta.side), delta.price);
+        if (delta.size == 0) {
+            mirror.erase(key);
+        } else {
+            mirror[key] = delta.size;
+        }
+    };
+    auto resync = [&]() {
+        DepthSnapshot depth;
+        book.getDepthSnapshot(1000, depth);
+        mirror.clear();
+        for (size_t i = 0; i < depth.bids.size(); ++i) {
+            mirror[{static_cast<int>(OrderSide::BUY), depth.bids.prices[i]}] = depth.bids.sizes[i];
+        }
+        for (size_t i = 0; i < depth.asks.size(); ++i) {
+            mirror[{static_cast<int>(OrderSide::SELL), depth.asks.prices[i]}] = depth.asks.sizes[i];
+        }
+        return depth.sequence;
+    };
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> offset(0, 40);
+        std::uniform_int_distribution<int> size(0, 5);
+        for (int i = 0; i < 50000; ++i) {
+            bool buy = i % 2 == 0;
+            book.setLevel(buy ? OrderSide::BUY : OrderSide::SELL,
+                          buy ? 1000 - offset(rng) : 1001 + offset(rng), size(rng));
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t synced = 0;
+    auto consume = [&]() {
+        if (subscription->needsResync()) {
+            synced = resync();
+        }
+        subscription->poll([&](const LevelDelta& delta) {
+            if (delta.sequence > synced) {
+                apply(delta);
+            }
+        });
+    };
+    while (!done.load(std::memory_order_acquire)) {
+        consume();
+    }
+    writer.join();
+    consume();
+
+    std::map<std::pair<int, Price>, Quantity> expected;
+    for (const auto& [price, size] : book.getBidLevels(1000)) {
+        expected[{static_cast<int>(OrderSide::BUY), price}] = size;
+    }
+    for (const auto& [price, size] : book.getAskLevels(1000)) {
+        expected[{static_cast<int>(OrderSide::SELL), price}] = size;
+    }
+    EXPECT_EQ(mirror, expected);
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include "feed_handlers/capture_log.h"
+#include "feed_handlers/coinbase_handler.h"
+#include "feed_handlers/replay_feed_handler.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+// Capture file in the test's working directory, removed afterwards
+class TempCapture {
+public:
+    explicit TempCapture(const std::string& name) : path_(name + ".clunkcap") {}
+    ~TempCapture() { std::remove(path_.c_str()); }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+} // namespace
+
+// Test that records come back in order with their timestamps and sources
+TEST(CaptureLogTests, RoundTripsRecords) {
+    TempCapture file("round_trip");
+    {
+        CaptureWriter writer(file.path());
+        writer.append(100, 0, "first");
+        writer.append(250, 3, "");
+        writer.append(400, 1, R"({"type":"heartbeat"})");
+        EXPECT_EQ(writer.getRecordCount(), 3u);
+        EXPECT_EQ(writer.getByteCount(), kCaptureHeaderSize + 3 * kCaptureRecordHeaderSize + 25);
+    }
+
+    CaptureReader reader(file.path());
+    std::vector<CaptureRecord> records;
+    CaptureRecord record;
+    while (reader.next(record)) {
+        records.push_back(record);
+    }
+    EXPECT_FALSE(reader.truncated());
+
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0].receive_ns, 100u);
+    EXPECT_EQ(records[0].source, 0u);
+    EXPECT_EQ(records[0].payload, "first");
+    EXPECT_EQ(records[1].receive_ns, 250u);
+    EXPECT_EQ(records[1].source, 3u);
+    EXPECT_TRUE(records[1].payload.empty());
+    EXPECT_EQ(records[2].payload, R"({"type":"heartbeat"})");
+
+    // Rewinding starts over
+    reader.rewind();
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.payload, "first");
+}
+
+// Test that a record cut short ends the replay and is reported
+TEST(CaptureLogTests, StopsAtTruncatedRecord) {
+    TempCapture file("truncated");
+    {
+        CaptureWriter writer(file.path());
+        writer.append(1, 0, "complete");
+        writer.append(2, 0, "cut short");
+    }
+    {
+        // Drop the last three payload bytes
+        std::ifstream in(file.path(), std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::ofstream out(file.path(), std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 3));
+    }
+
+    CaptureReader reader(file.path());
+    CaptureRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.payload, "complete");
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_TRUE(reader.truncated());
+}
+
+// Test that files without the capture header are refused
+TEST(CaptureLogTests, RejectsOtherFiles) {
+    TempCapture file("not_a_capture");
+    {
+        std::ofstream out(file.path(), std::ios::binary);
+        out << "this is not a capture file";
+    }
+    EXPECT_THROW(CaptureReader reader(file.path()), std::runtime_error);
+    EXPECT_THROW(CaptureReader reader("missing.clunkcap"), std::runtime_error);
+}
+
+// Test that replaying a capture builds the same book the live feed would
+TEST(CaptureLogTests, ReplayBuildsBooks) {
+    TempCapture file("replay");
+    {
+        CaptureWriter writer(file.path());
+        writer.append(1000, 0, R"({"type":"subscriptions","channels":[]})");
+        writer.append(2000, 0,
+            R"({"type":"snapshot","product_id":"BTC-USD","bids":[["65000.00","1"],["64999.00","2"]],)"
+            R"("asks":[["65001.00","1.5"]]})");
+        writer.append(3000, 0,
+            R"({"type":"l2update","product_id":"BTC-USD","changes":[["buy","65000.50","0.25"]]})");
+        writer.append(4000, 0,
+            R"({"type":"l2update","product_id":"BTC-USD","changes":[["sell","65001.00","0"],)"
+            R"(["sell","65002.00","3"]]})");
+        writer.append(5000, 0,
+            R"({"type":"l2update","product_id":"ETH-USD","changes":[["buy","3000.00","1"]]})");
+    }
+
+    ReplayFeedHandler replay(file.path());
+    replay.subscribe("BTC-USD");
+    replay.connect();
+    replay.wait();
+
+    ReplayStats stats = replay.getStats();
+    EXPECT_TRUE(stats.finished);
+    EXPECT_FALSE(stats.truncated);
+    EXPECT_EQ(stats.messages, 5u);
+    EXPECT_FALSE(replay.isConnected());
+
+    std::shared_ptr<LevelBook> book = replay.getHandler().getLevelBook("BTC-USD");
+    ASSERT_NE(book, nullptr);
+    const ProductScale& scale = book->getScale();
+    TopOfBook top = book->getTopOfBook();
+    EXPECT_EQ(top.bid_price, scale.toPrice(65000.50));
+    EXPECT_EQ(top.bid_size, scale.toQuantity(0.25));
+    EXPECT_EQ(top.ask_price, scale.toPrice(65002.00));
+    EXPECT_EQ(top.ask_size, scale.toQuantity(3));
+    EXPECT_EQ(book->getBidLevelCount(), 3u);
+    EXPECT_EQ(book->getAskLevelCount(), 1u);
+
+    // Products that were not subscribed get no book
+    EXPECT_EQ(replay.getHandler().getLevelBook("ETH-USD"), nullptr);
+}
+
+// Test that only the copy applied from redundant connections is captured
+TEST(CaptureLogTests, CapturesOneCopyPerSequence) {
+    TempCapture file("redundant");
+    {
+        CoinbaseHandler handler(BookMode::ORDERS);
+        handler.enableConnectionPool(2, 2);
+        handler.enableCapture(file.path());
+        handler.subscribe("BTC-USD");
+
+        std::string open = R"({"type":"open","product_id":"BTC-USD","sequence":11,"order_id":"m1",)"
+                           R"("side":"buy","price":"100.00","remaining_size":"1"})";
+        std::string ticker = R"({"type":"ticker","product_id":"BTC-USD","sequence":11,"price":"100.00"})";
+        handler.injectMessage(open, 1);
+        handler.injectMessage(open, 0);
+        handler.injectMessage(ticker, 0);
+        handler.injectMessage(ticker, 1);
+        handler.injectMessage(R"({"type":"done","product_id":"BTC-USD","sequence":10,"order_id":"m0"})", 0);
+        EXPECT_EQ(handler.getCapturedCount(), 2u);
+        handler.disconnect();
+    }
+
+    CaptureReader reader(file.path());
+    CaptureRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.source, 1u);
+    EXPECT_NE(record.payload.find("\"open\""), std::string_view::npos);
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.source, 0u);
+    EXPECT_NE(record.payload.find("\"ticker\""), std::string_view::npos);
+    EXPECT_FALSE(reader.next(record));
+}
+
+// Test that copies racing in on two connections' threads are captured once
+// per sequence
+TEST(CaptureLogTests, CapturesOneCopyAcrossThreads) {
+    TempCapture file("racing");
+    CoinbaseHandler handler(BookMode::ORDERS);
+    handler.enableConnectionPool(2, 2);
+    handler.enableCapture(file.path());
+    handler.subscribe("BTC-USD");
+
+    constexpr uint64_t kMessages = 2000;
+    std::vector<std::string> messages;
+    for (uint64_t sequence = 1; sequence <= kMessages; ++sequence) {
+        messages.push_back(R"({"type":"done","product_id":"BTC-USD","sequence":)" + std::to_string(sequence) +
+                           R"(,"order_id":"m0"})");
+    }
+    auto feed = [&handler, &messages](size_t connection) {
+        for (const std::string& message : messages) {
+            handler.injectMessage(message, connection);
+        }
+    };
+    std::thread first(feed, 0);
+    std::thread second(feed, 1);
+    first.join();
+    second.join();
+
+    EXPECT_EQ(handler.getCapturedCount(), kMessages);
+    handler.disconnect();
+}
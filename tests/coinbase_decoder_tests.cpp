@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "feed_handlers/coinbase_decoder.h"
+#include "orderbook/fixed_point.h"
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+// l2update: type dispatch and the raw changes array
+TEST(CoinbaseDecoderTest, DecodesL2Update) {
+    std::string text = R"({"type":"l2update","product_id":"BTC-USD","changes":[["buy","65000.01","0.5"],)"
+                       R"(["sell","65001.00","0"]],"time":"2024-01-01T00:00:00.000000Z"})";
+
+    CoinbaseMessage m;
+    ASSERT_TRUE(decodeCoinbaseMessage(text, m));
+    EXPECT_EQ(m.type, CoinbaseMessageType::L2UPDATE);
+    EXPECT_EQ(m.product_id, "BTC-USD");
+
+    std::vector<Price> prices;
+    std::vector<OrderSide> sides;
+    ASSERT_TRUE(forEachRow(m.changes, [&](const JsonRow& change) {
+        Price price = 0;
+        ASSERT_TRUE(parseFixed(change[1], 2, price));
+        prices.push_back(price);
+        sides.push_back(coinbaseSide(change[0]));
+    }));
+    EXPECT_EQ(prices, (std::vector<Price>{6500001, 6500100}));
+    EXPECT_EQ(sides, (std::vector<OrderSide>{OrderSide::BUY, OrderSide::SELL}));
+}
+
+// "type" may come after the fields; absent and null fields stay absent
+TEST(CoinbaseDecoderTest, DecodesL3MessagesInAnyKeyOrder) {
+    std::string text = R"({"order_id":"d50ec984-77a8-460a-b958-66f114b0de9b","price":null,)"
+                       R"("side":"sell","size":"1.25","product_id":"ETH-USD","sequence":10,"type":"received"})";
+
+    CoinbaseMessage m;
+    ASSERT_TRUE(decodeCoinbaseMessage(text, m));
+    EXPECT_EQ(m.type, CoinbaseMessageType::RECEIVED);
+    EXPECT_EQ(m.order_id, "d50ec984-77a8-460a-b958-66f114b0de9b");
+    EXPECT_EQ(m.side, "sell");
+    EXPECT_EQ(m.order_side, OrderSide::SELL);
+    EXPECT_EQ(m.size, "1.25");
+    EXPECT_EQ(m.sequence, "10");
+    EXPECT_FALSE(CoinbaseMessage::has(m.price));
+    EXPECT_FALSE(CoinbaseMessage::has(m.new_size));
+
+    ASSERT_TRUE(decodeCoinbaseMessage(
+        R"({"type":"match","maker_order_id":"ac928c66-ca53-498f-9c13-a110027a60e8","size":"0.1","side":"buy"})", m));
+    EXPECT_EQ(m.type, CoinbaseMessageType::MATCH);
+    EXPECT_EQ(m.order_side, OrderSide::BUY);
+    EXPECT_EQ(m.maker_order_id, "ac928c66-ca53-498f-9c13-a110027a60e8");
+    EXPECT_FALSE(CoinbaseMessage::has(m.order_id));
+}
+
+// Ticker decimals may be strings or bare numbers
+TEST(CoinbaseDecoderTest, DecodesTickerAndSnapshot) {
+    CoinbaseMessage m;
+    ASSERT_TRUE(decodeCoinbaseMessage(
+        R"({"type":"ticker","product_id":"BTC-USD","best_bid":"65000.00","best_bid_size":0.25,)"
+        R"("best_ask":"65000.01","best_ask_size":"1.5","price":"65000.01","last_size":"0.002"})", m));
+    EXPECT_EQ(m.type, CoinbaseMessageType::TICKER);
+    EXPECT_EQ(m.best_bid, "65000.00");
+    EXPECT_EQ(m.best_bid_size, "0.25");
+    EXPECT_EQ(m.best_ask_size, "1.5");
+    EXPECT_EQ(m.last_size, "0.002");
+
+    ASSERT_TRUE(decodeCoinbaseMessage(
+        R"({"type":"snapshot","product_id":"BTC-USD","bids":[["65000.00","1"],["64999.99","2"]],"asks":[]})", m));
+    EXPECT_EQ(m.type, CoinbaseMessageType::SNAPSHOT);
+    EXPECT_EQ(countElements(m.bids), 2u);
+    EXPECT_EQ(countElements(m.asks), 0u);
+}
+
+// Malformed text and non-objects are rejected; unknown types decode
+TEST(CoinbaseDecoderTest, RejectsMalformedMessages) {
+    CoinbaseMessage m;
+    EXPECT_FALSE(decodeCoinbaseMessage(R"({"type":"l2update","changes":[["buy","1","1"]})", m));
+    EXPECT_FALSE(decodeCoinbaseMessage(R"(["type","ticker"])", m));
+    EXPECT_FALSE(decodeCoinbaseMessage(R"({"type":"ticker"} trailing)", m));
+    EXPECT_FALSE(decodeCoinbaseMessage("", m));
+
+    ASSERT_TRUE(decodeCoinbaseMessage(R"({"type":"status","products":[]})", m));
+    EXPECT_EQ(m.type, CoinbaseMessageType::UNKNOWN);
+    EXPECT_EQ(m.type_name, "status");
+}
+
+// Routing only needs the product ID, found without decoding the message
+TEST(CoinbaseDecoderTest, PeeksProductId) {
+    EXPECT_EQ(peekProductId(R"({"type":"l2update","product_id":"BTC-USD","changes":[]})"), "BTC-USD");
+    EXPECT_EQ(peekProductId(R"({"type":"ticker", "product_id" : "ETH-USD"})"), "ETH-USD");
+    EXPECT_EQ(peekProductId(R"({"type":"subscriptions","channels":[{"product_ids":["BTC-USD"]}]})"), "");
+    EXPECT_EQ(peekProductId(R"({"product_id":null})"), "");
+    EXPECT_EQ(peekProductId(R"({"product_id":"BTC)"), "");
+}
+
+// A REST level-3 book becomes a snapshot message for its product
+TEST(CoinbaseDecoderTest, WrapsRestSnapshot) {
+    std::string text;
+    ASSERT_TRUE(coinbaseRestSnapshot(
+        "BTC-USD", R"( {"bids":[["65000.00","1","b1"]],"asks":[["65000.01","2","a1"]],"sequence":3051})", text));
+    EXPECT_EQ(peekProductId(text), "BTC-USD");
+
+    CoinbaseMessage m;
+    ASSERT_TRUE(decodeCoinbaseMessage(text, m));
+    EXPECT_EQ(m.type, CoinbaseMessageType::SNAPSHOT);
+    EXPECT_EQ(m.sequence, "3051");
+    EXPECT_EQ(countElements(m.bids), 1u);
+    EXPECT_EQ(countElements(m.asks), 1u);
+
+    ASSERT_TRUE(coinbaseRestSnapshot("BTC-USD", "{}", text));
+    EXPECT_TRUE(decodeCoinbaseMessage(text, m));
+    EXPECT_FALSE(coinbaseRestSnapshot("BTC-USD", R"({"message":)", text) && decodeCoinbaseMessage(text, m));
+    EXPECT_FALSE(coinbaseRestSnapshot("BTC-USD", "Not Found", text));
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "feed_handlers/coinbase_handler.h"
+#include "orderbook/level_book.h"
+#include "orderbook/order_book.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+const char* kSnapshot =
+    R"({"type":"snapshot","product_id":"BTC-USD","sequence":10,)"
+    R"("bids":[["100.00","2","m1"]],"asks":[["101.00","1","a1"]]})";
+
+// A full-channel message for BTC-USD, with `fields` after the common ones
+std::string fullMessage(const char* type, uint64_t sequence, const std::string& fields) {
+    return R"({"type":")" + std::string(type) + R"(","product_id":"BTC-USD","sequence":)" +
+           std::to_string(sequence) + "," + fields + "}";
+}
+
+} // namespace
+
+// Test that full-channel messages are held until a snapshot, and that
+// orders only join the book once open, with what they rest with
+TEST(CoinbaseHandlerTests, FullChannelBuildsOrderBook) {
+    CoinbaseHandler handler(BookMode::ORDERS);
+    handler.subscribe("BTC-USD");
+    std::shared_ptr<OrderBook> book = handler.getOrderBook("BTC-USD");
+    ProductScale scale = book->getScale();
+
+    handler.injectMessage(fullMessage("open", 10, R"("order_id":"m1","side":"buy","price":"100.00","remaining_size":"2")"));
+    handler.injectMessage(fullMessage("received", 11, R"("order_id":"m2","side":"buy","price":"99.00","size":"3")"));
+    handler.injectMessage(fullMessage("open", 12, R"("order_id":"m2","side":"buy","price":"99.00","remaining_size":"1.5")"));
+    EXPECT_FALSE(handler.isBookReady("BTC-USD"));
+    EXPECT_EQ(book->getOrderCount(), 0u);
+
+    // The snapshot replays what it does not already reflect
+    handler.injectMessage(kSnapshot);
+    EXPECT_TRUE(handler.isBookReady("BTC-USD"));
+    EXPECT_EQ(book->getOrderCount(), 3u);
+    EXPECT_EQ(book->getLevelSize(OrderSide::BUY, scale.toPrice(99.00)), scale.toQuantity(1.5));
+
+    // A received order that never rests stays off the book
+    handler.injectMessage(fullMessage("received", 13, R"("order_id":"t1","side":"sell","size":"1")"));
+    handler.injectMessage(fullMessage("done", 14, R"("order_id":"t1","side":"sell","reason":"filled")"));
+    EXPECT_EQ(book->getOrderCount(), 3u);
+
+    // A jump in sequence numbers holds updates until the next snapshot
+    handler.injectMessage(fullMessage("done", 16, R"("order_id":"m2","side":"buy","reason":"canceled")"));
+    EXPECT_EQ(book->getOrderCount(), 3u);
+    handler.injectMessage(
+        R"({"type":"snapshot","product_id":"BTC-USD","sequence":15,)"
+        R"("bids":[["100.00","2","m1"],["99.00","1.5","m2"]],"asks":[["101.00","1","a1"]]})");
+    EXPECT_EQ(book->getOrderCount(), 2u);
+    EXPECT_EQ(book->getLevelSize(OrderSide::BUY, scale.toPrice(99.00)), 0);
+}
+
+// Test that pooled products spread over the least loaded connections
+TEST(CoinbaseHandlerTests, PoolSpreadsProducts) {
+    CoinbaseHandler handler(BookMode::LEVELS);
+    handler.enableConnectionPool(3, 2);
+    EXPECT_EQ(handler.getConnectionCount(), 3u);
+
+    handler.subscribe("BTC-USD");
+    handler.subscribe("ETH-USD");
+    handler.subscribe("SOL-USD");
+    EXPECT_EQ(handler.getRoute("BTC-USD"), (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(handler.getRoute("ETH-USD"), (std::vector<size_t>{2, 0}));
+    EXPECT_EQ(handler.getRoute("SOL-USD"), (std::vector<size_t>{1, 2}));
+
+    handler.unsubscribe("ETH-USD");
+    EXPECT_TRUE(handler.getRoute("ETH-USD").empty());
+    handler.subscribe("ETH-USD");
+    EXPECT_EQ(handler.getRoute("ETH-USD"), (std::vector<size_t>{0, 1}));
+}
+
+// Test that unsequenced copies only count from the primary connection
+TEST(CoinbaseHandlerTests, UnsequencedCopiesFromPrimary) {
+    CoinbaseHandler handler(BookMode::LEVELS);
+    handler.enableConnectionPool(2, 2);
+    handler.subscribe("BTC-USD");
+    std::shared_ptr<LevelBook> book = handler.getLevelBook("BTC-USD");
+    ProductScale scale = book->getScale();
+
+    // Nothing is connected, so the first connection of the route is primary
+    const char* snapshot =
+        R"({"type":"snapshot","product_id":"BTC-USD","bids":[["100.00","2"]],"asks":[["101.00","1"]]})";
+    handler.injectMessage(snapshot, 1);
+    EXPECT_FALSE(handler.isBookReady("BTC-USD"));
+    handler.injectMessage(snapshot, 0);
+    EXPECT_TRUE(handler.isBookReady("BTC-USD"));
+
+    const char* update = R"({"type":"l2update","product_id":"BTC-USD","changes":[["buy","100.00","5"]]})";
+    handler.injectMessage(update, 1);
+    EXPECT_EQ(book->getLevelSize(OrderSide::BUY, scale.toPrice(100.00)), scale.toQuantity(2));
+    handler.injectMessage(update, 0);
+    EXPECT_EQ(book->getLevelSize(OrderSide::BUY, scale.toPrice(100.00)), scale.toQuantity(5));
+}
+
+// Test that a sequenced message is applied once, from whichever copy is
+// first, and that a gap on one connection is filled from another
+TEST(CoinbaseHandlerTests, SequencedCopiesAppliedOnce) {
+    CoinbaseHandler handler(BookMode::ORDERS);
+    handler.enableConnectionPool(2, 2);
+    handler.subscribe("BTC-USD");
+    std::shared_ptr<OrderBook> book = handler.getOrderBook("BTC-USD");
+    ProductScale scale = book->getScale();
+    handler.injectMessage(kSnapshot, 0);
+    ASSERT_TRUE(handler.isBookReady("BTC-USD"));
+
+    std::string match = fullMessage("match", 11, R"("maker_order_id":"m1","side":"buy","price":"100.00","size":"0.5")");
+    handler.injectMessage(match, 1);
+    handler.injectMessage(match, 0);
+    EXPECT_EQ(book->getLevelSize(OrderSide::BUY, scale.toPrice(100.00)), scale.toQuantity(1.5));
+
+    // Connection 0 misses 12; 13 still applies once 1 delivers 12
+    handler.injectMessage(fullMessage("open", 12, R"("order_id":"m2","side":"buy","price":"99.00","remaining_size":"1")"), 1);
+    handler.injectMessage(fullMessage("open", 13, R"("order_id":"m3","side":"buy","price":"99.00","remaining_size":"1")"), 0);
+    handler.injectMessage(fullMessage("open", 13, R"("order_id":"m3","side":"buy","price":"99.00","remaining_size":"1")"), 1);
+    EXPECT_EQ(book->getOrderCount(), 4u);
+    EXPECT_EQ(book->getLevelSize(OrderSide::BUY, scale.toPrice(99.00)), scale.toQuantity(2));
+    EXPECT_TRUE(handler.isBookReady("BTC-USD"));
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include "network/connection_routes.h"
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+// Test that products go to the least loaded connection, one copy per
+// connection after it
+TEST(ConnectionRoutesTests, AssignsLeastLoaded) {
+    ConnectionRoutes routes;
+    routes.reset(3, 2);
+
+    EXPECT_EQ(routes.assign("A"), (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(routes.assign("B"), (std::vector<size_t>{2, 0}));
+    EXPECT_EQ(routes.assign("C"), (std::vector<size_t>{1, 2}));
+    EXPECT_EQ(routes.assign("A"), (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(routes.getLoad(0), 2u);
+    EXPECT_EQ(routes.getLoad(1), 2u);
+    EXPECT_EQ(routes.getLoad(2), 2u);
+    EXPECT_EQ(routes.symbolsOn(2).size(), 2u);
+
+    // Released load is handed out first
+    routes.release("B");
+    EXPECT_EQ(routes.find("B"), nullptr);
+    EXPECT_EQ(routes.getLoad(0), 1u);
+    EXPECT_EQ(routes.assign("D"), (std::vector<size_t>{0, 1}));
+
+    // Redundancy is clamped to the pool
+    routes.reset(2, 5);
+    EXPECT_EQ(routes.getRedundancy(), 2u);
+    EXPECT_EQ(routes.find("A"), nullptr);
+}
+
+// Test that the primary is the first live connection of a route
+TEST(ConnectionRoutesTests, PrimaryFailsOver) {
+    std::vector<bool> up = {true, true, true};
+    auto isUp = [&up](size_t connection) { return static_cast<bool>(up[connection]); };
+    std::vector<size_t> route = {1, 2};
+
+    EXPECT_EQ(ConnectionRoutes::primary(route, isUp), 1u);
+    up[1] = false;
+    EXPECT_EQ(ConnectionRoutes::primary(route, isUp), 2u);
+    up[1] = true;
+    EXPECT_EQ(ConnectionRoutes::primary(route, isUp), 1u);
+
+    // With every copy down, the first one stays primary
+    up = {false, false, false};
+    EXPECT_EQ(ConnectionRoutes::primary(route, isUp), 1u);
+}
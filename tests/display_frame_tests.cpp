@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "visualization/display_frame.h"
+#include "visualization/terminal_writer.h"
+#include <cstdio>
+#include <string>
+
+using namespace clunk;
+
+namespace {
+
+// Build a frame from `rows` and return its diff
+std::string render(DisplayFrame& frame, std::initializer_list<const char*> rows) {
+    frame.begin();
+    for (const char* row : rows) {
+        frame.addRow() += row;
+    }
+    std::string out;
+    frame.diff(out);
+    return out;
+}
+
+} // namespace
+
+// Test that only changed rows are redrawn after the first frame
+TEST(DisplayFrameTests, DiffsAgainstShownFrame) {
+    DisplayFrame frame;
+    EXPECT_EQ(render(frame, {"a", "b"}), "\033[1;1Ha\033[K\033[2;1Hb\033[K\033[3;1H");
+
+    // Nothing changed, nothing written
+    EXPECT_EQ(render(frame, {"a", "b"}), "");
+
+    EXPECT_EQ(render(frame, {"a", "c", "d"}), "\033[2;1Hc\033[K\033[3;1Hd\033[K\033[4;1H");
+
+    // Rows the new frame no longer has are blanked
+    EXPECT_EQ(render(frame, {"a"}), "\033[2;1H\033[K\033[3;1H\033[K\033[2;1H");
+    EXPECT_EQ(frame.size(), 0u);
+}
+
+// Test that an invalidated frame is redrawn in full
+TEST(DisplayFrameTests, InvalidateRedrawsEveryRow) {
+    DisplayFrame frame;
+    render(frame, {"a", "b"});
+
+    frame.invalidate();
+    std::string out;
+    frame.begin();
+    frame.addRow() += "a";
+    frame.addRow() += "b";
+    EXPECT_EQ(frame.size(), 2u);
+    EXPECT_EQ(frame.diff(out), 2u);
+    EXPECT_EQ(out, "\033[1;1Ha\033[K\033[2;1Hb\033[K\033[3;1H");
+}
+
+// Test that the writer delivers submitted bytes in order and drops a
+// backlog beyond its limit
+TEST(TerminalWriterTests, WritesAndDropsBacklog) {
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    {
+        TerminalWriter writer(file, 8);
+        EXPECT_TRUE(writer.submit("abc"));
+        EXPECT_TRUE(writer.submit("def"));
+        writer.flush();
+
+        // Larger than the limit on its own: dropped whatever the timing
+        EXPECT_FALSE(writer.submit("0123456789"));
+        EXPECT_GE(writer.getDroppedBytes(), 10u);
+        EXPECT_TRUE(writer.submit("gh"));
+    }
+
+    std::rewind(file);
+    char buffer[32] = {};
+    size_t read = std::fread(buffer, 1, sizeof(buffer) - 1, file);
+    std::fclose(file);
+    EXPECT_EQ(std::string(buffer, read), "abcdefgh");
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include "orderbook/fixed_point.h"
+#include <string>
+
+using namespace clunk;
+
+// Test parsing feed decimal strings into scaled integers
+TEST(FixedPointTests, ParseFixed) {
+    int64_t value = 0;
+
+    EXPECT_TRUE(parseFixed("65000.01", 2, value));
+    EXPECT_EQ(value, 6500001);
+
+    EXPECT_TRUE(parseFixed("0.00100000", 8, value));
+    EXPECT_EQ(value, 100000);
+
+    EXPECT_TRUE(parseFixed("42", 2, value));
+    EXPECT_EQ(value, 4200);
+
+    EXPECT_TRUE(parseFixed("-1.5", 1, value));
+    EXPECT_EQ(value, -15);
+
+    // Digits past the scale round half away from zero
+    EXPECT_TRUE(parseFixed("1.005", 2, value));
+    EXPECT_EQ(value, 101);
+    EXPECT_TRUE(parseFixed("1.0049", 2, value));
+    EXPECT_EQ(value, 100);
+
+    EXPECT_FALSE(parseFixed("", 2, value));
+    EXPECT_FALSE(parseFixed(".", 2, value));
+    EXPECT_FALSE(parseFixed("1.2.3", 2, value));
+    EXPECT_FALSE(parseFixed("1e5", 2, value));
+    EXPECT_FALSE(parseFixed("99999999999999999999", 0, value));
+}
+
+// Test exact decimal rendering and per-product scales
+TEST(FixedPointTests, FormatAndScale) {
+    EXPECT_EQ(formatFixed(6500001, 2), "65000.01");
+    EXPECT_EQ(formatFixed(100000, 8), "0.00100000");
+    EXPECT_EQ(formatFixed(-15, 1), "-1.5");
+    EXPECT_EQ(formatFixed(42, 0), "42");
+
+    // Appending keeps what the buffer already holds
+    std::string row = "bid ";
+    appendFixed(row, -5, 3);
+    EXPECT_EQ(row, "bid -0.005");
+
+    ProductScale btc = ProductScale::forSymbol("BTC-USD");
+    EXPECT_EQ(btc.price_decimals, 2);
+    EXPECT_EQ(btc.toPrice(65000.01), 6500001);
+    EXPECT_DOUBLE_EQ(btc.toDouble(6500001), 65000.01);
+    EXPECT_EQ(btc.formatSize(btc.toQuantity(0.5)), "0.50000000");
+
+    // Unknown products fall back to a fine scale rather than truncating
+    EXPECT_EQ(ProductScale::forSymbol("FOO-BAR").price_decimals, 8);
+}
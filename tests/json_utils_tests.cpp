@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "utils/json_utils.h"
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+// Keys and values of a flat object come back as views into the text
+TEST(JsonScannerTest, WalksFlatObject) {
+    std::string text = R"( { "type" : "ticker", "price": "65000.01", "volume": 12.5, "ok": true } )";
+    JsonScanner scanner(text);
+    ASSERT_TRUE(scanner.beginObject());
+
+    std::string_view key, value;
+    ASSERT_TRUE(scanner.nextKey(key));
+    EXPECT_EQ(key, "type");
+    ASSERT_TRUE(scanner.readString(value));
+    EXPECT_EQ(value, "ticker");
+    EXPECT_GE(value.data(), text.data());
+    EXPECT_LT(value.data(), text.data() + text.size());
+
+    ASSERT_TRUE(scanner.nextKey(key));
+    EXPECT_EQ(key, "price");
+    ASSERT_TRUE(scanner.readScalar(value));
+    EXPECT_EQ(value, "65000.01");
+
+    ASSERT_TRUE(scanner.nextKey(key));
+    EXPECT_EQ(key, "volume");
+    ASSERT_TRUE(scanner.readScalar(value));
+    EXPECT_EQ(value, "12.5");
+
+    ASSERT_TRUE(scanner.nextKey(key));
+    EXPECT_EQ(scanner.peek(), JsonType::LITERAL);
+    ASSERT_TRUE(scanner.skipValue());
+
+    EXPECT_FALSE(scanner.nextKey(key));
+    EXPECT_FALSE(scanner.failed());
+    EXPECT_TRUE(scanner.atEnd());
+}
+
+// Nested values are skipped or captured raw, including empty containers and
+// brackets inside strings
+TEST(JsonScannerTest, SkipsAndCapturesNestedValues) {
+    std::string text = R"({"a":{},"b":[],"c":{"x":["]",{"y":null}]},"d":[[1,2],[3]],"e":"\"q\""})";
+    JsonScanner scanner(text);
+    ASSERT_TRUE(scanner.beginObject());
+
+    std::string_view key, value;
+    ASSERT_TRUE(scanner.nextKey(key));
+    ASSERT_TRUE(scanner.beginObject());
+    EXPECT_FALSE(scanner.nextKey(key));
+    ASSERT_TRUE(scanner.nextKey(key));
+    ASSERT_TRUE(scanner.beginArray());
+    EXPECT_FALSE(scanner.nextElement());
+    ASSERT_TRUE(scanner.nextKey(key));
+    ASSERT_TRUE(scanner.skipValue());
+    ASSERT_TRUE(scanner.nextKey(key));
+    EXPECT_EQ(key, "d");
+    ASSERT_TRUE(scanner.readRaw(value));
+    EXPECT_EQ(value, "[[1,2],[3]]");
+    ASSERT_TRUE(scanner.nextKey(key));
+    ASSERT_TRUE(scanner.readString(value));
+    EXPECT_EQ(value, R"(\"q\")");
+    EXPECT_FALSE(scanner.nextKey(key));
+    EXPECT_FALSE(scanner.failed());
+}
+
+// Malformed input latches the failure
+TEST(JsonScannerTest, RejectsMalformedInput) {
+    for (std::string text : {R"({"a" 1})", R"({"a":1,})", R"({"a":1 "b":2})", R"({"a":"x)",
+                             R"({"a":tru})", R"({"a":{"b":1})"}) {
+        JsonScanner scanner(text);
+        ASSERT_TRUE(scanner.beginObject()) << text;
+        std::string_view key;
+        while (scanner.nextKey(key) && scanner.skipValue()) {
+        }
+        EXPECT_TRUE(scanner.failed()) << text;
+    }
+
+    // Arrays walked element by element reject trailing commas
+    JsonScanner scanner("[1,]");
+    ASSERT_TRUE(scanner.beginArray());
+    ASSERT_TRUE(scanner.nextElement());
+    ASSERT_TRUE(scanner.skipValue());
+    EXPECT_FALSE(scanner.nextElement());
+    EXPECT_TRUE(scanner.failed());
+}
+
+// Rows of an array of arrays arrive as scalar views, extra fields ignored
+TEST(JsonScannerTest, ForEachRow) {
+    std::vector<std::vector<std::string>> rows;
+    bool ok = forEachRow(R"([["buy","65000.01","0.5"], ["sell", 65001, "1", "x", "y"], []])",
+                         [&](const JsonRow& row) {
+        rows.emplace_back();
+        for (size_t i = 0; i < row.size(); ++i) {
+            rows.back().emplace_back(row[i]);
+        }
+    });
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(rows.size(), 3u);
+    EXPECT_EQ(rows[0], (std::vector<std::string>{"buy", "65000.01", "0.5"}));
+    EXPECT_EQ(rows[1], (std::vector<std::string>{"sell", "65001", "1", "x"}));
+    EXPECT_TRUE(rows[2].empty());
+
+    EXPECT_FALSE(forEachRow(R"([["buy","1"],["sell")", [](const JsonRow&) {}));
+    EXPECT_FALSE(forEachRow(R"([{"a":1}])", [](const JsonRow&) {}));
+    EXPECT_EQ(countElements(R"([[1],[2,3],"x"])"), 3u);
+    EXPECT_EQ(countElements("[]"), 0u);
+}
+
+// Scalars are peeked as numbers or strings, without decoding the rest
+TEST(JsonScannerTest, PeeksScalar) {
+    EXPECT_EQ(peekScalar(R"({"type":"open","sequence": 1234,"price":"1.5"})", "\"sequence\""), "1234");
+    EXPECT_EQ(peekScalar(R"({"type":"open","sequence":"77"})", "\"sequence\""), "77");
+    EXPECT_EQ(peekScalar(R"({"sequence":null})", "\"sequence\""), "");
+    EXPECT_EQ(peekScalar(R"({"type":"l2update"})", "\"sequence\""), "");
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "feed_handlers/kraken_decoder.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+// Book snapshot: bids then asks, whatever order the keys come in
+TEST(KrakenDecoderTest, DecodesBookSnapshot) {
+    std::string text = R"({"channel":"book","type":"snapshot","data":[{"symbol":"BTC/USD",)"
+                       R"("asks":[{"price":45285.2,"qty":0.001}],)"
+                       R"("bids":[{"price":45283.5,"qty":0.10000000},{"price":45283.4,"qty":1.5}],)"
+                       R"("checksum":2439117997}]})";
+
+    KrakenDecoder decoder;
+    BookEvents events;
+    ASSERT_TRUE(decoder.decode(text, events));
+    ASSERT_EQ(events.size(), 1u);
+    const BookEvent& event = events[0];
+    EXPECT_EQ(event.type, BookEventType::SNAPSHOT);
+    EXPECT_EQ(event.symbol, "BTC/USD");
+    EXPECT_EQ(event.sequence, 0u);
+    ASSERT_EQ(event.levels.size(), 3u);
+    EXPECT_EQ(event.levels[0].side, OrderSide::BUY);
+    EXPECT_EQ(event.levels[0].price, "45283.5");
+    EXPECT_EQ(event.levels[0].size, "0.10000000");
+    EXPECT_EQ(event.levels[1].price, "45283.4");
+    EXPECT_EQ(event.levels[2].side, OrderSide::SELL);
+    EXPECT_EQ(event.levels[2].size, "0.001");
+    EXPECT_EQ(decoder.peekSymbol(text), "BTC/USD");
+}
+
+// Updates and trades; the reused events keep their level storage
+TEST(KrakenDecoderTest, DecodesUpdatesAndTrades) {
+    KrakenDecoder decoder;
+    BookEvents events;
+    ASSERT_TRUE(decoder.decode(R"({"channel":"book","type":"update","data":[{"symbol":"ETH/USD",)"
+                               R"("bids":[{"price":2500.1,"qty":0}],"asks":[],"checksum":1,)"
+                               R"("timestamp":"2024-01-01T00:00:00.000000Z"}]})", events));
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, BookEventType::UPDATE);
+    ASSERT_EQ(events[0].levels.size(), 1u);
+    EXPECT_EQ(events[0].levels[0].size, "0");
+
+    events.clear();
+    ASSERT_TRUE(decoder.decode(R"({"channel":"trade","type":"update","data":[)"
+                               R"({"symbol":"ETH/USD","side":"buy","price":2500.2,"qty":0.5,"ord_type":"market",)"
+                               R"("trade_id":1,"timestamp":"2024-01-01T00:00:00.000000Z"},)"
+                               R"({"symbol":"ETH/USD","side":"sell","price":2500.0,"qty":1e-05,"trade_id":2}]})",
+                               events));
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, BookEventType::TRADE);
+    EXPECT_TRUE(events[0].levels.empty());
+    EXPECT_EQ(events[0].maker_side, OrderSide::SELL);
+    EXPECT_EQ(events[0].price, "2500.2");
+    EXPECT_EQ(events[1].maker_side, OrderSide::BUY);
+    EXPECT_EQ(events[1].size, "1e-05");
+
+    // Trades replayed on subscription are history, not live events
+    events.clear();
+    ASSERT_TRUE(decoder.decode(R"({"channel":"trade","type":"snapshot","data":[)"
+                               R"({"symbol":"ETH/USD","side":"buy","price":1,"qty":1}]})", events));
+    EXPECT_TRUE(events.empty());
+}
+
+// Heartbeats, status and acknowledgements add nothing; failures are errors
+TEST(KrakenDecoderTest, HandlesControlMessages) {
+    KrakenDecoder decoder;
+    BookEvents events;
+    ASSERT_TRUE(decoder.decode(R"({"channel":"heartbeat"})", events));
+    ASSERT_TRUE(decoder.decode(R"({"channel":"status","type":"update","data":[{"system":"online"}]})", events));
+    ASSERT_TRUE(decoder.decode(R"({"method":"subscribe","result":{"channel":"book","symbol":"BTC/USD"},)"
+                               R"("success":true})", events));
+    EXPECT_TRUE(events.empty());
+
+    ASSERT_TRUE(decoder.decode(R"({"error":"Currency pair not supported","method":"subscribe",)"
+                               R"("success":false,"symbol":"XX/YY"})", events));
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, BookEventType::ERROR);
+    EXPECT_EQ(events[0].symbol, "XX/YY");
+    EXPECT_EQ(events[0].message, "Currency pair not supported");
+
+    EXPECT_FALSE(decoder.decode(R"({"channel":"book","type":"update","data":[{"symbol":"BTC/USD",)"
+                                R"("bids":[{"price":1}]}]})", events));
+    EXPECT_FALSE(decoder.decode(R"({"channel":"book")", events));
+}
+
+// Requests name the channel, symbol and (for books) depth
+TEST(KrakenDecoderTest, BuildsRequests) {
+    KrakenDecoder decoder(25);
+    std::vector<std::string> subscribe = decoder.subscribeMessages("BTC/USD");
+    ASSERT_EQ(subscribe.size(), 2u);
+
+    nlohmann::json book = nlohmann::json::parse(subscribe[0]);
+    EXPECT_EQ(book["method"], "subscribe");
+    EXPECT_EQ(book["params"]["channel"], "book");
+    EXPECT_EQ(book["params"]["symbol"][0], "BTC/USD");
+    EXPECT_EQ(book["params"]["depth"], 25);
+    EXPECT_EQ(nlohmann::json::parse(subscribe[1])["params"]["channel"], "trade");
+
+    // A resync re-subscribes the book alone, for a fresh snapshot
+    std::vector<std::string> resync = decoder.resyncMessages("BTC/USD");
+    ASSERT_EQ(resync.size(), 2u);
+    EXPECT_EQ(nlohmann::json::parse(resync[0])["method"], "unsubscribe");
+    EXPECT_EQ(nlohmann::json::parse(resync[1])["params"]["channel"], "book");
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "network/pipeline_latency.h"
+#include "utils/latency_histogram.h"
+#include "utils/time_utils.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace clunk;
+
+// Test that buckets tile the value range with bounded relative width
+TEST(LatencyHistogramTests, BucketsCoverRange) {
+    EXPECT_EQ(LatencyHistogram::bucketFor(0), 0u);
+    EXPECT_EQ(LatencyHistogram::bucketFor(63), 63u);
+    EXPECT_EQ(LatencyHistogram::bucketFor(64), 64u);
+    EXPECT_EQ(LatencyHistogram::bucketFor(65), 64u);
+    EXPECT_EQ(LatencyHistogram::bucketFor(UINT64_MAX), LatencyHistogram::kBucketCount - 1);
+    EXPECT_EQ(LatencyHistogram::bucketHighest(LatencyHistogram::kBucketCount - 1), UINT64_MAX);
+
+    for (size_t i = 0; i + 1 < LatencyHistogram::kBucketCount; ++i) {
+        uint64_t low = LatencyHistogram::bucketLowest(i);
+        uint64_t high = LatencyHistogram::bucketHighest(i);
+        ASSERT_EQ(LatencyHistogram::bucketFor(low), i);
+        ASSERT_EQ(LatencyHistogram::bucketFor(high), i);
+        ASSERT_EQ(LatencyHistogram::bucketLowest(i + 1), high + 1);
+        ASSERT_LE(high - low, low / 32);
+    }
+}
+
+// Test percentiles, mean and max over a known distribution
+TEST(LatencyHistogramTests, ReportsPercentiles) {
+    auto histogram = std::make_unique<LatencyHistogram>();
+    EXPECT_EQ(histogram->valueAtPercentile(50.0), 0u);
+
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram->record(value);
+    }
+    histogram->record(1000000);
+
+    HistogramSummary summary = histogram->summarize();
+    EXPECT_EQ(summary.count, 1001u);
+    EXPECT_EQ(summary.max, 1000000u);
+    EXPECT_NEAR(summary.mean, (500500.0 + 1000000.0) / 1001.0, 1e-6);
+
+    // Within a bucket's width above the exact rank
+    EXPECT_GE(summary.p50, 501u);
+    EXPECT_LE(summary.p50, 501u + 501u / 32);
+    EXPECT_GE(summary.p99, 991u);
+    EXPECT_LE(summary.p99, 991u + 991u / 32);
+    EXPECT_EQ(histogram->valueAtPercentile(100.0), 1000000u);
+
+    histogram->reset();
+    EXPECT_EQ(histogram->getCount(), 0u);
+    EXPECT_EQ(histogram->getMax(), 0u);
+}
+
+// Test that merged histograms add up and per-stage summaries skip gaps
+TEST(LatencyHistogramTests, MergesStages) {
+    auto io = std::make_unique<StageLatency>();
+    auto shard = std::make_unique<StageLatency>();
+    io->record(LatencyStage::DEFRAME, 100, 150);
+    shard->record(LatencyStage::PARSE, 200, 300);
+    shard->record(LatencyStage::PARSE, 300, 200);   // Counters disagree: clamped to 0
+    shard->record(LatencyStage::TOTAL, 0, 500);     // Unknown start: skipped
+
+    auto merged = std::make_unique<StageLatency>();
+    merged->merge(*io);
+    merged->merge(*shard);
+    EXPECT_EQ(merged->get(LatencyStage::DEFRAME).getCount(), 1u);
+    EXPECT_EQ(merged->get(LatencyStage::PARSE).getCount(), 2u);
+    EXPECT_EQ(merged->get(LatencyStage::PARSE).getMax(), 100u);
+
+    std::vector<LatencySummary> summaries = merged->summarize();
+    ASSERT_EQ(summaries.size(), 2u);
+    EXPECT_EQ(summaries[0].stage, LatencyStage::DEFRAME);
+    EXPECT_EQ(summaries[1].stage, LatencyStage::PARSE);
+    EXPECT_EQ(summaries[1].count, 2u);
+}
+
+// Test that the cycle clock is calibrated to roughly real time
+TEST(LatencyHistogramTests, CycleClockTracksSteadyClock) {
+    const CycleClock& clock = CycleClock::instance();
+    EXPECT_GT(clock.nanosPerCycle(), 0.0);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t start_cycles = readCycles();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    uint64_t cycles = readCycles() - start_cycles;
+    double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_NEAR(clock.toNanos(cycles), nanos, nanos * 0.1);
+}
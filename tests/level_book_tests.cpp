@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "orderbook/level_book.h"
+#include "orderbook/order_book.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+using Levels = std::vector<std::pair<Price, Quantity>>;
+
+} // namespace
+
+// Test set/erase semantics per level
+TEST(LevelBookTests, SetAndEraseLevels) {
+    LevelBook book("TEST", ProductScale(2, 8));
+
+    EXPECT_TRUE(book.setLevel(OrderSide::BUY, 10000, 5));
+    EXPECT_TRUE(book.setLevel(OrderSide::BUY, 9999, 7));
+    EXPECT_TRUE(book.setLevel(OrderSide::SELL, 10002, 3));
+    EXPECT_EQ(book.getBestBid(), 10000);
+    EXPECT_EQ(book.getBestAsk(), 10002);
+    EXPECT_EQ(book.getSpread(), 2);
+    EXPECT_EQ(book.getLevel(OrderSide::BUY, 9999), 7);
+
+    // Setting the same size or erasing a missing level changes nothing
+    EXPECT_FALSE(book.setLevel(OrderSide::BUY, 9999, 7));
+    EXPECT_FALSE(book.setLevel(OrderSide::SELL, 10005, 0));
+    EXPECT_EQ(book.getTopOfBook().sequence, 3u);
+
+    // Replace, then erase the touch
+    EXPECT_TRUE(book.setLevel(OrderSide::BUY, 9999, 2));
+    EXPECT_TRUE(book.setLevel(OrderSide::BUY, 10000, 0));
+    EXPECT_EQ(book.getBestBid(), 9999);
+    EXPECT_EQ(book.getTopOfBook().bid_size, 2);
+    EXPECT_EQ(book.getBidLevels(10), (Levels{{9999, 2}}));
+
+    EXPECT_TRUE(book.setLevel(OrderSide::SELL, 10002, 0));
+    EXPECT_FALSE(book.getTopOfBook().hasAsk());
+    EXPECT_EQ(book.getBestAsk(), LevelBook::kNoAsk);
+    EXPECT_EQ(book.getTopOfBook().sequence, 6u);
+}
+
+// Test batched changes and snapshot replacement
+TEST(LevelBookTests, BatchesAndSnapshots) {
+    LevelBook book("TEST", ProductScale(2, 8));
+
+    // Entries sharing a price are summed; zero sizes are skipped
+    std::vector<LevelUpdate> snapshot = {
+        {OrderSide::BUY, 100, 1, OrderId::fromString("b-1")},
+        {OrderSide::BUY, 100, 2, OrderId::fromString("b-2")},
+        {OrderSide::BUY, 99, 4, OrderId()},
+        {OrderSide::BUY, 98, 0, OrderId()},
+        {OrderSide::SELL, 101, 5, OrderId()},
+        {OrderSide::SELL, 103, 6, OrderId()},
+    };
+    book.loadSnapshot(snapshot.data(), snapshot.size());
+    EXPECT_EQ(book.getTopOfBook().sequence, 1u);
+    EXPECT_EQ(book.getBidLevels(10), (Levels{{100, 3}, {99, 4}}));
+    EXPECT_EQ(book.getAskLevels(10), (Levels{{101, 5}, {103, 6}}));
+    EXPECT_EQ(book.getOrderCount(), 4u);
+
+    std::vector<LevelUpdate> changes = {
+        {OrderSide::BUY, 100, 0, OrderId()},
+        {OrderSide::SELL, 102, 1, OrderId()},
+        {OrderSide::SELL, 103, 6, OrderId()},
+    };
+    EXPECT_EQ(book.applyUpdates(changes.data(), changes.size()), 2u);
+    EXPECT_EQ(book.getTopOfBook().sequence, 2u);
+    EXPECT_EQ(book.getBestBid(), 99);
+
+    DepthSnapshot depth;
+    book.getDepthSnapshot(2, depth);
+    EXPECT_EQ(depth.sequence, book.getTopOfBook().sequence);
+    ASSERT_EQ(depth.asks.size(), 2u);
+    EXPECT_EQ(depth.asks.prices[0], 101);
+    EXPECT_EQ(depth.asks.prices[1], 102);
+
+    // A new snapshot replaces everything
+    book.loadSnapshot(snapshot.data() + 4, 1);
+    EXPECT_EQ(book.getBidLevelCount(), 0u);
+    EXPECT_EQ(book.getAskLevels(10), (Levels{{101, 5}}));
+
+    book.clear();
+    EXPECT_EQ(book.getOrderCount(), 0u);
+    EXPECT_FALSE(book.getTopOfBook().hasBid());
+}
+
+// Test that random L2 churn leaves the level book with the same depth as an
+// order book fed the same changes through synthetic level orders
+TEST(LevelBookTests, MatchesOrderBookUnderL2Churn) {
+    const ProductScale scale(2, 8);
+    LevelBook level_book("TEST", scale);
+    OrderBook order_book("TEST", scale);
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<Price> offset_dist(1, 400);
+    std::uniform_int_distribution<Quantity> size_dist(0, 50);
+
+    std::vector<LevelUpdate> batch;
+    for (int step = 0; step < 2000; ++step) {
+        batch.clear();
+        size_t changes = 1 + static_cast<size_t>(rng() % 8);
+        for (size_t i = 0; i < changes; ++i) {
+            OrderSide side = rng() % 2 ? OrderSide::BUY : OrderSide::SELL;
+            Price offset = offset_dist(rng);
+            Price price = side == OrderSide::BUY ? 100000 - offset : 100000 + offset;
+            batch.push_back({side, price, size_dist(rng) < 10 ? 0 : size_dist(rng), OrderId()});
+        }
+
+        level_book.applyUpdates(batch.data(), batch.size());
+        order_book.applyUpdates(batch.data(), batch.size());
+
+        ASSERT_EQ(level_book.getBestBid(), order_book.getBestBid()) << "step " << step;
+        ASSERT_EQ(level_book.getBestAsk(), order_book.getBestAsk()) << "step " << step;
+        if (step % 50 == 0) {
+            ASSERT_EQ(level_book.getBidLevels(1000), order_book.getBidLevels(1000)) << "step " << step;
+            ASSERT_EQ(level_book.getAskLevels(1000), order_book.getAskLevels(1000)) << "step " << step;
+        }
+    }
+}
+
+// Test that changes at and inside the touch take the best-level slot, and
+// that touch-heavy churn leaves the tree books matching the ladder book
+TEST(LevelBookTests, TouchUpdatesSkipTree) {
+    LevelBook book("TEST", ProductScale(2, 8));
+    book.setLevel(OrderSide::BUY, 100, 1);      // Empty side: inside
+    book.setLevel(OrderSide::BUY, 98, 1);       // Deep
+    book.setLevel(OrderSide::BUY, 100, 2);      // At the touch
+    book.setLevel(OrderSide::BUY, 101, 3);      // Inside
+    book.setLevel(OrderSide::BUY, 101, 0);      // At the touch, dropping it
+    EXPECT_EQ(book.getBestBid(), 100);
+    EXPECT_EQ(book.getTopOfBook().bid_size, 2);
+    book.setLevel(OrderSide::BUY, 100, 0);
+    EXPECT_EQ(book.getBestBid(), 98);
+
+    TouchStats stats = book.getTouchStats();
+    EXPECT_EQ(stats.updates, 6u);
+    EXPECT_EQ(stats.at_touch, 3u);
+    EXPECT_EQ(stats.inside, 2u);
+    EXPECT_NEAR(stats.hitRate(), 5.0 / 6.0, 1e-9);
+
+    const ProductScale scale(2, 8);
+    LevelBook level_book("TEST", scale);
+    OrderBook order_book("TEST", scale);
+    LadderOrderBook ladder_book("TEST", scale);
+
+    // Prices cluster at the touch, so levels there come and go constantly
+    std::mt19937 rng(11);
+    std::geometric_distribution<Price> offset_dist(0.5);
+    std::uniform_int_distribution<Quantity> size_dist(0, 5);
+    for (int step = 0; step < 20000; ++step) {
+        OrderSide side = rng() % 2 ? OrderSide::BUY : OrderSide::SELL;
+        Price offset = 1 + offset_dist(rng);
+        LevelUpdate change{side, side == OrderSide::BUY ? 1000 - offset : 1000 + offset, size_dist(rng), OrderId()};
+        level_book.applyUpdates(&change, 1);
+        order_book.applyUpdates(&change, 1);
+        ladder_book.applyUpdates(&change, 1);
+
+        ASSERT_EQ(level_book.getTopOfBook().bid_size, ladder_book.getTopOfBook().bid_size) << "step " << step;
+        ASSERT_EQ(order_book.getTopOfBook().ask_size, ladder_book.getTopOfBook().ask_size) << "step " << step;
+        if (step % 500 == 0) {
+            ASSERT_EQ(level_book.getBidLevels(1000), ladder_book.getBidLevels(1000)) << "step " << step;
+            ASSERT_EQ(order_book.getAskLevels(1000), ladder_book.getAskLevels(1000)) << "step " << step;
+        }
+    }
+
+    EXPECT_GT(level_book.getTouchStats().hitRate(), 0.4);
+    EXPECT_GT(order_book.getTouchStats().at_touch, 0u);
+    EXPECT_EQ(ladder_book.getTouchStats().updates, 0u);
+}
+
+// Test that either book can be read through BookView
+TEST(LevelBookTests, BookViewCoversBothBooks) {
+    const ProductScale scale(2, 8);
+    std::vector<std::unique_ptr<BookView>> books;
+    books.push_back(std::make_unique<LevelBook>("TEST", scale));
+    books.push_back(std::make_unique<OrderBook>("TEST", scale));
+
+    std::vector<LevelUpdate> snapshot = {
+        {OrderSide::BUY, 500, 1, OrderId()},
+        {OrderSide::SELL, 501, 2, OrderId()},
+        {OrderSide::SELL, 502, 3, OrderId()},
+    };
+    static_cast<LevelBook&>(*books[0]).loadSnapshot(snapshot.data(), snapshot.size());
+    static_cast<OrderBook&>(*books[1]).loadSnapshot(snapshot.data(), snapshot.size());
+
+    for (const auto& book : books) {
+        EXPECT_EQ(book->getSymbol(), "TEST");
+        EXPECT_EQ(book->getTopOfBook().ask_size, 2);
+        EXPECT_EQ(book->getOrderCount(), 3u);
+        EXPECT_EQ(book->getAskLevelCount(), 2u);
+
+        DepthSnapshot depth;
+        book->getDepthSnapshot(10, depth);
+        EXPECT_EQ(depth.bids.size(), 1u);
+        EXPECT_EQ(depth.asks.sizes[1], 3);
+    }
+}
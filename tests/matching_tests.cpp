@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "orderbook/order_book.h"
+#include <chrono>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+Order makeOrder(const char* id, OrderSide side, Price price, Quantity size) {
+    return Order(OrderId::fromString(id), side, price, size, std::chrono::nanoseconds(0));
+}
+
+OrderId id(const char* text) {
+    return OrderId::fromString(text);
+}
+
+} // namespace
+
+// Test suite for matching incoming orders, on both level containers
+template <typename Book>
+class MatchingTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        book_.addOrder(makeOrder("a1", OrderSide::SELL, 101, 2));
+        book_.addOrder(makeOrder("a2", OrderSide::SELL, 101, 3));
+        book_.addOrder(makeOrder("a3", OrderSide::SELL, 102, 4));
+        book_.addOrder(makeOrder("b1", OrderSide::BUY, 99, 5));
+    }
+
+    Book book_{"TEST", ProductScale(2, 8)};
+    std::vector<Fill> fills_;
+};
+
+using BookTypes = ::testing::Types<OrderBook, LadderOrderBook>;
+TYPED_TEST_SUITE(MatchingTests, BookTypes);
+
+// Test that a sweep fills best price first, oldest order first
+TYPED_TEST(MatchingTests, FillsInPriceTimePriority) {
+    MatchResult result = this->book_.submitOrder(makeOrder("t", OrderSide::BUY, 102, 6), TimeInForce::GTC,
+                                                 this->fills_);
+
+    EXPECT_EQ(result.filled, 6);
+    EXPECT_EQ(result.remaining, 0);
+    EXPECT_FALSE(result.rested);
+    ASSERT_EQ(result.fill_count, 3u);
+    ASSERT_EQ(this->fills_.size(), 3u);
+
+    EXPECT_EQ(this->fills_[0].maker_id, id("a1"));
+    EXPECT_EQ(this->fills_[0].price, 101);
+    EXPECT_EQ(this->fills_[0].size, 2);
+    EXPECT_EQ(this->fills_[0].maker_remaining, 0);
+    EXPECT_EQ(this->fills_[1].maker_id, id("a2"));
+    EXPECT_EQ(this->fills_[1].size, 3);
+    EXPECT_EQ(this->fills_[2].maker_id, id("a3"));
+    EXPECT_EQ(this->fills_[2].price, 102);
+    EXPECT_EQ(this->fills_[2].size, 1);
+    EXPECT_EQ(this->fills_[2].maker_remaining, 3);
+    EXPECT_EQ(this->fills_[2].taker_id, id("t"));
+    EXPECT_EQ(this->fills_[2].taker_side, OrderSide::BUY);
+
+    // The partly filled maker keeps its place; the others are gone
+    EXPECT_FALSE(this->book_.getOrder(id("a1")).has_value());
+    EXPECT_EQ(this->book_.getOrder(id("a3"))->getSize(), 3);
+    EXPECT_EQ(this->book_.getBestAsk(), 102);
+    EXPECT_EQ(this->book_.getAskLevelCount(), 1u);
+    EXPECT_EQ(this->book_.getOrderCount(), 2u);
+}
+
+// Test that a GTC remainder rests at its limit and an IOC one is dropped
+TYPED_TEST(MatchingTests, HandlesRemainderPerTimeInForce) {
+    MatchResult result = this->book_.submitOrder(makeOrder("t1", OrderSide::BUY, 101, 7), TimeInForce::GTC,
+                                                 this->fills_);
+    EXPECT_EQ(result.filled, 5);
+    EXPECT_EQ(result.remaining, 2);
+    EXPECT_TRUE(result.rested);
+    EXPECT_EQ(this->book_.getBestBid(), 101);
+    EXPECT_EQ(this->book_.getLevelSize(OrderSide::BUY, 101), 2);
+    EXPECT_EQ(this->book_.getBestAsk(), 102);
+
+    result = this->book_.submitOrder(makeOrder("t2", OrderSide::SELL, 100, 4), TimeInForce::IOC, this->fills_);
+    EXPECT_EQ(result.filled, 2);
+    EXPECT_EQ(result.remaining, 2);
+    EXPECT_FALSE(result.rested);
+    ASSERT_EQ(this->fills_.size(), 1u);
+    EXPECT_EQ(this->fills_[0].maker_id, id("t1"));
+    EXPECT_FALSE(this->book_.getOrder(id("t2")).has_value());
+    EXPECT_EQ(this->book_.getBestBid(), 99);
+
+    // A market IOC sweeps every crossing level
+    result = this->book_.submitOrder(makeOrder("t3", OrderSide::SELL, marketLimit(OrderSide::SELL), 10),
+                                     TimeInForce::IOC, this->fills_);
+    EXPECT_EQ(result.filled, 5);
+    EXPECT_EQ(this->book_.getBidLevelCount(), 0u);
+}
+
+// Test that a FOK order fills completely or leaves the book untouched
+TYPED_TEST(MatchingTests, FillOrKillIsAllOrNothing) {
+    uint64_t sequence = this->book_.getTopOfBook().sequence;
+    MatchResult result = this->book_.submitOrder(makeOrder("t1", OrderSide::BUY, 101, 6), TimeInForce::FOK,
+                                                 this->fills_);
+    EXPECT_TRUE(result.rejected);
+    EXPECT_EQ(result.filled, 0);
+    EXPECT_TRUE(this->fills_.empty());
+    EXPECT_EQ(this->book_.getOrderCount(), 4u);
+    EXPECT_EQ(this->book_.getTopOfBook().sequence, sequence);
+
+    result = this->book_.submitOrder(makeOrder("t2", OrderSide::BUY, 102, 9), TimeInForce::FOK, this->fills_);
+    EXPECT_FALSE(result.rejected);
+    EXPECT_EQ(result.filled, 9);
+    EXPECT_EQ(this->book_.getAskLevelCount(), 0u);
+}
+
+// Test that duplicate IDs and empty orders are rejected
+TYPED_TEST(MatchingTests, RejectsInvalidOrders) {
+    EXPECT_TRUE(this->book_.submitOrder(makeOrder("b1", OrderSide::BUY, 98, 1), TimeInForce::GTC,
+                                        this->fills_).rejected);
+    EXPECT_TRUE(this->book_.submitOrder(makeOrder("t", OrderSide::BUY, 101, 0), TimeInForce::GTC,
+                                        this->fills_).rejected);
+    EXPECT_EQ(this->book_.getOrderCount(), 4u);
+}
+
+// Test that subscribers see a sweep as level changes
+TYPED_TEST(MatchingTests, PublishesSweepAsDeltas) {
+    auto subscription = this->book_.subscribe();
+    uint64_t sequence = this->book_.getTopOfBook().sequence;
+
+    this->book_.submitOrder(makeOrder("t", OrderSide::BUY, 102, 6), TimeInForce::IOC, this->fills_);
+
+    std::vector<LevelDelta> deltas;
+    subscription->poll([&deltas](const LevelDelta& delta) { deltas.push_back(delta); });
+    ASSERT_EQ(deltas.size(), 2u);
+    EXPECT_EQ(deltas[0].price, 101);
+    EXPECT_EQ(deltas[0].size, 0);
+    EXPECT_EQ(deltas[1].price, 102);
+    EXPECT_EQ(deltas[1].size, 3);
+
+    // Three makers changed, one publication
+    EXPECT_EQ(this->book_.getTopOfBook().sequence, sequence + 1);
+    EXPECT_EQ(deltas[1].sequence, sequence + 1);
+    EXPECT_EQ(this->book_.getTopOfBook().ask_price, 102);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "utils/memory_pool.h"
+#include "utils/node_allocator.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+// Test that destroyed slots are recycled without growing the pool
+TEST(ObjectPoolTests, ReusesSlots) {
+    ObjectPool<std::string> pool(4);
+
+    std::string* a = pool.construct("first");
+    EXPECT_EQ(*a, "first");
+    EXPECT_EQ(pool.size(), 1);
+    EXPECT_EQ(pool.capacity(), 4);
+
+    pool.destroy(a);
+    std::string* b = pool.construct("second");
+    EXPECT_EQ(b, a);
+    EXPECT_EQ(pool.chunkCount(), 1);
+
+    pool.destroy(b);
+    EXPECT_EQ(pool.size(), 0);
+}
+
+// Test that reserve() pre-sizes the pool in a single chunk
+TEST(ObjectPoolTests, Reserve) {
+    ObjectPool<int> pool(2);
+    pool.reserve(100);
+    EXPECT_EQ(pool.capacity(), 100);
+    EXPECT_EQ(pool.chunkCount(), 1);
+
+    std::vector<int*> objects;
+    for (int i = 0; i < 100; ++i) {
+        objects.push_back(pool.construct(i));
+    }
+    EXPECT_EQ(pool.chunkCount(), 1);
+
+    for (int* object : objects) {
+        pool.destroy(object);
+    }
+}
+
+// Test that a map backed by a slab arena draws every node from it
+TEST(SlabArenaTests, BacksMapNodes) {
+    SlabArena arena(8);
+    arena.reserve(64);
+
+    using Allocator = SlabAllocator<std::pair<const int, double>>;
+    std::map<int, double, std::less<>, Allocator> levels{std::less<>(), Allocator(&arena)};
+
+    for (int i = 0; i < 64; ++i) {
+        levels.emplace(i, i * 1.5);
+    }
+
+    EXPECT_GT(arena.blockSize(), 0);
+    EXPECT_EQ(arena.size(), 64);
+    EXPECT_EQ(arena.capacity(), 64);
+    EXPECT_EQ(arena.slabCount(), 1);
+    EXPECT_EQ(arena.heapFallbacks(), 0);
+
+    levels.clear();
+    EXPECT_EQ(arena.size(), 0);
+}
+
+// Test that node-placed storage works like the heap's, with or without a node
+TEST(NodeAllocatorTests, AllocatesOnNodeOrHeap) {
+    for (int node : {0, -1}) {
+        auto text = std::allocate_shared<std::string>(NodeAllocator<std::string>(node), 64, 'x');
+        EXPECT_EQ(text->size(), 64u);
+
+        std::vector<int, NodeAllocator<int>> values{NodeAllocator<int>(node)};
+        for (int i = 0; i < 5000; ++i) {
+            values.push_back(i);
+        }
+        EXPECT_EQ(values.get_allocator().node(), node);
+        EXPECT_EQ(values[4999], 4999);
+    }
+}
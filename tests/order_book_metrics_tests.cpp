@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "orderbook/order_book.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+// Metrics recomputed from scratch for one side of a full depth snapshot
+SideMetrics referenceSide(const DepthSide& side, const MetricsConfig& config, bool is_bid) {
+    SideMetrics expected;
+    NotionalSum notional = 0;
+    NotionalSum top_notional = 0;
+    NotionalSum band_notional = 0;
+
+    Price edge = 0;
+    if (!side.empty()) {
+        Price best = side.prices[0];
+        edge = is_bid ? (best * (10000 - config.band_bps) + 9999) / 10000
+                      : best * (10000 + config.band_bps) / 10000;
+        expected.band_edge = edge;
+    }
+
+    for (size_t i = 0; i < side.size(); ++i) {
+        Price price = side.prices[i];
+        Quantity size = side.sizes[i];
+        NotionalSum value = static_cast<NotionalSum>(price) * size;
+
+        expected.volume += size;
+        notional += value;
+        ++expected.levels;
+
+        if (i < config.top_levels) {
+            expected.top_volume += size;
+            top_notional += value;
+            ++expected.top_levels;
+        }
+        if (is_bid ? price >= edge : price <= edge) {
+            expected.band_volume += size;
+            band_notional += value;
+        }
+    }
+
+    expected.notional = static_cast<double>(notional);
+    expected.top_notional = static_cast<double>(top_notional);
+    expected.band_notional = static_cast<double>(band_notional);
+    return expected;
+}
+
+void expectSideEq(const SideMetrics& actual, const SideMetrics& expected, int step) {
+    ASSERT_EQ(actual.volume, expected.volume) << "step " << step;
+    ASSERT_EQ(actual.notional, expected.notional) << "step " << step;
+    ASSERT_EQ(actual.levels, expected.levels) << "step " << step;
+    ASSERT_EQ(actual.top_volume, expected.top_volume) << "step " << step;
+    ASSERT_EQ(actual.top_notional, expected.top_notional) << "step " << step;
+    ASSERT_EQ(actual.top_levels, expected.top_levels) << "step " << step;
+    ASSERT_EQ(actual.band_volume, expected.band_volume) << "step " << step;
+    ASSERT_EQ(actual.band_notional, expected.band_notional) << "step " << step;
+    ASSERT_EQ(actual.band_edge, expected.band_edge) << "step " << step;
+}
+
+} // namespace
+
+template <typename Book>
+class OrderBookMetricsTests : public ::testing::Test {};
+
+using MetricsBooks = ::testing::Types<OrderBook, LadderOrderBook>;
+TYPED_TEST_SUITE(OrderBookMetricsTests, MetricsBooks);
+
+// Test that incremental metrics match a full recompute under random churn
+// (adds, resizes, fills and cancels, with the touch moving both ways)
+TYPED_TEST(OrderBookMetricsTests, MatchesRecompute) {
+    TypeParam book("TEST", ProductScale(2, 8));
+    MetricsConfig config;
+    config.top_levels = 5;
+    config.band_bps = 3;     // 30 ticks at 100000, inside the 60 tick spread of offsets
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> action_dist(0, 9);
+    std::uniform_int_distribution<Price> offset_dist(1, 60);
+    std::uniform_int_distribution<Quantity> size_dist(1, 100000000);
+
+    Price mid = 100000;
+    std::vector<OrderId> live;
+    int next_id = 0;
+
+    for (int step = 0; step < 6000; ++step) {
+        // Turn metrics on part way through so rebuild() is exercised too
+        if (step == 300) {
+            book.enableMetrics(config);
+        }
+        if (step % 400 == 0) {
+            mid += (step % 800 == 0) ? 25 : -40;
+        }
+
+        int action = action_dist(rng);
+        if (action < 5 || live.empty()) {
+            OrderSide side = (action % 2 == 0) ? OrderSide::BUY : OrderSide::SELL;
+            Price price = side == OrderSide::BUY ? mid - offset_dist(rng) : mid + offset_dist(rng);
+            Order order(OrderId::fromString("o-" + std::to_string(next_id++)), side, price,
+                        size_dist(rng), std::chrono::nanoseconds(step));
+            book.addOrder(order);
+            live.push_back(order.getId());
+        } else {
+            size_t index = static_cast<size_t>(rng()) % live.size();
+            if (action < 7) {
+                book.modifyOrder(live[index], size_dist(rng));
+            } else if (action < 8) {
+                book.reduceOrder(live[index], size_dist(rng) / 2);
+            } else {
+                book.removeOrder(live[index]);
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+
+        if (step >= 300) {
+            DepthSnapshot snapshot;
+            book.getDepthSnapshot(book.getBidLevelCount() + book.getAskLevelCount(), snapshot);
+            OrderBookMetrics metrics = book.getMetrics();
+
+            ASSERT_EQ(metrics.sequence, snapshot.sequence);
+            expectSideEq(metrics.bids, referenceSide(snapshot.bids, config, true), step);
+            expectSideEq(metrics.asks, referenceSide(snapshot.asks, config, false), step);
+        }
+    }
+
+    book.clear();
+    OrderBookMetrics cleared = book.getMetrics();
+    EXPECT_EQ(cleared.bids.volume, 0);
+    EXPECT_EQ(cleared.asks.top_levels, 0);
+    EXPECT_EQ(cleared.bids.band_volume, 0);
+}
+
+// Test the derived values on a small book
+TYPED_TEST(OrderBookMetricsTests, DerivedValues) {
+    TypeParam book("TEST", ProductScale(2, 8));
+    EXPECT_EQ(book.getMetrics().bids.volume, 0);
+
+    MetricsConfig config;
+    config.top_levels = 2;
+    book.enableMetrics(config);
+
+    book.addOrder(Order(OrderId::fromString("b1"), OrderSide::BUY, 10000, 30, std::chrono::nanoseconds(0)));
+    book.addOrder(Order(OrderId::fromString("b2"), OrderSide::BUY, 9990, 10, std::chrono::nanoseconds(0)));
+    book.addOrder(Order(OrderId::fromString("b3"), OrderSide::BUY, 9000, 50, std::chrono::nanoseconds(0)));
+    book.addOrder(Order(OrderId::fromString("a1"), OrderSide::SELL, 10010, 20, std::chrono::nanoseconds(0)));
+
+    OrderBookMetrics metrics = book.getMetrics();
+    EXPECT_EQ(metrics.bids.volume, 90);
+    EXPECT_EQ(metrics.bids.top_volume, 40);
+    EXPECT_EQ(metrics.bids.band_volume, 40);   // 9000 is outside 50 bps of 10000
+    EXPECT_EQ(metrics.bids.band_edge, 9950);
+    EXPECT_DOUBLE_EQ(metrics.bids.topVwap(), (10000.0 * 30 + 9990.0 * 10) / 40);
+    EXPECT_DOUBLE_EQ(metrics.topImbalance(), 2.0);
+    EXPECT_EQ(metrics.sequence, book.getTopOfBook().sequence);
+}
+
+// Test that batched updates feed the trackers and snapshot loads rebuild them
+TYPED_TEST(OrderBookMetricsTests, BatchesAndSnapshots) {
+    TypeParam book("TEST", ProductScale(2, 8));
+    MetricsConfig config;
+    config.top_levels = 3;
+    config.band_bps = 5;
+    book.enableMetrics(config);
+
+    std::vector<LevelUpdate> levels;
+    for (Price i = 0; i < 50; ++i) {
+        levels.push_back({OrderSide::BUY, 100000 - 7 * i, 10 + i, OrderId()});
+        levels.push_back({OrderSide::SELL, 100001 + 5 * i, 20 + i, OrderId()});
+    }
+    book.loadSnapshot(levels.data(), levels.size());
+
+    DepthSnapshot snapshot;
+    book.getDepthSnapshot(1000, snapshot);
+    OrderBookMetrics metrics = book.getMetrics();
+    expectSideEq(metrics.bids, referenceSide(snapshot.bids, config, true), 0);
+    expectSideEq(metrics.asks, referenceSide(snapshot.asks, config, false), 0);
+    EXPECT_EQ(metrics.sequence, book.getTopOfBook().sequence);
+
+    // Move both touches inside one batch
+    std::vector<LevelUpdate> changes = {
+        {OrderSide::BUY, 100000, 0, OrderId()},
+        {OrderSide::BUY, 99993, 0, OrderId()},
+        {OrderSide::SELL, 100000, 4, OrderId()},
+        {OrderSide::SELL, 100011, 1, OrderId()},
+        {OrderSide::BUY, 99700, 0, OrderId()},
+    };
+    book.applyUpdates(changes.data(), changes.size());
+
+    book.getDepthSnapshot(1000, snapshot);
+    metrics = book.getMetrics();
+    expectSideEq(metrics.bids, referenceSide(snapshot.bids, config, true), 1);
+    expectSideEq(metrics.asks, referenceSide(snapshot.asks, config, false), 1);
+}
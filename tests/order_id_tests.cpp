@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "orderbook/order.h"
+#include "orderbook/order_id.h"
+#include "utils/flat_hash_map.h"
+#include <string>
+
+using namespace clunk;
+
+// Test that exchange UUIDs parse losslessly and print back canonically
+TEST(OrderIdTests, ParsesUuid) {
+    const std::string uuid = "d50ec984-77a8-460a-b958-66f114b0de9b";
+
+    OrderId id;
+    ASSERT_TRUE(OrderId::parseUuid(uuid, id));
+    EXPECT_EQ(id.hi, 0xd50ec98477a8460aull);
+    EXPECT_EQ(id.lo, 0xb95866f114b0de9bull);
+    EXPECT_EQ(id.kind(), OrderId::Kind::EXCHANGE);
+    EXPECT_EQ(id.toString(), uuid);
+
+    // Upper-case hex maps to the same ID
+    EXPECT_EQ(OrderId::fromString("D50EC984-77A8-460A-B958-66F114B0DE9B"), id);
+
+    EXPECT_FALSE(OrderId::parseUuid("d50ec984-77a8-460a-b958-66f114b0de9", id));
+    EXPECT_FALSE(OrderId::parseUuid("d50ec984x77a8-460a-b958-66f114b0de9b", id));
+    EXPECT_FALSE(OrderId::parseUuid("g50ec984-77a8-460a-b958-66f114b0de9b", id));
+}
+
+// Test that non-UUID strings intern to stable, distinct hashed IDs
+TEST(OrderIdTests, HashesOtherStrings) {
+    OrderId a = OrderId::fromString("bid-1");
+    OrderId b = OrderId::fromString("bid-2");
+
+    EXPECT_EQ(a.kind(), OrderId::Kind::HASHED);
+    EXPECT_EQ(a, OrderId::fromString("bid-1"));
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a.toString().front(), '#');
+}
+
+// Test that level IDs are keyed on side and price only
+TEST(OrderIdTests, LevelIds) {
+    OrderId bid = OrderId::level(OrderSide::BUY, 10050);
+
+    EXPECT_EQ(bid.kind(), OrderId::Kind::LEVEL);
+    EXPECT_EQ(bid, OrderId::level(OrderSide::BUY, 10050));
+    EXPECT_NE(bid, OrderId::level(OrderSide::SELL, 10050));
+    EXPECT_NE(bid, OrderId::level(OrderSide::BUY, 10025));
+    EXPECT_EQ(bid.toString(), "bid-10050");
+}
+
+// Test insert/find/erase across growth and backward-shift deletion
+TEST(FlatHashMapTests, InsertFindErase) {
+    FlatHashMap<OrderId, int, OrderIdHash> map;
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(map.insert(OrderId::fromString(std::to_string(i)), i));
+    }
+    EXPECT_EQ(map.size(), 1000);
+    EXPECT_FALSE(map.insert(OrderId::fromString("7"), 0));
+
+    // Erase every other key; the survivors must stay reachable
+    for (int i = 0; i < 1000; i += 2) {
+        EXPECT_TRUE(map.erase(OrderId::fromString(std::to_string(i))));
+    }
+    EXPECT_FALSE(map.erase(OrderId::fromString("0")));
+    EXPECT_EQ(map.size(), 500);
+
+    for (int i = 0; i < 1000; ++i) {
+        const int* value = map.find(OrderId::fromString(std::to_string(i)));
+        if (i % 2 == 0) {
+            EXPECT_EQ(value, nullptr);
+        } else {
+            ASSERT_NE(value, nullptr);
+            EXPECT_EQ(*value, i);
+        }
+    }
+
+    size_t visited = 0;
+    for (const auto& slot : map) {
+        EXPECT_EQ(slot.value % 2, 1);
+        ++visited;
+    }
+    EXPECT_EQ(visited, 500);
+}
+
+// Test that reserve() sizes the table up front so inserts never grow it
+TEST(FlatHashMapTests, Reserve) {
+    FlatHashMap<OrderId, int, OrderIdHash> map;
+    map.reserve(5000);
+    size_t capacity = map.capacity();
+
+    for (int i = 0; i < 5000; ++i) {
+        map.insert(OrderId::level(OrderSide::BUY, 10000 + i), i);
+    }
+    EXPECT_EQ(map.capacity(), capacity);
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.capacity(), capacity);
+}
+
+// Test that a duplicate insert at the load limit neither grows the table
+// nor moves existing entries
+TEST(FlatHashMapTests, DuplicateInsertKeepsTable) {
+    FlatHashMap<OrderId, int, OrderIdHash> map;
+    size_t capacity = map.capacity();
+    for (size_t i = 0; i < capacity / 2; ++i) {
+        EXPECT_TRUE(map.insert(OrderId::level(OrderSide::BUY, 10000 + i), static_cast<int>(i)));
+    }
+    EXPECT_EQ(map.capacity(), capacity);
+
+    const int* value = map.find(OrderId::level(OrderSide::BUY, 10000));
+    EXPECT_FALSE(map.insert(OrderId::level(OrderSide::BUY, 10000), 99));
+    EXPECT_EQ(map.capacity(), capacity);
+    EXPECT_EQ(map.find(OrderId::level(OrderSide::BUY, 10000)), value);
+    EXPECT_EQ(*value, 0);
+
+    // A new key at the limit still grows it
+    EXPECT_TRUE(map.insert(OrderId::level(OrderSide::SELL, 10000), 1));
+    EXPECT_GT(map.capacity(), capacity);
+}
@@ -2,13 +2,23 @@
 #include "orderbook/order_book.h"
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 using namespace clunk;
 
+// Scale used by every test book (cents and satoshis, as for BTC-USD)
+const ProductScale kScale(2, 8);
+
+// Convert test prices and sizes to ticks and lots
+Price px(double price) { return kScale.toPrice(price); }
+Quantity qty(double size) { return kScale.toQuantity(size); }
+
 // Helper function to create orders with a timestamp
-std::shared_ptr<Order> createOrder(const std::string& id, OrderSide side, double price, double size) {
-    return std::make_shared<Order>(
-        id, side, price, size,
+Order createOrder(const std::string& id, OrderSide side, double price, double size) {
+    return Order(
+        OrderId::fromString(id), side, px(price), qty(size),
         std::chrono::duration_cast<std::chrono::nanoseconds>(
             std::chrono::system_clock::now().time_since_epoch()
         )
@@ -20,32 +30,32 @@ class OrderTests : public ::testing::Test {
 protected:
     void SetUp() override {
         // Create a test order
-        order_ = createOrder("test-order-1", OrderSide::BUY, 100.0, 1.5);
+        order_ = std::make_unique<Order>(createOrder("test-order-1", OrderSide::BUY, 100.0, 1.5));
     }
     
-    std::shared_ptr<Order> order_;
+    std::unique_ptr<Order> order_;
 };
 
 // Test basic order properties
 TEST_F(OrderTests, BasicProperties) {
-    EXPECT_EQ(order_->getId(), "test-order-1");
+    EXPECT_EQ(order_->getId(), OrderId::fromString("test-order-1"));
     EXPECT_EQ(order_->getSide(), OrderSide::BUY);
-    EXPECT_DOUBLE_EQ(order_->getPrice(), 100.0);
-    EXPECT_DOUBLE_EQ(order_->getSize(), 1.5);
+    EXPECT_EQ(order_->getPrice(), px(100.0));
+    EXPECT_EQ(order_->getSize(), qty(1.5));
 }
 
 // Test order size reduction
 TEST_F(OrderTests, ReduceSize) {
-    EXPECT_TRUE(order_->reduceSize(0.5));
-    EXPECT_DOUBLE_EQ(order_->getSize(), 1.0);
+    EXPECT_TRUE(order_->reduceSize(qty(0.5)));
+    EXPECT_EQ(order_->getSize(), qty(1.0));
     
     // Try to reduce by too much
-    EXPECT_FALSE(order_->reduceSize(2.0));
-    EXPECT_DOUBLE_EQ(order_->getSize(), 1.0);
+    EXPECT_FALSE(order_->reduceSize(qty(2.0)));
+    EXPECT_EQ(order_->getSize(), qty(1.0));
     
     // Try to reduce by a negative amount
-    EXPECT_FALSE(order_->reduceSize(-0.5));
-    EXPECT_DOUBLE_EQ(order_->getSize(), 1.0);
+    EXPECT_FALSE(order_->reduceSize(qty(-0.5)));
+    EXPECT_EQ(order_->getSize(), qty(1.0));
 }
 
 // Test suite for the PriceLevel class
@@ -53,63 +63,78 @@ class PriceLevelTests : public ::testing::Test {
 protected:
     void SetUp() override {
         // Create a test price level
-        level_ = std::make_unique<PriceLevel>(100.0);
+        level_ = std::make_unique<PriceLevel>(px(100.0));
         
         // Create some test orders
-        order1_ = createOrder("test-order-1", OrderSide::BUY, 100.0, 1.5);
-        order2_ = createOrder("test-order-2", OrderSide::BUY, 100.0, 2.5);
+        order1_ = std::make_unique<Order>(createOrder("test-order-1", OrderSide::BUY, 100.0, 1.5));
+        order2_ = std::make_unique<Order>(createOrder("test-order-2", OrderSide::BUY, 100.0, 2.5));
+    }
+
+    void TearDown() override {
+        // Orders must be unlinked before they are destroyed
+        level_->clear();
     }
     
     std::unique_ptr<PriceLevel> level_;
-    std::shared_ptr<Order> order1_;
-    std::shared_ptr<Order> order2_;
+    std::unique_ptr<Order> order1_;
+    std::unique_ptr<Order> order2_;
 };
 
 // Test adding orders to a price level
 TEST_F(PriceLevelTests, AddOrder) {
-    EXPECT_TRUE(level_->addOrder(order1_));
+    EXPECT_TRUE(level_->addOrder(*order1_));
     EXPECT_EQ(level_->getOrderCount(), 1);
-    EXPECT_DOUBLE_EQ(level_->getTotalSize(), 1.5);
+    EXPECT_EQ(level_->getTotalSize(), qty(1.5));
     
-    EXPECT_TRUE(level_->addOrder(order2_));
+    EXPECT_TRUE(level_->addOrder(*order2_));
     EXPECT_EQ(level_->getOrderCount(), 2);
-    EXPECT_DOUBLE_EQ(level_->getTotalSize(), 4.0);
+    EXPECT_EQ(level_->getTotalSize(), qty(4.0));
     
     // Try to add an order at the wrong price
     auto wrong_price_order = createOrder("test-order-3", OrderSide::BUY, 101.0, 1.0);
     EXPECT_FALSE(level_->addOrder(wrong_price_order));
     
     // Try to add a duplicate order
-    EXPECT_FALSE(level_->addOrder(order1_));
+    EXPECT_FALSE(level_->addOrder(*order1_));
+}
+
+// Test that orders queue in arrival order
+TEST_F(PriceLevelTests, FifoOrder) {
+    EXPECT_TRUE(level_->addOrder(*order1_));
+    EXPECT_TRUE(level_->addOrder(*order2_));
+    EXPECT_EQ(level_->front()->getId(), OrderId::fromString("test-order-1"));
+
+    // Modifying size keeps queue position
+    level_->updateOrder(*order1_, qty(0.5));
+    EXPECT_EQ(level_->front()->getId(), OrderId::fromString("test-order-1"));
+
+    level_->removeOrder(*order1_);
+    EXPECT_FALSE(order1_->isQueued());
+    EXPECT_EQ(level_->front()->getId(), OrderId::fromString("test-order-2"));
 }
 
 // Test removing orders from a price level
 TEST_F(PriceLevelTests, RemoveOrder) {
-    EXPECT_TRUE(level_->addOrder(order1_));
-    EXPECT_TRUE(level_->addOrder(order2_));
+    EXPECT_TRUE(level_->addOrder(*order1_));
+    EXPECT_TRUE(level_->addOrder(*order2_));
     
-    EXPECT_TRUE(level_->removeOrder("test-order-1"));
+    level_->removeOrder(*order1_);
     EXPECT_EQ(level_->getOrderCount(), 1);
-    EXPECT_DOUBLE_EQ(level_->getTotalSize(), 2.5);
+    EXPECT_EQ(level_->getTotalSize(), qty(2.5));
     
-    // Try to remove a non-existent order
-    EXPECT_FALSE(level_->removeOrder("non-existent"));
-    
-    EXPECT_TRUE(level_->removeOrder("test-order-2"));
+    level_->removeOrder(*order2_);
     EXPECT_EQ(level_->getOrderCount(), 0);
-    EXPECT_DOUBLE_EQ(level_->getTotalSize(), 0.0);
+    EXPECT_EQ(level_->getTotalSize(), qty(0.0));
     EXPECT_TRUE(level_->isEmpty());
 }
 
 // Test updating orders in a price level
 TEST_F(PriceLevelTests, UpdateOrder) {
-    EXPECT_TRUE(level_->addOrder(order1_));
+    EXPECT_TRUE(level_->addOrder(*order1_));
     
-    EXPECT_TRUE(level_->updateOrder("test-order-1", 3.0));
-    EXPECT_DOUBLE_EQ(level_->getTotalSize(), 3.0);
-    
-    // Try to update a non-existent order
-    EXPECT_FALSE(level_->updateOrder("non-existent", 1.0));
+    level_->updateOrder(*order1_, qty(3.0));
+    EXPECT_EQ(level_->getTotalSize(), qty(3.0));
+    EXPECT_EQ(order1_->getSize(), qty(3.0));
 }
 
 // Test suite for the OrderBook class
@@ -117,20 +142,14 @@ class OrderBookTests : public ::testing::Test {
 protected:
     void SetUp() override {
         // Create a test order book
-        book_ = std::make_unique<OrderBook>("BTC-USD");
-        
-        // Create some test orders
-        bid1_ = createOrder("bid-1", OrderSide::BUY, 100.0, 1.5);
-        bid2_ = createOrder("bid-2", OrderSide::BUY, 99.0, 2.5);
-        ask1_ = createOrder("ask-1", OrderSide::SELL, 101.0, 1.0);
-        ask2_ = createOrder("ask-2", OrderSide::SELL, 102.0, 2.0);
+        book_ = std::make_unique<OrderBook>("BTC-USD", kScale);
     }
     
     std::unique_ptr<OrderBook> book_;
-    std::shared_ptr<Order> bid1_;
-    std::shared_ptr<Order> bid2_;
-    std::shared_ptr<Order> ask1_;
-    std::shared_ptr<Order> ask2_;
+    Order bid1_ = createOrder("bid-1", OrderSide::BUY, 100.0, 1.5);
+    Order bid2_ = createOrder("bid-2", OrderSide::BUY, 99.0, 2.5);
+    Order ask1_ = createOrder("ask-1", OrderSide::SELL, 101.0, 1.0);
+    Order ask2_ = createOrder("ask-2", OrderSide::SELL, 102.0, 2.0);
 };
 
 // Test adding orders to the order book
@@ -153,40 +172,139 @@ TEST_F(OrderBookTests, RemoveOrder) {
     EXPECT_TRUE(book_->addOrder(bid1_));
     EXPECT_TRUE(book_->addOrder(bid2_));
     
-    EXPECT_TRUE(book_->removeOrder("bid-1"));
+    EXPECT_TRUE(book_->removeOrder(OrderId::fromString("bid-1")));
     EXPECT_EQ(book_->getOrderCount(), 1);
     EXPECT_EQ(book_->getBidLevelCount(), 1);
     
     // Try to remove a non-existent order
-    EXPECT_FALSE(book_->removeOrder("non-existent"));
+    EXPECT_FALSE(book_->removeOrder(OrderId::fromString("non-existent")));
 }
 
 // Test modifying orders in the order book
 TEST_F(OrderBookTests, ModifyOrder) {
     EXPECT_TRUE(book_->addOrder(bid1_));
     
-    EXPECT_TRUE(book_->modifyOrder("bid-1", 3.0));
+    EXPECT_TRUE(book_->modifyOrder(OrderId::fromString("bid-1"), qty(3.0)));
+    EXPECT_EQ(book_->getOrder(OrderId::fromString("bid-1"))->getSize(), qty(3.0));
+    EXPECT_EQ(book_->getBidLevels(1)[0].second, qty(3.0));
     
     // Try to modify a non-existent order
-    EXPECT_FALSE(book_->modifyOrder("non-existent", 1.0));
+    EXPECT_FALSE(book_->modifyOrder(OrderId::fromString("non-existent"), qty(1.0)));
+}
+
+// Test reducing orders by fills
+TEST_F(OrderBookTests, ReduceOrder) {
+    EXPECT_TRUE(book_->addOrder(bid1_));
+
+    // Partial fill keeps the order resting
+    EXPECT_TRUE(book_->reduceOrder(OrderId::fromString("bid-1"), qty(0.5)));
+    EXPECT_EQ(book_->getOrder(OrderId::fromString("bid-1"))->getSize(), qty(1.0));
+
+    // Full fill removes the order and its level
+    EXPECT_TRUE(book_->reduceOrder(OrderId::fromString("bid-1"), qty(1.0)));
+    EXPECT_FALSE(book_->getOrder(OrderId::fromString("bid-1")).has_value());
+    EXPECT_EQ(book_->getBidLevelCount(), 0);
+
+    EXPECT_FALSE(book_->reduceOrder(OrderId::fromString("non-existent"), qty(1.0)));
+}
+
+// Test that orders can be re-added after removal and clearing
+TEST_F(OrderBookTests, ReuseAfterClear) {
+    EXPECT_TRUE(book_->addOrder(bid1_));
+    EXPECT_TRUE(book_->addOrder(ask1_));
+    book_->clear();
+    EXPECT_EQ(book_->getOrderCount(), 0);
+    EXPECT_EQ(book_->getBidLevelCount(), 0);
+
+    EXPECT_TRUE(book_->addOrder(bid1_));
+    EXPECT_TRUE(book_->removeOrder(OrderId::fromString("bid-1")));
+    EXPECT_TRUE(book_->addOrder(bid1_));
+    EXPECT_EQ(book_->getOrderCount(), 1);
+    EXPECT_EQ(book_->getBestBid(), px(100.0));
 }
 
 // Test getting the best bid and ask
 TEST_F(OrderBookTests, BestBidAsk) {
-    EXPECT_DOUBLE_EQ(book_->getBestBid(), 0.0);
-    EXPECT_DOUBLE_EQ(book_->getBestAsk(), std::numeric_limits<double>::max());
+    EXPECT_EQ(book_->getBestBid(), px(0.0));
+    EXPECT_EQ(book_->getBestAsk(), OrderBook::kNoAsk);
     
     EXPECT_TRUE(book_->addOrder(bid1_));
     EXPECT_TRUE(book_->addOrder(bid2_));
     EXPECT_TRUE(book_->addOrder(ask1_));
     EXPECT_TRUE(book_->addOrder(ask2_));
     
-    EXPECT_DOUBLE_EQ(book_->getBestBid(), 100.0);
-    EXPECT_DOUBLE_EQ(book_->getBestAsk(), 101.0);
-    EXPECT_DOUBLE_EQ(book_->getSpread(), 1.0);
+    EXPECT_EQ(book_->getBestBid(), px(100.0));
+    EXPECT_EQ(book_->getBestAsk(), px(101.0));
+    EXPECT_EQ(book_->getSpread(), px(1.0));
     EXPECT_DOUBLE_EQ(book_->getMidpointPrice(), 100.5);
 }
 
+// Test that the top of book snapshot tracks sizes and counts mutations
+TEST_F(OrderBookTests, TopOfBookSnapshot) {
+    TopOfBook empty = book_->getTopOfBook();
+    EXPECT_FALSE(empty.hasBid());
+    EXPECT_FALSE(empty.hasAsk());
+    EXPECT_EQ(empty.ask_price, OrderBook::kNoAsk);
+
+    EXPECT_TRUE(book_->addOrder(bid1_));
+    EXPECT_TRUE(book_->addOrder(ask1_));
+    EXPECT_TRUE(book_->modifyOrder(OrderId::fromString("bid-1"), qty(4.0)));
+
+    TopOfBook top = book_->getTopOfBook();
+    EXPECT_EQ(top.bid_price, px(100.0));
+    EXPECT_EQ(top.bid_size, qty(4.0));
+    EXPECT_EQ(top.ask_price, px(101.0));
+    EXPECT_EQ(top.ask_size, ask1_.getSize());
+    EXPECT_EQ(top.sequence, empty.sequence + 3);
+
+    // Failed mutations leave the snapshot untouched
+    EXPECT_FALSE(book_->removeOrder(OrderId::fromString("non-existent")));
+    EXPECT_EQ(book_->getTopOfBook().sequence, top.sequence);
+
+    book_->clear();
+    EXPECT_FALSE(book_->getTopOfBook().hasBid());
+    EXPECT_FALSE(book_->getTopOfBook().hasAsk());
+}
+
+// Test that readers on another thread never see a torn bid/ask pair
+TEST_F(OrderBookTests, TopOfBookConcurrentReads) {
+    std::atomic<bool> done(false);
+
+    // Each step moves both sides together: bid at 1000 + i, ask at 3000 - i,
+    // each with size i + 1, so any consistent snapshot satisfies
+    // bid + ask == 4000 and both sizes == bid - 999
+    std::thread writer([this, &done] {
+        for (int i = 0; i < 500; ++i) {
+            Order bid(OrderId::fromString("b-" + std::to_string(i)), OrderSide::BUY,
+                      1000 + i, i + 1, std::chrono::nanoseconds(i));
+            Order ask(OrderId::fromString("a-" + std::to_string(i)), OrderSide::SELL,
+                      3000 - i, i + 1, std::chrono::nanoseconds(i));
+            book_->clear();
+            book_->addOrder(bid);
+            book_->addOrder(ask);
+        }
+        done = true;
+    });
+
+    uint64_t last_sequence = 0;
+    while (!done) {
+        TopOfBook top = book_->getTopOfBook();
+        EXPECT_GE(top.sequence, last_sequence);
+        last_sequence = top.sequence;
+
+        if (top.hasBid()) {
+            EXPECT_EQ(top.bid_size, top.bid_price - 999);
+        }
+        if (top.hasBid() && top.hasAsk()) {
+            EXPECT_EQ(top.bid_price + top.ask_price, 4000);
+            EXPECT_EQ(top.ask_size, top.bid_size);
+        }
+    }
+
+    writer.join();
+    EXPECT_EQ(book_->getSpread(), 3000 - 499 - (1000 + 499));
+}
+
 // Test getting bid and ask levels
 TEST_F(OrderBookTests, GetLevels) {
     EXPECT_TRUE(book_->addOrder(bid1_));
@@ -196,30 +314,114 @@ TEST_F(OrderBookTests, GetLevels) {
     
     auto bid_levels = book_->getBidLevels(10);
     EXPECT_EQ(bid_levels.size(), 2);
-    EXPECT_DOUBLE_EQ(bid_levels[0].first, 100.0);
-    EXPECT_DOUBLE_EQ(bid_levels[0].second, 1.5);
-    EXPECT_DOUBLE_EQ(bid_levels[1].first, 99.0);
-    EXPECT_DOUBLE_EQ(bid_levels[1].second, 2.5);
+    EXPECT_EQ(bid_levels[0].first, px(100.0));
+    EXPECT_EQ(bid_levels[0].second, qty(1.5));
+    EXPECT_EQ(bid_levels[1].first, px(99.0));
+    EXPECT_EQ(bid_levels[1].second, qty(2.5));
     
     auto ask_levels = book_->getAskLevels(10);
     EXPECT_EQ(ask_levels.size(), 2);
-    EXPECT_DOUBLE_EQ(ask_levels[0].first, 101.0);
-    EXPECT_DOUBLE_EQ(ask_levels[0].second, 1.0);
-    EXPECT_DOUBLE_EQ(ask_levels[1].first, 102.0);
-    EXPECT_DOUBLE_EQ(ask_levels[1].second, 2.0);
+    EXPECT_EQ(ask_levels[0].first, px(101.0));
+    EXPECT_EQ(ask_levels[0].second, qty(1.0));
+    EXPECT_EQ(ask_levels[1].first, px(102.0));
+    EXPECT_EQ(ask_levels[1].second, qty(2.0));
+}
+
+// Test that prices parsed from feed strings land on exact, shared levels
+TEST_F(OrderBookTests, DecimalPricesShareLevel) {
+    Price a = 0;
+    Price b = 0;
+    ASSERT_TRUE(kScale.parsePrice("65000.01", a));
+    ASSERT_TRUE(kScale.parsePrice("65000.010", b));
+    EXPECT_EQ(a, b);
+
+    // 0.1 + 0.2 style drift used to split these into two levels
+    EXPECT_TRUE(book_->addOrder(Order(OrderId::fromString("x-1"), OrderSide::SELL, a, qty(0.1),
+                                      std::chrono::nanoseconds(0))));
+    EXPECT_TRUE(book_->addOrder(Order(OrderId::fromString("x-2"), OrderSide::SELL,
+                                      px(65000.0) + px(0.01), qty(0.2),
+                                      std::chrono::nanoseconds(0))));
+    EXPECT_EQ(book_->getAskLevelCount(), 1);
+    EXPECT_EQ(book_->getAskLevels(1)[0].second, qty(0.3));
 }
 
 // Test processing L3 updates
 TEST_F(OrderBookTests, ProcessL3Update) {
     // Process an open order
-    book_->processL3Update("open", "bid-1", OrderSide::BUY, 100.0, 1.5);
+    book_->processL3Update("open", OrderId::fromString("bid-1"), OrderSide::BUY, px(100.0), qty(1.5));
     EXPECT_EQ(book_->getOrderCount(), 1);
-    EXPECT_DOUBLE_EQ(book_->getBestBid(), 100.0);
+    EXPECT_EQ(book_->getBestBid(), px(100.0));
     
     // Process a done order
-    book_->processL3Update("done", "bid-1", OrderSide::BUY, 0.0, 0.0);
+    book_->processL3Update("done", OrderId::fromString("bid-1"), OrderSide::BUY, 0, 0);
     EXPECT_EQ(book_->getOrderCount(), 0);
-    EXPECT_DOUBLE_EQ(book_->getBestBid(), 0.0);
+    EXPECT_EQ(book_->getBestBid(), px(0.0));
+}
+
+// Test applying an L2 change set as one batch
+TEST_F(OrderBookTests, ApplyUpdatesBatch) {
+    std::vector<LevelUpdate> changes = {
+        {OrderSide::BUY, px(100.0), qty(1.0), OrderId()},
+        {OrderSide::BUY, px(99.0), qty(2.0), OrderId()},
+        {OrderSide::SELL, px(101.0), qty(3.0), OrderId()},
+    };
+    EXPECT_EQ(book_->applyUpdates(changes.data(), changes.size()), 3u);
+    EXPECT_EQ(book_->getBidLevelCount(), 2);
+    EXPECT_EQ(book_->getTopOfBook().sequence, 1u);
+
+    // Resize, remove, and remove a level that is not there
+    changes = {
+        {OrderSide::BUY, px(100.0), qty(4.0), OrderId()},
+        {OrderSide::BUY, px(99.0), 0, OrderId()},
+        {OrderSide::SELL, px(105.0), 0, OrderId()},
+    };
+    EXPECT_EQ(book_->applyUpdates(changes.data(), changes.size()), 2u);
+    EXPECT_EQ(book_->getTopOfBook().sequence, 2u);
+    EXPECT_EQ(book_->getBidLevels(5), (std::vector<std::pair<Price, Quantity>>{{px(100.0), qty(4.0)}}));
+    EXPECT_EQ(book_->getBestAsk(), px(101.0));
+
+    // Nothing changed, nothing published
+    EXPECT_EQ(book_->applyUpdates(changes.data() + 2, 1), 0u);
+    EXPECT_EQ(book_->getTopOfBook().sequence, 2u);
+}
+
+// Test replacing the book from a snapshot
+TEST_F(OrderBookTests, LoadSnapshot) {
+    EXPECT_TRUE(book_->addOrder(bid1_));
+
+    // L3 levels: two orders share 99.00; zero sizes and repeated IDs skipped
+    std::vector<LevelUpdate> levels = {
+        {OrderSide::BUY, px(99.5), qty(1.0), OrderId::fromString("b-1")},
+        {OrderSide::BUY, px(99.0), qty(2.0), OrderId::fromString("b-2")},
+        {OrderSide::BUY, px(99.0), qty(0.5), OrderId::fromString("b-3")},
+        {OrderSide::BUY, px(98.0), 0, OrderId::fromString("b-4")},
+        {OrderSide::SELL, px(101.0), qty(1.0), OrderId::fromString("a-1")},
+        {OrderSide::SELL, px(102.0), qty(1.0), OrderId::fromString("a-1")},
+    };
+    book_->loadSnapshot(levels.data(), levels.size());
+
+    EXPECT_EQ(book_->getTopOfBook().sequence, 2u);
+    EXPECT_FALSE(book_->getOrder(OrderId::fromString("bid-1")).has_value());
+    EXPECT_EQ(book_->getOrderCount(), 4);
+    EXPECT_EQ(book_->getBidLevels(5), (std::vector<std::pair<Price, Quantity>>{
+        {px(99.5), qty(1.0)}, {px(99.0), qty(2.5)}}));
+    EXPECT_EQ(book_->getAskLevels(5), (std::vector<std::pair<Price, Quantity>>{{px(101.0), qty(1.0)}}));
+
+    // Levels out of best-first order still land in the right place
+    std::vector<LevelUpdate> unsorted = {
+        {OrderSide::SELL, px(103.0), qty(1.0), OrderId()},
+        {OrderSide::BUY, px(97.0), qty(1.0), OrderId()},
+        {OrderSide::SELL, px(101.0), qty(2.0), OrderId()},
+        {OrderSide::BUY, px(98.0), qty(2.0), OrderId()},
+    };
+    book_->loadSnapshot(unsorted.data(), unsorted.size());
+    EXPECT_EQ(book_->getBestBid(), px(98.0));
+    EXPECT_EQ(book_->getBestAsk(), px(101.0));
+    EXPECT_EQ(book_->getAskLevels(5), (std::vector<std::pair<Price, Quantity>>{
+        {px(101.0), qty(2.0)}, {px(103.0), qty(1.0)}}));
+
+    // Level IDs resolve for later L2 updates
+    EXPECT_TRUE(book_->modifyOrder(OrderId::level(OrderSide::BUY, px(97.0)), qty(5.0)));
 }
 
 int main(int argc, char **argv) {
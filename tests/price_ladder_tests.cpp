@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "orderbook/order_book.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+Order ladderOrder(int id, OrderSide side, Price price, Quantity size) {
+    return Order(OrderId::fromString("o-" + std::to_string(id)), side, price, size,
+                 std::chrono::nanoseconds(id));
+}
+
+} // namespace
+
+// Test that the ladder follows the touch and spills far levels into overflow
+TEST(PriceLadderTests, RecentersAndSpills) {
+    SlabArena arena;
+    PriceLadder<OrderSide::BUY> bids(&arena);
+
+    Order a = ladderOrder(1, OrderSide::BUY, 100000, 1);
+    Order b = ladderOrder(2, OrderSide::BUY, 99000, 2);
+    bids.getOrCreate(a.getPrice()).addOrder(a);
+    bids.getOrCreate(b.getPrice()).addOrder(b);
+    EXPECT_EQ(bids.windowLevelCount(), 2);
+    EXPECT_EQ(bids.best()->getPrice(), 100000);
+
+    // A far worse bid goes straight to overflow
+    Order deep = ladderOrder(3, OrderSide::BUY, 50000, 3);
+    bids.getOrCreate(deep.getPrice()).addOrder(deep);
+    EXPECT_EQ(bids.windowLevelCount(), 2);
+    EXPECT_EQ(bids.size(), 3);
+
+    // A much better bid moves the window; the old levels spill out intact
+    Order touch = ladderOrder(4, OrderSide::BUY, 110000, 4);
+    bids.getOrCreate(touch.getPrice()).addOrder(touch);
+    EXPECT_EQ(bids.windowLevelCount(), 1);
+    EXPECT_EQ(bids.size(), 4);
+    EXPECT_EQ(bids.best()->getPrice(), 110000);
+    ASSERT_NE(bids.find(100000), nullptr);
+    EXPECT_EQ(bids.find(100000)->front(), &a);
+
+    std::vector<Price> prices;
+    bids.forEach(10, [&prices](const PriceLevel& level) { prices.push_back(level.getPrice()); });
+    EXPECT_EQ(prices, (std::vector<Price>{110000, 100000, 99000, 50000}));
+
+    // Removing the touch falls back to the best overflow level
+    bids.removeOrder(touch);
+    EXPECT_EQ(bids.best()->getPrice(), 100000);
+
+    bids.clear();
+    EXPECT_TRUE(bids.empty());
+    EXPECT_FALSE(a.isQueued());
+}
+
+// Test that the ladder book agrees with the map book under random churn
+TEST(PriceLadderTests, MatchesMapBook) {
+    const ProductScale scale(2, 8);
+    OrderBook map_book("TEST", scale);
+    LadderOrderBook ladder_book("TEST", scale);
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> action_dist(0, 9);
+    std::normal_distribution<double> offset_dist(0.0, 1500.0);
+    std::uniform_int_distribution<Quantity> size_dist(1, 1000);
+
+    // Mid drifts so the window has to move, and the wide offsets keep the
+    // overflow map populated on both sides
+    Price mid = 1000000;
+    std::vector<OrderId> live;
+    int next_id = 0;
+
+    for (int step = 0; step < 20000; ++step) {
+        mid += (step % 500 == 0) ? 3000 : 0;
+        int action = action_dist(rng);
+
+        if (action < 6 || live.empty()) {
+            OrderSide side = (action % 2 == 0) ? OrderSide::BUY : OrderSide::SELL;
+            Price offset = 1 + static_cast<Price>(std::abs(offset_dist(rng)));
+            Price price = side == OrderSide::BUY ? mid - offset : mid + offset;
+            Order order = ladderOrder(next_id++, side, price, size_dist(rng));
+            EXPECT_EQ(map_book.addOrder(order), ladder_book.addOrder(order));
+            live.push_back(order.getId());
+        } else {
+            size_t index = static_cast<size_t>(rng()) % live.size();
+            if (action < 8) {
+                Quantity size = size_dist(rng);
+                EXPECT_EQ(map_book.modifyOrder(live[index], size),
+                          ladder_book.modifyOrder(live[index], size));
+            } else {
+                EXPECT_EQ(map_book.removeOrder(live[index]), ladder_book.removeOrder(live[index]));
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+
+        ASSERT_EQ(map_book.getBestBid(), ladder_book.getBestBid()) << "step " << step;
+        ASSERT_EQ(map_book.getBestAsk(), ladder_book.getBestAsk()) << "step " << step;
+        ASSERT_EQ(map_book.getBidLevelCount(), ladder_book.getBidLevelCount()) << "step " << step;
+        ASSERT_EQ(map_book.getAskLevelCount(), ladder_book.getAskLevelCount()) << "step " << step;
+        if (step % 100 == 0) {
+            ASSERT_EQ(map_book.getBidLevels(200), ladder_book.getBidLevels(200)) << "step " << step;
+            ASSERT_EQ(map_book.getAskLevels(200), ladder_book.getAskLevels(200)) << "step " << step;
+        }
+    }
+
+    map_book.clear();
+    ladder_book.clear();
+    EXPECT_EQ(ladder_book.getOrderCount(), 0);
+    EXPECT_EQ(ladder_book.getBidLevelCount(), 0);
+}
+
+// Test that a deep snapshot loads identically into both books, whether or
+// not it arrives best-first
+TEST(PriceLadderTests, LoadSnapshotMatchesMapBook) {
+    const ProductScale scale(2, 8);
+    OrderBook map_book("TEST", scale);
+    LadderOrderBook ladder_book("TEST", scale);
+
+    // Deep enough that most levels spill into the ladder's overflow map
+    std::vector<LevelUpdate> levels;
+    for (Price i = 0; i < 20000; ++i) {
+        levels.push_back({OrderSide::BUY, 1000000 - 3 * i, 1 + i % 17, OrderId()});
+    }
+    for (Price i = 0; i < 20000; ++i) {
+        levels.push_back({OrderSide::SELL, 1000001 + 2 * i, 1 + i % 13, OrderId()});
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) {
+            std::mt19937 rng(11);
+            std::shuffle(levels.begin(), levels.end(), rng);
+        }
+
+        map_book.loadSnapshot(levels.data(), levels.size());
+        ladder_book.loadSnapshot(levels.data(), levels.size());
+
+        ASSERT_EQ(map_book.getBidLevelCount(), 20000u);
+        ASSERT_EQ(ladder_book.getAskLevelCount(), 20000u);
+        EXPECT_EQ(ladder_book.getBestBid(), 1000000);
+        EXPECT_EQ(ladder_book.getBestAsk(), 1000001);
+        EXPECT_EQ(map_book.getBidLevels(30000), ladder_book.getBidLevels(30000));
+        EXPECT_EQ(map_book.getAskLevels(30000), ladder_book.getAskLevels(30000));
+    }
+}
@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+#include "utils/published.h"
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace clunk;
+
+// Test that readers see each published value, per instance
+TEST(PublishedTests, ReadsLatestValue) {
+    Published<std::string> first(std::make_shared<const std::string>("a"));
+    Published<std::string> second(std::make_shared<const std::string>("x"));
+
+    EXPECT_EQ(first.get(), "a");
+    EXPECT_EQ(second.get(), "x");
+
+    first.publish(std::make_shared<const std::string>("b"));
+    EXPECT_EQ(first.get(), "b");
+    EXPECT_EQ(second.get(), "x");
+    EXPECT_EQ(*first.load(), "b");
+
+    // Another thread has a cache of its own
+    std::string seen;
+    std::thread reader([&first, &seen]() { seen = first.get(); });
+    reader.join();
+    EXPECT_EQ(seen, "b");
+
+    // A new instance never reuses a dead one's cached value
+    second.publish(std::make_shared<const std::string>("y"));
+    EXPECT_EQ(second.get(), "y");
+    auto third = std::make_unique<Published<std::string>>(std::make_shared<const std::string>("z"));
+    EXPECT_EQ(third->get(), "z");
+}
@@ -0,0 +1,22 @@
+#include <gtest/gtest.h>
+#include "network/reconnect_policy.h"
+
+using namespace clunk;
+using std::chrono::milliseconds;
+
+// Test that the backoff doubles per failure and saturates at the cap
+TEST(ReconnectPolicyTests, ExponentialBackoff) {
+    ReconnectPolicy policy;
+    policy.initial_delay = milliseconds(50);
+    policy.max_delay = milliseconds(1000);
+
+    EXPECT_EQ(policy.delayFor(0), milliseconds(50));
+    EXPECT_EQ(policy.delayFor(1), milliseconds(100));
+    EXPECT_EQ(policy.delayFor(4), milliseconds(800));
+    EXPECT_EQ(policy.delayFor(5), milliseconds(1000));
+    EXPECT_EQ(policy.delayFor(1000000), milliseconds(1000));
+
+    // A cap below the initial delay wins
+    policy.max_delay = milliseconds(20);
+    EXPECT_EQ(policy.delayFor(0), milliseconds(20));
+}
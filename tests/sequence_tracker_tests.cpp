@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "feed_handlers/sequence_tracker.h"
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+// Test holding updates until the first snapshot, then replaying the newer ones
+TEST(SequenceTrackerTests, ReplaysUpdatesHeldForSnapshot) {
+    SequenceTracker tracker;
+    EXPECT_TRUE(tracker.isSyncing());
+
+    EXPECT_EQ(tracker.check(9, "m9"), SequenceCheck::BUFFERED);
+    EXPECT_EQ(tracker.check(10, "m10"), SequenceCheck::BUFFERED);
+    EXPECT_EQ(tracker.check(11, "m11"), SequenceCheck::BUFFERED);
+    EXPECT_EQ(tracker.check(12, "m12"), SequenceCheck::BUFFERED);
+    EXPECT_EQ(tracker.checkUnsequenced(), SequenceCheck::STALE);
+    EXPECT_EQ(tracker.getPendingCount(), 4u);
+
+    std::vector<std::string> replayed;
+    EXPECT_TRUE(tracker.onSnapshot(10, [&](std::string_view text) { replayed.emplace_back(text); }));
+    EXPECT_EQ(replayed, (std::vector<std::string>{"m11", "m12"}));
+    EXPECT_FALSE(tracker.isSyncing());
+    EXPECT_EQ(tracker.getLastSequence(), 12u);
+    EXPECT_EQ(tracker.getPendingCount(), 0u);
+
+    EXPECT_EQ(tracker.check(13, "m13"), SequenceCheck::APPLY);
+    EXPECT_EQ(tracker.check(13, "m13"), SequenceCheck::STALE);
+    EXPECT_EQ(tracker.checkUnsequenced(), SequenceCheck::APPLY);
+
+    const SequenceStats& stats = tracker.getStats();
+    EXPECT_EQ(stats.replayed, 2u);
+    EXPECT_EQ(stats.stale, 4u);     // m9, m10, the unsequenced message and the duplicate
+    EXPECT_EQ(stats.gaps, 0u);
+}
+
+// Test that a jump marks a gap and holds everything until a new snapshot
+TEST(SequenceTrackerTests, GapHoldsUntilSnapshot) {
+    SequenceTracker tracker;
+    tracker.onSnapshot(100, [](std::string_view) {});
+
+    EXPECT_EQ(tracker.check(101, "m101"), SequenceCheck::APPLY);
+    EXPECT_EQ(tracker.check(104, "m104"), SequenceCheck::GAP);
+    EXPECT_TRUE(tracker.isSyncing());
+    EXPECT_EQ(tracker.check(105, "m105"), SequenceCheck::BUFFERED);
+    EXPECT_EQ(tracker.getStats().gaps, 1u);
+    EXPECT_EQ(tracker.getStats().missed, 2u);
+
+    // A snapshot that still predates the gap leaves it unresolved
+    std::vector<std::string> replayed;
+    EXPECT_FALSE(tracker.onSnapshot(102, [&](std::string_view text) { replayed.emplace_back(text); }));
+    EXPECT_TRUE(replayed.empty());
+    EXPECT_TRUE(tracker.isSyncing());
+    EXPECT_EQ(tracker.getPendingCount(), 2u);
+    EXPECT_EQ(tracker.check(106, "m106"), SequenceCheck::BUFFERED);
+
+    // One covering it resumes from the held messages
+    EXPECT_TRUE(tracker.onSnapshot(104, [&](std::string_view text) { replayed.emplace_back(text); }));
+    EXPECT_EQ(replayed, (std::vector<std::string>{"m105", "m106"}));
+    EXPECT_EQ(tracker.check(107, "m107"), SequenceCheck::APPLY);
+}
+
+// Test snapshots without a sequence number and explicit resyncs
+TEST(SequenceTrackerTests, UnsequencedSnapshotsAndResync) {
+    SequenceTracker tracker;
+    tracker.check(50, "m50");
+
+    int replayed = 0;
+    EXPECT_TRUE(tracker.onSnapshot(0, [&](std::string_view) { ++replayed; }));
+    EXPECT_EQ(replayed, 0);
+    EXPECT_EQ(tracker.getPendingCount(), 0u);
+
+    // The next sequenced message sets the baseline
+    EXPECT_EQ(tracker.check(70, "m70"), SequenceCheck::APPLY);
+    EXPECT_EQ(tracker.check(71, "m71"), SequenceCheck::APPLY);
+
+    EXPECT_TRUE(tracker.beginResync());
+    EXPECT_FALSE(tracker.beginResync());
+    EXPECT_EQ(tracker.check(72, "m72"), SequenceCheck::BUFFERED);
+    EXPECT_EQ(tracker.checkUnsequenced(), SequenceCheck::STALE);
+}
+
+// Test that an overflowing buffer is discarded and the gap caught on replay
+TEST(SequenceTrackerTests, OverflowForcesAnotherSnapshot) {
+    SequenceTracker tracker(4);
+    for (uint64_t sequence = 1; sequence <= 6; ++sequence) {
+        EXPECT_EQ(tracker.check(sequence, "m"), SequenceCheck::BUFFERED);
+    }
+    EXPECT_EQ(tracker.getStats().overflows, 1u);
+    EXPECT_EQ(tracker.getPendingCount(), 2u);
+
+    // Messages 2-4 were dropped with the buffer
+    EXPECT_FALSE(tracker.onSnapshot(1, [](std::string_view) {}));
+    EXPECT_TRUE(tracker.isSyncing());
+    EXPECT_TRUE(tracker.onSnapshot(4, [](std::string_view) {}));
+    EXPECT_EQ(tracker.getLastSequence(), 6u);
+}
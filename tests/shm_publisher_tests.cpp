@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "gateway/shm_publisher.h"
+#include "gateway/shm_reader.h"
+#include "orderbook/level_book.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace clunk;
+
+namespace {
+
+// Region name unique to this test process
+std::string regionName(const char* test) {
+    return "/clunk_test_" + std::string(test) + "_" + std::to_string(::getpid());
+}
+
+} // namespace
+
+// Test suite for publishing books to another process's view of them
+class ShmPublisherTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        book_->setLevel(OrderSide::BUY, 100, 5);
+        book_->setLevel(OrderSide::BUY, 99, 4);
+        book_->setLevel(OrderSide::SELL, 101, 2);
+    }
+
+    std::shared_ptr<LevelBook> book_ = std::make_shared<LevelBook>("BTC-USD", ProductScale(2, 8));
+};
+
+// Test that a reader sees the published touch and depth, republished only
+// when the book changes
+TEST_F(ShmPublisherTests, ReaderSeesPublishedBook) {
+    ShmPublisher publisher(regionName("book"), 2, 4);
+    ASSERT_TRUE(publisher.addBook("BTC-USD", book_));
+    EXPECT_FALSE(publisher.addBook("BTC-USD", book_));
+    EXPECT_FALSE(publisher.addBook(std::string(kShmSymbolSize, 'X'), book_));
+    EXPECT_EQ(publisher.publish(), 1u);
+    EXPECT_EQ(publisher.publish(), 0u);
+
+    ShmBookReader reader(publisher.getName());
+    ASSERT_EQ(reader.getProductCount(), 1u);
+    EXPECT_EQ(reader.findProduct("ETH-USD"), -1);
+    int index = reader.findProduct("BTC-USD");
+    ASSERT_EQ(index, 0);
+    EXPECT_EQ(reader.getPriceDecimals(index), 2);
+    EXPECT_EQ(reader.getSizeDecimals(index), 8);
+    EXPECT_EQ(reader.getDepth(), 2u);
+    EXPECT_NE(reader.getHeartbeatNanos(), 0u);
+
+    ShmQuote quote;
+    ASSERT_TRUE(reader.readQuote(index, quote));
+    EXPECT_EQ(quote.bid_price, 100);
+    EXPECT_EQ(quote.bid_size, 5);
+    EXPECT_EQ(quote.ask_price, 101);
+    EXPECT_EQ(quote.sequence, book_->getTopOfBook().sequence);
+
+    ShmDepth depth;
+    ASSERT_TRUE(reader.readDepth(index, depth));
+    ASSERT_EQ(depth.bid_count, 2u);
+    ASSERT_EQ(depth.ask_count, 1u);
+    EXPECT_EQ(depth.bid_prices[1], 99);
+    EXPECT_EQ(depth.bid_sizes[1], 4);
+
+    // A level going away clears its row
+    book_->setLevel(OrderSide::BUY, 100, 0);
+    EXPECT_EQ(publisher.publish(), 1u);
+    ASSERT_TRUE(reader.readQuote(index, quote));
+    EXPECT_EQ(quote.bid_price, 99);
+    ASSERT_TRUE(reader.readDepth(index, depth));
+    EXPECT_EQ(depth.bid_count, 1u);
+    EXPECT_EQ(depth.bid_prices[1], 0);
+
+    ShmPublisherStats stats = publisher.getStats();
+    EXPECT_EQ(stats.passes, 3u);
+    EXPECT_EQ(stats.quotes, 2u);
+    EXPECT_EQ(stats.depths, 2u);
+}
+
+// Test that readers polling a running publisher only ever see whole books
+TEST_F(ShmPublisherTests, ConcurrentReadsAreConsistent) {
+    ShmPublisher publisher(regionName("concurrent"), 4, 1);
+    ASSERT_TRUE(publisher.addBook("BTC-USD", book_));
+    publisher.start(std::chrono::microseconds(0));
+
+    // Every bid level is set to the same size in turn, so a torn copy shows
+    // up as levels far apart
+    std::atomic<bool> done{false};
+    std::thread writer([this, &done]() {
+        for (Quantity size = 1; size <= 2000; ++size) {
+            for (Price price = 96; price <= 99; ++price) {
+                book_->setLevel(OrderSide::BUY, price, size);
+            }
+            book_->setLevel(OrderSide::BUY, 100, size);
+        }
+        done = true;
+    });
+
+    ShmBookReader reader(publisher.getName());
+    ShmDepth depth;
+    size_t reads = 0;
+    while (!done || reads == 0) {
+        ASSERT_TRUE(reader.readDepth(0, depth));
+        if (depth.bid_count < 4) {
+            continue;
+        }
+
+        // Captured under the book lock, so at most one level behind the rest
+        ASSERT_LE(depth.bid_sizes[3], depth.bid_sizes[0] + 1);
+        ASSERT_GE(depth.bid_sizes[3], depth.bid_sizes[0] - 1);
+        ++reads;
+    }
+    writer.join();
+    publisher.stop();
+    EXPECT_GT(reads, 0u);
+}
+
+// Test that opening a missing region fails cleanly
+TEST(ShmBookReaderTests, MissingRegionThrows) {
+    EXPECT_THROW(ShmBookReader(regionName("missing")), std::runtime_error);
+}
@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include "backtest/simulated_execution.h"
+#include "feed_handlers/capture_log.h"
+#include "feed_handlers/replay_feed_handler.h"
+#include "orderbook/level_book.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+// Capture file in the test's working directory, removed afterwards
+class TempCapture {
+public:
+    explicit TempCapture(const std::string& name) : path_(name + ".clunkcap") {}
+    ~TempCapture() { std::remove(path_.c_str()); }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+} // namespace
+
+// Test suite for simulated fills against an aggregated book
+class SimulatedExecutionTests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        book_->setLevel(OrderSide::BUY, 100, 5);
+        book_->setLevel(OrderSide::BUY, 99, 4);
+        book_->setLevel(OrderSide::SELL, 101, 2);
+        book_->setLevel(OrderSide::SELL, 102, 3);
+        simulation_ = std::make_unique<SimulatedExecution>(book_);
+        simulation_->setFillCallback([this](const SimulatedFill& fill) { fills_.push_back(fill); });
+    }
+
+    std::shared_ptr<LevelBook> book_ = std::make_shared<LevelBook>("TEST", ProductScale(2, 8));
+    std::unique_ptr<SimulatedExecution> simulation_;
+    std::vector<SimulatedFill> fills_;
+};
+
+// Test that a resting order fills only once the volume ahead has traded
+TEST_F(SimulatedExecutionTests, TradesConsumeQueueAhead) {
+    uint64_t id = simulation_->place(OrderSide::BUY, 100, 3);
+    ASSERT_EQ(simulation_->getOrder(id)->status, SimulatedStatus::RESTING);
+    EXPECT_EQ(simulation_->getOrder(id)->queue_ahead, 5);
+    EXPECT_TRUE(fills_.empty());
+
+    simulation_->onTrade(Trade{OrderSide::BUY, 100, 4});
+    EXPECT_EQ(simulation_->getOrder(id)->queue_ahead, 1);
+    EXPECT_TRUE(fills_.empty());
+
+    // Trades on the other side or at worse prices never reach it
+    simulation_->onTrade(Trade{OrderSide::SELL, 101, 10});
+    simulation_->onTrade(Trade{OrderSide::BUY, 101, 10});
+    EXPECT_TRUE(fills_.empty());
+
+    simulation_->onTrade(Trade{OrderSide::BUY, 100, 3});
+    ASSERT_EQ(fills_.size(), 1u);
+    EXPECT_EQ(fills_[0].order_id, id);
+    EXPECT_EQ(fills_[0].price, 100);
+    EXPECT_EQ(fills_[0].size, 2);
+    EXPECT_EQ(fills_[0].remaining, 1);
+    EXPECT_TRUE(fills_[0].passive);
+    EXPECT_EQ(simulation_->getOrder(id)->queue_ahead, 0);
+
+    simulation_->onTrade(Trade{OrderSide::BUY, 100, 5});
+    EXPECT_EQ(simulation_->getOrder(id)->status, SimulatedStatus::FILLED);
+    EXPECT_EQ(simulation_->getRestingCount(), 0u);
+    EXPECT_EQ(simulation_->getStats().passive_fills, 2u);
+    EXPECT_EQ(simulation_->getStats().trades, 5u);
+}
+
+// Test that the level shrinking below an order's position moves it up
+TEST_F(SimulatedExecutionTests, CancelsAheadAdvanceQueue) {
+    uint64_t id = simulation_->place(OrderSide::BUY, 100, 1);
+
+    // Cancels while the level stays above the position are taken as behind
+    book_->setLevel(OrderSide::BUY, 100, 6);
+    book_->setLevel(OrderSide::BUY, 100, 5);
+    simulation_->sync();
+    EXPECT_EQ(simulation_->getOrder(id)->queue_ahead, 5);
+
+    book_->setLevel(OrderSide::BUY, 100, 2);
+    simulation_->sync();
+    EXPECT_EQ(simulation_->getOrder(id)->queue_ahead, 2);
+
+    // A resync re-reads the level
+    std::vector<LevelUpdate> levels = {{OrderSide::BUY, 100, 1, OrderId()}, {OrderSide::SELL, 101, 1, OrderId()}};
+    book_->loadSnapshot(levels.data(), levels.size());
+    simulation_->sync();
+    EXPECT_EQ(simulation_->getOrder(id)->queue_ahead, 1);
+    EXPECT_EQ(simulation_->getStats().resyncs, 1u);
+}
+
+// Test that a trade through an order's price fills all of it
+TEST_F(SimulatedExecutionTests, TradeThroughFillsOrder) {
+    uint64_t id = simulation_->place(OrderSide::SELL, 103, 2);
+    EXPECT_EQ(simulation_->getOrder(id)->queue_ahead, 0);
+
+    simulation_->onTrade(Trade{OrderSide::SELL, 104, 1});
+    ASSERT_EQ(fills_.size(), 1u);
+    EXPECT_EQ(fills_[0].price, 103);
+    EXPECT_EQ(fills_[0].size, 2);
+    EXPECT_EQ(simulation_->getOrder(id)->status, SimulatedStatus::FILLED);
+
+    // Cancelled orders never fill
+    uint64_t cancelled = simulation_->place(OrderSide::SELL, 103, 1);
+    EXPECT_TRUE(simulation_->cancel(cancelled));
+    EXPECT_FALSE(simulation_->cancel(cancelled));
+    simulation_->onTrade(Trade{OrderSide::SELL, 104, 1});
+    EXPECT_EQ(fills_.size(), 1u);
+}
+
+// Test that marketable orders take the opposite side per time in force
+TEST_F(SimulatedExecutionTests, MarketableOrdersSweepBook) {
+    uint64_t ioc = simulation_->place(OrderSide::BUY, 102, 6, TimeInForce::IOC);
+    ASSERT_EQ(fills_.size(), 2u);
+    EXPECT_EQ(fills_[0].price, 101);
+    EXPECT_EQ(fills_[0].size, 2);
+    EXPECT_EQ(fills_[1].price, 102);
+    EXPECT_EQ(fills_[1].size, 3);
+    EXPECT_FALSE(fills_[1].passive);
+    EXPECT_EQ(simulation_->getOrder(ioc)->filled, 5);
+    EXPECT_EQ(simulation_->getOrder(ioc)->status, SimulatedStatus::CANCELLED);
+
+    // The replayed book is left alone
+    EXPECT_EQ(book_->getLevelSize(OrderSide::SELL, 101), 2);
+
+    uint64_t fok = simulation_->place(OrderSide::SELL, 100, 6, TimeInForce::FOK);
+    EXPECT_EQ(simulation_->getOrder(fok)->status, SimulatedStatus::REJECTED);
+    EXPECT_EQ(fills_.size(), 2u);
+
+    // A GTC remainder rests behind the level it joins
+    uint64_t gtc = simulation_->place(OrderSide::SELL, 100, 7);
+    EXPECT_EQ(simulation_->getOrder(gtc)->filled, 5);
+    EXPECT_EQ(simulation_->getOrder(gtc)->status, SimulatedStatus::RESTING);
+    EXPECT_EQ(simulation_->getOrder(gtc)->queue_ahead, 0);
+    EXPECT_EQ(simulation_->getStats().orders, 3u);
+    EXPECT_EQ(simulation_->getStats().rejected, 1u);
+}
+
+// Test that orders at one price share a trade in placement order
+TEST_F(SimulatedExecutionTests, TradeSizeSharedAcrossOrders) {
+    book_->setLevel(OrderSide::BUY, 100, 0);
+    uint64_t first = simulation_->place(OrderSide::BUY, 100, 2);
+    uint64_t second = simulation_->place(OrderSide::BUY, 100, 2);
+    EXPECT_EQ(simulation_->getOrder(second)->queue_ahead, 0);
+
+    simulation_->onTrade(Trade{OrderSide::BUY, 100, 1});
+    ASSERT_EQ(fills_.size(), 1u);
+    EXPECT_EQ(fills_[0].order_id, first);
+    EXPECT_EQ(fills_[0].size, 1);
+    EXPECT_EQ(simulation_->getOrder(second)->filled, 0);
+
+    // What the first order leaves of a trade reaches the second
+    simulation_->onTrade(Trade{OrderSide::BUY, 100, 2});
+    ASSERT_EQ(fills_.size(), 3u);
+    EXPECT_EQ(fills_[1].order_id, first);
+    EXPECT_EQ(fills_[1].size, 1);
+    EXPECT_EQ(fills_[2].order_id, second);
+    EXPECT_EQ(fills_[2].size, 1);
+    EXPECT_EQ(simulation_->getStats().filled, 3);
+}
+
+// Test that back-to-back sweeps do not take the same liquidity twice
+TEST_F(SimulatedExecutionTests, SweepsConsumeLiquidity) {
+    uint64_t first = simulation_->place(OrderSide::BUY, 101, 2, TimeInForce::IOC);
+    uint64_t second = simulation_->place(OrderSide::BUY, 101, 2, TimeInForce::IOC);
+    EXPECT_EQ(simulation_->getOrder(first)->filled, 2);
+    EXPECT_EQ(simulation_->getOrder(second)->filled, 0);
+    EXPECT_EQ(simulation_->getOrder(second)->status, SimulatedStatus::CANCELLED);
+
+    // A FOK only counts what is left, and a deeper sweep skips the taken level
+    uint64_t fok = simulation_->place(OrderSide::BUY, 102, 4, TimeInForce::FOK);
+    EXPECT_EQ(simulation_->getOrder(fok)->status, SimulatedStatus::REJECTED);
+    uint64_t deeper = simulation_->place(OrderSide::BUY, 102, 5, TimeInForce::IOC);
+    ASSERT_EQ(fills_.size(), 2u);
+    EXPECT_EQ(fills_[1].order_id, deeper);
+    EXPECT_EQ(fills_[1].price, 102);
+    EXPECT_EQ(fills_[1].size, 3);
+
+    // Once the venue updates the level, its new size is what is available
+    book_->setLevel(OrderSide::SELL, 101, 4);
+    uint64_t refreshed = simulation_->place(OrderSide::BUY, 101, 5, TimeInForce::IOC);
+    EXPECT_EQ(simulation_->getOrder(refreshed)->filled, 4);
+    EXPECT_EQ(simulation_->getStats().filled, 9);
+}
+
+// Test that a replayed full-channel session fills a strategy's order from
+// the venue's matches
+TEST(SimulatedReplayTests, MatchesDriveFills) {
+    TempCapture file("simulated_replay");
+    {
+        CaptureWriter writer(file.path());
+        writer.append(1000, 0,
+            R"({"type":"snapshot","product_id":"BTC-USD","sequence":10,)"
+            R"("bids":[["100.00","2","m1"]],"asks":[["101.00","1","a1"]]})");
+        writer.append(2000, 0,
+            R"({"type":"open","product_id":"BTC-USD","sequence":11,"order_id":"m2","side":"buy",)"
+            R"("price":"100.00","size":"1"})");
+        writer.append(3000, 0,
+            R"({"type":"match","product_id":"BTC-USD","sequence":12,"maker_order_id":"m1",)"
+            R"("side":"buy","price":"100.00","size":"1"})");
+        writer.append(4000, 0,
+            R"({"type":"match","product_id":"BTC-USD","sequence":13,"maker_order_id":"m1",)"
+            R"("side":"buy","price":"100.00","size":"1"})");
+        writer.append(5000, 0,
+            R"({"type":"match","product_id":"BTC-USD","sequence":14,"maker_order_id":"m2",)"
+            R"("side":"buy","price":"100.00","size":"1"})");
+        writer.append(6000, 0,
+            R"({"type":"open","product_id":"BTC-USD","sequence":15,"order_id":"m3","side":"buy",)"
+            R"("price":"99.00","size":"5"})");
+        writer.append(7000, 0,
+            R"({"type":"match","product_id":"BTC-USD","sequence":16,"maker_order_id":"m3",)"
+            R"("side":"buy","price":"99.00","size":"1"})");
+    }
+
+    ReplayFeedHandler replay(file.path(), BookMode::ORDERS);
+    std::shared_ptr<SimulatedExecution> simulation = replay.simulate("BTC-USD");
+    EXPECT_EQ(replay.simulate("BTC-USD"), simulation);
+
+    // Join the bid at the first trade, behind everything resting there
+    uint64_t id = 0;
+    std::vector<Quantity> queue;
+    simulation->setTradeCallback([&](const Trade&) {
+        if (id == 0) {
+            const ProductScale& scale = simulation->getBook().getScale();
+            id = simulation->place(OrderSide::BUY, scale.toPrice(100.00), scale.toQuantity(2));
+        } else {
+            queue.push_back(simulation->getOrder(id)->queue_ahead);
+        }
+    });
+    std::vector<SimulatedFill> fills;
+    simulation->setFillCallback([&fills](const SimulatedFill& fill) { fills.push_back(fill); });
+
+    replay.connect();
+    replay.wait();
+
+    const ProductScale& scale = simulation->getBook().getScale();
+    ASSERT_NE(id, 0u);
+    ASSERT_EQ(queue.size(), 3u);
+    EXPECT_EQ(queue[0], scale.toQuantity(1));
+    EXPECT_EQ(queue[1], 0);
+
+    // Nothing filled until the 99.00 trade went through the order's price
+    ASSERT_EQ(fills.size(), 1u);
+    EXPECT_EQ(fills[0].price, scale.toPrice(100.00));
+    EXPECT_EQ(fills[0].size, scale.toQuantity(2));
+    EXPECT_EQ(simulation->getOrder(id)->status, SimulatedStatus::FILLED);
+    EXPECT_EQ(simulation->getStats().trades, 4u);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "utils/snapshot_buffer.h"
+#include "orderbook/level_book.h"
+#include "orderbook/order_book.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+// Write `value` into the next free slot; false if none was free
+bool publishValue(SnapshotBuffer<int>& buffer, int value) {
+    int* slot = buffer.beginWrite();
+    if (slot == nullptr) {
+        return false;
+    }
+    *slot = value;
+    buffer.publish();
+    return true;
+}
+
+} // namespace
+
+// Test that readers pin what they acquired while the writer moves on
+TEST(SnapshotBufferTests, HandlesPinTheirValue) {
+    SnapshotBuffer<int> buffer(2);
+    EXPECT_FALSE(buffer.acquire());
+
+    ASSERT_TRUE(publishValue(buffer, 1));
+    SnapshotBuffer<int>::Handle first = buffer.acquire();
+    ASSERT_TRUE(first);
+
+    ASSERT_TRUE(publishValue(buffer, 2));
+    SnapshotBuffer<int>::Handle second = buffer.acquire();
+    EXPECT_EQ(*first, 1);
+    EXPECT_EQ(*second, 2);
+
+    // Both slots are pinned (and one is current): nowhere to write
+    EXPECT_FALSE(publishValue(buffer, 3));
+    EXPECT_EQ(buffer.getSkippedCount(), 1u);
+    EXPECT_EQ(*buffer.acquire(), 2);
+
+    // Dropping a handle frees its slot for the writer
+    first = SnapshotBuffer<int>::Handle();
+    EXPECT_TRUE(publishValue(buffer, 3));
+    EXPECT_EQ(*buffer.acquire(), 3);
+    EXPECT_EQ(*second, 2);
+    EXPECT_EQ(buffer.getPublishedCount(), 3u);
+}
+
+// Test that books publish depth on their interval and on demand
+TEST(SnapshotBufferTests, BookPublishesDepth) {
+    LadderOrderBook book("TEST", ProductScale(2, 8));
+    EXPECT_FALSE(book.getPublishedDepth());
+    EXPECT_FALSE(book.publishDepth());
+
+    std::vector<LevelUpdate> levels = {
+        {OrderSide::BUY, 100, 1, OrderId()},
+        {OrderSide::BUY, 99, 2, OrderId()},
+        {OrderSide::BUY, 98, 3, OrderId()},
+        {OrderSide::SELL, 101, 4, OrderId()},
+    };
+    book.loadSnapshot(levels.data(), levels.size());
+
+    book.enableDepthPublishing(2, 3);
+    PublishedDepth depth = book.getPublishedDepth();
+    ASSERT_TRUE(depth);
+    EXPECT_EQ(depth->sequence, 1u);
+    ASSERT_EQ(depth->bids.size(), 2u);
+    EXPECT_EQ(depth->bids.prices[1], 99);
+    EXPECT_EQ(depth->asks.sizes[0], 4);
+    EXPECT_EQ(depth->bid_levels, 3u);
+    EXPECT_EQ(depth->ask_levels, 1u);
+    EXPECT_EQ(depth->orders, 4u);
+
+    // Two mutations: not due yet; the third publishes
+    LevelUpdate change{OrderSide::BUY, 100, 0, OrderId()};
+    book.applyUpdates(&change, 1);
+    change = {OrderSide::SELL, 102, 5, OrderId()};
+    book.applyUpdates(&change, 1);
+    EXPECT_EQ(book.getPublishedDepth()->sequence, 1u);
+    change = {OrderSide::SELL, 101, 0, OrderId()};
+    book.applyUpdates(&change, 1);
+
+    PublishedDepth latest = book.getPublishedDepth();
+    EXPECT_EQ(latest->sequence, 4u);
+    EXPECT_EQ(latest->bids.prices[0], 99);
+    EXPECT_EQ(latest->asks.prices[0], 102);
+
+    // The pinned older snapshot is untouched
+    EXPECT_EQ(depth->bids.prices[0], 100);
+
+    change = {OrderSide::BUY, 97, 1, OrderId()};
+    book.applyUpdates(&change, 1);
+    EXPECT_TRUE(book.publishDepth());
+    EXPECT_EQ(book.getPublishedDepth()->sequence, 5u);
+}
+
+// Test that readers racing the writer always see a snapshot from one book
+// state: each batch written here gives every level the same size
+TEST(SnapshotBufferTests, ReadersSeeWholeSnapshots) {
+    LevelBook book("TEST", ProductScale(2, 8));
+    book.enableDepthPublishing(5);
+
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                PublishedDepth depth = book.getPublishedDepth();
+                if (!depth) {
+                    continue;
+                }
+                for (size_t i = 0; i < depth->bids.size(); ++i) {
+                    if (depth->bids.sizes[i] != depth->bids.sizes[0]) {
+                        torn.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    for (Quantity size = 1; size <= 20000; ++size) {
+        std::vector<LevelUpdate> changes;
+        for (Price price = 100; price > 95; --price) {
+            changes.push_back({OrderSide::BUY, price, size, OrderId()});
+        }
+        book.applyUpdates(changes.data(), changes.size());
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(book.getPublishedDepth()->bids.sizes[0], 20000);
+}
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include "network/message_pipeline.h"
+#include "network/sharded_pipeline.h"
+#include "utils/spsc_queue.h"
+#include "utils/thread_utils.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace clunk;
+
+// Test that the ring rounds its capacity up, fills, and reuses slots in order
+TEST(SpscQueueTests, FillAndDrain) {
+    SpscQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4);
+    EXPECT_EQ(queue.front(), nullptr);
+
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_TRUE(queue.tryPush(lap * 10 + i));
+        }
+        EXPECT_FALSE(queue.tryPush(99));
+        EXPECT_EQ(queue.size(), 4);
+
+        for (int i = 0; i < 4; ++i) {
+            ASSERT_NE(queue.front(), nullptr);
+            EXPECT_EQ(*queue.front(), lap * 10 + i);
+            queue.pop();
+        }
+        EXPECT_TRUE(queue.empty());
+    }
+}
+
+// Test that values cross threads intact and in order
+TEST(SpscQueueTests, CrossThreadOrder) {
+    SpscQueue<std::string> queue(64);
+    const int count = 100000;
+
+    std::thread producer([&queue] {
+        for (int i = 0; i < count; ++i) {
+            std::string value = std::to_string(i);
+            while (!queue.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (int expected = 0; expected < count;) {
+        if (std::string* value = queue.front()) {
+            ASSERT_EQ(*value, std::to_string(expected));
+            queue.pop();
+            ++expected;
+        }
+    }
+
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
+// Test that the pipeline applies every payload in order on its worker, with
+// its receive stamps, and counts the back-pressure from a slow consumer
+TEST(MessagePipelineTests, DeliversInOrder) {
+    std::vector<std::string> seen;
+    std::vector<uint64_t> stamps;
+    std::thread::id worker_id;
+
+    MessagePipeline pipeline(4, [&](std::string_view payload, const MessageTiming& timing) {
+        worker_id = std::this_thread::get_id();
+        seen.emplace_back(payload);
+        stamps.push_back(timing.read);
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    });
+    pipeline.start();
+
+    for (int i = 0; i < 200; ++i) {
+        pipeline.push("msg-" + std::to_string(i), MessageTiming{static_cast<uint64_t>(i + 1), 0});
+    }
+    pipeline.stop();
+
+    ASSERT_EQ(seen.size(), 200);
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_EQ(seen[i], "msg-" + std::to_string(i));
+        EXPECT_EQ(stamps[i], static_cast<uint64_t>(i + 1));
+    }
+    EXPECT_NE(worker_id, std::this_thread::get_id());
+
+    PipelineStats stats = pipeline.getStats();
+    EXPECT_EQ(stats.enqueued, 200);
+    EXPECT_EQ(stats.processed, 200);
+    EXPECT_EQ(stats.depth, 0);
+    EXPECT_EQ(stats.capacity, 4);
+    EXPECT_LE(stats.max_depth, 4);
+    EXPECT_GT(stats.full_events, 0);
+}
+
+// Test that keys are spread over the shards and each key's payloads arrive
+// in order on one worker
+TEST(ShardedPipelineTests, RoutesKeysToOneWorkerEach) {
+    constexpr size_t kShards = 3;
+    std::vector<std::vector<std::string>> seen(kShards);
+    std::vector<std::thread::id> workers(kShards);
+
+    ShardedPipeline pipeline(kShards, 8, [&seen, &workers](size_t shard, std::string_view payload, const MessageTiming&) {
+        workers[shard] = std::this_thread::get_id();
+        seen[shard].emplace_back(payload);
+    });
+
+    const std::vector<std::string> keys = {"BTC-USD", "ETH-USD", "SOL-USD", "ETH-BTC"};
+    std::vector<size_t> shards;
+    for (const std::string& key : keys) {
+        shards.push_back(pipeline.assign(key));
+    }
+    EXPECT_EQ(shards, (std::vector<size_t>{0, 1, 2, 0}));
+    EXPECT_EQ(pipeline.assign("ETH-USD"), 1u);
+    EXPECT_EQ(pipeline.shardFor("SOL-USD"), 2u);
+    EXPECT_EQ(pipeline.shardFor("XRP-USD"), 0u);
+
+    pipeline.start();
+    for (int i = 0; i < 100; ++i) {
+        for (const std::string& key : keys) {
+            pipeline.push(key, key + "/" + std::to_string(i));
+        }
+    }
+    pipeline.push(std::string_view(), "control");
+    pipeline.stop();
+
+    // Shard 0 holds BTC-USD and ETH-BTC interleaved, then the unrouted payload
+    ASSERT_EQ(seen[0].size(), 201u);
+    EXPECT_EQ(seen[0][0], "BTC-USD/0");
+    EXPECT_EQ(seen[0][1], "ETH-BTC/0");
+    EXPECT_EQ(seen[0].back(), "control");
+    ASSERT_EQ(seen[2].size(), 100u);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(seen[2][i], "SOL-USD/" + std::to_string(i));
+    }
+    EXPECT_NE(workers[0], workers[1]);
+    EXPECT_NE(workers[1], workers[2]);
+
+    std::vector<ShardStats> stats = pipeline.getStats();
+    ASSERT_EQ(stats.size(), kShards);
+    EXPECT_EQ(stats[0].keys, 2u);
+    EXPECT_EQ(stats[0].pipeline.processed, 201u);
+    EXPECT_EQ(stats[1].pipeline.enqueued, 100u);
+    EXPECT_EQ(stats[2].cpu, -1);
+
+    // Freed slots are reused by the next key
+    pipeline.unassign("SOL-USD");
+    EXPECT_EQ(pipeline.shardFor("SOL-USD"), 0u);
+    EXPECT_EQ(pipeline.assign("ADA-USD"), 2u);
+}
+
+// Test that several producers can feed the same shard in multi-producer mode
+TEST(ShardedPipelineTests, AcceptsSeveralProducers) {
+    std::vector<std::string> seen;
+    ShardedPipeline pipeline(2, 4, [&seen](size_t shard, std::string_view payload, const MessageTiming&) {
+        if (shard == 1) {
+            seen.emplace_back(payload);
+        }
+    });
+    pipeline.assign("BTC-USD");
+    pipeline.assign("ETH-USD");
+    pipeline.setMultiProducer(true);
+    pipeline.start();
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 3; ++p) {
+        producers.emplace_back([&pipeline, p]() {
+            for (int i = 0; i < 500; ++i) {
+                pipeline.push(std::string_view("ETH-USD"), std::to_string(p) + ":" + std::to_string(i));
+            }
+        });
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    pipeline.stop();
+
+    // Every payload arrives once, and each producer's stay in order
+    ASSERT_EQ(seen.size(), 1500u);
+    std::vector<int> next(3, 0);
+    for (const std::string& payload : seen) {
+        int p = payload[0] - '0';
+        EXPECT_EQ(payload.substr(2), std::to_string(next[p]));
+        ++next[p];
+    }
+    EXPECT_EQ(pipeline.getStats()[1].pipeline.processed, 1500u);
+}
+
+// Test that routes can change while a producer is routing payloads
+TEST(ShardedPipelineTests, ReroutesWhileProducing) {
+    std::vector<size_t> btc_shards;
+    ShardedPipeline pipeline(2, 64, [&btc_shards](size_t shard, std::string_view payload, const MessageTiming&) {
+        if (payload == "BTC-USD") {
+            btc_shards.push_back(shard);
+        }
+    });
+    pipeline.assign("ETH-USD");
+    size_t btc = pipeline.assign("BTC-USD");
+    ASSERT_EQ(btc, 1u);
+    pipeline.start();
+
+    std::atomic<bool> done{false};
+    std::atomic<int> pushed{0};
+    std::thread producer([&pipeline, &done, &pushed]() {
+        while (!done.load(std::memory_order_relaxed)) {
+            pipeline.push(std::string_view("BTC-USD"), "BTC-USD");
+            pushed.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    for (int i = 0; i < 200 || pushed.load(std::memory_order_relaxed) < 1000; ++i) {
+        std::string key = "KEY-" + std::to_string(i);
+        pipeline.assign(key);
+        pipeline.getStats();
+        pipeline.unassign(key);
+    }
+    done.store(true, std::memory_order_relaxed);
+    producer.join();
+    pipeline.stop();
+
+    // Other keys coming and going never moved BTC-USD
+    ASSERT_FALSE(btc_shards.empty());
+    for (size_t shard : btc_shards) {
+        EXPECT_EQ(shard, btc);
+    }
+    EXPECT_EQ(pipeline.getStats()[0].keys, 1u);
+}
+
+// Test that only pinned shards get a NUMA node for their memory
+TEST(ShardedPipelineTests, PlacesPinnedShardsOnTheirNode) {
+    ShardedPipeline placed(2, 4, [](size_t, std::string_view, const MessageTiming&) {}, {0, -1}, true);
+    EXPECT_EQ(placed.nodeFor(0), cpuNode(0));
+    EXPECT_EQ(placed.nodeFor(1), -1);
+    EXPECT_EQ(placed.getStats()[0].node, cpuNode(0));
+
+    ShardedPipeline unplaced(1, 4, [](size_t, std::string_view, const MessageTiming&) {}, {0});
+    EXPECT_EQ(unplaced.nodeFor(0), -1);
+
+    // Placement needs a worker CPU to take the node from
+    EXPECT_EQ(cpuNode(-1), -1);
+}
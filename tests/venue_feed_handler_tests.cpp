@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "feed_handlers/kraken_decoder.h"
+#include "feed_handlers/venue_feed_handler.h"
+#include <charconv>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace clunk;
+
+namespace {
+
+// A sequenced venue in a terse text format, to drive the shared stage:
+// "snapshot|update <symbol> <sequence> [B|A]<price>:<size>..."
+class TestDecoder : public VenueDecoder {
+public:
+    const char* getName() const override { return "Test"; }
+    VenueEndpoint getEndpoint() const override { return VenueEndpoint{"localhost", "1", "/"}; }
+    ProductScale getScale(const std::string&) const override { return ProductScale(2, 2); }
+
+    std::vector<std::string> subscribeMessages(const std::string& symbol) const override { return {symbol}; }
+    std::vector<std::string> unsubscribeMessages(const std::string& symbol) const override { return {symbol}; }
+    std::vector<std::string> resyncMessages(const std::string& symbol) const override { return {symbol}; }
+
+    std::string_view peekSymbol(std::string_view text) const override {
+        std::vector<std::string_view> fields = split(text);
+        return fields.size() > 1 ? fields[1] : std::string_view{};
+    }
+
+    bool decode(std::string_view text, BookEvents& out) const override {
+        std::vector<std::string_view> fields = split(text);
+        if (fields.size() < 3) {
+            return false;
+        }
+        BookEvent& event = out.add(fields[0] == "snapshot" ? BookEventType::SNAPSHOT : BookEventType::UPDATE,
+                                   fields[1]);
+        std::from_chars(fields[2].data(), fields[2].data() + fields[2].size(), event.sequence);
+        for (size_t i = 3; i < fields.size(); ++i) {
+            std::string_view level = fields[i];
+            size_t colon = level.find(':');
+            if (colon == std::string_view::npos) {
+                return false;
+            }
+            event.levels.push_back(LevelText{level[0] == 'B' ? OrderSide::BUY : OrderSide::SELL,
+                                             level.substr(1, colon - 1), level.substr(colon + 1)});
+        }
+        return true;
+    }
+
+private:
+    static std::vector<std::string_view> split(std::string_view text) {
+        std::vector<std::string_view> fields;
+        while (!text.empty()) {
+            size_t space = text.find(' ');
+            fields.push_back(text.substr(0, space));
+            text = space == std::string_view::npos ? std::string_view{} : text.substr(space + 1);
+        }
+        return fields;
+    }
+};
+
+} // namespace
+
+// Kraken book messages build and maintain the book
+TEST(VenueFeedHandlerTest, AppliesKrakenBook) {
+    VenueFeedHandler handler(std::make_unique<KrakenDecoder>());
+    handler.subscribe("BTC/USD");
+    auto book = handler.getLevelBook("BTC/USD");
+    ASSERT_NE(book, nullptr);
+    const ProductScale& scale = book->getScale();
+
+    // Updates before the snapshot have nothing to apply to
+    handler.injectMessage(R"({"channel":"book","type":"update","data":[{"symbol":"BTC/USD",)"
+                          R"("bids":[{"price":99.0,"qty":5.0}],"asks":[],"checksum":1}]})");
+    EXPECT_EQ(book->getBidLevelCount(), 0u);
+    EXPECT_FALSE(handler.isBookReady("BTC/USD"));
+
+    handler.injectMessage(R"({"channel":"book","type":"snapshot","data":[{"symbol":"BTC/USD",)"
+                          R"("bids":[{"price":100.5,"qty":1.0},{"price":100.0,"qty":3.0}],)"
+                          R"("asks":[{"price":101.0,"qty":2.0}],"checksum":1}]})");
+    EXPECT_TRUE(handler.isBookReady("BTC/USD"));
+    EXPECT_TRUE(handler.waitForBooks({"BTC/USD"}, std::chrono::milliseconds(0)));
+    EXPECT_EQ(book->getBestBid(), scale.toPrice(100.5));
+    EXPECT_EQ(book->getBestAsk(), scale.toPrice(101.0));
+    EXPECT_EQ(book->getBidLevelCount(), 2u);
+
+    // Exponent-form quantities parse, and a quantity of 0 removes the level
+    handler.injectMessage(R"({"channel":"book","type":"update","data":[{"symbol":"BTC/USD",)"
+                          R"("bids":[{"price":100.5,"qty":0}],"asks":[{"price":100.8,"qty":5e-05}],)"
+                          R"("checksum":1}]})");
+    EXPECT_EQ(book->getBestBid(), scale.toPrice(100.0));
+    EXPECT_EQ(book->getBestAsk(), scale.toPrice(100.8));
+    auto asks = book->getAskLevels(1);
+    ASSERT_EQ(asks.size(), 1u);
+    EXPECT_EQ(asks[0].second, scale.toQuantity(0.00005));
+
+    EXPECT_EQ(handler.getDecodeErrorCount(), 0u);
+    handler.injectMessage(R"({"channel":"book","type":"update","data":[{"symbol":"BTC/USD",)"
+                          R"("bids":[{"price":"x","qty":1}],"asks":[]}]})");
+    EXPECT_EQ(handler.getDecodeErrorCount(), 1u);
+    EXPECT_EQ(book->getBestBid(), scale.toPrice(100.0));
+}
+
+// Levels pushed past the subscribed depth are dropped
+TEST(VenueFeedHandlerTest, TrimsToVenueDepth) {
+    VenueFeedHandler handler(std::make_unique<KrakenDecoder>(2));
+    handler.subscribe("ETH/USD");
+    auto book = handler.getLevelBook("ETH/USD");
+    const ProductScale& scale = book->getScale();
+
+    handler.injectMessage(R"({"channel":"book","type":"snapshot","data":[{"symbol":"ETH/USD",)"
+                          R"("bids":[{"price":10.0,"qty":1},{"price":9.0,"qty":1}],)"
+                          R"("asks":[{"price":11.0,"qty":1},{"price":12.0,"qty":1}],"checksum":1}]})");
+    handler.injectMessage(R"({"channel":"book","type":"update","data":[{"symbol":"ETH/USD",)"
+                          R"("bids":[{"price":10.5,"qty":1}],"asks":[{"price":10.8,"qty":1}],"checksum":1}]})");
+
+    auto bids = book->getBidLevels(5);
+    auto asks = book->getAskLevels(5);
+    ASSERT_EQ(bids.size(), 2u);
+    ASSERT_EQ(asks.size(), 2u);
+    EXPECT_EQ(bids[1].first, scale.toPrice(10.0));
+    EXPECT_EQ(asks[1].first, scale.toPrice(11.0));
+}
+
+// Trades reach the callback at the book's scale
+TEST(VenueFeedHandlerTest, DeliversTrades) {
+    VenueFeedHandler handler(std::make_unique<KrakenDecoder>());
+    std::vector<Trade> trades;
+    handler.setTradeCallback([&](const std::string& symbol, const Trade& trade) {
+        EXPECT_EQ(symbol, "BTC/USD");
+        trades.push_back(trade);
+    });
+    handler.subscribe("BTC/USD");
+    const ProductScale& scale = handler.getLevelBook("BTC/USD")->getScale();
+
+    handler.injectMessage(R"({"channel":"trade","type":"update","data":[)"
+                          R"({"symbol":"BTC/USD","side":"sell","price":100.25,"qty":0.5,"trade_id":7}]})");
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_EQ(trades[0].maker_side, OrderSide::BUY);
+    EXPECT_EQ(trades[0].price, scale.toPrice(100.25));
+    EXPECT_EQ(trades[0].size, scale.toQuantity(0.5));
+}
+
+// Sequenced venues hold updates for the snapshot and resync on gaps
+TEST(VenueFeedHandlerTest, SequencesUpdates) {
+    VenueFeedHandler handler(std::make_unique<TestDecoder>());
+    std::vector<ResyncReason> resyncs;
+    handler.setResyncCallback([&](const std::string&, ResyncReason reason) { resyncs.push_back(reason); });
+    handler.subscribe("X");
+    auto book = handler.getLevelBook("X");
+    const ProductScale& scale = book->getScale();
+
+    // Held until the snapshot, then replayed past its sequence
+    handler.injectMessage("update X 10 B9.00:1.00");
+    handler.injectMessage("update X 11 B9.50:2.00");
+    EXPECT_EQ(book->getBidLevelCount(), 0u);
+    handler.injectMessage("snapshot X 10 B9.00:3.00 A10.00:1.00");
+    EXPECT_TRUE(handler.isBookReady("X"));
+    EXPECT_EQ(book->getBestBid(), scale.toPrice(9.50));
+    auto bids = book->getBidLevels(2);
+    ASSERT_EQ(bids.size(), 2u);
+    EXPECT_EQ(bids[1].second, scale.toQuantity(3.0));
+
+    // Stale updates are dropped; a gap starts a resync
+    handler.injectMessage("update X 11 B9.50:0");
+    EXPECT_EQ(book->getBestBid(), scale.toPrice(9.50));
+    handler.injectMessage("update X 13 B9.60:1.00");
+    ASSERT_EQ(resyncs.size(), 1u);
+    EXPECT_EQ(resyncs[0], ResyncReason::SEQUENCE_GAP);
+    EXPECT_EQ(book->getBestBid(), scale.toPrice(9.50));
+
+    // The book stays ready and the next snapshot rebuilds it
+    EXPECT_TRUE(handler.isBookReady("X"));
+    handler.injectMessage("snapshot X 20 B8.00:1.00");
+    handler.injectMessage("update X 21 A8.50:1.00");
+    EXPECT_EQ(book->getBestBid(), scale.toPrice(8.0));
+    EXPECT_EQ(book->getBestAsk(), scale.toPrice(8.5));
+}
+
+// Waiting gives up on books that never see a snapshot
+TEST(VenueFeedHandlerTest, WaitForBooksTimesOut) {
+    VenueFeedHandler handler(std::make_unique<KrakenDecoder>());
+    handler.subscribe("BTC/USD");
+    EXPECT_FALSE(handler.waitForBooks({"BTC/USD"}, std::chrono::milliseconds(20)));
+    EXPECT_FALSE(handler.waitForBooks({"SOL/USD"}, std::chrono::milliseconds(0)));
+    EXPECT_EQ(handler.getBookView("SOL/USD"), nullptr);
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "network/websocket_frame.h"
+#include <cstring>
+#include <string>
+
+using namespace clunk;
+
+namespace {
+
+// Server frame (unmasked) with the given FIN bit, opcode and payload
+std::string serverFrame(bool fin, WsOpcode opcode, const std::string& payload) {
+    std::string frame;
+    frame.push_back(static_cast<char>((fin ? 0x80 : 0x00) | static_cast<uint8_t>(opcode)));
+
+    size_t length = payload.size();
+    if (length < 126) {
+        frame.push_back(static_cast<char>(length));
+    } else if (length <= 0xFFFF) {
+        frame.push_back(static_cast<char>(126));
+        frame.push_back(static_cast<char>(length >> 8));
+        frame.push_back(static_cast<char>(length & 0xFF));
+    } else {
+        frame.push_back(static_cast<char>(127));
+        for (int i = 7; i >= 0; --i) {
+            frame.push_back(static_cast<char>((static_cast<uint64_t>(length) >> (i * 8)) & 0xFF));
+        }
+    }
+    return frame + payload;
+}
+
+// Copy bytes into the parser as if they arrived in one socket read
+void feed(WsFrameParser& parser, const std::string& bytes) {
+    char* data = parser.prepare(bytes.size());
+    ASSERT_GE(parser.writable(), bytes.size());
+    std::memcpy(data, bytes.data(), bytes.size());
+    parser.commit(bytes.size());
+}
+
+} // namespace
+
+// Test that several frames in one read come out in order as in-buffer views
+TEST(WsFrameParserTests, ManyFramesOneRead) {
+    WsFrameParser parser(64);
+    feed(parser, serverFrame(true, WsOpcode::TEXT, "first") +
+                 serverFrame(true, WsOpcode::PING, "hb") +
+                 serverFrame(true, WsOpcode::TEXT, "second"));
+
+    // Payloads point straight into the receive buffer, past the 2-byte header
+    const char* base = parser.buffered().data();
+
+    WsMessage message;
+    ASSERT_EQ(parser.next(message), WsFrameParser::Result::MESSAGE);
+    EXPECT_EQ(message.opcode, WsOpcode::TEXT);
+    EXPECT_EQ(message.payload, "first");
+    EXPECT_EQ(message.payload.data(), base + 2);
+
+    ASSERT_EQ(parser.next(message), WsFrameParser::Result::MESSAGE);
+    EXPECT_TRUE(message.isControl());
+    EXPECT_EQ(message.payload, "hb");
+
+    ASSERT_EQ(parser.next(message), WsFrameParser::Result::MESSAGE);
+    EXPECT_EQ(message.payload, "second");
+    EXPECT_EQ(parser.next(message), WsFrameParser::Result::NEED_MORE);
+}
+
+// Test that a frame much larger than the buffer, arriving in small reads,
+// grows the buffer and is delivered whole
+TEST(WsFrameParserTests, LargeFrameAcrossReads) {
+    WsFrameParser parser(64);
+    std::string payload(200000, 'x');
+    payload.front() = '{';
+    payload.back() = '}';
+    std::string frame = serverFrame(true, WsOpcode::TEXT, payload);
+
+    WsMessage message;
+    size_t offset = 0;
+    while (offset < frame.size()) {
+        EXPECT_EQ(parser.next(message), WsFrameParser::Result::NEED_MORE);
+        size_t chunk = std::min<size_t>(1000, frame.size() - offset);
+        feed(parser, frame.substr(offset, chunk));
+        offset += chunk;
+    }
+
+    ASSERT_EQ(parser.next(message), WsFrameParser::Result::MESSAGE);
+    EXPECT_EQ(message.payload.size(), payload.size());
+    EXPECT_EQ(message.payload, payload);
+    EXPECT_GE(parser.capacity(), frame.size());
+}
+
+// Test that fragmented messages are reassembled around interleaved pings
+TEST(WsFrameParserTests, ReassemblesFragments) {
+    WsFrameParser parser(64);
+    feed(parser, serverFrame(false, WsOpcode::TEXT, "{\"type\":") +
+                 serverFrame(true, WsOpcode::PING, "") +
+                 serverFrame(false, WsOpcode::CONTINUATION, "\"snap") +
+                 serverFrame(true, WsOpcode::CONTINUATION, "shot\"}"));
+
+    WsMessage message;
+    ASSERT_EQ(parser.next(message), WsFrameParser::Result::MESSAGE);
+    EXPECT_EQ(message.opcode, WsOpcode::PING);
+
+    ASSERT_EQ(parser.next(message), WsFrameParser::Result::MESSAGE);
+    EXPECT_EQ(message.opcode, WsOpcode::TEXT);
+    EXPECT_EQ(message.payload, "{\"type\":\"snapshot\"}");
+    EXPECT_EQ(parser.next(message), WsFrameParser::Result::NEED_MORE);
+}
+
+// Test protocol violations and the message size limit
+TEST(WsFrameParserTests, RejectsBadFrames) {
+    WsMessage message;
+
+    WsFrameParser stray(64);
+    feed(stray, serverFrame(true, WsOpcode::CONTINUATION, "orphan"));
+    EXPECT_EQ(stray.next(message), WsFrameParser::Result::ERROR);
+
+    WsFrameParser fragmented_ping(64);
+    feed(fragmented_ping, serverFrame(false, WsOpcode::PING, "x"));
+    EXPECT_EQ(fragmented_ping.next(message), WsFrameParser::Result::ERROR);
+
+    WsFrameParser limited(64, 100);
+    feed(limited, serverFrame(true, WsOpcode::TEXT, std::string(101, 'x')));
+    EXPECT_EQ(limited.next(message), WsFrameParser::Result::ERROR);
+}
+
+// Test that client frames are masked and decode back to the payload
+TEST(WsFrameParserTests, EncodesMaskedClientFrames) {
+    const std::array<uint8_t, 4> mask = {0x01, 0x02, 0x03, 0x04};
+    std::string payload(300, 'a');
+    std::string frame = encodeClientFrame(WsOpcode::TEXT, payload, mask);
+
+    ASSERT_EQ(frame.size(), 2 + 2 + 4 + payload.size());
+    EXPECT_EQ(static_cast<uint8_t>(frame[0]), 0x81);
+    EXPECT_EQ(static_cast<uint8_t>(frame[1]), 0x80 | 126);
+
+    // The parser unmasks in place, so it reads client frames back too
+    WsFrameParser parser(16);
+    feed(parser, frame);
+    WsMessage message;
+    ASSERT_EQ(parser.next(message), WsFrameParser::Result::MESSAGE);
+    EXPECT_EQ(message.payload, payload);
+}